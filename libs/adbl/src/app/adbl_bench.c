@@ -0,0 +1,442 @@
+#include "adbl.h"
+
+// cape includes
+#include "bench/cape_bench.h"
+#include <stc/cape_udc.h>
+#include <fmt/cape_json.h>
+#include <sys/cape_log.h>
+
+// c includes
+#include <stdio.h>
+#include <stdlib.h>
+
+//-----------------------------------------------------------------------------
+
+/* throughput and latency of the adbl calls
+ *
+ * runs against bench.db with SQLite by default, other backends are used with
+ *
+ *   --backend adbl2_mysql --config bench_mysql.json
+ *
+ * the config contains the connection properties, the database needs the table
+ *
+ *   CREATE TABLE bench_table01 (id int NOT NULL AUTO_INCREMENT, wpid int NOT NULL, gpid int, name varchar(128), description varchar(1024),
+ *                               state int, amount double, active tinyint, created varchar(32), PRIMARY KEY (id), KEY (wpid));
+ *
+ * -> with 'trace_ms' in the connection properties the MySQL backend logs each statement with its timings
+ * -> the log level is set with --log, the default is 'warn' to not measure the logging
+ * -> all arguments of the bench harness can be used, see cape_bench.h
+ */
+
+//-----------------------------------------------------------------------------
+
+#define BENCH_TABLE       "bench_table01"
+#define BENCH_ROWS        10000     // rows in the table for the select, update and cursor cases
+#define BENCH_WORKSPACES  100       // the rows are distributed over the workspaces
+
+static AdblSession session = NULL;
+
+static number_t* ids = NULL;        // all ids of the initial rows
+static number_t ids_size = 0;
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc bench_row_new (number_t i)
+{
+  CapeUdc ret = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  // a workstep as it is stored by the flow module
+  cape_udc_add_n (ret, "id", ADBL_AUTO_INCREMENT);
+  cape_udc_add_n (ret, "wpid", i % BENCH_WORKSPACES);
+  cape_udc_add_n (ret, "gpid", 3300 + i % 97);
+  cape_udc_add_s_mv (ret, "name", &(CapeString){cape_str_fmt ("workstep %lu", i)});
+  cape_udc_add_s_cp (ret, "description", "some text with \"quotes\" and unicode \xc3\xa4\xc3\xb6\xc3\xbc, which is as long as a typical description of a workstep in the flow module");
+  cape_udc_add_n (ret, "state", i % 5);
+  cape_udc_add_f (ret, "amount", i * 1.25);
+  cape_udc_add_b (ret, "active", i % 2);
+  cape_udc_add_s_cp (ret, "created", "2023-05-01 12:00:00");
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc bench_columns_new (void)
+{
+  CapeUdc ret = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  cape_udc_add_n (ret, "id", 0);
+  cape_udc_add_n (ret, "wpid", 0);
+  cape_udc_add_n (ret, "gpid", 0);
+  cape_udc_add_s_cp (ret, "name", NULL);
+  cape_udc_add_s_cp (ret, "description", NULL);
+  cape_udc_add_n (ret, "state", 0);
+  cape_udc_add_f (ret, "amount", .0);
+  cape_udc_add_b (ret, "active", FALSE);
+  cape_udc_add_s_cp (ret, "created", NULL);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static int bench_table_init (CapeErr err)
+{
+  int res;
+  number_t i;
+
+  AdblTrx trx = adbl_trx_new (session, err);
+  if (trx == NULL)
+  {
+    return cape_err_code (err);
+  }
+
+  // start with an empty table
+  res = adbl_trx_delete (trx, BENCH_TABLE, NULL, err);
+  if (res)
+  {
+    goto exit_and_cleanup;
+  }
+
+  {
+    CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+    for (i = 0; i < BENCH_ROWS; i++)
+    {
+      CapeUdc row = bench_row_new (i);
+
+      cape_udc_add (rows, &row);
+    }
+
+    res = adbl_trx_insert_many (trx, BENCH_TABLE, &rows, err);
+    if (res)
+    {
+      goto exit_and_cleanup;
+    }
+  }
+
+  // fetch all ids for the lookups
+  {
+    CapeUdc columns = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc results;
+
+    cape_udc_add_n (columns, "id", 0);
+
+    results = adbl_trx_query (trx, BENCH_TABLE, NULL, &columns, err);
+    if (results == NULL)
+    {
+      res = cape_err_code (err);
+      goto exit_and_cleanup;
+    }
+
+    ids_size = cape_udc_size (results);
+    ids = CAPE_ALLOC (ids_size * sizeof(number_t));
+
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (results, CAPE_DIRECTION_FORW);
+
+      while (cape_udc_cursor_next (cursor))
+      {
+        ids[cursor->position] = cape_udc_get_n (cursor->item, "id", 0);
+      }
+
+      cape_udc_cursor_del (&cursor);
+    }
+
+    cape_udc_del (&results);
+  }
+
+  if (ids_size == 0)
+  {
+    res = cape_err_set (err, CAPE_ERR_NOT_FOUND, "no rows in the table");
+    goto exit_and_cleanup;
+  }
+
+  return adbl_trx_commit (&trx, err);
+
+exit_and_cleanup:
+
+  adbl_trx_rollback (&trx, NULL);
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_insert (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeErr err = cape_err_new ();
+
+  AdblTrx trx = adbl_trx_new (session, err);
+
+  for (i = 0; trx && i < loops; i++)
+  {
+    CapeUdc row = bench_row_new (i);
+
+    if (adbl_trx_insert (trx, BENCH_TABLE, &row, err) <= 0)
+    {
+      printf ("insert failed: %s\n", cape_err_text (err));
+      break;
+    }
+  }
+
+  adbl_trx_commit (&trx, err);
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_insert_many (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeErr err = cape_err_new ();
+
+  AdblTrx trx;
+  CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+  // exclude the creation of the rows
+  cape_bench_stop (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc row = bench_row_new (i);
+
+    cape_udc_add (rows, &row);
+  }
+
+  cape_bench_start (bench);
+
+  trx = adbl_trx_new (session, err);
+
+  if (adbl_trx_insert_many (trx, BENCH_TABLE, &rows, err))
+  {
+    printf ("insert many failed: %s\n", cape_err_text (err));
+  }
+
+  adbl_trx_commit (&trx, err);
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_select_id (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeErr err = cape_err_new ();
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc columns = bench_columns_new ();
+    CapeUdc results;
+
+    cape_udc_add_n (params, "id", ids[rand () % ids_size]);
+
+    results = adbl_session_query (session, BENCH_TABLE, &params, &columns, err);
+    if (results == NULL)
+    {
+      printf ("select failed: %s\n", cape_err_text (err));
+      break;
+    }
+
+    cape_udc_del (&results);
+  }
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_select_workspace (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeErr err = cape_err_new ();
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc columns = bench_columns_new ();
+    CapeUdc results;
+
+    // returns BENCH_ROWS / BENCH_WORKSPACES rows
+    cape_udc_add_n (params, "wpid", rand () % BENCH_WORKSPACES);
+
+    results = adbl_session_query (session, BENCH_TABLE, &params, &columns, err);
+    if (results == NULL)
+    {
+      printf ("select failed: %s\n", cape_err_text (err));
+      break;
+    }
+
+    cape_udc_del (&results);
+  }
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_update (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeErr err = cape_err_new ();
+
+  AdblTrx trx = adbl_trx_new (session, err);
+
+  for (i = 0; trx && i < loops; i++)
+  {
+    CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_n (params, "id", ids[rand () % ids_size]);
+
+    cape_udc_add_n (values, "state", i % 5);
+    cape_udc_add_f (values, "amount", i * 0.5);
+
+    if (adbl_trx_update (trx, BENCH_TABLE, &params, &values, err))
+    {
+      printf ("update failed: %s\n", cape_err_text (err));
+      break;
+    }
+  }
+
+  adbl_trx_commit (&trx, err);
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_cursor (CapeBench bench, number_t loops)
+{
+  number_t i = 0;
+  CapeErr err = cape_err_new ();
+
+  AdblTrx trx = adbl_trx_new (session, err);
+
+  // iterate over the table until loops rows were read
+  while (trx && i < loops)
+  {
+    CapeUdc columns = bench_columns_new ();
+
+    AdblCursor cursor = adbl_trx_cursor_new (trx, BENCH_TABLE, NULL, &columns, err);
+    if (cursor == NULL)
+    {
+      printf ("cursor failed: %s\n", cape_err_text (err));
+      break;
+    }
+
+    while (i < loops && adbl_trx_cursor_next (cursor))
+    {
+      CapeUdc row = adbl_trx_cursor_get (cursor);
+
+      if (row)
+      {
+        i++;
+      }
+    }
+
+    adbl_trx_cursor_del (&cursor);
+  }
+
+  adbl_trx_commit (&trx, err);
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 2;
+
+  CapeErr err = cape_err_new ();
+  CapeBench bench = cape_bench_new (argc, argv, "adbl");
+
+  AdblCtx ctx = NULL;
+  CapeUdc properties = NULL;
+
+  const CapeString backend = cape_udc_get_s (bench->args, "backend", "adbl2_sqlite3");
+  const CapeString config = cape_udc_get_s (bench->args, "config", NULL);
+
+  cape_log_set_level (cape_log_level_from_s (cape_udc_get_s (bench->args, "log", NULL), CAPE_LL_WARN));
+
+  ctx = adbl_ctx_new (cape_udc_get_s (bench->args, "path", "adbl"), backend, err);
+  if (ctx == NULL)
+  {
+    printf ("can't load backend '%s': %s\n", backend, cape_err_text (err));
+    goto exit_and_cleanup;
+  }
+
+  if (config)
+  {
+    properties = cape_json_from_file (config, err);
+    if (properties == NULL)
+    {
+      printf ("can't read config '%s': %s\n", config, cape_err_text (err));
+      goto exit_and_cleanup;
+    }
+  }
+  else
+  {
+    properties = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_s_cp (properties, "dbfile", "bench.db");
+  }
+
+  session = adbl_session_open (ctx, properties, err);
+  if (session == NULL)
+  {
+    printf ("can't open session: %s\n", cape_err_text (err));
+    goto exit_and_cleanup;
+  }
+
+  if (bench_table_init (err))
+  {
+    printf ("can't fill table '%s': %s\n", BENCH_TABLE, cape_err_text (err));
+    goto exit_and_cleanup;
+  }
+
+  // throughput in rows
+  cape_bench_run (bench, "insert", 1000, bench_insert);
+  cape_bench_run (bench, "insert_many", 10000, bench_insert_many);
+  cape_bench_run (bench, "update", 1000, bench_update);
+  cape_bench_run (bench, "cursor", 10000, bench_cursor);
+
+  // latency of a single query
+  cape_bench_run (bench, "select_id", 2000, bench_select_id);
+  cape_bench_run (bench, "select_workspace", 500, bench_select_workspace);
+
+  // statistics of the connection pool and the cache
+  {
+    CapeUdc stats = adbl_session_stats (session);
+    CapeString h = cape_json_to_s (stats);
+
+    printf ("\nsession: %s\n", h);
+
+    cape_str_del (&h);
+    cape_udc_del (&stats);
+  }
+
+  res = cape_bench_done (bench);
+
+exit_and_cleanup:
+
+  if (ids)
+  {
+    CAPE_FREE (ids);
+  }
+
+  adbl_session_close (&session);
+  adbl_ctx_del (&ctx);
+
+  cape_udc_del (&properties);
+  cape_bench_del (&bench);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
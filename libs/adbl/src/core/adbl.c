@@ -1,6 +1,7 @@
 #include "adbl.h" 
 #include "adbl_types.h"
 #include "adbl_pool.h"
+#include "adbl_cache.h"
 
 // cape includes
 #include "sys/cape_dl.h"
@@ -9,6 +10,26 @@
 #include "fmt/cape_json.h"
 #include "fmt/cape_args.h"
 #include "sys/cape_file.h"
+#include "sys/cape_mutex.h"
+#include "sys/cape_queue.h"
+
+#include <time.h>
+
+//-----------------------------------------------------------------------------
+
+static void adbl__udc_del (CapeUdc* p_params, CapeUdc* p_values)
+{
+  // params and values are optional
+  if (p_params)
+  {
+    cape_udc_del (p_params);
+  }
+  
+  if (p_values)
+  {
+    cape_udc_del (p_values);
+  }
+}
 
 //-----------------------------------------------------------------------------
 
@@ -91,6 +112,18 @@ AdblCtx adbl_ctx_new (const char* path, const char* backend, CapeErr err)
     goto exit_and_cleanup;
   }
   
+  pvd.pvd_ping = cape_dl_funct (hlib, "adbl_pvd_ping", err);
+  if (pvd.pvd_ping == NULL)
+  {
+    goto exit_and_cleanup;
+  }
+  
+  pvd.pvd_lag = cape_dl_funct (hlib, "adbl_pvd_lag", err);
+  if (pvd.pvd_lag == NULL)
+  {
+    goto exit_and_cleanup;
+  }
+  
   pvd.pvd_get = cape_dl_funct (hlib, "adbl_pvd_get", err);
   if (pvd.pvd_get == NULL)
   {
@@ -121,6 +154,18 @@ AdblCtx adbl_ctx_new (const char* path, const char* backend, CapeErr err)
     goto exit_and_cleanup;
   }
   
+  pvd.pvd_ins_many = cape_dl_funct (hlib, "adbl_pvd_ins_many", err);
+  if (pvd.pvd_ins_many == NULL)
+  {
+    goto exit_and_cleanup;
+  }
+  
+  pvd.pvd_set_many = cape_dl_funct (hlib, "adbl_pvd_set_many", err);
+  if (pvd.pvd_set_many == NULL)
+  {
+    goto exit_and_cleanup;
+  }
+  
   pvd.pvd_cursor_new = cape_dl_funct (hlib, "adbl_pvd_cursor_new", err);
   if (pvd.pvd_cursor_new == NULL)
   {
@@ -196,6 +241,36 @@ void adbl_ctx_del (AdblCtx* p_self)
 
 //-----------------------------------------------------------------------------
 
+typedef struct
+{
+  const AdblPvd* pvd;
+  
+  void* session;
+  
+  AdblPool pool;
+  
+  number_t lag;             // seconds behind the primary, -1 -> not usable
+  
+  time_t lag_checked;
+  
+} AdblSessionReplica;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_session__replicas__on_del (void* ptr)
+{
+  AdblSessionReplica* replica = ptr;
+  
+  // the pool clones connections from the session
+  adbl_pool_del (&(replica->pool));
+  
+  replica->pvd->pvd_close (&(replica->session));
+  
+  CAPE_DEL (&replica, AdblSessionReplica);
+}
+
+//-----------------------------------------------------------------------------
+
 struct AdblSession_s
 {
   const AdblPvd* pvd;
@@ -203,8 +278,79 @@ struct AdblSession_s
   void* session;
   
   AdblPool pool;
+  
+  CapeMutex mutex;
+  
+  CapeQueue queue;          // workers for the async calls, created on first use
+  
+  number_t async_threads;
+  
+  CapeList replicas;        // read only copies of the primary database
+  
+  CapeListNode replicas_next;
+  
+  number_t replica_max_lag;
+  
+  number_t replica_check;
+  
+  AdblCache cache;          // NULL if not enabled
 };
 
+//-----------------------------------------------------------------------------
+
+static void adbl_session__replicas_open (AdblSession self, CapeUdc connection_properties)
+{
+  CapeUdc replicas = cape_udc_get (connection_properties, "replicas");
+  
+  if (replicas)
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (replicas, CAPE_DIRECTION_FORW);
+    
+    while (cape_udc_cursor_next (cursor))
+    {
+      CapeErr err = cape_err_new ();
+      
+      // a replica inherits all properties of the primary
+      CapeUdc replica_properties = cape_udc_cp (connection_properties);
+      
+      {
+        CapeUdc h = cape_udc_ext (replica_properties, "replicas");
+        cape_udc_del (&h);
+      }
+      
+      cape_udc_merge_cp (replica_properties, cursor->item);
+      
+      {
+        void* session = self->pvd->pvd_open (replica_properties, err);
+        
+        if (session)
+        {
+          AdblSessionReplica* replica = CAPE_NEW (AdblSessionReplica);
+          
+          replica->pvd = self->pvd;
+          replica->session = session;
+          replica->pool = adbl_pool_new (self->pvd, session, replica_properties);
+          replica->lag = 0;
+          replica->lag_checked = 0;
+          
+          cape_list_push_back (self->replicas, replica);
+        }
+        else
+        {
+          cape_log_fmt (CAPE_LL_WARN, "ADBL", "session open", "can't open replica #%i: %s", cursor->position, cape_err_text (err));
+        }
+      }
+      
+      cape_udc_del (&replica_properties);
+      cape_err_del (&err);
+    }
+    
+    cape_udc_cursor_del (&cursor);
+  }
+  
+  self->replicas_next = cape_list_node_front (self->replicas);
+}
+
 //=============================================================================
 
 AdblSession adbl_session_open (AdblCtx ctx, CapeUdc connection_properties, CapeErr err)
@@ -223,7 +369,21 @@ AdblSession adbl_session_open (AdblCtx ctx, CapeUdc connection_properties, CapeE
     self->pvd = pvd;
     self->session = session;
     
-    self->pool = adbl_pool_new (&(ctx->pvd));
+    self->pool = adbl_pool_new (&(ctx->pvd), session, connection_properties);
+    
+    self->mutex = cape_mutex_new ();
+    self->queue = NULL;
+    
+    self->async_threads = cape_udc_get_n (connection_properties, "async_threads", 4);
+    
+    self->replicas = cape_list_new (adbl_session__replicas__on_del);
+    
+    self->replica_max_lag = cape_udc_get_n (connection_properties, "replica_max_lag", 30);
+    self->replica_check = cape_udc_get_n (connection_properties, "replica_check", 10);
+    
+    adbl_session__replicas_open (self, connection_properties);
+    
+    self->cache = adbl_cache_new (connection_properties);
     
     return self;
   }
@@ -268,10 +428,20 @@ void adbl_session_close (AdblSession* p_self)
   {
     AdblSession self = *p_self;
     
-    self->pvd->pvd_close (&(self->session));
+    // waits for all running async calls, the ones still queued are cancelled
+    cape_queue_del (&(self->queue));
+    
+    cape_list_del (&(self->replicas));
+    
+    adbl_cache_del (&(self->cache));
     
+    cape_mutex_del (&(self->mutex));
+    
+    // the pool clones connections from the session
     adbl_pool_del (&(self->pool));
     
+    self->pvd->pvd_close (&(self->session));
+    
     CAPE_DEL(p_self, struct AdblSession_s);
   }  
 }
@@ -280,35 +450,469 @@ void adbl_session_close (AdblSession* p_self)
 
 CapeUdc adbl_session_query (AdblSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err)
 {
-  return self->pvd->pvd_get (self->session, table, p_params, p_values, 0, 0, NULL, NULL, err);
+  return adbl_session_query_ex (self, table, p_params, p_values, 0, 0, NULL, NULL, err);
+}
+
+//-----------------------------------------------------------------------------
+
+static AdblSessionReplica* adbl_session__replica_next (AdblSession self)
+{
+  AdblSessionReplica* ret;
+  
+  cape_mutex_lock (self->mutex);
+  
+  ret = cape_list_node_data (self->replicas_next);
+  
+  // round robin
+  self->replicas_next = cape_list_node_next (self->replicas_next);
+  if (NULL == self->replicas_next)
+  {
+    self->replicas_next = cape_list_node_front (self->replicas);
+  }
+  
+  cape_mutex_unlock (self->mutex);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static int adbl_session__replica_usable (AdblSession self, AdblSessionReplica* replica)
+{
+  int check;
+  int busy = FALSE;
+  number_t lag;
+  time_t lag_checked;
+  
+  time_t now = time (NULL);
+  
+  cape_mutex_lock (self->mutex);
+  
+  // only one thread checks the lag, all others use the last value
+  lag_checked = replica->lag_checked;
+  
+  check = (now - lag_checked >= self->replica_check);
+  if (check)
+  {
+    replica->lag_checked = now;
+  }
+  
+  lag = replica->lag;
+  
+  cape_mutex_unlock (self->mutex);
+  
+  if (check)
+  {
+    CapeErr err = cape_err_new ();
+    
+    // don't wait for a connection, a busy replica keeps its last lag
+    CapeListNode pool_node = adbl_pool_try (replica->pool, err);
+    
+    if (pool_node)
+    {
+      lag = self->pvd->pvd_lag (adbl_pool_handle (replica->pool, pool_node), err);
+      
+      adbl_pool_rel (replica->pool, pool_node);
+    }
+    else if (cape_err_code (err))
+    {
+      lag = -1;
+    }
+    else
+    {
+      // all connections are in use, keep the last value and check again with the next request
+      busy = TRUE;
+    }
+    
+    cape_mutex_lock (self->mutex);
+    
+    if (busy)
+    {
+      replica->lag_checked = lag_checked;
+    }
+    else
+    {
+      replica->lag = lag;
+    }
+    
+    cape_mutex_unlock (self->mutex);
+    
+    if (busy)
+    {
+      cape_log_msg (CAPE_LL_TRACE, "ADBL", "session replica", "all connections are in use, lag check was postponed");
+    }
+    else if (lag < 0)
+    {
+      cape_log_fmt (CAPE_LL_WARN, "ADBL", "session replica", "replica is not usable: %s", cape_err_text (err));
+    }
+    else if (lag > self->replica_max_lag)
+    {
+      cape_log_fmt (CAPE_LL_WARN, "ADBL", "session replica", "replica is %i seconds behind", lag);
+    }
+    
+    cape_err_del (&err);
+  }
+  
+  return (lag >= 0) && (lag <= self->replica_max_lag);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeListNode adbl_session__pool_get_read (AdblSession self, AdblPool* p_pool, CapeErr err)
+{
+  number_t i;
+  number_t replicas_cnt = cape_list_size (self->replicas);
+  
+  for (i = 0; i < replicas_cnt; i++)
+  {
+    AdblSessionReplica* replica = adbl_session__replica_next (self);
+    
+    if (adbl_session__replica_usable (self, replica))
+    {
+      // don't wait for a busy replica, the next one or the primary might be free
+      CapeListNode pool_node = adbl_pool_try (replica->pool, err);
+      
+      if (pool_node)
+      {
+        *p_pool = replica->pool;
+        return pool_node;
+      }
+      
+      // try the next one
+      cape_err_clr (err);
+    }
+  }
+  
+  // no replica is usable
+  *p_pool = self->pool;
+  
+  return adbl_pool_get (self->pool, err);
 }
 
 //-----------------------------------------------------------------------------
 
 CapeUdc adbl_session_query_ex (AdblSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr err)
 {
-  return self->pvd->pvd_get (self->session, table, p_params, p_values, limit, offset, group_by, order_by, err);
+  CapeUdc ret = NULL;
+  AdblPool pool;
+  CapeListNode pool_node;
+  
+  // local objects
+  CapeString cache_key = NULL;
+  number_t cache_stamp = 0;
+  
+  if (self->cache)
+  {
+    cache_key = adbl_cache_key (table, p_params ? *p_params : NULL, p_values ? *p_values : NULL, limit, offset, group_by, order_by);
+    
+    ret = adbl_cache_get (self->cache, table, cache_key);
+    if (ret)
+    {
+      adbl__udc_del (p_params, p_values);
+      
+      goto exit_and_cleanup;
+    }
+    
+    cache_stamp = adbl_cache_stamp (self->cache);
+  }
+  
+  // don't use the session handle, all calls on it would be serialized
+  if (cache_key && adbl_cache_modified (self->cache, table, self->replica_max_lag))
+  {
+    // a replica might not have the modification yet, its result would be cached as valid
+    pool = self->pool;
+    pool_node = adbl_pool_get (self->pool, err);
+  }
+  else
+  {
+    pool_node = adbl_session__pool_get_read (self, &pool, err);
+  }
+  
+  if (NULL == pool_node)
+  {
+    adbl__udc_del (p_params, p_values);
+    
+    goto exit_and_cleanup;
+  }
+  
+  ret = self->pvd->pvd_get (adbl_pool_handle (pool, pool_node), table, p_params, p_values, limit, offset, group_by, order_by, err);
+  
+  adbl_pool_rel (pool, pool_node);
+  
+  if (ret && cache_key)
+  {
+    adbl_cache_set (self->cache, table, cache_key, cache_stamp, ret);
+  }
+  
+exit_and_cleanup:
+  
+  cape_str_del (&cache_key);
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
 
 number_t adbl_session_atomic_dec (AdblSession self, const char* table, CapeUdc* p_params, const CapeString atomic_value, CapeErr err)
 {
-  return self->pvd->pvd_atomic_dec (self->session, table, p_params, atomic_value, err);
+  number_t ret;
+  
+  CapeListNode pool_node = adbl_pool_get (self->pool, err);
+  
+  if (NULL == pool_node)
+  {
+    adbl__udc_del (p_params, NULL);
+    
+    return -1;
+  }
+  
+  ret = self->pvd->pvd_atomic_dec (adbl_pool_handle (self->pool, pool_node), table, p_params, atomic_value, err);
+  
+  adbl_pool_rel (self->pool, pool_node);
+  
+  if (self->cache)
+  {
+    adbl_cache_invalidate (self->cache, table);
+  }
+  
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
 
 number_t adbl_session_atomic_inc (AdblSession self, const char* table, CapeUdc* p_params, const CapeString atomic_value, CapeErr err)
 {
-  return self->pvd->pvd_atomic_inc (self->session, table, p_params, atomic_value, err);
+  number_t ret;
+  
+  CapeListNode pool_node = adbl_pool_get (self->pool, err);
+  
+  if (NULL == pool_node)
+  {
+    adbl__udc_del (p_params, NULL);
+    
+    return -1;
+  }
+  
+  ret = self->pvd->pvd_atomic_inc (adbl_pool_handle (self->pool, pool_node), table, p_params, atomic_value, err);
+  
+  adbl_pool_rel (self->pool, pool_node);
+  
+  if (self->cache)
+  {
+    adbl_cache_invalidate (self->cache, table);
+  }
+  
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
 
 number_t adbl_session_atomic_or (AdblSession self, const char* table, CapeUdc* p_params, const CapeString atomic_value, number_t or_val, CapeErr err)
 {
-  return self->pvd->pvd_atomic_or (self->session, table, p_params, atomic_value, or_val, err);
+  number_t ret;
+  
+  CapeListNode pool_node = adbl_pool_get (self->pool, err);
+  
+  if (NULL == pool_node)
+  {
+    adbl__udc_del (p_params, NULL);
+    
+    return -1;
+  }
+  
+  ret = self->pvd->pvd_atomic_or (adbl_pool_handle (self->pool, pool_node), table, p_params, atomic_value, or_val, err);
+  
+  adbl_pool_rel (self->pool, pool_node);
+  
+  if (self->cache)
+  {
+    adbl_cache_invalidate (self->cache, table);
+  }
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc adbl_session_stats (AdblSession self)
+{
+  CapeUdc ret = adbl_pool_stats (self->pool);
+  
+  if (self->cache)
+  {
+    CapeUdc h = adbl_cache_stats (self->cache);
+    
+    cape_udc_add_name (ret, &h, "cache");
+  }
+  
+  if (cape_list_size (self->replicas))
+  {
+    CapeUdc replicas = cape_udc_new (CAPE_UDC_LIST, NULL);
+    
+    CapeListCursor* cursor = cape_list_cursor_create (self->replicas, CAPE_DIRECTION_FORW);
+    
+    while (cape_list_cursor_next (cursor))
+    {
+      AdblSessionReplica* replica = cape_list_node_data (cursor->node);
+      
+      CapeUdc h = adbl_pool_stats (replica->pool);
+      
+      cape_mutex_lock (self->mutex);
+      
+      cape_udc_add_n (h, "lag", replica->lag);
+      
+      cape_mutex_unlock (self->mutex);
+      
+      cape_udc_add (replicas, &h);
+    }
+    
+    cape_list_cursor_destroy (&cursor);
+    
+    cape_udc_add_name (ret, &replicas, "replicas");
+  }
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  AdblSession session;
+  
+  CapeString table;
+  
+  CapeUdc params;
+  
+  CapeUdc values;
+  
+  void* ptr;
+  
+  fct_adbl_session__on_result on_result;
+  
+} AdblSessionTask;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_session__task__on_event (void* ptr, number_t pos, number_t queue_size)
+{
+  AdblSessionTask* task = ptr;
+  
+  CapeErr err = cape_err_new ();
+  
+  CapeUdc result = adbl_session_query (task->session, task->table, &(task->params), &(task->values), err);
+  
+  task->on_result (task->ptr, &result, err);
+  
+  // mark the task as done
+  task->on_result = NULL;
+  
+  cape_udc_del (&result);
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_session__task__on_done (void* ptr, number_t pos, number_t queue_size)
+{
+  AdblSessionTask* task = ptr;
+  
+  if (task->on_result)
+  {
+    // the task was never executed
+    CapeErr err = cape_err_new ();
+    
+    cape_err_set (err, CAPE_ERR_RUNTIME, "session was closed");
+    
+    task->on_result (task->ptr, NULL, err);
+    
+    cape_err_del (&err);
+  }
+  
+  cape_str_del (&(task->table));
+  cape_udc_del (&(task->params));
+  cape_udc_del (&(task->values));
+  
+  CAPE_DEL (&task, AdblSessionTask);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_session__task__on_cancel (void* ptr, number_t pos, number_t queue_size)
+{
+  AdblSessionTask* task = ptr;
+  
+  // don't cancel the thread, it might hold a connection
+  cape_log_fmt (CAPE_LL_WARN, "ADBL", "session async", "query on table '%s' takes too long", task->table);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeQueue adbl_session__queue (AdblSession self, CapeErr err)
+{
+  CapeQueue ret;
+  
+  cape_mutex_lock (self->mutex);
+  
+  if (NULL == self->queue)
+  {
+    CapeQueue queue = cape_queue_new (300000);   // maximum of 5 minutes
+    
+    if (cape_queue_start (queue, self->async_threads, err))
+    {
+      cape_queue_del (&queue);
+    }
+    else
+    {
+      self->queue = queue;
+    }
+  }
+  
+  ret = self->queue;
+  
+  cape_mutex_unlock (self->mutex);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_session_query_async (AdblSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, void* ptr, fct_adbl_session__on_result on_result)
+{
+  CapeErr err = cape_err_new ();
+  
+  CapeQueue queue = adbl_session__queue (self, err);
+  
+  if (queue)
+  {
+    AdblSessionTask* task = CAPE_NEW (AdblSessionTask);
+    
+    task->session = self;
+    task->table = cape_str_cp (table);
+    task->params = NULL;
+    task->values = NULL;
+    task->ptr = ptr;
+    task->on_result = on_result;
+    
+    if (p_params)
+    {
+      cape_udc_replace_mv (&(task->params), p_params);
+    }
+    
+    if (p_values)
+    {
+      cape_udc_replace_mv (&(task->values), p_values);
+    }
+    
+    cape_queue_add (queue, NULL, adbl_session__task__on_event, adbl_session__task__on_done, adbl_session__task__on_cancel, task, 0);
+  }
+  else
+  {
+    adbl__udc_del (p_params, p_values);
+    
+    on_result (ptr, NULL, err);
+  }
+  
+  cape_err_del (&err);
 }
 
 //=============================================================================
@@ -319,28 +923,36 @@ struct AdblTrx_s
   CapeListNode pool_node;
   
   int in_trx;
+  
+  AdblCache cache;          // reference
+  CapeUdc tables;           // all modified tables, invalidated in the cache on commit
 };
 
 //-----------------------------------------------------------------------------
 
-AdblTrx adbl_trx_new  (AdblSession session, CapeErr err)
+static void adbl_trx__modified (AdblTrx self, const char* table)
 {
-  CapeListNode pool_node = adbl_pool_get (session->pool);
-
-  if (NULL == pool_node)
+  if (self->cache)
   {
-    // clone the current pvd handle
-    void* pvd_handle = session->pvd->pvd_clone (session->session, err);
-    
-    if (NULL == pvd_handle)
+    if (NULL == self->tables)
     {
-      // some error happened
-      return NULL;
+      self->tables = cape_udc_new (CAPE_UDC_NODE, NULL);
     }
     
-    pool_node = adbl_pool_add (session->pool, pvd_handle);
-    
-    cape_log_fmt (CAPE_LL_DEBUG, "ADBL", "trx new", "created new connection, current connections %i", adbl_pool_size (session->pool));
+    cape_udc_put_b (self->tables, table, TRUE);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+AdblTrx adbl_trx_new  (AdblSession session, CapeErr err)
+{
+  // waits for a free connection if the pool reached its maximum
+  CapeListNode pool_node = adbl_pool_get (session->pool, err);
+
+  if (NULL == pool_node)
+  {
+    return NULL;
   }
   
   {
@@ -352,6 +964,9 @@ AdblTrx adbl_trx_new  (AdblSession session, CapeErr err)
     // don't start with a transaction  
     self->in_trx = FALSE;
     
+    self->cache = session->cache;
+    self->tables = NULL;
+    
     return self;
   }  
 }
@@ -373,6 +988,20 @@ int adbl_trx_commit (AdblTrx* p_self, CapeErr err)
       res = adbl_pool_trx_commit (self->pool, self->pool_node, err);
     }
     
+    if (self->tables)
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (self->tables, CAPE_DIRECTION_FORW);
+      
+      while (cape_udc_cursor_next (cursor))
+      {
+        adbl_cache_invalidate (self->cache, cape_udc_name (cursor->item));
+      }
+      
+      cape_udc_cursor_del (&cursor);
+      
+      cape_udc_del (&(self->tables));
+    }
+    
     adbl_pool_rel (self->pool, self->pool_node);
     
     CAPE_DEL(p_self, struct AdblTrx_s);
@@ -398,6 +1027,8 @@ int adbl_trx_rollback (AdblTrx* p_self, CapeErr err)
       res = adbl_pool_trx_rollback (self->pool, self->pool_node, err);
     }
     
+    cape_udc_del (&(self->tables));
+    
     adbl_pool_rel (self->pool, self->pool_node);
     
     CAPE_DEL(p_self, struct AdblTrx_s);    
@@ -456,6 +1087,8 @@ number_t adbl_trx_insert (AdblTrx self, const char* table, CapeUdc* p_values, Ca
     return -1;
   }
   
+  adbl_trx__modified (self, table);
+  
   return adbl_pool_trx_insert (self->pool, self->pool_node, table, p_values, err);
 }
 
@@ -469,6 +1102,8 @@ int adbl_trx_update (AdblTrx self, const char* table, CapeUdc* p_params, CapeUdc
     return res;
   }
   
+  adbl_trx__modified (self, table);
+  
   return adbl_pool_trx_update (self->pool, self->pool_node, table, p_params, p_values, err);
 }
 
@@ -482,6 +1117,8 @@ int adbl_trx_delete (AdblTrx self, const char* table, CapeUdc* p_params, CapeErr
     return res;
   }
   
+  adbl_trx__modified (self, table);
+  
   return adbl_pool_trx_delete (self->pool, self->pool_node, table, p_params, err);
 }
 
@@ -495,11 +1132,45 @@ number_t adbl_trx_inorup (AdblTrx self, const char* table, CapeUdc* p_params, Ca
     return -1;
   }
   
+  adbl_trx__modified (self, table);
+  
   return adbl_pool_trx_inorup (self->pool, self->pool_node, table, p_params, p_values, err);
 }
 
 //-----------------------------------------------------------------------------
 
+int adbl_trx_insert_many (AdblTrx self, const char* table, CapeUdc* p_rows, CapeErr err)
+{
+  int res = adbl_trx_start (self, err);
+  if (res)
+  {
+    cape_udc_del (p_rows);
+    return res;
+  }
+  
+  adbl_trx__modified (self, table);
+  
+  return adbl_pool_trx_insert_many (self->pool, self->pool_node, table, p_rows, err);
+}
+
+//-----------------------------------------------------------------------------
+
+int adbl_trx_update_many (AdblTrx self, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr err)
+{
+  int res = adbl_trx_start (self, err);
+  if (res)
+  {
+    cape_udc_del (p_rows);
+    return res;
+  }
+  
+  adbl_trx__modified (self, table);
+  
+  return adbl_pool_trx_update_many (self->pool, self->pool_node, table, key, p_rows, err);
+}
+
+//-----------------------------------------------------------------------------
+
 struct AdblCursor_s
 {
   const AdblPvd* pvd;
@@ -563,6 +1234,61 @@ CapeUdc adbl_trx_cursor_get (AdblCursor self)
 
 //-----------------------------------------------------------------------------
 
+int adbl_trx_cursor_json (AdblCursor self, CapeStream stream, number_t chunk_size, void* ptr, fct_adbl_cursor__on_chunk on_chunk, CapeErr err)
+{
+  int res;
+  int first = TRUE;
+  
+  cape_stream_append_c (stream, '[');
+  
+  while (self->pvd->pvd_cursor_next (self->handle))
+  {
+    // only one row exists as udc at the same time
+    CapeUdc row = self->pvd->pvd_cursor_get (self->handle);
+    
+    if (first)
+    {
+      first = FALSE;
+    }
+    else
+    {
+      cape_stream_append_c (stream, ',');
+    }
+    
+    cape_json_append (stream, row);
+    
+    cape_udc_del (&row);
+    
+    if (on_chunk && cape_stream_size (stream) > chunk_size)
+    {
+      res = on_chunk (ptr, stream, err);
+      if (res)
+      {
+        return res;
+      }
+      
+      cape_stream_clr (stream);
+    }
+  }
+  
+  cape_stream_append_c (stream, ']');
+  
+  if (on_chunk)
+  {
+    res = on_chunk (ptr, stream, err);
+    if (res)
+    {
+      return res;
+    }
+    
+    cape_stream_clr (stream);
+  }
+  
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 void adbl_param_add__greater_than_n (CapeUdc params, const CapeString name, number_t value)
 {
   CapeUdc h = cape_udc_new (CAPE_UDC_NODE, name);
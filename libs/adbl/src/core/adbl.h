@@ -4,6 +4,7 @@
 #include "sys/cape_export.h"
 #include "sys/cape_err.h"
 #include "stc/cape_udc.h"
+#include "stc/cape_stream.h"
 
 //-----------------------------------------------------------------------------
 
@@ -33,6 +34,13 @@ struct AdblSession_s; typedef struct AdblSession_s* AdblSession;
 
 //-----------------------------------------------------------------------------
 
+                                  /* connection_properties can have a list 'replicas' of read only copies
+                                     -> each replica inherits all properties of the primary and overrides some of them, e.g. [{"host": "db2"}]
+                                     -> session queries are balanced over all replicas, all other calls and transactions use the primary
+                                     -> a replica is not used if it is more than 'replica_max_lag' seconds behind (default 30)
+                                     -> the lag is checked every 'replica_check' seconds (default 10)
+                                     -> session queries can be cached, see adbl_cache.h
+                                     -> with the cache, tables modified within the last 'replica_max_lag' seconds are read from the primary */
 __CAPE_LIBEX   AdblSession        adbl_session_open          (AdblCtx, CapeUdc connection_properties, CapeErr);
 
 __CAPE_LIBEX   AdblSession        adbl_session_open_file     (AdblCtx, const char* config_file, CapeErr);
@@ -41,6 +49,8 @@ __CAPE_LIBEX   void               adbl_session_close         (AdblSession*);
 
 //-----------------------------------------------------------------------------
 
+                                  /* all session calls take a connection from the pool for the time of the call,
+                                     so that calls from different threads run in parallel */
 __CAPE_LIBEX   CapeUdc            adbl_session_query         (AdblSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
 
                                   /* same as session query with extended options */
@@ -55,6 +65,21 @@ __CAPE_LIBEX   number_t           adbl_session_atomic_inc    (AdblSession, const
                                   /* apply a binaer operation, the result will be returned or an error if not possible */
 __CAPE_LIBEX   number_t           adbl_session_atomic_or     (AdblSession, const char* table, CapeUdc* p_params, const CapeString atomic_value, number_t or_with, CapeErr);
 
+                                  /* statistics of the connection pool, see adbl_pool.h
+                                     -> with cache: a node 'cache' with the cache statistics
+                                     -> with replicas: a list 'replicas' with the statistics and the lag of each replica */
+__CAPE_LIBEX   CapeUdc            adbl_session_stats         (AdblSession);
+
+//-----------------------------------------------------------------------------
+
+                                  /* p_result is NULL in case of an error, the callback can take over the result */
+typedef void (__STDCALL *fct_adbl_session__on_result) (void* ptr, CapeUdc* p_result, CapeErr err);
+
+                                  /* runs the query in the background on one of the session workers
+                                     -> on_result is called on the worker thread, also with an error if the session was closed before
+                                     -> the amount of workers is set by the connection property 'async_threads' (default 4) */
+__CAPE_LIBEX   void               adbl_session_query_async   (AdblSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, void* ptr, fct_adbl_session__on_result);
+
 //=============================================================================
 
 struct AdblTrx_s; typedef struct AdblTrx_s* AdblTrx;
@@ -79,12 +104,22 @@ __CAPE_LIBEX   int                adbl_trx_delete            (AdblTrx, const cha
 
 __CAPE_LIBEX   number_t           adbl_trx_inorup            (AdblTrx, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
 
+                                  /* inserts a list of rows, rows with the same columns are sent as one statement
+                                     -> the amount of rows per statement is set by 'batch_size' of the connection properties
+                                     -> no IDs are returned, use adbl_trx_insert if the IDs are needed */
+__CAPE_LIBEX   int                adbl_trx_insert_many       (AdblTrx, const char* table, CapeUdc* p_rows, CapeErr);
+
+                                  /* updates a list of rows, the column 'key' of each row is the constraint */
+__CAPE_LIBEX   int                adbl_trx_update_many       (AdblTrx, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr);
+
 //-----------------------------------------------------------------------------
 
 struct AdblCursor_s; typedef struct AdblCursor_s* AdblCursor;
 
 //-----------------------------------------------------------------------------
 
+                                  /* rows are fetched one by one, the mysql provider uses a server side cursor
+                                     -> the amount of rows transfered at once is set by 'prefetch_rows' of the connection properties */
 __CAPE_LIBEX   AdblCursor         adbl_trx_cursor_new        (AdblTrx, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
 
 __CAPE_LIBEX   void               adbl_trx_cursor_del        (AdblCursor*);
@@ -93,6 +128,13 @@ __CAPE_LIBEX   int                adbl_trx_cursor_next       (AdblCursor);
 
 __CAPE_LIBEX   CapeUdc            adbl_trx_cursor_get        (AdblCursor);
 
+typedef int (__STDCALL *fct_adbl_cursor__on_chunk) (void* ptr, CapeStream stream, CapeErr err);
+
+                                  /* writes all remaining rows as json array into the stream
+                                     -> on_chunk is called each time the stream exceeds chunk_size and at the end, the stream is cleared afterwards
+                                     -> without on_chunk the whole array is written into the stream */
+__CAPE_LIBEX   int                adbl_trx_cursor_json       (AdblCursor, CapeStream stream, number_t chunk_size, void* ptr, fct_adbl_cursor__on_chunk, CapeErr);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   void          adbl_param_add__greater_than_n  (CapeUdc params, const CapeString name, number_t value);
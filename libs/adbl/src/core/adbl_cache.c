@@ -0,0 +1,407 @@
+#include "adbl_cache.h"
+
+// cape includes
+#include <sys/cape_types.h>
+#include <sys/cape_mutex.h>
+#include <sys/cape_log.h>
+#include <stc/cape_map.h>
+#include <stc/cape_list.h>
+#include <fmt/cape_json.h>
+
+// c includes
+#include <time.h>
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeString key;          // reference, owned by the map
+
+  CapeString table;
+
+  CapeUdc result;
+
+  number_t stamp;          // the result is older than all invalidations after this stamp
+
+  time_t expires;
+
+  number_t size;           // estimated memory usage
+
+  CapeListNode fifo_node;
+
+} AdblCacheEntry;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_cache__entries__on_del (void* key, void* val)
+{
+  {
+    CapeString h = key; cape_str_del (&h);
+  }
+  {
+    AdblCacheEntry* entry = val;
+
+    cape_str_del (&(entry->table));
+    cape_udc_del (&(entry->result));
+
+    CAPE_DEL (&entry, AdblCacheEntry);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+struct AdblCache_s
+{
+  CapeMutex mutex;
+
+  CapeMap entries;         // key -> entry
+
+  CapeList fifo;           // entries in the order they were added, all have the same ttl
+
+  CapeUdc invalidated;     // table -> stamp of the last invalidation
+
+  CapeUdc modified;        // table -> time of the last invalidation
+
+  number_t stamp;
+
+  // settings
+
+  number_t ttl;
+  number_t size_max;
+
+  CapeUdc depends;         // view -> list of tables
+
+  // statistics
+
+  number_t size;
+  number_t hits;
+  number_t misses;
+  number_t invalidations;
+  number_t evictions;
+};
+
+//-----------------------------------------------------------------------------
+
+AdblCache adbl_cache_new (CapeUdc cp)
+{
+  AdblCache self;
+
+  number_t ttl = cape_udc_get_n (cp, "cache_ttl", 0);
+  if (ttl <= 0)
+  {
+    return NULL;
+  }
+
+  self = CAPE_NEW (struct AdblCache_s);
+
+  self->mutex = cape_mutex_new ();
+
+  self->entries = cape_map_new (cape_map__compare__s, adbl_cache__entries__on_del, NULL);
+  self->fifo = cape_list_new (NULL);
+  self->invalidated = cape_udc_new (CAPE_UDC_NODE, NULL);
+  self->modified = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  self->stamp = 0;
+
+  self->ttl = ttl;
+  self->size_max = cape_udc_get_n (cp, "cache_max", 67108864);
+
+  {
+    CapeUdc depends = cape_udc_get (cp, "cache_depends");
+
+    self->depends = depends ? cape_udc_cp (depends) : cape_udc_new (CAPE_UDC_NODE, NULL);
+  }
+
+  self->size = 0;
+  self->hits = 0;
+  self->misses = 0;
+  self->invalidations = 0;
+  self->evictions = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_cache_del (AdblCache* p_self)
+{
+  if (*p_self)
+  {
+    AdblCache self = *p_self;
+
+    cape_list_del (&(self->fifo));
+    cape_map_del (&(self->entries));
+
+    cape_udc_del (&(self->invalidated));
+    cape_udc_del (&(self->modified));
+    cape_udc_del (&(self->depends));
+
+    cape_mutex_del (&(self->mutex));
+
+    CAPE_DEL (p_self, struct AdblCache_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeString adbl_cache_key (const char* table, const CapeUdc params, const CapeUdc values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by)
+{
+  CapeString ret;
+
+  CapeString params_json = params ? cape_json_to_s (params) : NULL;
+  CapeString values_json = values ? cape_json_to_s (values) : NULL;
+
+  ret = cape_str_fmt ("%s|%s|%s|%i|%i|%s|%s", table, params_json ? params_json : "", values_json ? values_json : "", limit, offset, group_by ? group_by : "", order_by ? order_by : "");
+
+  cape_str_del (&params_json);
+  cape_str_del (&values_json);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static void adbl_cache__remove (AdblCache self, CapeMapNode n)
+{
+  AdblCacheEntry* entry = cape_map_node_value (n);
+
+  self->size -= entry->size;
+
+  cape_list_node_erase (self->fifo, entry->fifo_node);
+  cape_map_erase (self->entries, n);
+}
+
+//-----------------------------------------------------------------------------
+
+static int adbl_cache__is_valid (AdblCache self, AdblCacheEntry* entry)
+{
+  if (entry->expires < time (NULL))
+  {
+    return FALSE;
+  }
+
+  if (cape_udc_get_n (self->invalidated, entry->table, 0) > entry->stamp)
+  {
+    return FALSE;
+  }
+
+  {
+    int ret = TRUE;
+
+    CapeUdc tables = cape_udc_get (self->depends, entry->table);
+    if (tables)
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (tables, CAPE_DIRECTION_FORW);
+
+      while (ret && cape_udc_cursor_next (cursor))
+      {
+        const CapeString table = cape_udc_s (cursor->item, NULL);
+
+        if (table && cape_udc_get_n (self->invalidated, table, 0) > entry->stamp)
+        {
+          ret = FALSE;
+        }
+      }
+
+      cape_udc_cursor_del (&cursor);
+    }
+
+    return ret;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc adbl_cache_get (AdblCache self, const char* table, const CapeString key)
+{
+  CapeUdc ret = NULL;
+
+  cape_mutex_lock (self->mutex);
+
+  {
+    CapeMapNode n = cape_map_find (self->entries, (void*)key);
+    if (n)
+    {
+      AdblCacheEntry* entry = cape_map_node_value (n);
+
+      if (adbl_cache__is_valid (self, entry))
+      {
+        ret = cape_udc_share (entry->result);
+      }
+      else
+      {
+        adbl_cache__remove (self, n);
+      }
+    }
+  }
+
+  if (ret)
+  {
+    self->hits++;
+  }
+  else
+  {
+    self->misses++;
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t adbl_cache_stamp (AdblCache self)
+{
+  number_t ret;
+
+  cape_mutex_lock (self->mutex);
+
+  ret = self->stamp;
+
+  cape_mutex_unlock (self->mutex);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_cache_set (AdblCache self, const char* table, const CapeString key, number_t stamp, const CapeUdc result)
+{
+  number_t size;
+  AdblCacheEntry* entry;
+
+  // estimate the memory usage by the size of the serialized result
+  {
+    CapeString h = cape_json_to_s (result);
+
+    size = cape_str_size (h) + cape_str_size (key);
+
+    cape_str_del (&h);
+  }
+
+  if (size > self->size_max)
+  {
+    return;
+  }
+
+  entry = CAPE_NEW (AdblCacheEntry);
+
+  entry->table = cape_str_cp (table);
+  entry->result = cape_udc_share (result);
+  entry->stamp = stamp;
+  entry->expires = time (NULL) + self->ttl;
+  entry->size = size;
+
+  cape_mutex_lock (self->mutex);
+
+  {
+    CapeMapNode n = cape_map_find (self->entries, (void*)key);
+    if (n)
+    {
+      adbl_cache__remove (self, n);
+    }
+  }
+
+  // the oldest entries are removed first, they expire first
+  while (cape_list_size (self->fifo))
+  {
+    AdblCacheEntry* oldest = cape_list_node_data (cape_list_node_front (self->fifo));
+
+    if (oldest->expires >= entry->expires - self->ttl)
+    {
+      if (self->size + size <= self->size_max)
+      {
+        break;
+      }
+
+      // still valid, but there is no space left
+      self->evictions++;
+    }
+
+    adbl_cache__remove (self, cape_map_find (self->entries, (void*)oldest->key));
+  }
+
+  entry->fifo_node = cape_list_push_back (self->fifo, entry);
+
+  entry->key = cape_str_cp (key);
+
+  cape_map_insert (self->entries, entry->key, entry);
+
+  self->size += size;
+
+  cape_mutex_unlock (self->mutex);
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_cache_invalidate (AdblCache self, const char* table)
+{
+  cape_mutex_lock (self->mutex);
+
+  self->stamp++;
+
+  cape_udc_put_n (self->invalidated, table, self->stamp);
+  cape_udc_put_n (self->modified, table, time (NULL));
+
+  self->invalidations++;
+
+  cape_mutex_unlock (self->mutex);
+}
+
+//-----------------------------------------------------------------------------
+
+int adbl_cache_modified (AdblCache self, const char* table, number_t seconds)
+{
+  int ret;
+  time_t since = time (NULL) - seconds;
+
+  cape_mutex_lock (self->mutex);
+
+  ret = cape_udc_get_n (self->modified, table, 0) >= since;
+
+  if (!ret)
+  {
+    CapeUdc tables = cape_udc_get (self->depends, table);
+    if (tables)
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (tables, CAPE_DIRECTION_FORW);
+
+      while (!ret && cape_udc_cursor_next (cursor))
+      {
+        const CapeString h = cape_udc_s (cursor->item, NULL);
+
+        ret = h && (cape_udc_get_n (self->modified, h, 0) >= since);
+      }
+
+      cape_udc_cursor_del (&cursor);
+    }
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc adbl_cache_stats (AdblCache self)
+{
+  CapeUdc ret = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  cape_mutex_lock (self->mutex);
+
+  cape_udc_add_n (ret, "entries", cape_map_size (self->entries));
+  cape_udc_add_n (ret, "size", self->size);
+  cape_udc_add_n (ret, "max", self->size_max);
+  cape_udc_add_n (ret, "hits", self->hits);
+  cape_udc_add_n (ret, "misses", self->misses);
+  cape_udc_add_n (ret, "invalidations", self->invalidations);
+  cape_udc_add_n (ret, "evictions", self->evictions);
+
+  cape_mutex_unlock (self->mutex);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+#ifndef __ADBL_CACHE__H
+#define __ADBL_CACHE__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_str.h"
+#include "stc/cape_udc.h"
+
+//-----------------------------------------------------------------------------
+
+/* cache of query results
+ *
+ * the cache is configured by the connection properties
+ *
+ * -> cache_ttl:      seconds a result is kept, 0 -> no cache (default 0)
+ * -> cache_max:      maximum size of all results in bytes (default 64 MB)
+ * -> cache_depends:  the tables of each view, e.g. {"auth_roles_view": ["auth_roles", "auth_users"]}
+ *
+ * a result is invalidated when one of its tables was modified by this process,
+ * results of views without dependencies are only removed after the ttl
+ */
+
+//-----------------------------------------------------------------------------
+
+struct AdblCache_s; typedef struct AdblCache_s* AdblCache;
+
+//-----------------------------------------------------------------------------
+
+                                  /* returns NULL if the cache is not enabled */
+__CAPE_LIBEX   AdblCache          adbl_cache_new             (CapeUdc connection_properties);
+
+__CAPE_LIBEX   void               adbl_cache_del             (AdblCache*);
+
+//-----------------------------------------------------------------------------
+
+                                  /* creates the key of a query */
+__CAPE_LIBEX   CapeString         adbl_cache_key             (const char* table, const CapeUdc params, const CapeUdc values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by);
+
+                                  /* returns a copy of the result or NULL */
+__CAPE_LIBEX   CapeUdc            adbl_cache_get             (AdblCache, const char* table, const CapeString key);
+
+                                  /* must be fetched before the query runs, so that invalidations while the query runs are seen */
+__CAPE_LIBEX   number_t           adbl_cache_stamp           (AdblCache);
+
+                                  /* adds a copy of the result */
+__CAPE_LIBEX   void               adbl_cache_set             (AdblCache, const char* table, const CapeString key, number_t stamp, const CapeUdc result);
+
+                                  /* all results of the table and the views depending on it are not used anymore */
+__CAPE_LIBEX   void               adbl_cache_invalidate      (AdblCache, const char* table);
+
+                                  /* returns TRUE if the table or one of the tables of the view was invalidated within the last seconds */
+__CAPE_LIBEX   int                adbl_cache_modified        (AdblCache, const char* table, number_t seconds);
+
+                                  /* returns {entries, size, max, hits, misses, invalidations, evictions}
+                                     -> size and max are in bytes */
+__CAPE_LIBEX   CapeUdc            adbl_cache_stats           (AdblCache);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -3,17 +3,29 @@
 // cape includes
 #include <sys/cape_types.h>
 #include <sys/cape_mutex.h>
+#include <sys/cape_thread.h>
+#include <sys/cape_time.h>
+#include <sys/cape_log.h>
+
+// c includes
+#include <time.h>
+
+// wake up interval of the maintenance thread in milliseconds
+#define ADBL_POOL_MAINTENANCE_INTERVAL 1000
 
 //-----------------------------------------------------------------------------
 
 typedef struct
 {
   const AdblPvd* pvd;
-  
+
   void* handle;
-  
+
   int used;
-  
+
+  time_t last_used;        // the connection was released
+  time_t last_check;       // the connection was validated
+
 } AdblPoolItem;
 
 //-----------------------------------------------------------------------------
@@ -21,11 +33,43 @@ typedef struct
 struct AdblPool_s
 {
   const AdblPvd* pvd;
-  
+
+  void* session;           // reference, new connections are cloned from it
+
   CapeMutex mutex;
-  
-  CapeList connections;
-  
+
+  CapeCond cond;           // signals a released connection
+
+  CapeList connections;    // all connections
+
+  CapeList idle;           // nodes of the free connections, the last released is used first
+
+  number_t creating;       // connections which are cloned right now
+
+  // settings
+
+  number_t size_min;
+  number_t size_max;
+  number_t wait_timeout;
+  number_t idle_timeout;
+  number_t check_interval;
+
+  // maintenance
+
+  CapeThread thread;
+  CapeCond thread_cond;
+  int terminated;
+
+  // statistics
+
+  number_t waiters;
+  number_t waits;
+  double wait_time;
+  double wait_max;
+  number_t timeouts;
+  number_t created;
+  number_t closed;
+  number_t broken;
 };
 
 //-----------------------------------------------------------------------------
@@ -33,24 +77,290 @@ struct AdblPool_s
 static void __STDCALL adbl_pool__connections__on_del (void* ptr)
 {
   AdblPoolItem* item = ptr;
-  
+
   item->pvd->pvd_close (&(item->handle));
-  
-  CAPE_DEL (&item, struct AdblPool_s);
+
+  CAPE_DEL (&item, AdblPoolItem);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeListNode adbl_pool__add (AdblPool self, void* pvd_handle)
+{
+  AdblPoolItem* item = CAPE_NEW (AdblPoolItem);
+
+  item->handle = pvd_handle;
+  item->pvd = self->pvd;
+  item->used = TRUE;
+
+  item->last_used = time (NULL);
+  item->last_check = item->last_used;
+
+  self->created++;
+
+  return cape_list_push_back (self->connections, item);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeListNode adbl_pool__create (AdblPool self, CapeErr err)
+{
+  CapeListNode n = NULL;
+  void* pvd_handle;
+
+  // cloning takes a while, don't block the others
+  self->creating++;
+
+  cape_mutex_unlock (self->mutex);
+
+  pvd_handle = self->pvd->pvd_clone (self->session, err);
+
+  cape_mutex_lock (self->mutex);
+
+  self->creating--;
+
+  if (pvd_handle)
+  {
+    n = adbl_pool__add (self, pvd_handle);
+
+    cape_log_fmt (CAPE_LL_DEBUG, "ADBL", "pool", "created new connection, current connections %i", cape_list_size (self->connections));
+  }
+  else
+  {
+    // a waiting thread might try it again
+    cape_cond_signal (self->cond);
+  }
+
+  return n;
+}
+
+//-----------------------------------------------------------------------------
+
+static void adbl_pool__remove (AdblPool self, CapeListNode n, CapeList closing)
+{
+  // the connection is closed outside of the lock
+  cape_list_push_back (closing, cape_list_node_extract (self->connections, n));
+}
+
+//-----------------------------------------------------------------------------
+
+static void adbl_pool__maintenance (AdblPool self)
+{
+  time_t now = time (NULL);
+
+  // local objects
+  CapeList closing = cape_list_new (adbl_pool__connections__on_del);
+  CapeList checking = cape_list_new (NULL);
+
+  {
+    CapeListCursor* cursor = cape_list_cursor_create (self->idle, CAPE_DIRECTION_FORW);
+
+    while (cape_list_cursor_next (cursor))
+    {
+      CapeListNode n = cape_list_node_data (cursor->node);
+      AdblPoolItem* item = cape_list_node_data (n);
+
+      if (self->idle_timeout && now - item->last_used >= self->idle_timeout && (number_t)cape_list_size (self->connections) > self->size_min)
+      {
+        cape_list_cursor_erase (self->idle, cursor);
+
+        adbl_pool__remove (self, n, closing);
+
+        self->closed++;
+      }
+      else if (self->check_interval && now - item->last_check >= self->check_interval)
+      {
+        // take the connection out of the pool while it is validated
+        cape_list_cursor_erase (self->idle, cursor);
+
+        item->used = TRUE;
+
+        cape_list_push_back (checking, n);
+      }
+    }
+
+    cape_list_cursor_destroy (&cursor);
+  }
+
+  if (cape_list_size (checking))
+  {
+    CapeErr err = cape_err_new ();
+
+    cape_mutex_unlock (self->mutex);
+
+    {
+      CapeListCursor* cursor = cape_list_cursor_create (checking, CAPE_DIRECTION_FORW);
+
+      while (cape_list_cursor_next (cursor))
+      {
+        CapeListNode n = cape_list_node_data (cursor->node);
+        AdblPoolItem* item = cape_list_node_data (n);
+
+        if (self->pvd->pvd_ping (item->handle, err))
+        {
+          cape_log_fmt (CAPE_LL_WARN, "ADBL", "pool", "connection is broken: %s", cape_err_text (err));
+
+          // mark as broken
+          item->last_check = 0;
+        }
+        else
+        {
+          item->last_check = now;
+        }
+      }
+
+      cape_list_cursor_destroy (&cursor);
+    }
+
+    cape_mutex_lock (self->mutex);
+
+    {
+      CapeListCursor* cursor = cape_list_cursor_create (checking, CAPE_DIRECTION_FORW);
+
+      while (cape_list_cursor_next (cursor))
+      {
+        CapeListNode n = cape_list_node_data (cursor->node);
+        AdblPoolItem* item = cape_list_node_data (n);
+
+        if (item->last_check)
+        {
+          item->used = FALSE;
+
+          // keep the order of usage
+          cape_list_push_front (self->idle, n);
+
+          cape_cond_signal (self->cond);
+        }
+        else
+        {
+          adbl_pool__remove (self, n, closing);
+
+          self->broken++;
+        }
+      }
+
+      cape_list_cursor_destroy (&cursor);
+    }
+
+    cape_err_del (&err);
+  }
+
+  // keep the minimum of open connections
+  while ((number_t)cape_list_size (self->connections) + self->creating < self->size_min && !self->terminated)
+  {
+    CapeErr err = cape_err_new ();
+
+    CapeListNode n = adbl_pool__create (self, err);
+
+    cape_err_del (&err);
+
+    if (n == NULL)
+    {
+      break;
+    }
+
+    {
+      AdblPoolItem* item = cape_list_node_data (n);
+
+      item->used = FALSE;
+
+      cape_list_push_back (self->idle, n);
+
+      cape_cond_signal (self->cond);
+    }
+  }
+
+  cape_list_del (&checking);
+
+  if (cape_list_size (closing))
+  {
+    cape_mutex_unlock (self->mutex);
+
+    cape_list_del (&closing);
+
+    cape_mutex_lock (self->mutex);
+  }
+  else
+  {
+    cape_list_del (&closing);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL adbl_pool__worker (void* ptr)
+{
+  AdblPool self = ptr;
+  int ret;
+
+  cape_mutex_lock (self->mutex);
+
+  if (!self->terminated)
+  {
+    cape_cond_wait (self->thread_cond, self->mutex, ADBL_POOL_MAINTENANCE_INTERVAL);
+  }
+
+  if (self->terminated)
+  {
+    ret = FALSE;
+  }
+  else
+  {
+    adbl_pool__maintenance (self);
+
+    ret = TRUE;
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
 
-AdblPool adbl_pool_new (const AdblPvd* pvd)
+AdblPool adbl_pool_new (const AdblPvd* pvd, void* session, CapeUdc cp)
 {
   AdblPool self = CAPE_NEW (struct AdblPool_s);
-  
+
   self->pvd = pvd;
-  
+  self->session = session;
+
   self->mutex = cape_mutex_new ();
+  self->cond = cape_cond_new ();
+
   self->connections = cape_list_new (adbl_pool__connections__on_del);
-  
-  return self;  
+  self->idle = cape_list_new (NULL);
+
+  self->creating = 0;
+
+  self->size_min = cape_udc_get_n (cp, "pool_min", 0);
+  self->size_max = cape_udc_get_n (cp, "pool_max", 50);
+  self->wait_timeout = cape_udc_get_n (cp, "pool_wait", 10000);
+  self->idle_timeout = cape_udc_get_n (cp, "pool_idle", 300);
+  self->check_interval = cape_udc_get_n (cp, "pool_check", 60);
+
+  self->waiters = 0;
+  self->waits = 0;
+  self->wait_time = 0;
+  self->wait_max = 0;
+  self->timeouts = 0;
+  self->created = 0;
+  self->closed = 0;
+  self->broken = 0;
+
+  self->thread = NULL;
+  self->thread_cond = NULL;
+  self->terminated = FALSE;
+
+  if (self->size_min || self->idle_timeout || self->check_interval)
+  {
+    self->thread_cond = cape_cond_new ();
+    self->thread = cape_thread_new ();
+
+    cape_thread_start (self->thread, adbl_pool__worker, self);
+  }
+
+  return self;
 }
 
 //-----------------------------------------------------------------------------
@@ -60,12 +370,31 @@ void adbl_pool_del (AdblPool* p_self)
   if (*p_self)
   {
     AdblPool self = *p_self;
-    
-    cape_mutex_del (&(self->mutex));
+
+    if (self->thread)
+    {
+      cape_mutex_lock (self->mutex);
+
+      self->terminated = TRUE;
+
+      cape_cond_signal (self->thread_cond);
+
+      cape_mutex_unlock (self->mutex);
+
+      cape_thread_join (self->thread);
+
+      cape_thread_del (&(self->thread));
+      cape_cond_del (&(self->thread_cond));
+    }
+
+    cape_list_del (&(self->idle));
     cape_list_del (&(self->connections));
-    
+
+    cape_cond_del (&(self->cond));
+    cape_mutex_del (&(self->mutex));
+
     CAPE_DEL(p_self, struct AdblPool_s);
-  } 
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -77,55 +406,108 @@ const AdblPvd* adbl_pool_pvd (AdblPool self)
 
 //-----------------------------------------------------------------------------
 
-CapeListNode adbl_pool_get (AdblPool self)
+static CapeListNode adbl_pool__get (AdblPool self, int wait, CapeErr err)
 {
   CapeListNode n = NULL;
-  
+
+  // local objects
+  CapeStopTimer st = NULL;
+
   cape_mutex_lock (self->mutex);
 
+  while (TRUE)
   {
-    CapeListCursor* cursor = cape_list_cursor_create (self->connections, CAPE_DIRECTION_FORW);
-    
-    while (cape_list_cursor_next (cursor))
+    if (cape_list_size (self->idle))
+    {
+      // the last released connection is still warm
+      n = cape_list_pop_back (self->idle);
+
+      ((AdblPoolItem*)cape_list_node_data (n))->used = TRUE;
+
+      break;
+    }
+
+    if (self->size_max == 0 || (number_t)cape_list_size (self->connections) + self->creating < self->size_max)
+    {
+      n = adbl_pool__create (self, err);
+
+      break;
+    }
+
+    // all connections are in use
+    if (!wait)
+    {
+      break;
+    }
+
+    if (st == NULL)
+    {
+      st = cape_stoptimer_new ();
+      cape_stoptimer_start (st);
+
+      self->waits++;
+    }
+
     {
-      AdblPoolItem* item = cape_list_node_data (cursor->node);
-      
-      if (item->used == FALSE)
+      number_t time_left;
+
+      cape_stoptimer_stop (st);
+
+      time_left = self->wait_timeout - (number_t)cape_stoptimer_get (st);
+
+      cape_stoptimer_start (st);
+
+      if (time_left <= 0)
       {
-        n = cursor->node;
-        item->used = TRUE;
-        
+        self->timeouts++;
+
+        cape_err_set_fmt (err, CAPE_ERR_RUNTIME, "no free connection, all %i connections are in use", cape_list_size (self->connections));
         break;
       }
+
+      self->waiters++;
+
+      cape_cond_wait (self->cond, self->mutex, time_left);
+
+      self->waiters--;
+    }
+  }
+
+  if (st)
+  {
+    double wait_time;
+
+    cape_stoptimer_stop (st);
+
+    wait_time = cape_stoptimer_get (st);
+
+    self->wait_time += wait_time;
+
+    if (wait_time > self->wait_max)
+    {
+      self->wait_max = wait_time;
     }
-    
-    cape_list_cursor_destroy (&cursor);
   }
 
   cape_mutex_unlock (self->mutex);
-  
+
+  cape_stoptimer_del (&st);
+
   return n;
 }
 
 //-----------------------------------------------------------------------------
 
-CapeListNode adbl_pool_add (AdblPool self, void* pvd_handle)
+CapeListNode adbl_pool_get (AdblPool self, CapeErr err)
 {
-  CapeListNode n = NULL;
-  
-  AdblPoolItem* item = CAPE_NEW (AdblPoolItem);
-  
-  item->handle = pvd_handle;
-  item->pvd = self->pvd;
-  item->used = TRUE;
-  
-  cape_mutex_lock (self->mutex);
+  return adbl_pool__get (self, TRUE, err);
+}
 
-  n = cape_list_push_back (self->connections, item);
-  
-  cape_mutex_unlock (self->mutex);
-  
-  return n;
+//-----------------------------------------------------------------------------
+
+CapeListNode adbl_pool_try (AdblPool self, CapeErr err)
+{
+  return adbl_pool__get (self, FALSE, err);
 }
 
 //-----------------------------------------------------------------------------
@@ -133,11 +515,16 @@ CapeListNode adbl_pool_add (AdblPool self, void* pvd_handle)
 void adbl_pool_rel (AdblPool self, CapeListNode n)
 {
   AdblPoolItem* item = cape_list_node_data (n);
-  
+
   cape_mutex_lock (self->mutex);
-  
+
   item->used = FALSE;
-  
+  item->last_used = time (NULL);
+
+  cape_list_push_back (self->idle, n);
+
+  cape_cond_signal (self->cond);
+
   cape_mutex_unlock (self->mutex);
 }
 
@@ -146,18 +533,52 @@ void adbl_pool_rel (AdblPool self, CapeListNode n)
 number_t adbl_pool_size (AdblPool self)
 {
   number_t ret = 0;
-  
+
   cape_mutex_lock (self->mutex);
-  
+
   ret = cape_list_size (self->connections);
-  
+
   cape_mutex_unlock (self->mutex);
-  
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc adbl_pool_stats (AdblPool self)
+{
+  CapeUdc ret = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  cape_mutex_lock (self->mutex);
+
+  cape_udc_add_n (ret, "size"        , cape_list_size (self->connections));
+  cape_udc_add_n (ret, "used"        , cape_list_size (self->connections) - cape_list_size (self->idle));
+  cape_udc_add_n (ret, "idle"        , cape_list_size (self->idle));
+  cape_udc_add_n (ret, "waiters"     , self->waiters);
+  cape_udc_add_n (ret, "waits"       , self->waits);
+  cape_udc_add_f (ret, "wait_time"   , self->wait_time);
+  cape_udc_add_f (ret, "wait_max"    , self->wait_max);
+  cape_udc_add_n (ret, "timeouts"    , self->timeouts);
+  cape_udc_add_n (ret, "created"     , self->created);
+  cape_udc_add_n (ret, "closed"      , self->closed);
+  cape_udc_add_n (ret, "broken"      , self->broken);
+
+  cape_mutex_unlock (self->mutex);
+
   return ret;
 }
 
 //-----------------------------------------------------------------------------
 
+void* adbl_pool_handle (AdblPool self, CapeListNode n)
+{
+  AdblPoolItem* item = cape_list_node_data (n);
+  
+  return item->handle;
+}
+
+//-----------------------------------------------------------------------------
+
 int adbl_pool_trx_begin (AdblPool self, CapeListNode n, CapeErr err)
 {
   AdblPoolItem* item = cape_list_node_data (n);
@@ -230,9 +651,27 @@ number_t adbl_pool_trx_inorup (AdblPool self, CapeListNode n, const char* table,
 
 //-----------------------------------------------------------------------------
 
+int adbl_pool_trx_insert_many (AdblPool self, CapeListNode n, const char* table, CapeUdc* p_rows, CapeErr err)
+{
+  AdblPoolItem* item = cape_list_node_data (n);
+  
+  return self->pvd->pvd_ins_many (item->handle, table, p_rows, err);
+}
+
+//-----------------------------------------------------------------------------
+
+int adbl_pool_trx_update_many (AdblPool self, CapeListNode n, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr err)
+{
+  AdblPoolItem* item = cape_list_node_data (n);
+  
+  return self->pvd->pvd_set_many (item->handle, table, key, p_rows, err);
+}
+
+//-----------------------------------------------------------------------------
+
 void* adbl_pool_trx_cursor_new (AdblPool self, CapeListNode n, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err)
 {
   AdblPoolItem* item = cape_list_node_data (n);
 
-  return self->pvd->pvd_cursor_new (item->handle, table, p_params, p_values, err);
+  return self->pvd->pvd_cursor_new (item->handle, table, p_params, p_values, 0, 0, NULL, NULL, err);
 }
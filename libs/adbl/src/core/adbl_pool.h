@@ -9,11 +9,25 @@
 
 //-----------------------------------------------------------------------------
 
+/* pool of cloned connections
+ *
+ * the pool is configured by the connection properties
+ *
+ * -> pool_min:    connections which are kept open (default 0)
+ * -> pool_max:    maximum amount of connections, 0 -> no limit (default 50)
+ * -> pool_wait:   milliseconds to wait for a free connection if the maximum was reached (default 10000)
+ * -> pool_idle:   seconds until an unused connection is closed, 0 -> never (default 300)
+ * -> pool_check:  seconds until an unused connection is validated by the provider, 0 -> never (default 60)
+ */
+
+//-----------------------------------------------------------------------------
+
 struct AdblPool_s; typedef struct AdblPool_s* AdblPool;
 
 //-----------------------------------------------------------------------------
 
-__CAPE_LIBEX   AdblPool           adbl_pool_new              (const AdblPvd* pvd);
+                                  /* new connections are cloned from session */
+__CAPE_LIBEX   AdblPool           adbl_pool_new              (const AdblPvd* pvd, void* session, CapeUdc connection_properties);
 
 __CAPE_LIBEX   void               adbl_pool_del              (AdblPool*);
 
@@ -21,18 +35,26 @@ __CAPE_LIBEX   const AdblPvd*     adbl_pool_pvd              (AdblPool);
 
 //-----------------------------------------------------------------------------
 
-                                  /* get the next free connection */
-__CAPE_LIBEX   CapeListNode       adbl_pool_get              (AdblPool);
+                                  /* get the next free connection, creates or waits for one if none is free */
+__CAPE_LIBEX   CapeListNode       adbl_pool_get              (AdblPool, CapeErr err);
 
-                                  /* add another connection to the pool */
-__CAPE_LIBEX   CapeListNode       adbl_pool_add              (AdblPool, void* session);
+                                  /* get the next free connection without waiting, creates one if the maximum was not reached
+                                     -> returns NULL without an error if all connections are in use */
+__CAPE_LIBEX   CapeListNode       adbl_pool_try              (AdblPool, CapeErr err);
 
                                   /* release a connection */
 __CAPE_LIBEX   void               adbl_pool_rel              (AdblPool, CapeListNode);
 
+                                  /* the provider handle of a connection */
+__CAPE_LIBEX   void*              adbl_pool_handle           (AdblPool, CapeListNode);
+
                                   /* get the current size */
 __CAPE_LIBEX   number_t           adbl_pool_size             (AdblPool);
 
+                                  /* returns {size, used, idle, waiters, waits, wait_time, wait_max, timeouts, created, closed, broken}
+                                     -> wait_time and wait_max are in milliseconds */
+__CAPE_LIBEX   CapeUdc            adbl_pool_stats            (AdblPool);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   int                adbl_pool_trx_begin        (AdblPool, CapeListNode, CapeErr err);
@@ -51,6 +73,10 @@ __CAPE_LIBEX   int                adbl_pool_trx_delete       (AdblPool, CapeList
 
 __CAPE_LIBEX   number_t           adbl_pool_trx_inorup       (AdblPool, CapeListNode n, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err);
 
+__CAPE_LIBEX   int                adbl_pool_trx_insert_many  (AdblPool, CapeListNode n, const char* table, CapeUdc* p_rows, CapeErr err);
+
+__CAPE_LIBEX   int                adbl_pool_trx_update_many  (AdblPool, CapeListNode n, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr err);
+
 __CAPE_LIBEX   void*              adbl_pool_trx_cursor_new   (AdblPool, CapeListNode n, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err);
 
 //-----------------------------------------------------------------------------
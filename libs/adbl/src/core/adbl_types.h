@@ -32,14 +32,18 @@ typedef void      (__STDCALL *fct_adbl_pvd_close)         (void**);
 typedef int       (__STDCALL *fct_adbl_pvd_begin)         (void*, CapeErr);
 typedef int       (__STDCALL *fct_adbl_pvd_commit)        (void*, CapeErr);
 typedef int       (__STDCALL *fct_adbl_pvd_rollback)      (void*, CapeErr);
+typedef int       (__STDCALL *fct_adbl_pvd_ping)          (void*, CapeErr);
+typedef number_t  (__STDCALL *fct_adbl_pvd_lag)           (void*, CapeErr);
 
 typedef CapeUdc   (__STDCALL *fct_adbl_pvd_get)           (void*, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr);
 typedef number_t  (__STDCALL *fct_adbl_pvd_ins)           (void*, const char* table, CapeUdc* p_values, CapeErr);
 typedef int       (__STDCALL *fct_adbl_pvd_set)           (void*, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
 typedef int       (__STDCALL *fct_adbl_pvd_del)           (void*, const char* table, CapeUdc* p_params, CapeErr);
 typedef number_t  (__STDCALL *fct_adbl_pvd_ins_or_set)    (void*, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
+typedef int       (__STDCALL *fct_adbl_pvd_ins_many)      (void*, const char* table, CapeUdc* p_rows, CapeErr);
+typedef int       (__STDCALL *fct_adbl_pvd_set_many)      (void*, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr);
 
-typedef void*     (__STDCALL *fct_adbl_pvd_cursor_new)    (void*, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
+typedef void*     (__STDCALL *fct_adbl_pvd_cursor_new)    (void*, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr);
 typedef void      (__STDCALL *fct_adbl_pvd_cursor_del)    (void**);
 typedef int       (__STDCALL *fct_adbl_pvd_cursor_next)   (void*);
 typedef CapeUdc   (__STDCALL *fct_adbl_pvd_cursor_get)    (void*);
@@ -58,11 +62,15 @@ typedef struct
   fct_adbl_pvd_begin          pvd_begin;
   fct_adbl_pvd_commit         pvd_commit;
   fct_adbl_pvd_rollback       pvd_rollback;
+  fct_adbl_pvd_ping           pvd_ping;
+  fct_adbl_pvd_lag            pvd_lag;
   fct_adbl_pvd_get            pvd_get;
   fct_adbl_pvd_ins            pvd_ins;
   fct_adbl_pvd_set            pvd_set;
   fct_adbl_pvd_del            pvd_del;
   fct_adbl_pvd_ins_or_set     pvd_ins_or_set;
+  fct_adbl_pvd_ins_many       pvd_ins_many;
+  fct_adbl_pvd_set_many       pvd_set_many;
   fct_adbl_pvd_cursor_new     pvd_cursor_new;
   fct_adbl_pvd_cursor_del     pvd_cursor_del;
   fct_adbl_pvd_cursor_next    pvd_cursor_next;
@@ -148,10 +148,25 @@ struct AdblPvdSession_s
   int max_retries;
   
   CapeMutex mutex;
+  
+  AdblStmtCache stmts;   // prepared statements of the mysql handle
+  
+  number_t batch_size;   // maximum rows of a multi-row insert
+  
+  number_t prefetch;     // rows fetched at once by cursors, 0 -> the result is stored in the client
+  
+  number_t trace;        // statements which take longer are logged in milliseconds, -1 -> no tracing
 };
 
 //-----------------------------------------------------------------------------
 
+number_t adbl_trace_ms (AdblPvdSession self)
+{
+  return self->trace;
+}
+
+//-----------------------------------------------------------------------------
+
 int adbl_pvd__error (AdblPvdSession self, CapeErr err)
 {
   unsigned int error_code = mysql_errno (self->mysql);
@@ -334,6 +349,9 @@ int adbl_check_error (AdblPvdSession self, unsigned int error_code, CapeErr err)
       
       cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql error", "server went away -> try to reconnect");
 
+      // all statements belong to the old handle
+      adbl_stmtcache_clr (self->stmts);
+      
       // disconnect
       mysql_close (self->mysql);
 
@@ -391,6 +409,13 @@ AdblPvdSession __STDCALL adbl_pvd_open (CapeUdc cp, CapeErr err)
   
   self->mutex = cape_mutex_new ();
   
+  // the most used statement shapes stay prepared
+  self->stmts = adbl_stmtcache_new (cape_udc_get_n (cp, "stmt_cache", 64));
+  
+  self->batch_size = cape_udc_get_n (cp, "batch_size", 100);
+  self->prefetch = cape_udc_get_n (cp, "prefetch_rows", 100);
+  self->trace = cape_udc_get_n (cp, "trace_ms", -1);
+  
   // init mysql
   self->mysql = mysql_init (NULL);
   
@@ -419,6 +444,13 @@ AdblPvdSession __STDCALL adbl_pvd_clone (AdblPvdSession rhs, CapeErr err)
   self->cp = cape_udc_cp (rhs->cp);
   
   self->mutex = cape_mutex_new ();
+  
+  // the statements can't be shared with the other handle
+  self->stmts = adbl_stmtcache_new (cape_udc_get_n (rhs->cp, "stmt_cache", 64));
+  
+  self->batch_size = rhs->batch_size;
+  self->prefetch = rhs->prefetch;
+  self->trace = rhs->trace;
 
   // init mysql
   self->mysql = mysql_init (NULL);
@@ -448,6 +480,9 @@ void __STDCALL adbl_pvd_close (AdblPvdSession* p_self)
   cape_udc_del (&(self->cp));
   cape_str_del (&(self->schema));
   
+  // must be closed before the handle
+  adbl_stmtcache_del (&(self->stmts));
+  
   mysql_close (self->mysql);
   
   cape_mutex_del (&(self->mutex));
@@ -457,9 +492,14 @@ void __STDCALL adbl_pvd_close (AdblPvdSession* p_self)
 
 //-----------------------------------------------------------------------------
 
+static AdblPvdCursor adbl_pvd__cursor_new (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, number_t prefetch, CapeErr err);
+
+//-----------------------------------------------------------------------------
+
 CapeUdc __STDCALL adbl_pvd_get (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr err)
 {
-  AdblPvdCursor cursor = adbl_pvd_cursor_new (self, table, p_params, p_values, limit, offset, group_by, order_by, err);
+  // the result is stored in the client, all rows are needed anyway
+  AdblPvdCursor cursor = adbl_pvd__cursor_new (self, table, p_params, p_values, limit, offset, group_by, order_by, 0, err);
 
   if (cursor == NULL)
   {
@@ -490,9 +530,75 @@ CapeUdc __STDCALL adbl_pvd_get (AdblPvdSession self, const char* table, CapeUdc*
 
 //-----------------------------------------------------------------------------
 
-number_t __STDCALL adbl_pvd_ins (AdblPvdSession self, const char* table, CapeUdc* p_values, CapeErr err)
+static int adbl_pvd__ins_run (AdblPvdSession self, const char* table, AdblPrepare pre, CapeErr err)
 {
   int res;
+  int i;
+  
+  for (i = 0; i < self->max_retries; i++)
+  {
+    res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #1 -> [%i]", i);
+        continue;
+      }
+      
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
+      return res;
+    }
+    
+    res = adbl_prepare_statement_insert (pre, self, self->schema, table, self->ansi_quotes, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #2 -> [%i]", i);
+        continue;
+      }
+      
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
+      return res;
+    }
+    
+    res = adbl_prepare_binds_values (pre, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #3 -> [%i]", i);
+        continue;
+      }
+      
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
+      return res;
+    }
+    
+    res = adbl_prepare_execute (pre, self, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #4 -> [%i]", i);
+        continue;
+      }
+      
+      return res;
+    }
+    
+    // done
+    return CAPE_ERR_NONE;
+  }
+  
+  return cape_err_set (err, CAPE_ERR_RUNTIME, "too many retries");
+}
+
+//-----------------------------------------------------------------------------
+
+number_t __STDCALL adbl_pvd_ins (AdblPvdSession self, const char* table, CapeUdc* p_values, CapeErr err)
+{
   number_t last_insert_id = 0;  
 
   // local objects
@@ -502,13 +608,13 @@ number_t __STDCALL adbl_pvd_ins (AdblPvdSession self, const char* table, CapeUdc
   if (NULL == p_values)
   {
     cape_err_set (err, CAPE_ERR_MISSING_PARAM, "values was not provided");
-    goto exit_and_cleanup;
+    return 0;
   }
   
   // some prechecks
   if (0 == cape_udc_size (*p_values))
   {
-    goto exit_and_cleanup;
+    return 0;
   }
 
   pre = adbl_prepare_new (NULL, p_values, 0, 0, NULL, NULL);
@@ -517,76 +623,87 @@ number_t __STDCALL adbl_pvd_ins (AdblPvdSession self, const char* table, CapeUdc
   cape_mutex_lock (self->mutex);
 
   // run the procedure
+  if (adbl_pvd__ins_run (self, table, pre, err) == CAPE_ERR_NONE)
   {
-    int i;
-    for (i = 0; i < self->max_retries; i++)
+    // get last inserted id
+    last_insert_id = (number_t)mysql_insert_id (self->mysql);
+  }
+  
+  adbl_prepare_del (&pre);
+
+  cape_mutex_unlock (self->mutex);
+
+  return last_insert_id;
+}
+
+//-----------------------------------------------------------------------------
+
+int __STDCALL adbl_pvd_ins_many (AdblPvdSession self, const char* table, CapeUdc* p_rows, CapeErr err)
+{
+  int res = CAPE_ERR_NONE;
+
+  // local objects
+  AdblPrepare pre = NULL;
+  CapeUdcCursor* cursor = NULL;
+  
+  // some prechecks
+  if (NULL == p_rows || NULL == *p_rows)
+  {
+    return cape_err_set (err, CAPE_ERR_MISSING_PARAM, "rows was not provided");
+  }
+  
+  cursor = cape_udc_cursor_new (*p_rows, CAPE_DIRECTION_FORW);
+
+  // mysqlclient is not thread safe, so we need to protect the resource with mutex
+  cape_mutex_lock (self->mutex);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc row = cape_udc_cursor_ext (*p_rows, cursor);
+    
+    if (0 == cape_udc_size (row))
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #1 -> [%i]", i);
-          continue;
-        }
-        
-        cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
-        goto exit_and_cleanup;
-      }
-      
-      res = adbl_prepare_statement_insert (pre, self, self->schema, table, self->ansi_quotes, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #2 -> [%i]", i);
-          continue;
-        }
-        
-        cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
-        goto exit_and_cleanup;
-      }
+      cape_udc_del (&row);
+      continue;
+    }
+    
+    // rows with the same columns are collected into one statement
+    if (pre && adbl_prepare_add_row (pre, &row, self->batch_size))
+    {
+      continue;
+    }
+    
+    if (pre)
+    {
+      res = adbl_pvd__ins_run (self, table, pre, err);
       
-      res = adbl_prepare_binds_values (pre, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #3 -> [%i]", i);
-          continue;
-        }
-        
-        cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
-        goto exit_and_cleanup;
-      }
+      adbl_prepare_del (&pre);
       
-      res = adbl_prepare_execute (pre, self, err);
       if (res)
       {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          cape_log_fmt (CAPE_LL_TRACE, "ADBL", "mysql insert", "enter new cycle #4 -> [%i]", i);
-          continue;
-        }
-        
+        cape_udc_del (&row);
         goto exit_and_cleanup;
       }
-
-      // get last inserted id
-      last_insert_id = (number_t)mysql_insert_id (self->mysql);
-
-      // done
-      break;
     }
-  }
     
+    pre = adbl_prepare_new (NULL, &row, 0, 0, NULL, NULL);
+  }
+  
+  if (pre)
+  {
+    res = adbl_pvd__ins_run (self, table, pre, err);
+  }
+  
 exit_and_cleanup:
   
   adbl_prepare_del (&pre);
-
+  
   cape_mutex_unlock (self->mutex);
-
-  return last_insert_id;
+  
+  cape_udc_cursor_del (&cursor);
+  cape_udc_del (p_rows);
+  
+  return res;
 }
 
 //-----------------------------------------------------------------------------
@@ -605,7 +722,7 @@ int __STDCALL adbl_pvd_del (AdblPvdSession self, const char* table, CapeUdc* p_p
     int i;
     for (i = 0; i < self->max_retries; i++)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
+      res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
       if (res)
       {
         if (res == CAPE_ERR_CONTINUE)
@@ -670,6 +787,70 @@ exit_and_cleanup:
 
 //-----------------------------------------------------------------------------
 
+static int adbl_pvd__set_run (AdblPvdSession self, const char* table, AdblPrepare pre, CapeErr err)
+{
+  int res;
+  int i;
+  
+  for (i = 0; i < self->max_retries; i++)
+  {
+    res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        continue;
+      }
+      
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql set", cape_err_text(err));    
+      return res;
+    }
+    
+    res = adbl_prepare_statement_update (pre, self, self->schema, table, self->ansi_quotes, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        continue;
+      }
+      
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql set", cape_err_text(err));    
+      return res;
+    }
+    
+    // all binds are done as parameter
+    res = adbl_prepare_binds_all (pre, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        continue;
+      }
+      
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql set", cape_err_text(err));    
+      return res;
+    }
+    
+    res = adbl_prepare_execute (pre, self, err);
+    if (res)
+    {
+      if (res == CAPE_ERR_CONTINUE)
+      {
+        continue;
+      }
+      
+      return res;
+    }
+    
+    // done
+    return CAPE_ERR_NONE;
+  }
+  
+  return cape_err_set (err, CAPE_ERR_RUNTIME, "too many retries");
+}
+
+//-----------------------------------------------------------------------------
+
 int __STDCALL adbl_pvd_set (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err)
 {
   int res;
@@ -724,71 +905,83 @@ int __STDCALL adbl_pvd_set (AdblPvdSession self, const char* table, CapeUdc* p_p
   cape_mutex_lock (self->mutex);
 
   // run the procedure
+  res = adbl_pvd__set_run (self, table, pre, err);
+  
+exit_and_cleanup:
+  
+  adbl_prepare_del (&pre);
+
+  cape_mutex_unlock (self->mutex);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int __STDCALL adbl_pvd_set_many (AdblPvdSession self, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr err)
+{
+  int res = CAPE_ERR_NONE;
+
+  // local objects
+  CapeUdcCursor* cursor = NULL;
+  
+  // some prechecks
+  if (NULL == p_rows || NULL == *p_rows)
   {
-    int i;
-    for (i = 0; i < self->max_retries; i++)
+    return cape_err_set (err, CAPE_ERR_MISSING_PARAM, "rows was not provided");
+  }
+  
+  cursor = cape_udc_cursor_new (*p_rows, CAPE_DIRECTION_FORW);
+
+  // mysqlclient is not thread safe, so we need to protect the resource with mutex
+  cape_mutex_lock (self->mutex);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc row = cape_udc_cursor_ext (*p_rows, cursor);
+    CapeUdc params;
+    AdblPrepare pre;
+    
+    // the key column is the constraint, all other columns are updated
+    CapeUdc key_item = cape_udc_ext (row, key);
+    if (NULL == key_item)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          continue;
-        }
-        
-        cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql insert", cape_err_text(err));    
-        goto exit_and_cleanup;
-      }
+      res = cape_err_set_fmt (err, CAPE_ERR_MISSING_PARAM, "row without key '%s'", key);
       
-      res = adbl_prepare_statement_update (pre, self, self->schema, table, self->ansi_quotes, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          continue;
-        }
-        
-        cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql set", cape_err_text(err));    
-        goto exit_and_cleanup;
-      }
-      
-      // all binds are done as parameter
-      res = adbl_prepare_binds_all (pre, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          continue;
-        }
-        
-        cape_log_msg (CAPE_LL_WARN, "ADBL", "mysql set", cape_err_text(err));    
-        goto exit_and_cleanup;    
-      }
-      
-      res = adbl_prepare_execute (pre, self, err);
-      if (res)
-      {
-        if (res == CAPE_ERR_CONTINUE)
-        {
-          continue;
-        }
-        
-        goto exit_and_cleanup;
-      }
-
-      // done
-      break;
+      cape_udc_del (&row);
+      goto exit_and_cleanup;
     }
-  }
     
-  res = CAPE_ERR_NONE;
+    if (0 == cape_udc_size (row))
+    {
+      cape_udc_del (&key_item);
+      cape_udc_del (&row);
+      continue;
+    }
+    
+    params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    cape_udc_add (params, &key_item);
+    
+    // rows with the same columns share the cached statement
+    pre = adbl_prepare_new (&params, &row, 0, 0, NULL, NULL);
+    
+    res = adbl_pvd__set_run (self, table, pre, err);
+    
+    adbl_prepare_del (&pre);
+    
+    if (res)
+    {
+      goto exit_and_cleanup;
+    }
+  }
   
 exit_and_cleanup:
   
-  adbl_prepare_del (&pre);
-
   cape_mutex_unlock (self->mutex);
-
+  
+  cape_udc_cursor_del (&cursor);
+  cape_udc_del (p_rows);
+  
   return res;
 }
 
@@ -825,7 +1018,7 @@ number_t __STDCALL adbl_pvd_ins_or_set (AdblPvdSession self, const char* table,
     int i;
     for (i = 0; i < self->max_retries; i++)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
+      res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
       if (res)
       {
         if (res == CAPE_ERR_CONTINUE)
@@ -956,10 +1149,97 @@ int __STDCALL adbl_pvd_rollback (AdblPvdSession self, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
-AdblPvdCursor __STDCALL adbl_pvd_cursor_new (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr err)
+int __STDCALL adbl_pvd_ping (AdblPvdSession self, CapeErr err)
+{
+  int res;
+  
+  cape_mutex_lock (self->mutex);
+  
+  if (mysql_ping (self->mysql))
+  {
+    res = adbl_pvd__error (self, err);
+  }
+  else
+  {
+    res = CAPE_ERR_NONE;
+  }
+  
+  cape_mutex_unlock (self->mutex);
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t __STDCALL adbl_pvd_lag (AdblPvdSession self, CapeErr err)
+{
+  number_t ret = -1;
+  
+  MYSQL_RES* mr;
+  MYSQL_ROW row;
+  
+  cape_mutex_lock (self->mutex);
+  
+  if (mysql_query (self->mysql, "SHOW SLAVE STATUS"))
+  {
+    adbl_pvd__error (self, err);
+    goto exit_and_cleanup;
+  }
+  
+  // fetch from mysql result set
+  mr = mysql_use_result (self->mysql);
+  if (mr == NULL)
+  {
+    adbl_pvd__error (self, err);
+    goto exit_and_cleanup;
+  }
+  
+  // a server without replication returns no rows
+  ret = 0;
+  
+  // all rows must be fetched
+  while ((row = mysql_fetch_row (mr)))
+  {
+    unsigned int i;
+    
+    unsigned int fields_cnt = mysql_num_fields (mr);
+    MYSQL_FIELD* fields = mysql_fetch_fields (mr);
+    
+    for (i = 0; i < fields_cnt; i++)
+    {
+      if (cape_str_equal (fields[i].name, "Seconds_Behind_Master"))
+      {
+        if (row[i])
+        {
+          ret = cape_str_to_n (row[i]);
+        }
+        else
+        {
+          // NULL means that the replication is not running
+          cape_err_set (err, CAPE_ERR_RUNTIME, "replication is not running");
+          ret = -1;
+        }
+      }
+    }
+  }
+  
+  mysql_free_result (mr);
+  
+exit_and_cleanup:
+  
+  cape_mutex_unlock (self->mutex);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static AdblPvdCursor adbl_pvd__cursor_new (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, number_t prefetch, CapeErr err)
 {
   int res;
   AdblPrepare pre = adbl_prepare_new (p_params, p_values, limit, offset, group_by, order_by);
+  
+  adbl_prepare_stream (pre, prefetch);
 
   cape_mutex_lock (self->mutex);
   
@@ -968,7 +1248,7 @@ AdblPvdCursor __STDCALL adbl_pvd_cursor_new (AdblPvdSession self, const char* ta
     int i;
     for (i = 0; i < self->max_retries; i++)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
+      res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
       if (res)
       {
         if (res == CAPE_ERR_CONTINUE)
@@ -1053,18 +1333,36 @@ exit_and_cleanup:
 
 //-----------------------------------------------------------------------------
 
+AdblPvdCursor __STDCALL adbl_pvd_cursor_new (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr err)
+{
+  // cursors don't hold the whole result in memory
+  return adbl_pvd__cursor_new (self, table, p_params, p_values, limit, offset, group_by, order_by, self->prefetch, err);
+}
+
+//-----------------------------------------------------------------------------
+
 void __STDCALL adbl_pvd_cursor_del (AdblPvdCursor* p_self)
 {
   AdblPvdCursor self = *p_self;
 
   cape_mutex_lock (self->mutex);
 
-  mysql_stmt_free_result (self->stmt);
-  
-  mysql_stmt_close (self->stmt);
+  if (self->stmts && !self->failed)
+  {
+    // the statement can be used by the next query of the same shape
+    adbl_stmtcache_put (self->stmts, self->sql, &(self->stmt));
+  }
+  else
+  {
+    mysql_stmt_free_result (self->stmt);
+    
+    mysql_stmt_close (self->stmt);
+  }
   
   cape_mutex_unlock (self->mutex);
   
+  cape_str_del (&(self->sql));
+  
   // clean up the array
   adbl_bindvars_del (&(self->binds));   
   
@@ -1097,6 +1395,8 @@ int __STDCALL adbl_pvd_cursor_next (AdblPvdCursor self)
     }
     case 1:   // some kind of error happened
     {
+      self->failed = TRUE;
+      
       cape_log_msg (CAPE_LL_ERROR, "ADBL", "cursor next", mysql_stmt_error(self->stmt));
       return FALSE;
     }
@@ -1164,7 +1464,7 @@ number_t __STDCALL adbl_pvd_atomic_dec (AdblPvdSession self, const char* table,
     int i;
     for (i = 0; i < self->max_retries; i++)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
+      res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
       if (res)
       {
         if (res == CAPE_ERR_CONTINUE)
@@ -1248,7 +1548,7 @@ number_t __STDCALL adbl_pvd_atomic_inc (AdblPvdSession self, const char* table,
     int i;
     for (i = 0; i < self->max_retries; i++)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
+      res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
       if (res)
       {
         if (res == CAPE_ERR_CONTINUE)
@@ -1332,7 +1632,7 @@ number_t __STDCALL adbl_pvd_atomic_or (AdblPvdSession self, const char* table, C
     int i;
     for (i = 0; i < self->max_retries; i++)
     {
-      res = adbl_prepare_init (pre, self, self->mysql, err);
+      res = adbl_prepare_init (pre, self, self->mysql, self->stmts, err);
       if (res)
       {
         if (res == CAPE_ERR_CONTINUE)
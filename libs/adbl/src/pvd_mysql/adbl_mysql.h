@@ -33,6 +33,10 @@ __CAPE_LIBEX   int             __STDCALL adbl_pvd_del               (AdblPvdSess
 
 __CAPE_LIBEX   int             __STDCALL adbl_pvd_set               (AdblPvdSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);    // returns error code
 
+__CAPE_LIBEX   int             __STDCALL adbl_pvd_ins_many          (AdblPvdSession, const char* table, CapeUdc* p_rows, CapeErr);                         // returns error code
+
+__CAPE_LIBEX   int             __STDCALL adbl_pvd_set_many          (AdblPvdSession, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr);   // returns error code
+
 // don't use
 __CAPE_LIBEX   number_t        __STDCALL adbl_pvd_ins_or_set        (AdblPvdSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);    // returns the ID (ID == 0 -> error)
 
@@ -46,6 +50,10 @@ __CAPE_LIBEX   int             __STDCALL adbl_pvd_commit            (AdblPvdSess
 
 __CAPE_LIBEX   int             __STDCALL adbl_pvd_rollback          (AdblPvdSession, CapeErr);
 
+__CAPE_LIBEX   int             __STDCALL adbl_pvd_ping              (AdblPvdSession, CapeErr);         // checks if the connection is still alive
+
+__CAPE_LIBEX   number_t        __STDCALL adbl_pvd_lag               (AdblPvdSession, CapeErr);         // seconds the replica is behind its primary, -1 on error
+
 //-----------------------------------------------------------------------------
 
 struct AdblPvdCursor_s; typedef struct AdblPvdCursor_s* AdblPvdCursor;
@@ -64,6 +72,9 @@ __CAPE_LIBEX   CapeUdc         __STDCALL adbl_pvd_cursor_get        (AdblPvdCurs
 
 __CAPE_LIBEX   int                       adbl_check_error           (AdblPvdSession, unsigned int error_code, CapeErr err);
 
+                                         /* statements which take longer are logged, -1 -> no tracing */
+__CAPE_LIBEX   number_t                  adbl_trace_ms              (AdblPvdSession);
+
 //=============================================================================
 
 #endif
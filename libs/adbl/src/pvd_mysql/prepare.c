@@ -7,6 +7,7 @@
 #include "stc/cape_stream.h"
 #include "fmt/cape_json.h"
 #include "sys/cape_log.h"
+#include "sys/cape_time.h"
 
 //-----------------------------------------------------------------------------
 
@@ -20,6 +21,7 @@ struct AdblPrepare_s
   
   CapeUdc params;                // owned
   CapeUdc values;                // will be transfered
+  CapeUdc rows;                  // owned, additional rows of a multi-row insert
   
   AdblBindVars bindsParams;     // owned
   AdblBindVars bindsValues;     // will be transfered
@@ -29,106 +31,138 @@ struct AdblPrepare_s
 
   number_t limit;
   number_t offset;
+  
+  MYSQL* mysql;                  // reference
+  AdblStmtCache stmts;           // reference
+  
+  CapeString sql;                // the key for the statement cache
+  int reuse;                     // the statement was executed and can be cached
+  
+  number_t prefetch;             // > 0 -> rows are fetched from a server side cursor
+  
+  CapeStopTimer timer;           // owned, only used for tracing
+  double time_prepare;
+  int cached;                    // the statement was taken from the cache
 };
 
 //-----------------------------------------------------------------------------
 
-AdblPrepare adbl_prepare_new (CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by)
+static CapeUdc adbl_prepare__values (AdblPrepare self, CapeUdc* p_values)
 {
-  AdblPrepare self = CAPE_NEW(struct AdblPrepare_s);
+  CapeUdc values = *p_values;
   
-  self->stmt = NULL;  
-  self->values = NULL;
-  self->params = NULL;
-
-  self->group_by = cape_str_cp (group_by);
-  self->order_by = cape_str_cp (order_by);
-
-  self->limit = limit;
-  self->offset = offset;
-
-  // check all values
-  if (p_values)
+  CapeUdc ret = cape_udc_new (CAPE_UDC_NODE, NULL);
+  
+  CapeUdcCursor* cursor = cape_udc_cursor_new (values, CAPE_DIRECTION_FORW);
+  
+  while (cape_udc_cursor_next (cursor))
   {
-    CapeUdc values = *p_values;
+    CapeUdc item = cape_udc_cursor_ext (values, cursor);
     
-    self->values = cape_udc_new (CAPE_UDC_NODE, NULL);
+    // the name of the column
+    const CapeString name = cape_udc_name (item);
     
-    CapeUdcCursor* cursor = cape_udc_cursor_new (values, CAPE_DIRECTION_FORW);
-    
-    while (cape_udc_cursor_next (cursor))
+    // check for special column entries
+    if (cape_str_equal (name, ADBL_SPECIAL__GROUP_BY))
     {
-      CapeUdc item = cape_udc_cursor_ext (values, cursor);
-      
-      // the name of the column
-      const CapeString name = cape_udc_name (item);
-      
-      // check for special column entries
-      if (cape_str_equal (name, ADBL_SPECIAL__GROUP_BY))
-      {
-        CapeString h = cape_udc_s_mv (item, NULL);
+      CapeString h = cape_udc_s_mv (item, NULL);
 
-        cape_str_replace_mv (&(self->group_by), &h);
+      cape_str_replace_mv (&(self->group_by), &h);
 
-        cape_udc_del (&item);
-      }
-      else if (cape_str_equal (name, ADBL_SPECIAL__ORDER_BY))
-      {
-        CapeString h = cape_udc_s_mv (item, NULL);
+      cape_udc_del (&item);
+    }
+    else if (cape_str_equal (name, ADBL_SPECIAL__ORDER_BY))
+    {
+      CapeString h = cape_udc_s_mv (item, NULL);
 
-        cape_str_replace_mv (&(self->order_by), &h);
+      cape_str_replace_mv (&(self->order_by), &h);
 
-        cape_udc_del (&item);
+      cape_udc_del (&item);
+    }
+    else switch (cape_udc_type(item))
+    {
+      case CAPE_UDC_STRING:
+      case CAPE_UDC_BOOL:
+      case CAPE_UDC_FLOAT:
+      case CAPE_UDC_DATETIME:
+      case CAPE_UDC_NULL:
+      case CAPE_UDC_NODE:
+      {
+        cape_udc_add (ret, &item);
+        break;
       }
-      else switch (cape_udc_type(item))
+      case CAPE_UDC_LIST:
       {
-        case CAPE_UDC_STRING:
-        case CAPE_UDC_BOOL:
-        case CAPE_UDC_FLOAT:
-        case CAPE_UDC_DATETIME:
-        case CAPE_UDC_NULL:
-        case CAPE_UDC_NODE:
-        {
-          cape_udc_add (self->values, &item);
-          break;
-        }
-        case CAPE_UDC_LIST:
+        cape_udc_add (ret, &item);
+        break;
+      }
+      case CAPE_UDC_NUMBER:
+      {
+        // check the value
+        number_t val = cape_udc_n (item, ADBL_AUTO_INCREMENT);
+        
+        if (val == ADBL_AUTO_INCREMENT)
         {
-          cape_udc_add (self->values, &item);
-          break;
+          cape_udc_del (&item);
         }
-        case CAPE_UDC_NUMBER:
+        else if (val == ADBL_AUTO_SEQUENCE_ID)
         {
-          // check the value
-          number_t val = cape_udc_n (item, ADBL_AUTO_INCREMENT);
-          
-          if (val == ADBL_AUTO_INCREMENT)
-          {
-            cape_udc_del (&item);
-          }
-          else if (val == ADBL_AUTO_SEQUENCE_ID)
-          {
-            cape_udc_del (&item);
-          }
-          else
-          {
-            cape_udc_add (self->values, &item);
-          }
-
-          break;
+          cape_udc_del (&item);
         }
-        default:
+        else
         {
-          cape_udc_del (&item);
-          break;
+          cape_udc_add (ret, &item);
         }
+
+        break;
+      }
+      default:
+      {
+        cape_udc_del (&item);
+        break;
       }
-      
     }
     
-    cape_udc_cursor_del (&cursor);
-    
-    cape_udc_del (p_values);
+  }
+  
+  cape_udc_cursor_del (&cursor);
+  
+  cape_udc_del (p_values);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+AdblPrepare adbl_prepare_new (CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by)
+{
+  AdblPrepare self = CAPE_NEW(struct AdblPrepare_s);
+  
+  self->stmt = NULL;  
+  self->values = NULL;
+  self->params = NULL;
+  self->rows = NULL;
+
+  self->mysql = NULL;
+  self->stmts = NULL;
+  self->sql = NULL;
+  self->reuse = FALSE;
+  self->prefetch = 0;
+
+  self->timer = NULL;
+  self->time_prepare = .0;
+  self->cached = FALSE;
+
+  self->group_by = cape_str_cp (group_by);
+  self->order_by = cape_str_cp (order_by);
+
+  self->limit = limit;
+  self->offset = offset;
+
+  // check all values
+  if (p_values)
+  {
+    self->values = adbl_prepare__values (self, p_values);
   }
     
   // params are optional
@@ -149,29 +183,104 @@ AdblPrepare adbl_prepare_new (CapeUdc* p_params, CapeUdc* p_values, number_t lim
 
 //-----------------------------------------------------------------------------
 
-int adbl_prepare_init (AdblPrepare self, AdblPvdSession session, MYSQL* mysql, CapeErr err)
+static int adbl_prepare__same_columns (CapeUdc values, CapeUdc row)
+{
+  int ret = TRUE;
+  
+  if (cape_udc_size (values) != cape_udc_size (row))
+  {
+    return FALSE;
+  }
+  
+  {
+    CapeUdcCursor* c1 = cape_udc_cursor_new (values, CAPE_DIRECTION_FORW);
+    CapeUdcCursor* c2 = cape_udc_cursor_new (row, CAPE_DIRECTION_FORW);
+    
+    while (cape_udc_cursor_next (c1) && cape_udc_cursor_next (c2))
+    {
+      if (!cape_str_equal (cape_udc_name (c1->item), cape_udc_name (c2->item)))
+      {
+        ret = FALSE;
+        break;
+      }
+    }
+    
+    cape_udc_cursor_del (&c1);
+    cape_udc_cursor_del (&c2);
+  }
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int adbl_prepare_add_row (AdblPrepare self, CapeUdc* p_values, number_t max_rows)
+{
+  number_t rows = adbl_prepare_rows (self);
+  
+  if (rows >= max_rows)
+  {
+    return FALSE;
+  }
+  
+  // mysql can't handle more placeholders in one statement
+  if ((rows + 1) * cape_udc_size (self->values) > ADBL_PREPARE_MAX_PLACEHOLDERS)
+  {
+    return FALSE;
+  }
+  
+  {
+    CapeUdc row = adbl_prepare__values (self, p_values);
+    
+    if (adbl_prepare__same_columns (self->values, row))
+    {
+      if (self->rows == NULL)
+      {
+        self->rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+      }
+      
+      cape_udc_add (self->rows, &row);
+      
+      return TRUE;
+    }
+    
+    // the row needs its own statement, return the checked values
+    *p_values = row;
+    
+    return FALSE;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t adbl_prepare_rows (AdblPrepare self)
+{
+  return self->rows ? cape_udc_size (self->rows) + 1 : 1;
+}
+
+//-----------------------------------------------------------------------------
+
+int adbl_prepare_init (AdblPrepare self, AdblPvdSession session, MYSQL* mysql, AdblStmtCache stmts, CapeErr err)
 {
   if (self->stmt)
   {
+    // a statement of the last cycle failed, don't put it back into the cache
+    
     // cleanup results
     mysql_stmt_free_result (self->stmt);
     
     // close old statement
     mysql_stmt_close (self->stmt);
-  }
-  
-  self->stmt = mysql_stmt_init (mysql);
-  if (self->stmt == NULL)
-  {
-    // gather error code
-    unsigned int error_code = mysql_stmt_errno (self->stmt);
-    
-    cape_log_fmt (CAPE_LL_ERROR, "ADBL", "prepare init", "error seen: %i", error_code);    
     
-    // use session error handling
-    return adbl_check_error (session, error_code, err);
+    self->stmt = NULL;
   }
   
+  // the handle might have changed after a reconnect
+  self->mysql = mysql;
+  self->stmts = stmts;
+  
+  self->reuse = FALSE;
+  
   return CAPE_ERR_NONE;
 }
 
@@ -186,8 +295,17 @@ void adbl_prepare_del (AdblPrepare* p_self)
     cape_str_del (&(self->group_by));
     cape_str_del (&(self->order_by));
     
+    if (self->stmt && self->reuse && self->stmts)
+    {
+      // keep the prepared statement for the next call with the same shape
+      adbl_stmtcache_put (self->stmts, self->sql, &(self->stmt));
+    }
+    
+    cape_str_del (&(self->sql));
+    
     cape_udc_del (&(self->params));
     cape_udc_del (&(self->values));
+    cape_udc_del (&(self->rows));
     
     if (self->bindsParams)
     {
@@ -206,6 +324,8 @@ void adbl_prepare_del (AdblPrepare* p_self)
       mysql_stmt_close (self->stmt);
     }
     
+    cape_stoptimer_del (&(self->timer));
+    
     CAPE_DEL(p_self, struct AdblPrepare_s);
   }
 }
@@ -242,6 +362,14 @@ AdblPvdCursor adbl_prepare_to_cursor (AdblPrepare* p_self, CapeMutex mutex)
   cursor->pos = 0;
   cursor->mutex = mutex;
   
+  // the cursor returns the statement to the cache
+  cursor->stmts = self->reuse ? self->stmts : NULL;
+  
+  cursor->sql = self->sql;
+  self->sql = NULL;
+  
+  cursor->failed = FALSE;
+  
   // cleanup
   adbl_prepare_del (p_self);
   
@@ -285,7 +413,7 @@ int adbl_prepare_binds_values (AdblPrepare self, CapeErr err)
   if (self->columns_used)  // optional
   {
     // create bindings for mysql prepared statement engine
-    adbl_prepare__replace_binds (&(self->bindsValues), adbl_bindvars_new (self->columns_used));
+    adbl_prepare__replace_binds (&(self->bindsValues), adbl_bindvars_new (self->columns_used * adbl_prepare_rows (self)));
     
     // set bindings for mysql for all parameters
     res = adbl_bindvars_set_from_node (self->bindsValues, self->values, FALSE, err);
@@ -294,6 +422,28 @@ int adbl_prepare_binds_values (AdblPrepare self, CapeErr err)
       return res;
     }
     
+    if (self->rows)
+    {
+      // the binds of all other rows follow in the same order
+      CapeUdcCursor* cursor = cape_udc_cursor_new (self->rows, CAPE_DIRECTION_FORW);
+      
+      while (cape_udc_cursor_next (cursor))
+      {
+        res = adbl_bindvars_set_from_node (self->bindsValues, cursor->item, FALSE, err);
+        if (res)
+        {
+          break;
+        }
+      }
+      
+      cape_udc_cursor_del (&cursor);
+      
+      if (res)
+      {
+        return res;
+      }
+    }
+    
     // try to bind all constraint values
     if (mysql_stmt_bind_param (self->stmt, adbl_bindvars_binds(self->bindsValues)) != 0)
     {
@@ -367,10 +517,54 @@ int adbl_prepare_binds_all (AdblPrepare self, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
+void adbl_prepare_stream (AdblPrepare self, number_t prefetch)
+{
+  self->prefetch = prefetch;
+}
+
+//-----------------------------------------------------------------------------
+
+static void adbl_prepare__trace (AdblPrepare self, AdblPvdSession session, double time_execute, double time_fetch)
+{
+  double time_total = self->time_prepare + time_execute + time_fetch;
+  
+  if (time_total >= adbl_trace_ms (session))
+  {
+    // with a server side cursor the rows are fetched later
+    long rows = self->prefetch ? -1 : (long)mysql_stmt_affected_rows (self->stmt);
+    
+    cape_log_fmt (CAPE_LL_INFO, "ADBL", "mysql trace", "%.3f ms | prepare %.3f ms%s | execute %.3f ms | fetch %.3f ms | binds %lu | rows %li | %s", time_total, self->time_prepare, self->cached ? " (cached)" : "", time_execute, time_fetch, mysql_stmt_param_count (self->stmt), rows, self->sql);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 int adbl_prepare_execute (AdblPrepare self, AdblPvdSession session, CapeErr err)
 {
   int res;
   
+  double time_execute = .0;
+  
+  if (self->timer)
+  {
+    cape_stoptimer_set (self->timer, .0);
+    cape_stoptimer_start (self->timer);
+  }
+  
+  {
+    // a cached statement might have been used with the other cursor type
+    unsigned long cursor_type = self->prefetch ? CURSOR_TYPE_READ_ONLY : CURSOR_TYPE_NO_CURSOR;
+    
+    mysql_stmt_attr_set (self->stmt, STMT_ATTR_CURSOR_TYPE, &cursor_type);
+    
+    if (self->prefetch)
+    {
+      unsigned long prefetch_rows = (unsigned long)self->prefetch;
+      
+      mysql_stmt_attr_set (self->stmt, STMT_ATTR_PREFETCH_ROWS, &prefetch_rows);
+    }
+  }
+  
   // execute
   if (mysql_stmt_execute (self->stmt) != 0)
   {
@@ -388,7 +582,17 @@ int adbl_prepare_execute (AdblPrepare self, AdblPvdSession session, CapeErr err)
     return cape_err_set_fmt (err, CAPE_ERR_3RDPARTY_LIB, "%i (%s): %s", error_code, mysql_stmt_sqlstate (self->stmt), mysql_stmt_error (self->stmt));
   }
   
-  if (mysql_stmt_store_result (self->stmt) != 0)
+  if (self->timer)
+  {
+    cape_stoptimer_stop (self->timer);
+    time_execute = cape_stoptimer_get (self->timer);
+    
+    cape_stoptimer_set (self->timer, .0);
+    cape_stoptimer_start (self->timer);
+  }
+  
+  // with a server side cursor the rows stay on the server, each fetch transfers the next prefetch rows
+  if (self->prefetch == 0 && mysql_stmt_store_result (self->stmt) != 0)
   {
     unsigned int error_code = mysql_stmt_errno (self->stmt);
     
@@ -404,6 +608,15 @@ int adbl_prepare_execute (AdblPrepare self, AdblPvdSession session, CapeErr err)
     return cape_err_set_fmt (err, CAPE_ERR_3RDPARTY_LIB, "%i (%s): %s", mysql_stmt_errno (self->stmt), mysql_stmt_sqlstate (self->stmt), mysql_stmt_error (self->stmt));
   }
   
+  if (self->timer)
+  {
+    cape_stoptimer_stop (self->timer);
+    
+    adbl_prepare__trace (self, session, time_execute, cape_stoptimer_get (self->timer));
+  }
+  
+  self->reuse = TRUE;
+  
   return CAPE_ERR_NONE;
 }
 
@@ -414,6 +627,46 @@ int adbl_prepare_prepare (AdblPrepare self, AdblPvdSession session, CapeStream s
   // debug output
   //cape_log_msg (CAPE_LL_TRACE, "ADBL", "mysql **SQL**", cape_stream_get (stream));
 
+  cape_str_replace_cp (&(self->sql), cape_stream_get (stream));
+  
+  if (adbl_trace_ms (session) >= 0 && NULL == self->timer)
+  {
+    self->timer = cape_stoptimer_new ();
+  }
+  
+  self->time_prepare = .0;
+  self->cached = FALSE;
+  
+  if (self->stmts)
+  {
+    self->stmt = adbl_stmtcache_get (self->stmts, self->sql);
+    if (self->stmt)
+    {
+      self->cached = TRUE;
+      
+      // the statement is already prepared, only the binds and execute are needed
+      return CAPE_ERR_NONE;
+    }
+  }
+  
+  self->stmt = mysql_stmt_init (self->mysql);
+  if (self->stmt == NULL)
+  {
+    // gather error code
+    unsigned int error_code = mysql_errno (self->mysql);
+    
+    cape_log_fmt (CAPE_LL_ERROR, "ADBL", "prepare init", "error seen: %i", error_code);    
+    
+    // use session error handling
+    return adbl_check_error (session, error_code, err);
+  }
+  
+  if (self->timer)
+  {
+    cape_stoptimer_set (self->timer, .0);
+    cape_stoptimer_start (self->timer);
+  }
+  
   // execute
   if (mysql_stmt_prepare (self->stmt, cape_stream_get (stream), cape_stream_size (stream)) != 0)
   {
@@ -434,6 +687,12 @@ int adbl_prepare_prepare (AdblPrepare self, AdblPvdSession session, CapeStream s
     return cape_err_set_fmt (err, CAPE_ERR_3RDPARTY_LIB, "%i (%s): %s", error_code, mysql_stmt_sqlstate (self->stmt), mysql_stmt_error (self->stmt));
   }
 
+  if (self->timer)
+  {
+    cape_stoptimer_stop (self->timer);
+    self->time_prepare = cape_stoptimer_get (self->timer);
+  }
+
   return CAPE_ERR_NONE;
 }
 
@@ -954,6 +1213,20 @@ int adbl_prepare_statement_insert (AdblPrepare self, AdblPvdSession session, con
 
   cape_stream_append_str (stream, ")");
   
+  {
+    number_t i, rows = adbl_prepare_rows (self);
+    
+    // multi-row insert, each row has the same columns
+    for (i = 1; i < rows; i++)
+    {
+      cape_stream_append_str (stream, ", (");
+      
+      adbl_prepare_append_values (stream, self->values);
+      
+      cape_stream_append_str (stream, ")");
+    }
+  }
+  
   res = adbl_prepare_prepare (self, session, stream, err);
 
   cape_stream_del (&stream);
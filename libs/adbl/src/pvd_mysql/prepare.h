@@ -2,6 +2,7 @@
 #define __ADBL_MYSQL__PREPARE_H 1
 
 #include "bindvars.h"
+#include "stmtcache.h"
 #include "adbl_mysql.h"
 
 //-----------------------------------------------------------------------------
@@ -15,6 +16,11 @@
 #include "stc/cape_udc.h"
 #include "sys/cape_mutex.h"
 
+//-----------------------------------------------------------------------------
+
+// the maximum amount of placeholders in one statement
+#define ADBL_PREPARE_MAX_PLACEHOLDERS 65535
+
 //=============================================================================
 
 struct AdblPrepare_s; typedef struct AdblPrepare_s* AdblPrepare;
@@ -33,6 +39,12 @@ struct AdblPvdCursor_s
   
   CapeMutex mutex;   // reference
   
+  AdblStmtCache stmts;   // reference, NULL -> the statement is closed
+  
+  CapeString sql;
+  
+  int failed;        // a fetch failed, don't reuse the statement
+  
 };
 
 //-----------------------------------------------------------------------------
@@ -43,9 +55,17 @@ __CAPE_LIBEX   void            adbl_prepare_del                (AdblPrepare*);
 
 __CAPE_LIBEX   AdblPvdCursor   adbl_prepare_to_cursor          (AdblPrepare*, CapeMutex);
 
+                               /* adds another row for a multi-row insert, returns FALSE if the row has other columns or the batch is full
+                                  -> if the row was not added, p_values contains the checked values */
+__CAPE_LIBEX   int             adbl_prepare_add_row            (AdblPrepare, CapeUdc* p_values, number_t max_rows);
+
+                               /* amount of rows of the insert statement */
+__CAPE_LIBEX   number_t        adbl_prepare_rows               (AdblPrepare);
+
 //-----------------------------------------------------------------------------
 
-__CAPE_LIBEX   int             adbl_prepare_init               (AdblPrepare, AdblPvdSession session, MYSQL* mysql, CapeErr err); 
+                               /* the statement is taken from the cache or prepared with the statement functions */
+__CAPE_LIBEX   int             adbl_prepare_init               (AdblPrepare, AdblPvdSession session, MYSQL* mysql, AdblStmtCache stmts, CapeErr err); 
 
 __CAPE_LIBEX   int             adbl_prepare_binds_params       (AdblPrepare, CapeErr err);
 
@@ -57,6 +77,9 @@ __CAPE_LIBEX   int             adbl_prepare_binds_all          (AdblPrepare, Cap
 
 __CAPE_LIBEX   int             adbl_prepare_execute            (AdblPrepare, AdblPvdSession session, CapeErr err);
 
+                               /* the result is not stored in the client, rows are fetched from a read-only server side cursor in chunks of prefetch rows */
+__CAPE_LIBEX   void            adbl_prepare_stream             (AdblPrepare, number_t prefetch);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   int             adbl_prepare_statement_select   (AdblPrepare, AdblPvdSession session, const char* schema, const char* table, int ansi, CapeErr err);
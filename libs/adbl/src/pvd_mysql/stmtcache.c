@@ -0,0 +1,162 @@
+#include "stmtcache.h"
+
+// cape includes
+#include <stc/cape_hash.h>
+#include <stc/cape_list.h>
+#include <sys/cape_log.h>
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeString sql;
+  
+  MYSQL_STMT* stmt;
+  
+} AdblStmtCacheEntry;
+
+//-----------------------------------------------------------------------------
+
+struct AdblStmtCache_s
+{
+  number_t max_size;
+  
+  CapeList entries;              // most recently used first, owns the entries
+  CapeHash index;                // sql -> list node
+};
+
+//-----------------------------------------------------------------------------
+
+static void adbl_stmtcache__stmt_close (MYSQL_STMT* stmt)
+{
+  mysql_stmt_free_result (stmt);
+  
+  mysql_stmt_close (stmt);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_stmtcache__entries__on_del (void* ptr)
+{
+  AdblStmtCacheEntry* entry = ptr;
+  
+  adbl_stmtcache__stmt_close (entry->stmt);
+  
+  cape_str_del (&(entry->sql));
+  
+  CAPE_DEL (&entry, AdblStmtCacheEntry);
+}
+
+//-----------------------------------------------------------------------------
+
+AdblStmtCache adbl_stmtcache_new (number_t max_size)
+{
+  AdblStmtCache self = CAPE_NEW (struct AdblStmtCache_s);
+  
+  self->max_size = max_size;
+  
+  self->entries = cape_list_new (adbl_stmtcache__entries__on_del);
+  
+  // the keys are owned by the entries
+  self->index = cape_hash_new (NULL, NULL, NULL, NULL);
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_stmtcache_del (AdblStmtCache* p_self)
+{
+  if (*p_self)
+  {
+    AdblStmtCache self = *p_self;
+    
+    cape_hash_del (&(self->index));
+    cape_list_del (&(self->entries));
+    
+    CAPE_DEL (p_self, struct AdblStmtCache_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_stmtcache_clr (AdblStmtCache self)
+{
+  cape_hash_clr (self->index);
+  cape_list_clr (self->entries);
+}
+
+//-----------------------------------------------------------------------------
+
+MYSQL_STMT* adbl_stmtcache_get (AdblStmtCache self, const CapeString sql)
+{
+  MYSQL_STMT* ret;
+  
+  CapeHashNode n = cape_hash_find (self->index, sql);
+  if (n == NULL)
+  {
+    return NULL;
+  }
+  
+  {
+    AdblStmtCacheEntry* entry = cape_list_node_extract (self->entries, cape_hash_node_value (n));
+    
+    // the key belongs to the entry
+    cape_hash_erase (self->index, n);
+    
+    ret = entry->stmt;
+    
+    cape_str_del (&(entry->sql));
+    CAPE_DEL (&entry, AdblStmtCacheEntry);
+  }
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_stmtcache_put (AdblStmtCache self, const CapeString sql, MYSQL_STMT** p_stmt)
+{
+  MYSQL_STMT* stmt = *p_stmt;
+  
+  *p_stmt = NULL;
+  
+  // another statement of the same shape was used at the same time
+  if (self->max_size == 0 || cape_hash_find (self->index, sql))
+  {
+    adbl_stmtcache__stmt_close (stmt);
+    return;
+  }
+  
+  // release the result set, the statement can be executed again
+  mysql_stmt_free_result (stmt);
+  
+  if (cape_list_size (self->entries) >= self->max_size)
+  {
+    // remove the least recently used statement
+    CapeListNode back = cape_list_node_back (self->entries);
+    AdblStmtCacheEntry* entry = cape_list_node_data (back);
+    
+    cape_hash_erase (self->index, cape_hash_find (self->index, entry->sql));
+    
+    cape_list_node_erase (self->entries, back);
+  }
+  
+  {
+    AdblStmtCacheEntry* entry = CAPE_NEW (AdblStmtCacheEntry);
+    
+    entry->sql = cape_str_cp (sql);
+    entry->stmt = stmt;
+    
+    cape_hash_insert (self->index, entry->sql, cape_list_push_front (self->entries, entry));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t adbl_stmtcache_size (AdblStmtCache self)
+{
+  return cape_list_size (self->entries);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,52 @@
+#ifndef __ADBL_MYSQL__STMTCACHE_H
+#define __ADBL_MYSQL__STMTCACHE_H 1
+
+//-----------------------------------------------------------------------------
+
+// mysql includes
+#include <mysql.h>
+
+// cape includes
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_str.h"
+
+//=============================================================================
+
+/* LRU cache of prepared statements of one session
+ *
+ * -> the key is the SQL text, which contains the table, the columns,
+ *    the constraint operators, limit and offset -> the shape of a statement
+ * -> a statement is taken out while it is used and returned afterwards,
+ *    so an open cursor never shares its statement
+ * -> all statements belong to one mysql handle, the cache must be cleared
+ *    before the handle is closed
+ */
+
+//-----------------------------------------------------------------------------
+
+struct AdblStmtCache_s; typedef struct AdblStmtCache_s* AdblStmtCache;
+
+//-----------------------------------------------------------------------------
+
+                                               /* max_size = 0 -> all statements are closed after usage */
+__CAPE_LIBEX   AdblStmtCache   adbl_stmtcache_new            (number_t max_size);
+
+__CAPE_LIBEX   void            adbl_stmtcache_del            (AdblStmtCache*);
+
+                                               /* closes all statements */
+__CAPE_LIBEX   void            adbl_stmtcache_clr            (AdblStmtCache);
+
+//-----------------------------------------------------------------------------
+
+                                               /* returns NULL if no statement was cached, the ownership is transfered */
+__CAPE_LIBEX   MYSQL_STMT*     adbl_stmtcache_get            (AdblStmtCache, const CapeString sql);
+
+                                               /* returns the statement to the cache, the least recently used one might be closed */
+__CAPE_LIBEX   void            adbl_stmtcache_put            (AdblStmtCache, const CapeString sql, MYSQL_STMT** p_stmt);
+
+__CAPE_LIBEX   number_t        adbl_stmtcache_size           (AdblStmtCache);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,264 @@
+#include "prepare.h"
+
+//-----------------------------------------------------------------------------
+
+// cape includes
+#include "sys/cape_err.h"
+#include "sys/cape_log.h"
+#include "stc/cape_udc.h"
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+
+#define TEST_BATCHES_MAX 10
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc test__row (number_t columns, const CapeString last_column)
+{
+  number_t i;
+
+  CapeUdc row = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  for (i = 0; i < columns; i++)
+  {
+    char name[32];
+
+    snprintf (name, 32, "col%03li", i);
+
+    cape_udc_add_n (row, name, i);
+  }
+
+  if (last_column)
+  {
+    cape_udc_add_s_cp (row, last_column, "value");
+  }
+
+  return row;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t test__batches (CapeUdc* p_rows, number_t batch_size, number_t* batches)
+{
+  number_t cnt = 0;
+
+  // collect the rows like adbl_pvd_ins_many does, instead of running the statements count the rows
+  AdblPrepare pre = NULL;
+  CapeUdcCursor* cursor = cape_udc_cursor_new (*p_rows, CAPE_DIRECTION_FORW);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc row = cape_udc_cursor_ext (*p_rows, cursor);
+
+    if (pre && adbl_prepare_add_row (pre, &row, batch_size))
+    {
+      continue;
+    }
+
+    if (pre && cnt < TEST_BATCHES_MAX)
+    {
+      batches[cnt++] = adbl_prepare_rows (pre);
+    }
+
+    adbl_prepare_del (&pre);
+
+    pre = adbl_prepare_new (NULL, &row, 0, 0, NULL, NULL);
+  }
+
+  if (pre && cnt < TEST_BATCHES_MAX)
+  {
+    batches[cnt++] = adbl_prepare_rows (pre);
+  }
+
+  adbl_prepare_del (&pre);
+
+  cape_udc_cursor_del (&cursor);
+  cape_udc_del (p_rows);
+
+  return cnt;
+}
+
+//-----------------------------------------------------------------------------
+
+static int test__expect (const char* where, number_t cnt, const number_t* batches, number_t expected_cnt, const number_t* expected)
+{
+  number_t i;
+
+  if (cnt != expected_cnt)
+  {
+    printf ("ERROR [%s]: %li statements instead of %li\n", where, cnt, expected_cnt);
+    return 1;
+  }
+
+  for (i = 0; i < cnt; i++)
+  {
+    if (batches[i] != expected[i])
+    {
+      printf ("ERROR [%s]: statement #%li has %li rows instead of %li\n", where, i, batches[i], expected[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int test01_batch_size ()
+{
+  int ret = 0;
+  number_t i, cnt;
+  number_t batches[TEST_BATCHES_MAX];
+
+  // 7 rows with the same columns and a batch size of 3
+  {
+    const number_t expected[] = {3, 3, 1};
+
+    CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+    for (i = 0; i < 7; i++)
+    {
+      CapeUdc row = test__row (3, NULL);
+
+      cape_udc_add (rows, &row);
+    }
+
+    cnt = test__batches (&rows, 3, batches);
+
+    ret |= test__expect ("batch size", cnt, batches, 3, expected);
+  }
+
+  // a batch size of 1 disables the multi-row insert
+  {
+    const number_t expected[] = {1, 1, 1};
+
+    CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+    for (i = 0; i < 3; i++)
+    {
+      CapeUdc row = test__row (3, NULL);
+
+      cape_udc_add (rows, &row);
+    }
+
+    cnt = test__batches (&rows, 1, batches);
+
+    ret |= test__expect ("batch size 1", cnt, batches, 3, expected);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int test02_columns ()
+{
+  int ret = 0;
+  number_t cnt;
+  number_t batches[TEST_BATCHES_MAX];
+
+  // a new statement starts with each change of the columns
+  const number_t expected[] = {2, 1, 2};
+
+  const char* last_columns[] = {"a", "a", "b", "a", "a", NULL};
+
+  CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+  {
+    number_t i;
+
+    for (i = 0; last_columns[i]; i++)
+    {
+      CapeUdc row = test__row (2, last_columns[i]);
+
+      cape_udc_add (rows, &row);
+    }
+  }
+
+  cnt = test__batches (&rows, 100, batches);
+
+  ret |= test__expect ("columns", cnt, batches, 3, expected);
+
+  // a row with a different amount of columns
+  {
+    AdblPrepare pre;
+
+    CapeUdc row = test__row (2, NULL);
+
+    pre = adbl_prepare_new (NULL, &row, 0, 0, NULL, NULL);
+
+    row = test__row (3, NULL);
+
+    if (adbl_prepare_add_row (pre, &row, 100))
+    {
+      printf ("ERROR [columns]: row with more columns was added\n");
+      ret = 1;
+    }
+
+    // the row is returned for the next statement
+    if (row == NULL || cape_udc_size (row) != 3 || adbl_prepare_rows (pre) != 1)
+    {
+      printf ("ERROR [columns]: the row was not returned\n");
+      ret = 1;
+    }
+
+    cape_udc_del (&row);
+    adbl_prepare_del (&pre);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int test03_placeholders ()
+{
+  int ret = 0;
+  number_t i, cnt;
+  number_t batches[TEST_BATCHES_MAX];
+
+  // 1000 columns -> 65 rows fit into the 65535 placeholders of one statement
+  const number_t expected[] = {65, 65, 20};
+
+  CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+  for (i = 0; i < 150; i++)
+  {
+    CapeUdc row = test__row (1000, NULL);
+
+    cape_udc_add (rows, &row);
+  }
+
+  cnt = test__batches (&rows, 1000, batches);
+
+  ret |= test__expect ("placeholders", cnt, batches, 3, expected);
+
+  if (cnt && batches[0] * 1000 > ADBL_PREPARE_MAX_PLACEHOLDERS)
+  {
+    printf ("ERROR [placeholders]: too many placeholders\n");
+    ret = 1;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  res |= test01_batch_size ();
+
+  res |= test02_columns ();
+
+  res |= test03_placeholders ();
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
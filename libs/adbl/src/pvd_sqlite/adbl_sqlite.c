@@ -7,6 +7,9 @@
 #include "sys/cape_log.h"
 #include "sys/cape_file.h"
 
+// c includes
+#include <ctype.h>
+
 //-----------------------------------------------------------------------------
 
 #include "sqlite3.h"
@@ -23,10 +26,105 @@ struct AdblPvdSession_s
   
   sqlite3_mutex* mutex;
   
+  CapeUdc cp;
+  
+  AdblStmtCache stmts;   // prepared statements of the handle
+  
 };
 
 //-----------------------------------------------------------------------------
 
+static int adbl_pvd__pragma_s (AdblPvdSession self, const CapeString pragma, const CapeString value, CapeErr err)
+{
+  int res;
+  const char* pos;
+  
+  // values are part of the statement, only allow names like 'WAL' or 'NORMAL'
+  for (pos = value; *pos; pos++)
+  {
+    if (!isalpha (*pos))
+    {
+      return cape_err_set_fmt (err, CAPE_ERR_WRONG_VALUE, "invalid value for '%s': %s", pragma, value);
+    }
+  }
+  
+  {
+    CapeString h = cape_str_fmt ("PRAGMA %s = %s", pragma, value);
+    
+    res = adbl_prepare_execute (h, self->handle, err);
+    
+    cape_str_del (&h);
+  }
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int adbl_pvd__pragma_n (AdblPvdSession self, const CapeString pragma, CapeErr err)
+{
+  int res = CAPE_ERR_NONE;
+  
+  // only set if configured, otherwise the sqlite3 defaults are used
+  CapeUdc item = cape_udc_get (self->cp, pragma);
+  if (item)
+  {
+    CapeString h = cape_str_fmt ("PRAGMA %s = %li", pragma, cape_udc_n (item, 0));
+    
+    res = adbl_prepare_execute (h, self->handle, err);
+    
+    cape_str_del (&h);
+  }
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int adbl_pvd__configure (AdblPvdSession self, CapeErr err)
+{
+  int res;
+  
+  // wait for locks of other connections instead of failing with SQLITE_BUSY
+  sqlite3_busy_timeout (self->handle, (int)cape_udc_get_n (self->cp, "busy_timeout", 5000));
+  
+  // WAL avoids the fsync of the rollback journal for each transaction
+  // and readers don't block the writer
+  res = adbl_pvd__pragma_s (self, "journal_mode", cape_udc_get_s (self->cp, "journal_mode", "WAL"), err);
+  if (res)
+  {
+    return res;
+  }
+  
+  // NORMAL is safe in WAL mode, only the last transactions might be lost on power loss
+  res = adbl_pvd__pragma_s (self, "synchronous", cape_udc_get_s (self->cp, "synchronous", "NORMAL"), err);
+  if (res)
+  {
+    return res;
+  }
+  
+  // negative values are in KiB, positive values in pages
+  res = adbl_pvd__pragma_n (self, "cache_size", err);
+  if (res)
+  {
+    return res;
+  }
+  
+  // bytes of the database file which are read by memory mapping
+  res = adbl_pvd__pragma_n (self, "mmap_size", err);
+  if (res)
+  {
+    return res;
+  }
+  
+  // the most used statements stay prepared
+  self->stmts = adbl_stmtcache_new (cape_udc_get_n (self->cp, "stmt_cache", 64));
+  
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 AdblPvdSession __STDCALL adbl_pvd_open (CapeUdc cp, CapeErr err)
 {
   AdblPvdSession self = CAPE_NEW (struct AdblPvdSession_s);
@@ -34,6 +132,10 @@ AdblPvdSession __STDCALL adbl_pvd_open (CapeUdc cp, CapeErr err)
   self->schema = cape_str_cp (cape_udc_get_s (cp, "schema", NULL));
   self->handle = NULL;
   self->file = NULL;
+  self->mutex = NULL;
+  self->stmts = NULL;
+  
+  self->cp = cape_udc_cp (cp);
 
   // get the file
   {
@@ -52,8 +154,10 @@ AdblPvdSession __STDCALL adbl_pvd_open (CapeUdc cp, CapeErr err)
     int res = sqlite3_open (self->file, &(self->handle));
     if( res == SQLITE_OK )
     {
-
-      
+      if (adbl_pvd__configure (self, err))
+      {
+        goto exit_and_cleanup;
+      }
     }
     else
     {
@@ -82,14 +186,22 @@ AdblPvdSession __STDCALL adbl_pvd_clone (AdblPvdSession rhs, CapeErr err)
   
   self->schema = cape_str_cp (rhs->schema);
   self->file = cape_str_cp (rhs->file);
+  self->handle = NULL;
+  self->mutex = NULL;
+  self->stmts = NULL;
+  
+  self->cp = cape_udc_cp (rhs->cp);
   
   // open the file
   {
     int res = sqlite3_open (self->file, &(self->handle));
     if( res == SQLITE_OK )
     {
-      
-      
+      // the statements can't be shared with the other handle
+      if (adbl_pvd__configure (self, err))
+      {
+        goto exit_and_cleanup;
+      }
     }
     else
     {
@@ -118,13 +230,20 @@ void __STDCALL adbl_pvd_close (AdblPvdSession* p_self)
   
   cape_str_del (&(self->schema));
   cape_str_del (&(self->file));
+  cape_udc_del (&(self->cp));
+  
+  // must be finalized before the handle is closed
+  adbl_stmtcache_del (&(self->stmts));
   
   if (self->handle)
   {
     sqlite3_close (self->handle);    
   }
   
-  sqlite3_mutex_free (self->mutex);
+  if (self->mutex)
+  {
+    sqlite3_mutex_free (self->mutex);
+  }
   
   CAPE_DEL(p_self, struct AdblPvdSession_s);
 }
@@ -133,7 +252,7 @@ void __STDCALL adbl_pvd_close (AdblPvdSession* p_self)
 
 CapeUdc __STDCALL adbl_pvd_get (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr err)
 {
-  AdblPvdCursor cursor = adbl_pvd_cursor_new (self, table, p_params, p_values, err);
+  AdblPvdCursor cursor = adbl_pvd_cursor_new (self, table, p_params, p_values, limit, offset, group_by, order_by, err);
   
   if (cursor == NULL)
   {
@@ -173,7 +292,7 @@ number_t __STDCALL adbl_pvd_ins (AdblPvdSession self, const char* table, CapeUdc
   
   adbl_prepare_statement_insert (pre, self->schema, table);
   
-  res = adbl_prepare_prepare (pre, self->handle, err);
+  res = adbl_prepare_prepare (pre, self->handle, self->stmts, err);
   if (res)
   {
     goto exit_and_cleanup;
@@ -213,7 +332,7 @@ int __STDCALL adbl_pvd_del (AdblPvdSession self, const char* table, CapeUdc* p_p
   
   adbl_prepare_statement_delete (pre, self->schema, table);
   
-  res = adbl_prepare_prepare (pre, self->handle, err);
+  res = adbl_prepare_prepare (pre, self->handle, self->stmts, err);
   if (res)
   {
     goto exit_and_cleanup;
@@ -248,7 +367,7 @@ int __STDCALL adbl_pvd_set (AdblPvdSession self, const char* table, CapeUdc* p_p
   
   adbl_prepare_statement_update (pre, self->schema, table);
   
-  res = adbl_prepare_prepare (pre, self->handle, err);
+  res = adbl_prepare_prepare (pre, self->handle, self->stmts, err);
   if (res)
   {
     goto exit_and_cleanup;
@@ -276,6 +395,135 @@ exit_and_cleanup:
 
 //-----------------------------------------------------------------------------
 
+static int adbl_pvd__run (AdblPvdSession self, AdblPrepare pre, CapeErr err)
+{
+  int res;
+  
+  res = adbl_prepare_prepare (pre, self->handle, self->stmts, err);
+  if (res)
+  {
+    return res;
+  }
+  
+  res = adbl_prepare_bind (pre, err);
+  if (res)
+  {
+    return res;
+  }
+  
+  return adbl_prepare_run (pre, self->handle, err);
+}
+
+//-----------------------------------------------------------------------------
+
+int __STDCALL adbl_pvd_ins_many (AdblPvdSession self, const char* table, CapeUdc* p_rows, CapeErr err)
+{
+  int res = CAPE_ERR_NONE;
+  CapeUdcCursor* cursor;
+  
+  if (NULL == p_rows || NULL == *p_rows)
+  {
+    return cape_err_set (err, CAPE_ERR_MISSING_PARAM, "rows was not provided");
+  }
+  
+  cursor = cape_udc_cursor_new (*p_rows, CAPE_DIRECTION_FORW);
+  
+  // there is no round trip, each row reuses the cached statement
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc row = cape_udc_cursor_ext (*p_rows, cursor);
+    AdblPrepare pre;
+    
+    if (0 == cape_udc_size (row))
+    {
+      cape_udc_del (&row);
+      continue;
+    }
+    
+    pre = adbl_prepare_new (NULL, &row);
+    
+    adbl_prepare_statement_insert (pre, self->schema, table);
+    
+    res = adbl_pvd__run (self, pre, err);
+    
+    adbl_prepare_del (&pre);
+    
+    if (res)
+    {
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "sqlite3 insert", cape_err_text(err));    
+      break;
+    }
+  }
+  
+  cape_udc_cursor_del (&cursor);
+  cape_udc_del (p_rows);
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int __STDCALL adbl_pvd_set_many (AdblPvdSession self, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr err)
+{
+  int res = CAPE_ERR_NONE;
+  CapeUdcCursor* cursor;
+  
+  if (NULL == p_rows || NULL == *p_rows)
+  {
+    return cape_err_set (err, CAPE_ERR_MISSING_PARAM, "rows was not provided");
+  }
+  
+  cursor = cape_udc_cursor_new (*p_rows, CAPE_DIRECTION_FORW);
+  
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc row = cape_udc_cursor_ext (*p_rows, cursor);
+    CapeUdc params;
+    AdblPrepare pre;
+    
+    // the key column is the constraint, all other columns are updated
+    CapeUdc key_item = cape_udc_ext (row, key);
+    if (NULL == key_item)
+    {
+      res = cape_err_set_fmt (err, CAPE_ERR_MISSING_PARAM, "row without key '%s'", key);
+      
+      cape_udc_del (&row);
+      break;
+    }
+    
+    if (0 == cape_udc_size (row))
+    {
+      cape_udc_del (&key_item);
+      cape_udc_del (&row);
+      continue;
+    }
+    
+    params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    cape_udc_add (params, &key_item);
+    
+    pre = adbl_prepare_new (&params, &row);
+    
+    adbl_prepare_statement_update (pre, self->schema, table);
+    
+    res = adbl_pvd__run (self, pre, err);
+    
+    adbl_prepare_del (&pre);
+    
+    if (res)
+    {
+      cape_log_msg (CAPE_LL_WARN, "ADBL", "sqlite3 set", cape_err_text(err));    
+      break;
+    }
+  }
+  
+  cape_udc_cursor_del (&cursor);
+  cape_udc_del (p_rows);
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
 number_t __STDCALL adbl_pvd_ins_or_set (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err)
 {
   int res;
@@ -285,7 +533,7 @@ number_t __STDCALL adbl_pvd_ins_or_set (AdblPvdSession self, const char* table,
   
   adbl_prepare_statement_setins (pre, self->schema, table);
   
-  res = adbl_prepare_prepare (pre, self->handle, err);
+  res = adbl_prepare_prepare (pre, self->handle, self->stmts, err);
   if (res)
   {
     goto exit_and_cleanup;
@@ -361,6 +609,22 @@ int __STDCALL adbl_pvd_rollback (AdblPvdSession self, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
+int __STDCALL adbl_pvd_ping (AdblPvdSession self, CapeErr err)
+{
+  // a local file has no connection which can break
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t __STDCALL adbl_pvd_lag (AdblPvdSession self, CapeErr err)
+{
+  // a local file has no replication
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
 struct AdblPvdCursor_s
 {
   AdblPrepare pre;
@@ -368,7 +632,7 @@ struct AdblPvdCursor_s
 
 //-----------------------------------------------------------------------------
 
-AdblPvdCursor __STDCALL adbl_pvd_cursor_new (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr err)
+AdblPvdCursor __STDCALL adbl_pvd_cursor_new (AdblPvdSession self, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr err)
 {
   int res;
   
@@ -378,7 +642,7 @@ AdblPvdCursor __STDCALL adbl_pvd_cursor_new (AdblPvdSession self, const char* ta
   
   adbl_prepare_statement_select (cursor->pre, self->schema, table);
   
-  res = adbl_prepare_prepare (cursor->pre, self->handle, err);
+  res = adbl_prepare_prepare (cursor->pre, self->handle, self->stmts, err);
   if (res)
   {
     goto exit_and_cleanup;
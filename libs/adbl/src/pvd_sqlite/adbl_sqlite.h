@@ -13,6 +13,8 @@ struct AdblPvdSession_s; typedef struct AdblPvdSession_s* AdblPvdSession;
 
 __CAPE_LIBEX   AdblPvdSession  __STDCALL adbl_pvd_open              (CapeUdc connection_properties, CapeErr);
 
+__CAPE_LIBEX   AdblPvdSession  __STDCALL adbl_pvd_clone             (AdblPvdSession, CapeErr);
+
 __CAPE_LIBEX   void            __STDCALL adbl_pvd_close             (AdblPvdSession*);
 
 //-----------------------------------------------------------------------------
@@ -33,6 +35,10 @@ __CAPE_LIBEX   int             __STDCALL adbl_pvd_del               (AdblPvdSess
 
 __CAPE_LIBEX   int             __STDCALL adbl_pvd_set               (AdblPvdSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);    // returns error code
 
+__CAPE_LIBEX   int             __STDCALL adbl_pvd_ins_many          (AdblPvdSession, const char* table, CapeUdc* p_rows, CapeErr);                         // returns error code
+
+__CAPE_LIBEX   int             __STDCALL adbl_pvd_set_many          (AdblPvdSession, const char* table, const CapeString key, CapeUdc* p_rows, CapeErr);   // returns error code
+
 // don't use
 __CAPE_LIBEX   number_t        __STDCALL adbl_pvd_ins_or_set        (AdblPvdSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);    // returns the ID (ID == 0 -> error)
 
@@ -46,13 +52,17 @@ __CAPE_LIBEX   int             __STDCALL adbl_pvd_commit            (AdblPvdSess
 
 __CAPE_LIBEX   int             __STDCALL adbl_pvd_rollback          (AdblPvdSession, CapeErr);
 
+__CAPE_LIBEX   int             __STDCALL adbl_pvd_ping              (AdblPvdSession, CapeErr);         // checks if the connection is still alive
+
+__CAPE_LIBEX   number_t        __STDCALL adbl_pvd_lag               (AdblPvdSession, CapeErr);         // seconds the replica is behind its primary, -1 on error
+
 //-----------------------------------------------------------------------------
 
 struct AdblPvdCursor_s; typedef struct AdblPvdCursor_s* AdblPvdCursor;
 
 //-----------------------------------------------------------------------------
 
-__CAPE_LIBEX   AdblPvdCursor   __STDCALL adbl_pvd_cursor_new        (AdblPvdSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, CapeErr);
+__CAPE_LIBEX   AdblPvdCursor   __STDCALL adbl_pvd_cursor_new        (AdblPvdSession, const char* table, CapeUdc* p_params, CapeUdc* p_values, number_t limit, number_t offset, const CapeString group_by, const CapeString order_by, CapeErr);
 
 __CAPE_LIBEX   void            __STDCALL adbl_pvd_cursor_del        (AdblPvdCursor*);
 
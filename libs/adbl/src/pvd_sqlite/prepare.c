@@ -24,6 +24,8 @@ struct AdblPrepare_s
   CapeString order_by;
 
   sqlite3_stmt* stmt;
+  
+  AdblStmtCache stmts;           // reference
 };
 
 //-----------------------------------------------------------------------------
@@ -120,6 +122,7 @@ AdblPrepare adbl_prepare_new (CapeUdc* p_params, CapeUdc* p_values)
 
   self->stream = cape_stream_new ();
   self->stmt = NULL;
+  self->stmts = NULL;
   self->binds = cape_list_new (NULL);
   
   return self;
@@ -131,6 +134,20 @@ void adbl_prepare_del (AdblPrepare* p_self)
 {
   AdblPrepare self = *p_self;
   
+  if (self->stmt)
+  {
+    if (self->stmts)
+    {
+      // keep the statement for the next call with the same SQL
+      adbl_stmtcache_put (self->stmts, cape_stream_get (self->stream), &(self->stmt));
+    }
+    else
+    {
+      // free resources
+      sqlite3_finalize (self->stmt);
+    }
+  }
+  
   cape_udc_del (&(self->params));
   cape_udc_del (&(self->values));
 
@@ -138,12 +155,6 @@ void adbl_prepare_del (AdblPrepare* p_self)
   
   cape_list_del (&(self->binds));
   
-  if (self->stmt)
-  {
-    // free resources
-    sqlite3_finalize (self->stmt);
-  }
-  
   CAPE_DEL(p_self, struct AdblPrepare_s);
 }
 
@@ -183,8 +194,20 @@ int adbl_prepare_execute (const CapeString statement, sqlite3* handle, CapeErr e
 
 //-----------------------------------------------------------------------------
 
-int adbl_prepare_prepare (AdblPrepare self, sqlite3* handle, CapeErr err)
+int adbl_prepare_prepare (AdblPrepare self, sqlite3* handle, AdblStmtCache stmts, CapeErr err)
 {
+  self->stmts = stmts;
+  
+  if (stmts)
+  {
+    self->stmt = adbl_stmtcache_get (stmts, cape_stream_get (self->stream));
+    if (self->stmt)
+    {
+      // the statement is already parsed, only the binds are needed
+      return CAPE_ERR_NONE;
+    }
+  }
+  
   if (sqlite3_prepare_v2 (handle, cape_stream_get (self->stream), cape_stream_size (self->stream), &(self->stmt), NULL) == SQLITE_OK)
   {
     return CAPE_ERR_NONE;
@@ -216,7 +239,8 @@ int adbl_prepare_run (AdblPrepare self, sqlite3* handle, CapeErr err)
     }      
     default:
     {
-      return CAPE_ERR_NONE;
+      // constraint violations, SQLITE_BUSY after the busy timeout...
+      return cape_err_set (err, CAPE_ERR_3RDPARTY_LIB, sqlite3_errmsg (handle));
     }
   }
 }
@@ -311,36 +335,9 @@ CapeUdc adbl_prepare_values (AdblPrepare self)
 
 number_t adbl_prepare_lastid (AdblPrepare self, sqlite3* handle, const char* schema, const char* table, CapeErr err)
 {
-  // free resources
-  sqlite3_finalize (self->stmt);
-  
-  cape_stream_clr (self->stream);
-  
-  cape_udc_del (&(self->values));
-  
-  self->values = cape_udc_new (CAPE_UDC_NODE, NULL);
-  
-  cape_udc_add_n (self->values, "seq", 0);
-  
-  cape_stream_append_str (self->stream, "SELECT seq FROM sqlite_sequence WHERE name = \"");
-
-  adbl_pvd_append_table (self->stream, schema, table);
-  
-  cape_stream_append_c (self->stream, '"');
-  
-  cape_log_msg (CAPE_LL_TRACE, "ADBL", "sqlite3 **SQL**", cape_stream_get (self->stream));
-  
-  if (sqlite3_prepare_v2 (handle, cape_stream_get (self->stream), cape_stream_size (self->stream), &(self->stmt), NULL) != SQLITE_OK)
-  {
-    return 0;
-  }
-  
-  if (!adbl_prepare_next (self))
-  {
-    return 0;
-  }
-
-  return cape_udc_get_n (self->values, "seq", 0);
+  // for AUTOINCREMENT tables this is the same as the sequence value,
+  // but it belongs to this connection and needs no extra statement
+  return (number_t)sqlite3_last_insert_rowid (handle);
 }
 
 //-----------------------------------------------------------------------------
@@ -556,8 +553,7 @@ void adbl_pvd_append_update (AdblPrepare self, CapeStream stream, CapeUdc values
         cape_stream_append_str (stream, ", ");
       }
       
-      cape_stream_append_str (stream, table );
-      cape_stream_append_str (stream, "." );
+      // sqlite doesn't allow the table name in the set clause
       cape_stream_append_str (stream, column_name);
       cape_stream_append_str (stream, " = ?" );
       
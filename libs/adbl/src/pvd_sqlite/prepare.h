@@ -2,6 +2,7 @@
 #define __ADBL_SQLITE3__PREPARE_H 1
 
 #include "adbl_sqlite.h"
+#include "stmtcache.h"
 
 //-----------------------------------------------------------------------------
 
@@ -27,7 +28,8 @@ __CAPE_LIBEX   int             adbl_prepare_execute            (const CapeString
 
 //-----------------------------------------------------------------------------
 
-__CAPE_LIBEX   int             adbl_prepare_prepare            (AdblPrepare, sqlite3* handle, CapeErr err);
+                               /* takes the statement from the cache if available, the statement is returned by del */
+__CAPE_LIBEX   int             adbl_prepare_prepare            (AdblPrepare, sqlite3* handle, AdblStmtCache stmts, CapeErr err);
 
 __CAPE_LIBEX   int             adbl_prepare_bind               (AdblPrepare, CapeErr err);
 
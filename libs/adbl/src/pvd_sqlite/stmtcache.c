@@ -0,0 +1,168 @@
+#include "stmtcache.h"
+
+// cape includes
+#include <stc/cape_hash.h>
+#include <stc/cape_list.h>
+#include <sys/cape_mutex.h>
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeString sql;
+  
+  sqlite3_stmt* stmt;
+  
+} AdblStmtCacheEntry;
+
+//-----------------------------------------------------------------------------
+
+struct AdblStmtCache_s
+{
+  number_t max_size;
+  
+  CapeList entries;              // most recently used first, owns the entries
+  CapeHash index;                // sql -> list node
+  
+  CapeMutex mutex;
+};
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL adbl_stmtcache__entries__on_del (void* ptr)
+{
+  AdblStmtCacheEntry* entry = ptr;
+  
+  sqlite3_finalize (entry->stmt);
+  
+  cape_str_del (&(entry->sql));
+  
+  CAPE_DEL (&entry, AdblStmtCacheEntry);
+}
+
+//-----------------------------------------------------------------------------
+
+AdblStmtCache adbl_stmtcache_new (number_t max_size)
+{
+  AdblStmtCache self = CAPE_NEW (struct AdblStmtCache_s);
+  
+  self->max_size = max_size;
+  
+  self->entries = cape_list_new (adbl_stmtcache__entries__on_del);
+  
+  // the keys are owned by the entries
+  self->index = cape_hash_new (NULL, NULL, NULL, NULL);
+  
+  self->mutex = cape_mutex_new ();
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_stmtcache_del (AdblStmtCache* p_self)
+{
+  if (*p_self)
+  {
+    AdblStmtCache self = *p_self;
+    
+    cape_hash_del (&(self->index));
+    cape_list_del (&(self->entries));
+    
+    cape_mutex_del (&(self->mutex));
+    
+    CAPE_DEL (p_self, struct AdblStmtCache_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+sqlite3_stmt* adbl_stmtcache_get (AdblStmtCache self, const CapeString sql)
+{
+  sqlite3_stmt* ret = NULL;
+  
+  cape_mutex_lock (self->mutex);
+  
+  {
+    CapeHashNode n = cape_hash_find (self->index, sql);
+    if (n)
+    {
+      AdblStmtCacheEntry* entry = cape_list_node_extract (self->entries, cape_hash_node_value (n));
+      
+      // the key belongs to the entry
+      cape_hash_erase (self->index, n);
+      
+      ret = entry->stmt;
+      
+      cape_str_del (&(entry->sql));
+      CAPE_DEL (&entry, AdblStmtCacheEntry);
+    }
+  }
+  
+  cape_mutex_unlock (self->mutex);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void adbl_stmtcache_put (AdblStmtCache self, const CapeString sql, sqlite3_stmt** p_stmt)
+{
+  sqlite3_stmt* stmt = *p_stmt;
+  
+  *p_stmt = NULL;
+  
+  // the statement can be executed again, string bindings might point to released values
+  sqlite3_reset (stmt);
+  sqlite3_clear_bindings (stmt);
+  
+  cape_mutex_lock (self->mutex);
+  
+  // another statement of the same shape was used at the same time
+  if (self->max_size == 0 || cape_hash_find (self->index, sql))
+  {
+    sqlite3_finalize (stmt);
+    goto exit_and_cleanup;
+  }
+  
+  if (cape_list_size (self->entries) >= self->max_size)
+  {
+    // remove the least recently used statement
+    CapeListNode back = cape_list_node_back (self->entries);
+    AdblStmtCacheEntry* entry = cape_list_node_data (back);
+    
+    cape_hash_erase (self->index, cape_hash_find (self->index, entry->sql));
+    
+    cape_list_node_erase (self->entries, back);
+  }
+  
+  {
+    AdblStmtCacheEntry* entry = CAPE_NEW (AdblStmtCacheEntry);
+    
+    entry->sql = cape_str_cp (sql);
+    entry->stmt = stmt;
+    
+    cape_hash_insert (self->index, entry->sql, cape_list_push_front (self->entries, entry));
+  }
+  
+exit_and_cleanup:
+  
+  cape_mutex_unlock (self->mutex);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t adbl_stmtcache_size (AdblStmtCache self)
+{
+  number_t ret;
+  
+  cape_mutex_lock (self->mutex);
+  
+  ret = cape_list_size (self->entries);
+  
+  cape_mutex_unlock (self->mutex);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
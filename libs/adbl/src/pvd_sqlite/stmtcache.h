@@ -0,0 +1,48 @@
+#ifndef __ADBL_SQLITE3__STMTCACHE_H
+#define __ADBL_SQLITE3__STMTCACHE_H 1
+
+//-----------------------------------------------------------------------------
+
+// sqlite3 includes
+#include <sqlite3.h>
+
+// cape includes
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_str.h"
+
+//=============================================================================
+
+/* LRU cache of prepared statements of one session
+ *
+ * -> the key is the SQL text of the statement
+ * -> a statement is taken out while it is used, returned statements are
+ *    reset and their bindings are cleared
+ * -> thread safe, a cursor might return its statement from another thread
+ */
+
+//-----------------------------------------------------------------------------
+
+struct AdblStmtCache_s; typedef struct AdblStmtCache_s* AdblStmtCache;
+
+//-----------------------------------------------------------------------------
+
+                                               /* max_size = 0 -> all statements are finalized after usage */
+__CAPE_LIBEX   AdblStmtCache   adbl_stmtcache_new            (number_t max_size);
+
+                                               /* must be called before the database handle is closed */
+__CAPE_LIBEX   void            adbl_stmtcache_del            (AdblStmtCache*);
+
+//-----------------------------------------------------------------------------
+
+                                               /* returns NULL if no statement was cached, the ownership is transfered */
+__CAPE_LIBEX   sqlite3_stmt*   adbl_stmtcache_get            (AdblStmtCache, const CapeString sql);
+
+                                               /* returns the statement to the cache, the least recently used one might be finalized */
+__CAPE_LIBEX   void            adbl_stmtcache_put            (AdblStmtCache, const CapeString sql, sqlite3_stmt** p_stmt);
+
+__CAPE_LIBEX   number_t        adbl_stmtcache_size           (AdblStmtCache);
+
+//-----------------------------------------------------------------------------
+
+#endif
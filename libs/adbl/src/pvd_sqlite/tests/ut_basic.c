@@ -5,164 +5,397 @@
 
 // cape includes
 #include "sys/cape_err.h"
+#include "sys/cape_file.h"
+#include "sys/cape_log.h"
 #include "stc/cape_udc.h"
-#include "fmt/cape_json.h"
+
+// sqlite includes
+#include <sqlite3.h>
+
+#include <stdio.h>
 
 //-----------------------------------------------------------------------------
 
-int main (int argc, char *argv[])
+#define TEST_DBFILE "test.db"
+
+//-----------------------------------------------------------------------------
+
+static int test__db_create (void)
+{
+  int ret = 0;
+  sqlite3* handle;
+  char* errmsg = NULL;
+
+  cape_fs_file_rm (TEST_DBFILE, NULL);
+
+  if (sqlite3_open (TEST_DBFILE, &handle) != SQLITE_OK)
+  {
+    printf ("ERROR [db]: can't create the database\n");
+    return 1;
+  }
+
+  if (sqlite3_exec (handle, "CREATE TABLE test_table01 (id INTEGER PRIMARY KEY AUTOINCREMENT, fk01 INTEGER, col01 TEXT, col02 TEXT);", 0, 0, &errmsg) != SQLITE_OK)
+  {
+    printf ("ERROR [db]: %s\n", errmsg);
+    ret = 1;
+  }
+
+  sqlite3_free (errmsg);
+  sqlite3_close (handle);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t test__count (AdblPvdSession session, CapeUdc* p_params)
 {
+  number_t ret = -1;
+
   CapeErr err = cape_err_new ();
-  
-  CapeUdc properties = cape_udc_new (CAPE_UDC_NODE, NULL);
-  
-  cape_udc_add_s_cp (properties, "schema", "test");
-  cape_udc_add_s_cp (properties, "dbfile", "test.db");
-  
+  CapeUdc columns = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc results;
+
+  cape_udc_add_n (columns, "id", 0);
+
+  results = adbl_pvd_get (session, "test_table01", p_params, &columns, 0, 0, NULL, NULL, err);
+
+  if (results)
+  {
+    ret = cape_udc_size (results);
+  }
+  else
   {
-    AdblPvdSession session = adbl_pvd_open (properties, err);
+    printf ("ERROR [count]: %s\n", cape_err_text (err));
+  }
+
+  cape_udc_del (&results);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static int test__expect_count (AdblPvdSession session, const char* where, const CapeString column, const CapeString value, number_t expected)
+{
+  number_t cnt;
+  CapeUdc params = NULL;
+
+  if (column)
+  {
+    params = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_s_cp (params, column, value);
+  }
+
+  cnt = test__count (session, column ? &params : NULL);
+
+  cape_udc_del (&params);
+
+  if (cnt != expected)
+  {
+    printf ("ERROR [%s]: %li rows instead of %li\n", where, cnt, expected);
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int test01_ins (AdblPvdSession session, number_t* p_last_id)
+{
+  int ret = 0;
+  int i;
+
+  CapeErr err = cape_err_new ();
 
-    if (session)
+  for (i = 0; i < 10; i++)
+  {
+    number_t id;
+    CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    // define the columns we want to insert
+    cape_udc_add_n       (values, "id", ADBL_AUTO_INCREMENT);   // this column is an auto increment column
+    cape_udc_add_n       (values, "fk01", 42);
+    cape_udc_add_s_cp    (values, "col01", "my column");
+    cape_udc_add_s_cp    (values, "col02", "is great");
+
+    id = adbl_pvd_ins (session, "test_table01", &values, err);
+
+    if (id <= *p_last_id)
     {
-      // delete
-      {
-        CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        
-        cape_udc_add_n       (params, "id", 1);
+      printf ("ERROR [ins]: wrong id %li: %s\n", id, cape_err_text (err));
+      ret = 1;
+    }
 
-        int res = adbl_pvd_del (session, "test_table01", &params, err);
-        if (res)
-        {
-          printf ("ERROR DEL: %s\n", cape_err_text(err));
-          
-          
-        }
-        
-      }
-      // fetch
-      {
-        //CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        
-        //cape_udc_add_n       (params, "id", 1);
-        
-        CapeUdc columns = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        
-        // define the columns we want to fetch
-        cape_udc_add_n       (columns, "fk01", 0);
-        cape_udc_add_s_cp    (columns, "col01", NULL);
-        cape_udc_add_s_cp    (columns, "col02", NULL);
-
-        CapeUdc results = adbl_pvd_get (session, "test_table01", NULL, &columns, 0, 0, NULL, NULL, err);
-
-        if (results)
-        {
-          cape_udc_del (&results);
-        }
-      }
+    *p_last_id = id;
+  }
 
-      int i;
-      number_t last_inserted_row = 0;
-      
-      // insert
-      for (i = 0; i < 10; i++)
-      {
-        CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        // define the columns we want to insert
-        cape_udc_add_n       (values, "id", ADBL_AUTO_INCREMENT);   // this column is an auto increment column
-        cape_udc_add_n       (values, "fk01", 42);
-        cape_udc_add_s_cp    (values, "col01", "my column");
-        cape_udc_add_s_cp    (values, "col02", "is great");
-        
-        last_inserted_row = adbl_pvd_ins (session, "test_table01", &values, err);
-        
-        if (last_inserted_row <= 0)
-        {
-          printf ("ERROR: %s\n", cape_err_text(err));
-          
-          
-        }
-        else
-        {
-          printf ("INSERTED ROW / ID: %li\n", last_inserted_row);
-        }
-      }
-      
-      // update all
-      {
-        CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        // define the columns we want to insert
-        cape_udc_add_n       (values, "fk01", 10);
-        cape_udc_add_s_cp    (values, "col02", "is small");
-
-        int res = adbl_pvd_set (session, "test_table01", NULL, &values, err);
-        
-      }
-      
-      // update last row
-      {
-        CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        
-        cape_udc_add_n       (params, "id", last_inserted_row);
-        
-        CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        // define the columns we want to insert
-        cape_udc_add_n       (values, "fk01", 10);
-        cape_udc_add_s_cp    (values, "col02", "is last");
-        
-        int res = adbl_pvd_set (session, "test_table01", &params, &values, err);
-        
-      }      
-      
-      // fetch
+  ret |= test__expect_count (session, "ins", NULL, NULL, 10);
+
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int test02_ins_many (AdblPvdSession session)
+{
+  int ret = 0;
+  int i;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+  for (i = 0; i < 10; i++)
+  {
+    CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_n       (values, "id", ADBL_AUTO_INCREMENT);
+    cape_udc_add_n       (values, "fk01", 100 + i);
+    cape_udc_add_s_cp    (values, "col01", "many");
+
+    cape_udc_add (rows, &values);
+  }
+
+  if (adbl_pvd_ins_many (session, "test_table01", &rows, err))
+  {
+    printf ("ERROR [ins many]: %s\n", cape_err_text (err));
+    ret = 1;
+  }
+
+  ret |= test__expect_count (session, "ins many", NULL, NULL, 20);
+  ret |= test__expect_count (session, "ins many", "col01", "many", 10);
+
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int test03_set_many (AdblPvdSession session)
+{
+  int ret = 0;
+  int i;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc rows = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+  for (i = 0; i < 3; i++)
+  {
+    CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_n       (values, "fk01", 100 + i);
+    cape_udc_add_s_cp    (values, "col02", "updated");
+
+    cape_udc_add (rows, &values);
+  }
+
+  if (adbl_pvd_set_many (session, "test_table01", "fk01", &rows, err))
+  {
+    printf ("ERROR [set many]: %s\n", cape_err_text (err));
+    ret = 1;
+  }
+
+  // only the rows with the keys were updated
+  {
+    CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc columns = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc results;
+
+    cape_udc_add_s_cp (params, "col02", "updated");
+    cape_udc_add_n (columns, "fk01", 0);
+
+    results = adbl_pvd_get (session, "test_table01", &params, &columns, 0, 0, NULL, NULL, err);
+
+    if (results == NULL || cape_udc_size (results) != 3)
+    {
+      printf ("ERROR [set many]: wrong amount of updated rows\n");
+      ret = 1;
+    }
+    else
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (results, CAPE_DIRECTION_FORW);
+
+      while (cape_udc_cursor_next (cursor))
       {
-        
-        //CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        //cape_udc_add_n       (params, "id", 1);
-        
-        CapeUdc columns = cape_udc_new (CAPE_UDC_NODE, NULL);
-        
-        // define the columns we want to fetch
-        cape_udc_add_n       (columns, "id", 0);
-        cape_udc_add_n       (columns, "fk01", 0);
-        cape_udc_add_s_cp    (columns, "col01", NULL);
-        cape_udc_add_s_cp    (columns, "col02", NULL);
-
-        CapeUdc results = adbl_pvd_get (session, "test_table01", NULL, &columns, 0, 0, NULL, NULL, err);
-
-        if (results)
+        number_t fk01 = cape_udc_get_n (cursor->item, "fk01", 0);
+
+        if (fk01 < 100 || fk01 > 102)
         {
-          CapeString h = cape_json_to_s (results);
-          
-          printf ("%s\n", h);
-          
-          cape_str_del(&h);
-          
-          cape_udc_del (&results);
+          printf ("ERROR [set many]: wrong row was updated\n");
+          ret = 1;
         }
       }
-      
-      
-      adbl_pvd_close (&session);
-    } 
+
+      cape_udc_cursor_del (&cursor);
+    }
+
+    cape_udc_del (&results);
+  }
+
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int test04_set (AdblPvdSession session, number_t last_id)
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+
+  // update all
+  {
+    CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_n       (values, "fk01", 10);
+    cape_udc_add_s_cp    (values, "col02", "is small");
+
+    if (adbl_pvd_set (session, "test_table01", NULL, &values, err))
+    {
+      printf ("ERROR [set]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+  }
+
+  ret |= test__expect_count (session, "set all", "col02", "is small", 20);
+
+  // update last row
+  {
+    CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc values = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_n       (params, "id", last_id);
+    cape_udc_add_s_cp    (values, "col02", "is last");
+
+    if (adbl_pvd_set (session, "test_table01", &params, &values, err))
+    {
+      printf ("ERROR [set]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+  }
+
+  ret |= test__expect_count (session, "set last", "col02", "is small", 19);
+
+  // the last row has the new value
+  {
+    CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc columns = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc results;
+
+    cape_udc_add_n       (params, "id", last_id);
+    cape_udc_add_n       (columns, "fk01", 0);
+    cape_udc_add_s_cp    (columns, "col02", NULL);
+
+    results = adbl_pvd_get (session, "test_table01", &params, &columns, 0, 0, NULL, NULL, err);
+
+    if (results == NULL || cape_udc_size (results) != 1)
+    {
+      printf ("ERROR [set last]: row was not found\n");
+      ret = 1;
+    }
     else
     {
-      printf ("ERROR: %s\n", cape_err_text(err));
+      CapeUdc row = cape_udc_get_first (results);
+
+      if (cape_udc_get_n (row, "fk01", 0) != 10 || !cape_str_equal (cape_udc_get_s (row, "col02", NULL), "is last"))
+      {
+        printf ("ERROR [set last]: wrong values\n");
+        ret = 1;
+      }
     }
+
+    cape_udc_del (&results);
   }
 
-  cape_udc_del (&properties);
   cape_err_del (&err);
-  
-  return 0;
+
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
 
+int test05_del (AdblPvdSession session)
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc params = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  cape_udc_add_n       (params, "id", 1);
+
+  if (adbl_pvd_del (session, "test_table01", &params, err))
+  {
+    printf ("ERROR [del]: %s\n", cape_err_text (err));
+    ret = 1;
+  }
+
+  ret |= test__expect_count (session, "del", NULL, NULL, 19);
+
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc properties = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  AdblPvdSession session;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  cape_udc_add_s_cp (properties, "schema", "test");
+  cape_udc_add_s_cp (properties, "dbfile", TEST_DBFILE);
+
+  if (test__db_create ())
+  {
+    res = 1;
+    goto exit_and_cleanup;
+  }
+
+  session = adbl_pvd_open (properties, err);
+
+  if (session == NULL)
+  {
+    printf ("ERROR: can't open the database: %s\n", cape_err_text (err));
+    res = 1;
+  }
+  else
+  {
+    number_t last_id = 0;
+
+    res |= test01_ins (session, &last_id);
+
+    res |= test02_ins_many (session);
+
+    res |= test03_set_many (session);
+
+    res |= test04_set (session, last_id);
+
+    res |= test05_del (session);
+
+    adbl_pvd_close (&session);
+  }
+
+exit_and_cleanup:
+
+  cape_udc_del (&properties);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,177 @@
+#include "adbl_sqlite.h"
+#include "adbl_pool.h"
+
+//-----------------------------------------------------------------------------
+
+// cape includes
+#include "sys/cape_err.h"
+#include "sys/cape_log.h"
+#include "sys/cape_time.h"
+#include "stc/cape_udc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+static int test__try_busy (AdblPool pool, const char* where)
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  cape_stoptimer_start (st);
+
+  if (adbl_pool_try (pool, err))
+  {
+    printf ("ERROR [%s]: got a connection of a full pool\n", where);
+    ret = 1;
+  }
+
+  cape_stoptimer_stop (st);
+
+  // a full pool is not an error
+  if (cape_err_code (err))
+  {
+    printf ("ERROR [%s]: %s\n", where, cape_err_text (err));
+    ret = 1;
+  }
+
+  if (cape_stoptimer_get (st) > 1000)
+  {
+    printf ("ERROR [%s]: waited %f ms for the connection\n", where, cape_stoptimer_get (st));
+    ret = 1;
+  }
+
+  cape_stoptimer_del (&st);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int test01_try (void* session, const AdblPvd* pvd)
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc properties = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  AdblPool pool;
+  CapeListNode n1, n2;
+
+  // a get would wait 5 seconds
+  cape_udc_add_n (properties, "pool_max", 2);
+  cape_udc_add_n (properties, "pool_wait", 5000);
+
+  pool = adbl_pool_new (pvd, session, properties);
+
+  // new connections are created without waiting
+  n1 = adbl_pool_try (pool, err);
+  n2 = adbl_pool_try (pool, err);
+
+  if (n1 == NULL || n2 == NULL)
+  {
+    printf ("ERROR: can't create connections: %s\n", cape_err_text (err));
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  ret |= test__try_busy (pool, "full");
+
+  // the released connection is used again
+  adbl_pool_rel (pool, n2);
+
+  n2 = adbl_pool_try (pool, err);
+
+  if (n2 == NULL)
+  {
+    printf ("ERROR: released connection was not returned\n");
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  ret |= test__try_busy (pool, "full again");
+
+  // the provider works with the connection
+  if (pvd->pvd_lag (adbl_pool_handle (pool, n1), err) != 0)
+  {
+    printf ("ERROR: lag of the connection: %s\n", cape_err_text (err));
+    ret = 1;
+  }
+
+  // a busy pool is not counted as timeout or wait
+  {
+    CapeUdc stats = adbl_pool_stats (pool);
+
+    if (cape_udc_get_n (stats, "waits", -1) != 0 || cape_udc_get_n (stats, "timeouts", -1) != 0 || cape_udc_get_n (stats, "created", -1) != 2)
+    {
+      printf ("ERROR: wrong statistics of the pool\n");
+      ret = 1;
+    }
+
+    cape_udc_del (&stats);
+  }
+
+  adbl_pool_rel (pool, n1);
+  adbl_pool_rel (pool, n2);
+
+exit_and_cleanup:
+
+  adbl_pool_del (&pool);
+
+  cape_udc_del (&properties);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc properties = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  AdblPvdSession session;
+  AdblPvd pvd;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  cape_udc_add_s_cp (properties, "schema", "test");
+  cape_udc_add_s_cp (properties, "dbfile", "test_pool.db");
+
+  // the pool only uses the connection functions
+  memset (&pvd, 0, sizeof(AdblPvd));
+
+  pvd.pvd_open = (fct_adbl_pvd_open)adbl_pvd_open;
+  pvd.pvd_clone = (fct_adbl_pvd_clone)adbl_pvd_clone;
+  pvd.pvd_close = (fct_adbl_pvd_close)adbl_pvd_close;
+  pvd.pvd_ping = (fct_adbl_pvd_ping)adbl_pvd_ping;
+  pvd.pvd_lag = (fct_adbl_pvd_lag)adbl_pvd_lag;
+
+  session = adbl_pvd_open (properties, err);
+
+  if (session == NULL)
+  {
+    printf ("ERROR: can't open the database: %s\n", cape_err_text (err));
+    res = 1;
+  }
+  else
+  {
+    res |= test01_try (session, &pvd);
+
+    adbl_pvd_close (&session);
+  }
+
+  cape_udc_del (&properties);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
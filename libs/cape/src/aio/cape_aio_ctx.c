@@ -43,6 +43,10 @@ struct CapeAioHandle_s
   // callback method for any kind of event
   fct_cape_aio_onEvent on_event;
   
+  // CAPE_AIO__INTERNAL_IN_EVENT while the AIO thread handles an event and re-arms the handle
+  // -> collects the flags of cape_aio_context_mod calls from other threads in the meantime
+  int pending;
+  
 #if defined __BSD_OS
 
   int option;
@@ -82,6 +86,7 @@ CapeAioHandle cape_aio_handle_new (int hflags, void* ptr, fct_cape_aio_onEvent o
   self->on_unref = on_unref;
   
   self->hflags = hflags;
+  self->pending = 0;
   
   return self;
 }
@@ -98,6 +103,77 @@ void cape_aio_handle_del (CapeAioHandle* p_self)
 
 //-----------------------------------------------------------------------------
 
+static void cape_aio_handle__event_begin (CapeAioHandle self)
+{
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  __sync_lock_test_and_set (&(self->pending), CAPE_AIO__INTERNAL_IN_EVENT);
+
+#else
+
+  self->pending = CAPE_AIO__INTERNAL_IN_EVENT;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_aio_handle__event_end (CapeAioHandle self)
+{
+  // returns all flags which were set by other threads during the event
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  return __sync_lock_test_and_set (&(self->pending), 0) & ~CAPE_AIO__INTERNAL_IN_EVENT;
+
+#else
+
+  int ret = self->pending & ~CAPE_AIO__INTERNAL_IN_EVENT;
+
+  self->pending = 0;
+
+  return ret;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_aio_handle__defer (CapeAioHandle self, int hflags)
+{
+  // the AIO thread re-arms the handle after the event with its own flags
+  // -> a modification in the meantime would be overwritten, the AIO thread applies it afterwards
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  while (TRUE)
+  {
+    int pending = self->pending;
+
+    if (!(pending & CAPE_AIO__INTERNAL_IN_EVENT))
+    {
+      return FALSE;
+    }
+
+    if (__sync_bool_compare_and_swap (&(self->pending), pending, pending | hflags))
+    {
+      return TRUE;
+    }
+  }
+
+#else
+
+  if (self->pending & CAPE_AIO__INTERNAL_IN_EVENT)
+  {
+    self->pending |= hflags;
+    return TRUE;
+  }
+
+  return FALSE;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
 struct CapeAioContext_s
 {
   
@@ -570,6 +646,8 @@ int cape_aio_context_next (CapeAioContext self, long timeout_in_ms, CapeErr err)
     {
       number_t hflags_result;
       
+      cape_aio_handle__event_begin (hobj);
+      
       if (hobj->on_event)
       {
         hflags_result = hobj->on_event (hobj->ptr, hobj->hflags, event.flags, 0);
@@ -600,6 +678,8 @@ int cape_aio_context_next (CapeAioContext self, long timeout_in_ms, CapeErr err)
         if (hflags_result & CAPE_AIO_ABORT)
         {
           cape_log_fmt (CAPE_LL_TRACE, "CAPE", "aio next", "abort");
+          
+          cape_aio_handle__event_end (hobj);
           return CAPE_ERR_CONTINUE;
         }
 
@@ -613,6 +693,16 @@ int cape_aio_context_next (CapeAioContext self, long timeout_in_ms, CapeErr err)
         }
         
         cape_aio_update_event (self, hobj, (void*)event.ident, hobj->option);
+        
+        // apply the modifications of other threads
+        {
+          int hflags_pending = cape_aio_handle__event_end (hobj);
+          
+          if (hflags_pending)
+          {
+            cape_aio_context_mod (self, hobj, (void*)event.ident, hflags_pending, hobj->option);
+          }
+        }
       }
     }
     else
@@ -694,6 +784,8 @@ int cape_aio_context_next (CapeAioContext self, long timeout_in_ms, CapeErr err)
     {
       number_t hflags_result;
       
+      cape_aio_handle__event_begin (hobj);
+      
       if (hobj->on_event)
       {
         hflags_result = hobj->on_event (hobj->ptr, hobj->hflags, events[i].events, 0);
@@ -737,6 +829,16 @@ int cape_aio_context_next (CapeAioContext self, long timeout_in_ms, CapeErr err)
         
         epoll_ctl (self->efd, EPOLL_CTL_MOD, (long)hobj->handle, &(events[i]));
       }
+      
+      // apply the modifications of other threads
+      {
+        int hflags_pending = cape_aio_handle__event_end (hobj);
+        
+        if (hflags_pending)
+        {
+          cape_aio_context_mod (self, hobj, hobj->handle, hflags_pending, 0);
+        }
+      }
     }
   }
   
@@ -754,6 +856,11 @@ exit:
 
 void cape_aio_context_mod (CapeAioContext self, CapeAioHandle aioh, void* handle, int hflags, number_t option)
 {
+  if (cape_aio_handle__defer (aioh, hflags))
+  {
+    return;
+  }
+  
 #if defined __BSD_OS
 
   aioh->hflags = hflags;
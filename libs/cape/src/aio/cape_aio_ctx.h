@@ -53,6 +53,7 @@ __CAPE_LIBEX   int               cape_aio_context_next          (CapeAioContext,
 
 // internal usage
 #define CAPE_AIO__INTERNAL_NO_CHANGE     0x1000
+#define CAPE_AIO__INTERNAL_IN_EVENT      0x2000
 
 //-----------------------------------------------------------------------------
 
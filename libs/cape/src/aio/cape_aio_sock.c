@@ -25,6 +25,12 @@
 #include <signal.h>
 #include <time.h>
 #include <errno.h>
+#include <sys/uio.h>
+
+#if defined __LINUX_OS
+#include <sys/sendfile.h>
+#include <pthread.h>
+#endif
 
 // includes specific event subsystem
 #if defined __BSD_OS
@@ -49,7 +55,7 @@ struct CapeAioSocket_s
 
     CapeAioHandle aioh;
 
-    int mask;
+    int mask;                   // contains CAPE_AIO__INTERNAL_IN_EVENT while the AIO thread handles an event of this socket
 
     // callbacks
 
@@ -69,6 +75,12 @@ struct CapeAioSocket_s
 
     ssize_t send_buftos;
 
+    CapeChunks send_chunks;     // reference, used instead of send_bufdat
+
+    long send_fd;               // reference, file descriptor used instead of send_bufdat (-1 if not set)
+
+    off_t send_fdpos;
+
     void* send_userdata;
 
     // for receive
@@ -96,6 +108,9 @@ CapeAioSocket cape_aio_socket_new (void* handle)
   self->send_bufdat = NULL;
   self->send_buflen = 0;
   self->send_buftos = 0;
+  self->send_chunks = NULL;
+  self->send_fd = -1;
+  self->send_fdpos = 0;
   self->send_userdata = NULL;
 
   // receiving
@@ -205,15 +220,56 @@ void cape_aio_socket_unref (CapeAioSocket self)
 
 //-----------------------------------------------------------------------------
 
+static int cape_aio_socket__mask_update (CapeAioSocket self, int keep, int hflags)
+{
+  // the mask is changed by the AIO thread and by other threads (markSent, close)
+  // -> returns FALSE if the AIO thread doesn't handle an event of this socket, the mask was not changed
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  while (TRUE)
+  {
+    int mask = self->mask;
+
+    if (!(mask & CAPE_AIO__INTERNAL_IN_EVENT))
+    {
+      return FALSE;
+    }
+
+    if (__sync_bool_compare_and_swap (&(self->mask), mask, (mask & keep) | hflags))
+    {
+      return TRUE;
+    }
+  }
+
+#else
+
+  if (!(self->mask & CAPE_AIO__INTERNAL_IN_EVENT))
+  {
+    return FALSE;
+  }
+
+  self->mask = (self->mask & keep) | hflags;
+
+  return TRUE;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_aio_socket_close (CapeAioSocket self, CapeAioContext aio)
 {
   if (self)
   {
-    self->mask = CAPE_AIO_DONE;
-
-    if (self->aioh)
+    // an event of this socket is handled right now (eg. close was called in onSent)
+    // -> the AIO context removes the handle after the event, the socket must stay valid until then
+    if (!cape_aio_socket__mask_update (self, CAPE_AIO__INTERNAL_IN_EVENT, CAPE_AIO_DONE))
     {
-      cape_aio_context_mod (aio, self->aioh, self->handle, CAPE_AIO_DONE, 0);
+      if (self->aioh)
+      {
+        // the AIO context defers it, if the event of this socket is not finished yet
+        cape_aio_context_mod (aio, self->aioh, self->handle, CAPE_AIO_DONE, 0);
+      }
     }
   }
 }
@@ -248,7 +304,7 @@ void cape_aio_socket_read (CapeAioSocket self, long sockfd)
         if( (errno != EWOULDBLOCK) && (errno != EINPROGRESS) && (errno != EAGAIN))
         {
           cape_log_fmt (CAPE_LL_ERROR, "CAPE", "socket read", "error while writing data to the socket [%i]", errno);
-          self->mask |= CAPE_AIO_DONE;
+          cape_aio_socket__mask_update (self, ~0, CAPE_AIO_DONE);
         }
 
         return;
@@ -259,7 +315,7 @@ void cape_aio_socket_read (CapeAioSocket self, long sockfd)
 
         // disable all other read / write / etc mask flags
         //otherwise we will run into a race condition
-        self->mask = CAPE_AIO_DONE;
+        cape_aio_socket__mask_update (self, CAPE_AIO__INTERNAL_IN_EVENT, CAPE_AIO_DONE);
 
         return;
       }
@@ -278,12 +334,125 @@ void cape_aio_socket_read (CapeAioSocket self, long sockfd)
 
 //-----------------------------------------------------------------------------
 
+#define CAPE_AIO_SOCKET_IOV_MAX 64
+
+static ssize_t cape_aio_socket__send_chunks (CapeAioSocket self, long sockfd)
+{
+  CapeChunksSegment segments[CAPE_AIO_SOCKET_IOV_MAX];
+  struct iovec iov[CAPE_AIO_SOCKET_IOV_MAX];
+
+  struct msghdr msg;
+
+  number_t i;
+  number_t cnt = cape_chunks_segments (self->send_chunks, segments, CAPE_AIO_SOCKET_IOV_MAX);
+
+  for (i = 0; i < cnt; i++)
+  {
+    iov[i].iov_base = (void*)segments[i].bufdat;
+    iov[i].iov_len = segments[i].buflen;
+  }
+
+  memset (&msg, 0, sizeof(struct msghdr));
+
+  msg.msg_iov = iov;
+  msg.msg_iovlen = cnt;
+
+  // sendmsg instead of writev to suppress signals
+  return sendmsg (sockfd, &msg, CAPE_NO_SIGNALS);
+}
+
+//-----------------------------------------------------------------------------
+
+static ssize_t cape_aio_socket__send_file (CapeAioSocket self, long sockfd)
+{
+  size_t len = self->send_buflen - self->send_buftos;
+
+#if defined __LINUX_OS
+
+  ssize_t res;
+  int errno_sendfile;
+
+  sigset_t sigpipe_mask;
+  sigset_t sigpipe_old;
+
+  // sendfile has no flag to suppress signals
+  // -> block SIGPIPE for this thread, a closed peer will be seen as EPIPE
+  sigemptyset (&sigpipe_mask);
+  sigaddset (&sigpipe_mask, SIGPIPE);
+
+  pthread_sigmask (SIG_BLOCK, &sigpipe_mask, &sigpipe_old);
+
+  // the kernel copies from the page cache into the socket
+  // -> sendfile moves send_fdpos forward
+  res = sendfile (sockfd, self->send_fd, &(self->send_fdpos), len);
+  errno_sendfile = errno;
+
+  if (!sigismember (&sigpipe_old, SIGPIPE))
+  {
+    sigset_t sigpipe_pending;
+
+    sigpending (&sigpipe_pending);
+
+    if (sigismember (&sigpipe_pending, SIGPIPE))
+    {
+      struct timespec ts = {0, 0};
+
+      // consume the pending signal before unblocking
+      sigtimedwait (&sigpipe_mask, NULL, &ts);
+    }
+  }
+
+  pthread_sigmask (SIG_SETMASK, &sigpipe_old, NULL);
+
+  errno = errno_sendfile;
+  return res;
+
+#else
+
+  char buffer[16384];
+  ssize_t bytes_read;
+  ssize_t bytes_sent;
+
+  if (len > sizeof(buffer))
+  {
+    len = sizeof(buffer);
+  }
+
+  bytes_read = pread (self->send_fd, buffer, len, self->send_fdpos);
+  if (bytes_read <= 0)
+  {
+    return bytes_read;
+  }
+
+  bytes_sent = send (sockfd, buffer, bytes_read, CAPE_NO_SIGNALS);
+  if (bytes_sent > 0)
+  {
+    self->send_fdpos += bytes_sent;
+  }
+
+  return bytes_sent;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_aio_socket__send_reset (CapeAioSocket self)
+{
+  self->send_buflen = 0;
+  self->send_bufdat = NULL;
+  self->send_chunks = NULL;
+  self->send_fd = -1;
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_aio_socket_write (CapeAioSocket self, long sockfd)
 {
     if (self->send_buflen == 0)
     {
       // disable to listen on write events
-      self->mask &= ~CAPE_AIO_WRITE;
+      cape_aio_socket__mask_update (self, ~CAPE_AIO_WRITE, 0);
 
       if (self->onSent)
       {
@@ -293,9 +462,23 @@ void cape_aio_socket_write (CapeAioSocket self, long sockfd)
     }
     else
     {
-      while (self->send_bufdat)
+      while (self->send_bufdat || self->send_chunks || self->send_fd >= 0)
       {
-        ssize_t writtenBytes = send (sockfd, self->send_bufdat + self->send_buftos, self->send_buflen - self->send_buftos, CAPE_NO_SIGNALS);
+        ssize_t writtenBytes;
+
+        if (self->send_chunks)
+        {
+          writtenBytes = cape_aio_socket__send_chunks (self, sockfd);
+        }
+        else if (self->send_fd >= 0)
+        {
+          writtenBytes = cape_aio_socket__send_file (self, sockfd);
+        }
+        else
+        {
+          writtenBytes = send (sockfd, self->send_bufdat + self->send_buftos, self->send_buflen - self->send_buftos, CAPE_NO_SIGNALS);
+        }
+
         if (writtenBytes < 0)
         {
           if( (errno != EWOULDBLOCK) && (errno != EINPROGRESS) && (errno != EAGAIN))
@@ -306,10 +489,13 @@ void cape_aio_socket_write (CapeAioSocket self, long sockfd)
 
             cape_log_fmt (CAPE_LL_ERROR, "CAPE", "socket write", "error while writing data to the socket: %s", cape_err_text(err));
 
-            self->mask |= CAPE_AIO_DONE;
+            cape_aio_socket__mask_update (self, ~0, CAPE_AIO_DONE);
 
             cape_err_del(&err);
 
+            // the buffer is not in the queue anymore, onUnref must not decrease again
+            cape_aio_socket__send_reset (self);
+
             // decrease ref counter (this was increased in send function)
             cape_aio_socket_unref (self);
 
@@ -331,7 +517,10 @@ void cape_aio_socket_write (CapeAioSocket self, long sockfd)
 
           // disable all other read / write / etc mask flags
           // otherwise we will run into a race condition
-          self->mask = CAPE_AIO_DONE;
+          cape_aio_socket__mask_update (self, CAPE_AIO__INTERNAL_IN_EVENT, CAPE_AIO_DONE);
+
+          // the buffer is not in the queue anymore, onUnref must not decrease again
+          cape_aio_socket__send_reset (self);
 
           // decrease ref counter (this was increased in send function)
           cape_aio_socket_unref (self);
@@ -342,14 +531,22 @@ void cape_aio_socket_write (CapeAioSocket self, long sockfd)
         {
           self->send_buftos += writtenBytes;
 
+          if (self->send_chunks)
+          {
+            // release the chunks which were written
+            cape_chunks_shift (self->send_chunks, writtenBytes);
+          }
+
           if (self->send_buftos == self->send_buflen)
           {
             //printf ("BYTES SENT: %lu\n", self->send_buftos);
             
-            self->mask &= ~CAPE_AIO_WRITE;
+            cape_aio_socket__mask_update (self, ~CAPE_AIO_WRITE, 0);
 
             self->send_buflen = 0;
             self->send_bufdat = NULL;
+            self->send_chunks = NULL;
+            self->send_fd = -1;
 
             if (self->onSent)
             {
@@ -381,7 +578,15 @@ static int __STDCALL cape_aio_socket_onEvent (void* ptr, int hflags, unsigned lo
 {
   CapeAioSocket self = ptr;
 
-  self->mask = hflags;
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  __sync_lock_test_and_set (&(self->mask), hflags | CAPE_AIO__INTERNAL_IN_EVENT);
+
+#else
+
+  self->mask = hflags | CAPE_AIO__INTERNAL_IN_EVENT;
+
+#endif
 
   long sock = (long)self->handle;
 
@@ -400,7 +605,7 @@ static int __STDCALL cape_aio_socket_onEvent (void* ptr, int hflags, unsigned lo
 
       cape_err_del (&err);
 
-      self->mask |= CAPE_AIO_DONE;
+      cape_aio_socket__mask_update (self, ~0, CAPE_AIO_DONE);
 
       // we still have a buffer in the queue
       // this means we have called send before and the ref counter was increased
@@ -408,6 +613,9 @@ static int __STDCALL cape_aio_socket_onEvent (void* ptr, int hflags, unsigned lo
       {
         //cape_log_msg (CAPE_LL_TRACE, "CAPE", "aio_sock", "-- UNREF --");
 
+        // the buffer is not in the queue anymore, onUnref must not decrease again
+        cape_aio_socket__send_reset (self);
+
         // decrease ref counter (this was increased in send function)
         cape_aio_socket_unref (self);
       }
@@ -433,13 +641,22 @@ static int __STDCALL cape_aio_socket_onEvent (void* ptr, int hflags, unsigned lo
       }
   }
 
-
   {
-      int ret = self->mask;
+    // takes the mask and leaves the event in one step
+    // -> afterwards other threads use the AIO context, which defers it until the handle was re-armed
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+    int ret = __sync_lock_test_and_set (&(self->mask), 0);
+
+#else
+
+    int ret = self->mask;
+
+    self->mask = 0;
 
-      self->mask = 0;
+#endif
 
-      return ret;
+    return ret & ~CAPE_AIO__INTERNAL_IN_EVENT;
   }
 }
 
@@ -456,6 +673,8 @@ static void __STDCALL cape_aio_socket_onUnref (void* ptr, CapeAioHandle aioh, in
     cape_log_msg (CAPE_LL_TRACE, "CAPE", "aio_sock", "unref buflen");
 
     self->send_buflen = 0;
+    self->send_chunks = NULL;
+    self->send_fd = -1;
 
     // decrease ref counter (this was increased in send function)
     cape_aio_socket_unref (self);
@@ -468,21 +687,23 @@ static void __STDCALL cape_aio_socket_onUnref (void* ptr, CapeAioHandle aioh, in
 
 void cape_aio_socket_markSent (CapeAioSocket self, CapeAioContext aio)
 {
-  if (self->mask == 0)
+  // might be called from any thread while the AIO thread handles an event of this socket
+  // -> the write flag must not get lost when the AIO thread resets the mask
+  if (!cape_aio_socket__mask_update (self, ~0, CAPE_AIO_WRITE))
   {
     if (self->aioh)
     {
       cape_aio_context_mod (aio, self->aioh, self->handle, CAPE_AIO_WRITE | CAPE_AIO_READ, 0);
     }
   }
-  else
-  {
-    self->mask |= CAPE_AIO_WRITE;
-  }
 }
 
 //-----------------------------------------------------------------------------
 
+static void cape_aio_socket__send_activate (CapeAioSocket self, CapeAioContext aio);
+
+//-----------------------------------------------------------------------------
+
 void cape_aio_socket_send (CapeAioSocket self, CapeAioContext aio, const char* bufdata, unsigned long buflen, void* userdata)
 {
   // check if we are ready to send
@@ -512,11 +733,99 @@ void cape_aio_socket_send (CapeAioSocket self, CapeAioContext aio, const char* b
 
   self->send_bufdat = bufdata;
   self->send_buflen = buflen;
+  self->send_chunks = NULL;
+  self->send_fd = -1;
 
   self->send_buftos = 0;
   self->send_userdata = userdata;
 
-  if (self->mask == 0)
+  cape_aio_socket__send_activate (self, aio);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_socket_send_chunks (CapeAioSocket self, CapeAioContext aio, CapeChunks chunks, void* userdata)
+{
+  number_t buflen = cape_chunks_size (chunks);
+
+  // check if we are ready to send
+  if (self->send_buflen)
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "aio_sock", "socket has already a buffer to send");
+    return;
+  }
+
+  // only allow data with a length
+  if (buflen == 0)
+  {
+    if (self->onSent)
+    {
+      // transfer userdata to the ownership beyond the callback
+      self->send_userdata = NULL;
+
+      // userdata can be deleted
+      self->onSent (self->ptr, self, userdata);
+    }
+
+    cape_log_msg (CAPE_LL_WARN, "CAPE", "aio_sock", "can't send chunks with buflen = 0");
+    return;
+  }
+
+  self->send_bufdat = NULL;
+  self->send_buflen = buflen;
+  self->send_chunks = chunks;
+  self->send_fd = -1;
+
+  self->send_buftos = 0;
+  self->send_userdata = userdata;
+
+  cape_aio_socket__send_activate (self, aio);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_socket_send_file (CapeAioSocket self, CapeAioContext aio, void* fd, number_t offset, number_t length, void* userdata)
+{
+  // check if we are ready to send
+  if (self->send_buflen)
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "aio_sock", "socket has already a buffer to send");
+    return;
+  }
+
+  // only allow data with a length
+  if (length == 0)
+  {
+    if (self->onSent)
+    {
+      // transfer userdata to the ownership beyond the callback
+      self->send_userdata = NULL;
+
+      // userdata can be deleted
+      self->onSent (self->ptr, self, userdata);
+    }
+
+    cape_log_msg (CAPE_LL_WARN, "CAPE", "aio_sock", "can't send a file with length = 0");
+    return;
+  }
+
+  self->send_bufdat = NULL;
+  self->send_buflen = length;
+  self->send_chunks = NULL;
+  self->send_fd = (long)fd;
+  self->send_fdpos = offset;
+
+  self->send_buftos = 0;
+  self->send_userdata = userdata;
+
+  cape_aio_socket__send_activate (self, aio);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_aio_socket__send_activate (CapeAioSocket self, CapeAioContext aio)
+{
+  if (!cape_aio_socket__mask_update (self, ~0, CAPE_AIO_WRITE))
   {
     // correct epoll flags for this filedescriptor
     if (self->aioh)
@@ -542,10 +851,6 @@ void cape_aio_socket_send (CapeAioSocket self, CapeAioContext aio, const char* b
       }
     }
   }
-  else
-  {
-    self->mask |= CAPE_AIO_WRITE;
-  }
 
   // increase the refcounter to ensure that the object will nont be deleted during sending cycle
   //cape_log_msg (CAPE_LL_TRACE, "CAPE", "aio_sock", "-- INREF --");
@@ -7,6 +7,7 @@
 #include "sys/cape_err.h"
 #include "aio/cape_aio_ctx.h"
 #include "stc/cape_stream.h"
+#include "stc/cape_chunks.h"
 
 #include <sys/types.h>
 
@@ -74,6 +75,15 @@ __CAPE_LIBEX   void                 cape_aio_socket_callback       (CapeAioSocke
 // WARNING: can only be used in the onSent callback function, to avoid race-conditions
 __CAPE_LIBEX   void                 cape_aio_socket_send           (CapeAioSocket, CapeAioContext, const char* bufdata, unsigned long buflen, void* userdata);   
 
+// WARNING: can only be used in the onSent callback function, to avoid race-conditions
+// sends all segments of the chunks with vectored writes, the chunks are consumed while sending
+__CAPE_LIBEX   void                 cape_aio_socket_send_chunks    (CapeAioSocket, CapeAioContext, CapeChunks chunks, void* userdata);
+
+// WARNING: can only be used in the onSent callback function, to avoid race-conditions
+// sends a part of an opened file (fd from cape_fh_fd) without copying it into user space (sendfile on linux)
+// the file descriptor must stay open until onSent was called
+__CAPE_LIBEX   void                 cape_aio_socket_send_file      (CapeAioSocket, CapeAioContext, void* fd, number_t offset, number_t length, void* userdata);
+
 //=============================================================================
 
 struct CapeAioAccept_s; typedef struct CapeAioAccept_s* CapeAioAccept;
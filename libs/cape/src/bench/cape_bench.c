@@ -0,0 +1,540 @@
+#include "cape_bench.h"
+
+// cape includes
+#include "stc/cape_map.h"
+#include "stc/cape_hash.h"
+#include "stc/cape_list.h"
+#include "stc/cape_stream.h"
+#include "stc/cape_chunks.h"
+
+//-----------------------------------------------------------------------------
+
+#define BENCH_KEYS  10000
+
+static CapeString keys [BENCH_KEYS];
+
+//-----------------------------------------------------------------------------
+
+static void bench_keys_init (void)
+{
+  number_t i;
+
+  // deterministic keys with the length of a chain key
+  for (i = 0; i < BENCH_KEYS; i++)
+  {
+    keys[i] = cape_str_fmt ("%08lX-%04lX-4%03lX-%04lX-%012lX", (i * 2654435761UL) & 0xffffffff, i & 0xffff, (i * 31) & 0xfff, 0x8000 | (i & 0x3fff), i * 40503UL);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void bench_keys_done (void)
+{
+  number_t i;
+
+  for (i = 0; i < BENCH_KEYS; i++)
+  {
+    cape_str_del (&(keys[i]));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc bench_payload_new (number_t rows)
+{
+  CapeUdc ret = cape_udc_new (CAPE_UDC_NODE, NULL);
+  number_t i;
+
+  // rinfo as it is used by the auth module
+  {
+    CapeUdc rinfo = cape_udc_add_node (ret, "rinfo");
+    CapeUdc roles = cape_udc_add_node (rinfo, "roles");
+
+    cape_udc_add_n (rinfo, "userid", 4711);
+    cape_udc_add_n (rinfo, "wpid", 12);
+    cape_udc_add_n (rinfo, "gpid", 3301);
+    cape_udc_add_s_cp (rinfo, "workspace", "main workspace");
+    cape_udc_add_s_cp (rinfo, "remote", "192.168.1.100");
+
+    cape_udc_add_b (roles, "admin", TRUE);
+    cape_udc_add_b (roles, "flow_editor", TRUE);
+    cape_udc_add_b (roles, "jobs_viewer", FALSE);
+  }
+
+  // cdata with a result set
+  {
+    CapeUdc cdata = cape_udc_add_node (ret, "cdata");
+    CapeUdc list = cape_udc_add_list (cdata, "rows");
+
+    for (i = 0; i < rows; i++)
+    {
+      CapeUdc row = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+      cape_udc_add_n (row, "id", i);
+      cape_udc_add_s_cp (row, "name", keys[i % BENCH_KEYS]);
+      cape_udc_add_s_cp (row, "description", "some text with \"quotes\" and unicode \xc3\xa4\xc3\xb6\xc3\xbc");
+      cape_udc_add_n (row, "state", i % 5);
+      cape_udc_add_f (row, "amount", i * 1.25);
+      cape_udc_add_b (row, "active", i % 2);
+      cape_udc_add_s_cp (row, "created", "2023-05-01T12:00:00.000Z");
+
+      cape_udc_add (list, &row);
+    }
+  }
+
+  return ret;
+}
+
+//=============================================================================
+
+static void __STDCALL bench_map_insert (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeMap m = cape_map_new (NULL, NULL, NULL);
+
+  for (i = 0; i < loops; i++)
+  {
+    if (i % BENCH_KEYS == 0)
+    {
+      cape_map_clr (m);
+    }
+
+    cape_map_insert (m, keys[i % BENCH_KEYS], NULL);
+  }
+
+  cape_map_del (&m);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_map_find (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeMap m = cape_map_new (NULL, NULL, NULL);
+
+  for (i = 0; i < BENCH_KEYS; i++)
+  {
+    cape_map_insert (m, keys[i], NULL);
+  }
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    cape_map_find (m, keys[(i * 7) % BENCH_KEYS]);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_map_del (&m);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_map_erase (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeMap m = cape_map_new (NULL, NULL, NULL);
+
+  for (i = 0; i < loops; i++)
+  {
+    if (i % BENCH_KEYS == 0)
+    {
+      number_t j;
+
+      cape_bench_stop (bench);
+
+      for (j = 0; j < BENCH_KEYS; j++)
+      {
+        cape_map_insert (m, keys[j], NULL);
+      }
+
+      cape_bench_start (bench);
+    }
+
+    cape_map_erase (m, cape_map_find (m, keys[i % BENCH_KEYS]));
+  }
+
+  cape_map_del (&m);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_hash_insert (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeHash h = cape_hash_new (NULL, NULL, NULL, NULL);
+
+  for (i = 0; i < loops; i++)
+  {
+    if (i % BENCH_KEYS == 0)
+    {
+      cape_hash_clr (h);
+    }
+
+    cape_hash_insert (h, keys[i % BENCH_KEYS], NULL);
+  }
+
+  cape_hash_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_hash_find (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeHash h = cape_hash_new (NULL, NULL, NULL, NULL);
+
+  for (i = 0; i < BENCH_KEYS; i++)
+  {
+    cape_hash_insert (h, keys[i], NULL);
+  }
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    cape_hash_find (h, keys[(i * 7) % BENCH_KEYS]);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_hash_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_list_push_pop (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeList l = cape_list_new (NULL);
+
+  for (i = 0; i < loops; i++)
+  {
+    cape_list_push_back (l, keys[i % BENCH_KEYS]);
+
+    if (i % 16 == 15)
+    {
+      while (cape_list_size (l))
+      {
+        cape_list_pop_front (l);
+      }
+    }
+  }
+
+  cape_list_del (&l);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_udc_build (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc h = bench_payload_new (10);
+
+    cape_udc_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_udc_lookup (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeUdc h = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  for (i = 0; i < 32; i++)
+  {
+    cape_udc_add_n (h, keys[i], i);
+  }
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    cape_udc_get_n (h, keys[i % 32], 0);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_udc_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_udc_copy (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeUdc h = bench_payload_new (50);
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc c = cape_udc_cp (h);
+
+    cape_udc_del (&c);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_udc_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_udc_share (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeUdc h = bench_payload_new (50);
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc c = cape_udc_share (h);
+
+    cape_udc_del (&c);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_udc_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_json_encode (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeUdc h = bench_payload_new (50);
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeString s = cape_json_to_s (h);
+
+    cape_str_del (&s);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_udc_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_json_decode (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeString s;
+
+  {
+    CapeUdc h = bench_payload_new (50);
+
+    s = cape_json_to_s (h);
+
+    cape_udc_del (&h);
+  }
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeUdc h = cape_json_from_s (s);
+
+    cape_udc_del (&h);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_str_del (&s);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_stream_append (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeStream s = cape_stream_new ();
+
+  for (i = 0; i < loops; i++)
+  {
+    // simulates building a http response
+    cape_stream_append_str (s, "Content-Type: ");
+    cape_stream_append_str (s, "application/json");
+    cape_stream_append_buf (s, "\r\n", 2);
+    cape_stream_append_n (s, i);
+
+    if (i % 10000 == 9999)
+    {
+      cape_stream_clr (s);
+    }
+  }
+
+  cape_stream_del (&s);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_stream_large (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  char buffer [1024];
+
+  memset (buffer, 'x', 1024);
+
+  for (i = 0; i < loops; i++)
+  {
+    // grows the stream up to 1 MB
+    CapeStream s = cape_stream_new ();
+    number_t j;
+
+    for (j = 0; j < 1024; j++)
+    {
+      cape_stream_append_buf (s, buffer, 1024);
+    }
+
+    cape_stream_del (&s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_chunks_large (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  char buffer [1024];
+
+  CapeChunksPool pool = cape_chunks_pool_new (0, 128);
+
+  memset (buffer, 'x', 1024);
+
+  for (i = 0; i < loops; i++)
+  {
+    // same as stream.large, but with chunks from the pool
+    CapeChunks s = cape_chunks_new (pool);
+    number_t j;
+
+    for (j = 0; j < 1024; j++)
+    {
+      cape_chunks_append_buf (s, buffer, 1024);
+    }
+
+    cape_chunks_del (&s);
+  }
+
+  cape_chunks_pool_del (&pool);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_str_uuid (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeString h = cape_str_uuid ();
+
+    cape_str_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_str_fmt (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeString h = cape_str_fmt ("%s/%s?id=%lu", "auth", keys[i % BENCH_KEYS], i);
+
+    cape_str_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_str_lower (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  for (i = 0; i < loops; i++)
+  {
+    // as done for each qbus method name
+    CapeString h = cape_str_cp ("GetUserSessionInformation");
+
+    cape_str_to_lower (h);
+
+    cape_str_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_str_catenate (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeString h = cape_str_catenate_3 ("/var/www/site", "/", keys[i % BENCH_KEYS]);
+
+    cape_str_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res;
+
+  CapeBench bench = cape_bench_new (argc, argv, "cape");
+
+  bench_keys_init ();
+
+  cape_bench_run (bench, "map.insert", 1000000, bench_map_insert);
+  cape_bench_run (bench, "map.find", 1000000, bench_map_find);
+  cape_bench_run (bench, "map.erase", 1000000, bench_map_erase);
+
+  cape_bench_run (bench, "hash.insert", 1000000, bench_hash_insert);
+  cape_bench_run (bench, "hash.find", 1000000, bench_hash_find);
+
+  cape_bench_run (bench, "list.push_pop", 1000000, bench_list_push_pop);
+
+  cape_bench_run (bench, "udc.build", 20000, bench_udc_build);
+  cape_bench_run (bench, "udc.lookup", 1000000, bench_udc_lookup);
+  cape_bench_run (bench, "udc.copy", 5000, bench_udc_copy);
+  cape_bench_run (bench, "udc.share", 1000000, bench_udc_share);
+
+  cape_bench_run (bench, "json.encode", 2000, bench_json_encode);
+  cape_bench_run (bench, "json.decode", 2000, bench_json_decode);
+
+  cape_bench_run (bench, "stream.append", 1000000, bench_stream_append);
+  cape_bench_run (bench, "stream.large", 200, bench_stream_large);
+  cape_bench_run (bench, "chunks.large", 200, bench_chunks_large);
+
+  cape_bench_run (bench, "str.uuid", 1000000, bench_str_uuid);
+  cape_bench_run (bench, "str.fmt", 1000000, bench_str_fmt);
+  cape_bench_run (bench, "str.lower", 1000000, bench_str_lower);
+  cape_bench_run (bench, "str.catenate", 1000000, bench_str_catenate);
+
+  bench_keys_done ();
+
+  res = cape_bench_done (bench);
+
+  cape_bench_del (&bench);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,299 @@
+#ifndef __CAPE_BENCH__H
+#define __CAPE_BENCH__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "sys/cape_err.h"
+#include "sys/cape_time.h"
+#include "stc/cape_str.h"
+#include "stc/cape_udc.h"
+#include "fmt/cape_json.h"
+#include "fmt/cape_args.h"
+
+#include <stdio.h>
+
+//=============================================================================
+
+/* a small harness for micro-benchmarks
+ *
+ * -> each case is run once to warm up and then several times, the median is taken
+ * -> the case function can exclude its setup by calling start / stop
+ * -> the results can be written as JSON and compared against a saved baseline
+ *
+ * arguments:
+ *   --filter <text>      run only cases which contain the text
+ *   --repeat <n>         amount of measured runs per case (default 5)
+ *   --scale <f>          multiplies the loops of all cases (default 1.0)
+ *   --out <file>         write the results as JSON into the file
+ *   --baseline <file>    compare the results with a previous JSON file
+ *   --threshold <pct>    allowed slowdown against the baseline (default 10)
+ *
+ * remarks: this file is header only, so that benchmarks of other libraries
+ *          can use the same harness and output format
+ */
+
+//=============================================================================
+
+struct CapeBench_s
+{
+  CapeUdc args;
+  CapeUdc results;
+
+  CapeStopTimer timer;
+  int timer_running;
+
+  number_t repeat;
+  double scale;
+  double threshold;
+
+  const CapeString filter;
+
+}; typedef struct CapeBench_s* CapeBench;
+
+typedef void (__STDCALL *fct_cape_bench__on_run) (CapeBench, number_t loops);
+
+//-----------------------------------------------------------------------------
+
+static CapeBench cape_bench_new (int argc, char *argv[], const CapeString name)
+{
+  CapeBench self = CAPE_NEW (struct CapeBench_s);
+
+  self->args = cape_args_from_args (argc, argv, NULL);
+
+  self->results = cape_udc_new (CAPE_UDC_NODE, NULL);
+  cape_udc_add_s_cp (self->results, "suite", name);
+  cape_udc_add_list (self->results, "results");
+
+  self->timer = cape_stoptimer_new ();
+  self->timer_running = FALSE;
+
+  self->repeat = cape_str_to_n (cape_udc_get_s (self->args, "repeat", "5"));
+  self->scale = cape_str_to_f (cape_udc_get_s (self->args, "scale", "1.0"));
+  self->threshold = cape_str_to_f (cape_udc_get_s (self->args, "threshold", "10"));
+  self->filter = cape_udc_get_s (self->args, "filter", NULL);
+
+  if (self->repeat < 1)
+  {
+    self->repeat = 1;
+  }
+
+  if (self->scale <= 0)
+  {
+    self->scale = 1.0;
+  }
+
+  // fixed seed for reproducible data
+  srand (42);
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_bench_del (CapeBench* p_self)
+{
+  if (*p_self)
+  {
+    CapeBench self = *p_self;
+
+    cape_stoptimer_del (&(self->timer));
+
+    cape_udc_del (&(self->results));
+    cape_udc_del (&(self->args));
+
+    CAPE_DEL (p_self, struct CapeBench_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_bench_start (CapeBench self)
+{
+  cape_stoptimer_start (self->timer);
+  self->timer_running = TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_bench_stop (CapeBench self)
+{
+  if (self->timer_running)
+  {
+    cape_stoptimer_stop (self->timer);
+    self->timer_running = FALSE;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL cape_bench__on_cmp_double (const void* a, const void* b)
+{
+  double da = *(const double*)a;
+  double db = *(const double*)b;
+
+  return (da > db) - (da < db);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_bench_run (CapeBench self, const CapeString name, number_t loops, fct_cape_bench__on_run on_run)
+{
+  number_t i;
+  number_t pos;
+  double* samples;
+
+  if (self->filter && !cape_str_find (name, self->filter, &pos))
+  {
+    return;
+  }
+
+  loops = (number_t)(loops * self->scale);
+  if (loops < 1)
+  {
+    loops = 1;
+  }
+
+  // warm up caches and allocator
+  on_run (self, loops / 10 + 1);
+  cape_bench_stop (self);
+
+  samples = CAPE_ALLOC (self->repeat * sizeof(double));
+
+  for (i = 0; i < self->repeat; i++)
+  {
+    cape_stoptimer_set (self->timer, .0);
+
+    // the case might call start by itself to exclude the setup
+    cape_bench_start (self);
+
+    on_run (self, loops);
+
+    cape_bench_stop (self);
+
+    // convert milliseconds into nanoseconds per operation
+    samples[i] = cape_stoptimer_get (self->timer) * 1000000.0 / loops;
+  }
+
+  qsort (samples, self->repeat, sizeof(double), cape_bench__on_cmp_double);
+
+  {
+    CapeUdc result = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    double median = samples[self->repeat / 2];
+
+    cape_udc_add_s_cp (result, "name", name);
+    cape_udc_add_n (result, "loops", loops);
+    cape_udc_add_n (result, "repeat", self->repeat);
+    cape_udc_add_f (result, "ns_op", median);
+    cape_udc_add_f (result, "ns_op_min", samples[0]);
+    cape_udc_add_f (result, "ops_s", median > 0 ? 1000000000.0 / median : 0);
+
+    printf ("%-32s %12lu loops %14.2f ns/op %14.2f ns/op (min)\n", name, loops, median, samples[0]);
+
+    cape_udc_add (cape_udc_get (self->results, "results"), &result);
+  }
+
+  CAPE_FREE (samples);
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_bench__compare (CapeBench self, const CapeString baseline_file)
+{
+  int ret = 0;
+
+  // local objects
+  CapeErr err = cape_err_new ();
+  CapeUdc baseline = cape_json_from_file (baseline_file, err);
+
+  if (baseline == NULL)
+  {
+    printf ("can't read baseline '%s': %s\n", baseline_file, cape_err_text (err));
+
+    ret = 2;
+    goto exit_and_cleanup;
+  }
+
+  printf ("\ncompare with baseline '%s' (threshold %.1f%%)\n", baseline_file, self->threshold);
+
+  {
+    CapeUdc baseline_results = cape_udc_get (baseline, "results");
+
+    CapeUdcCursor* cursor = cape_udc_cursor_new (cape_udc_get (self->results, "results"), CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      const CapeString name = cape_udc_get_s (cursor->item, "name", NULL);
+      double ns_op = cape_udc_get_f (cursor->item, "ns_op", 0);
+
+      CapeUdc base = baseline_results ? cape_udc_find_s (baseline_results, "name", name) : NULL;
+
+      if (base)
+      {
+        double base_ns_op = cape_udc_get_f (base, "ns_op", 0);
+        double delta = base_ns_op > 0 ? (ns_op - base_ns_op) * 100.0 / base_ns_op : 0;
+
+        int regression = delta > self->threshold;
+
+        cape_udc_add_f (cursor->item, "baseline_ns_op", base_ns_op);
+        cape_udc_add_f (cursor->item, "delta_pct", delta);
+        cape_udc_add_b (cursor->item, "regression", regression);
+
+        printf ("%-32s %14.2f -> %14.2f ns/op %+8.1f%% %s\n", name, base_ns_op, ns_op, delta, regression ? "REGRESSION" : "");
+
+        if (regression)
+        {
+          ret = 1;
+        }
+      }
+      else
+      {
+        printf ("%-32s not in baseline\n", name);
+      }
+    }
+
+    cape_udc_cursor_del (&cursor);
+  }
+
+exit_and_cleanup:
+
+  cape_udc_del (&baseline);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+                                 /* returns the exit code: 0 = ok, 1 = regression, 2 = error */
+static int cape_bench_done (CapeBench self)
+{
+  int ret = 0;
+
+  const CapeString baseline_file = cape_udc_get_s (self->args, "baseline", NULL);
+  const CapeString out_file = cape_udc_get_s (self->args, "out", NULL);
+
+  if (baseline_file)
+  {
+    ret = cape_bench__compare (self, baseline_file);
+  }
+
+  if (out_file)
+  {
+    CapeErr err = cape_err_new ();
+
+    if (cape_json_to_file (out_file, self->results, TRUE, err))
+    {
+      printf ("can't write results '%s': %s\n", out_file, cape_err_text (err));
+      ret = 2;
+    }
+
+    cape_err_del (&err);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+#endif
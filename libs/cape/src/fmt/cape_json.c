@@ -477,7 +477,7 @@ void cape_json_fill (CapeStream stream, const CapeUdc node, number_t max_bytes,
   {
     case CAPE_UDC_LIST:
     {
-      CapeUdcCursor* cursor = cape_udc_cursor_new (node, CAPE_DIRECTION_FORW);
+      CapeUdcCursor* cursor = cape_udc_cursor_new_r (node, CAPE_DIRECTION_FORW);
       
       cape_stream_append_c (stream, '[');
 
@@ -521,7 +521,7 @@ void cape_json_fill (CapeStream stream, const CapeUdc node, number_t max_bytes,
     }
     case CAPE_UDC_NODE:
     {
-      CapeUdcCursor* cursor = cape_udc_cursor_new (node, CAPE_DIRECTION_FORW);
+      CapeUdcCursor* cursor = cape_udc_cursor_new_r (node, CAPE_DIRECTION_FORW);
             
       cape_stream_append_c (stream, '{');
       
@@ -673,7 +673,7 @@ void cape_json_fill__strict (CapeStream stream, const CapeUdc node, const CapeSt
       cape_json_fill__strict_name (stream, name, comma);
 
       {
-        CapeUdcCursor* cursor = cape_udc_cursor_new (node, CAPE_DIRECTION_FORW);
+        CapeUdcCursor* cursor = cape_udc_cursor_new_r (node, CAPE_DIRECTION_FORW);
         
         cape_stream_append_c (stream, '[');
 
@@ -694,7 +694,7 @@ void cape_json_fill__strict (CapeStream stream, const CapeUdc node, const CapeSt
       cape_json_fill__strict_name (stream, name, comma);
       
       {
-        CapeUdcCursor* cursor = cape_udc_cursor_new (node, CAPE_DIRECTION_FORW);
+        CapeUdcCursor* cursor = cape_udc_cursor_new_r (node, CAPE_DIRECTION_FORW);
               
         cape_stream_append_c (stream, '{');
         
@@ -891,6 +891,20 @@ CapeStream cape_json_to_stream (const CapeUdc source)
 
 //-----------------------------------------------------------------------------
 
+void cape_json_append (CapeStream stream, const CapeUdc source)
+{
+  if (source)
+  {
+    cape_json_fill (stream, source, 0, NULL, FALSE, 0);
+  }
+  else
+  {
+    cape_stream_append_str (stream, "NULL");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 int __STDCALL cape_json_from_file__on_load (void* ptr, const char* bufdat, number_t buflen, CapeErr err)
 {
   int res = cape_parser_json_process (ptr, bufdat, buflen, err);
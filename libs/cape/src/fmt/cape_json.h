@@ -26,6 +26,9 @@ __CAPE_LIBEX   CapeString        cape_json_to_s_max         (const CapeUdc sourc
 
 __CAPE_LIBEX   CapeStream        cape_json_to_stream        (const CapeUdc source);
 
+                                 /* appends the json text of source to an existing stream */
+__CAPE_LIBEX   void              cape_json_append           (CapeStream, const CapeUdc source);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   CapeUdc           cape_json_from_file        (const CapeString file, CapeErr err);
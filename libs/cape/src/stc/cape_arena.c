@@ -0,0 +1,198 @@
+#include "cape_arena.h"
+
+// c includes
+#include <string.h>
+
+#define CAPE_ARENA_DEFAULT_SIZE 4096
+#define CAPE_ARENA_ALIGN 16
+
+//-----------------------------------------------------------------------------
+
+struct CapeArenaBlock_s
+{
+  struct CapeArenaBlock_s* next;
+
+  number_t size;       // usable bytes of the block
+  number_t used;
+
+  // the data follows the struct
+};
+
+typedef struct CapeArenaBlock_s* CapeArenaBlock;
+
+// keep the data of each block aligned
+#define CAPE_ARENA_HEAD ((sizeof(struct CapeArenaBlock_s) + CAPE_ARENA_ALIGN - 1) & ~(CAPE_ARENA_ALIGN - 1))
+
+#define CAPE_ARENA_DATA(block) ((char*)(block) + CAPE_ARENA_HEAD)
+
+//-----------------------------------------------------------------------------
+
+struct CapeArena_s
+{
+  number_t block_size;
+
+  CapeArenaBlock first;      // the current block, the others follow
+  CapeArenaBlock keep;       // will not be released by clr
+
+  number_t size;
+};
+
+//-----------------------------------------------------------------------------
+
+static CapeArenaBlock cape_arena__block_new (number_t size)
+{
+  CapeArenaBlock block = CAPE_ALLOC (CAPE_ARENA_HEAD + size);
+
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+
+  return block;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeArena cape_arena_new (number_t block_size)
+{
+  CapeArena self = CAPE_NEW (struct CapeArena_s);
+
+  self->block_size = block_size ? block_size : CAPE_ARENA_DEFAULT_SIZE;
+
+  // the first block is created on demand
+  self->first = NULL;
+  self->keep = NULL;
+
+  self->size = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_arena_del (CapeArena* p_self)
+{
+  if (*p_self)
+  {
+    CapeArena self = *p_self;
+
+    cape_arena_clr (self);
+
+    if (self->keep)
+    {
+      CAPE_FREE (self->keep);
+    }
+
+    CAPE_DEL (p_self, struct CapeArena_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_arena_clr (CapeArena self)
+{
+  while (self->first)
+  {
+    CapeArenaBlock block = self->first;
+
+    self->first = block->next;
+
+    if (block != self->keep)
+    {
+      CAPE_FREE (block);
+    }
+  }
+
+  if (self->keep)
+  {
+    self->keep->next = NULL;
+    self->keep->used = 0;
+
+    self->first = self->keep;
+    self->size = self->keep->size;
+  }
+  else
+  {
+    self->size = 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_arena_alloc (CapeArena self, number_t size)
+{
+  CapeArenaBlock block;
+
+  // round up to keep the next allocation aligned
+  size = (size + CAPE_ARENA_ALIGN - 1) & ~(CAPE_ARENA_ALIGN - 1);
+
+  if (size > self->block_size / 4)
+  {
+    // large allocation, use an extra block behind the current one
+    block = cape_arena__block_new (size);
+
+    if (self->first)
+    {
+      block->next = self->first->next;
+      self->first->next = block;
+    }
+    else
+    {
+      self->first = block;
+    }
+
+    block->used = size;
+    self->size += size;
+
+    return CAPE_ARENA_DATA (block);
+  }
+
+  block = self->first;
+
+  if (block == NULL || block->size - block->used < size)
+  {
+    block = cape_arena__block_new (self->block_size);
+
+    if (self->keep == NULL)
+    {
+      self->keep = block;
+    }
+
+    block->next = self->first;
+    self->first = block;
+
+    self->size += block->size;
+  }
+
+  {
+    char* ret = CAPE_ARENA_DATA (block) + block->used;
+
+    block->used += size;
+
+    return ret;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+char* cape_arena_sub (CapeArena self, const char* bufdat, number_t buflen)
+{
+  char* ret = cape_arena_alloc (self, buflen + 1);
+
+  if (buflen)
+  {
+    memcpy (ret, bufdat, buflen);
+  }
+
+  ret[buflen] = '\0';
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_arena_size (CapeArena self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
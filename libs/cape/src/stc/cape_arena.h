@@ -0,0 +1,45 @@
+#ifndef __CAPE_STC__ARENA__H
+#define __CAPE_STC__ARENA__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* arena for many small allocations with the same lifetime
+ *
+ * -> memory is taken from blocks, single allocations can't be released
+ * -> cape_arena_clr releases all allocations at once and keeps the
+ *    first block for reuse, so an arena which is cleared after each
+ *    message doesn't call malloc in the common case
+ * -> allocations larger than a quarter of the block size get their own block
+ */
+
+//-----------------------------------------------------------------------------
+
+struct CapeArena_s; typedef struct CapeArena_s* CapeArena;
+
+//-----------------------------------------------------------------------------
+
+                                 /* block_size = 0 -> default size of 4k */
+__CAPE_LIBEX CapeArena         cape_arena_new (number_t block_size);
+
+__CAPE_LIBEX void              cape_arena_del (CapeArena*);
+
+                                 /* releases all allocations, the first block is kept */
+__CAPE_LIBEX void              cape_arena_clr (CapeArena);
+
+//-----------------------------------------------------------------------------
+
+                                 /* returns memory aligned for any basic type, valid until the arena is cleared */
+__CAPE_LIBEX void*             cape_arena_alloc (CapeArena, number_t size);
+
+                                 /* returns a terminated copy of the buffer, valid until the arena is cleared */
+__CAPE_LIBEX char*             cape_arena_sub (CapeArena, const char* bufdat, number_t buflen);
+
+                                 /* amount of bytes used by all blocks */
+__CAPE_LIBEX number_t          cape_arena_size (CapeArena);
+
+//-----------------------------------------------------------------------------
+
+#endif
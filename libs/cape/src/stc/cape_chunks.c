@@ -0,0 +1,423 @@
+#include "cape_chunks.h"
+
+// cape includes
+#include "sys/cape_mutex.h"
+
+// c includes
+#include <string.h>
+#include <stdio.h>
+
+#define CAPE_CHUNKS_DEFAULT_SIZE 16384
+
+//-----------------------------------------------------------------------------
+
+struct CapeChunk_s
+{
+  struct CapeChunk_s* next;
+
+  number_t start;      // first byte which was not shifted
+  number_t end;        // first free byte
+
+  // the data follows the struct
+};
+
+typedef struct CapeChunk_s* CapeChunk;
+
+#define CAPE_CHUNK_DATA(chunk) ((char*)((chunk) + 1))
+
+//-----------------------------------------------------------------------------
+
+struct CapeChunksPool_s
+{
+  CapeMutex mutex;
+
+  number_t chunk_size;
+  number_t max_free;
+
+  CapeChunk free_list;
+  number_t free_cnt;
+};
+
+//-----------------------------------------------------------------------------
+
+CapeChunksPool cape_chunks_pool_new (number_t chunk_size, number_t max_free)
+{
+  CapeChunksPool self = CAPE_NEW (struct CapeChunksPool_s);
+
+  self->mutex = cape_mutex_new ();
+
+  self->chunk_size = chunk_size ? chunk_size : CAPE_CHUNKS_DEFAULT_SIZE;
+  self->max_free = max_free;
+
+  self->free_list = NULL;
+  self->free_cnt = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_pool_del (CapeChunksPool* p_self)
+{
+  if (*p_self)
+  {
+    CapeChunksPool self = *p_self;
+
+    while (self->free_list)
+    {
+      CapeChunk chunk = self->free_list;
+
+      self->free_list = chunk->next;
+
+      CAPE_FREE (chunk);
+    }
+
+    cape_mutex_del (&(self->mutex));
+
+    CAPE_DEL (p_self, struct CapeChunksPool_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeChunk cape_chunks_pool__get (CapeChunksPool self)
+{
+  CapeChunk ret = NULL;
+
+  cape_mutex_lock (self->mutex);
+
+  if (self->free_list)
+  {
+    ret = self->free_list;
+
+    self->free_list = ret->next;
+    self->free_cnt--;
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  if (ret == NULL)
+  {
+    ret = CAPE_ALLOC (sizeof(struct CapeChunk_s) + self->chunk_size);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_chunks_pool__put (CapeChunksPool self, CapeChunk chunk)
+{
+  cape_mutex_lock (self->mutex);
+
+  if (self->free_cnt < self->max_free)
+  {
+    chunk->next = self->free_list;
+
+    self->free_list = chunk;
+    self->free_cnt++;
+
+    chunk = NULL;
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  if (chunk)
+  {
+    CAPE_FREE (chunk);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+struct CapeChunks_s
+{
+  CapeChunksPool pool;       // reference
+
+  number_t chunk_size;
+
+  CapeChunk first;
+  CapeChunk last;
+
+  number_t size;
+};
+
+//-----------------------------------------------------------------------------
+
+CapeChunks cape_chunks_new (CapeChunksPool pool)
+{
+  CapeChunks self = CAPE_NEW (struct CapeChunks_s);
+
+  self->pool = pool;
+  self->chunk_size = pool ? pool->chunk_size : CAPE_CHUNKS_DEFAULT_SIZE;
+
+  self->first = NULL;
+  self->last = NULL;
+
+  self->size = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_del (CapeChunks* p_self)
+{
+  if (*p_self)
+  {
+    CapeChunks self = *p_self;
+
+    cape_chunks_clr (self);
+
+    CAPE_DEL (p_self, struct CapeChunks_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeChunk cape_chunks__chunk_new (CapeChunks self)
+{
+  CapeChunk chunk = self->pool ? cape_chunks_pool__get (self->pool) : CAPE_ALLOC (sizeof(struct CapeChunk_s) + self->chunk_size);
+
+  chunk->next = NULL;
+  chunk->start = 0;
+  chunk->end = 0;
+
+  if (self->last)
+  {
+    self->last->next = chunk;
+  }
+  else
+  {
+    self->first = chunk;
+  }
+
+  self->last = chunk;
+
+  return chunk;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_chunks__chunk_del (CapeChunks self, CapeChunk chunk)
+{
+  if (self->pool)
+  {
+    cape_chunks_pool__put (self->pool, chunk);
+  }
+  else
+  {
+    CAPE_FREE (chunk);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_clr (CapeChunks self)
+{
+  while (self->first)
+  {
+    CapeChunk chunk = self->first;
+
+    self->first = chunk->next;
+
+    cape_chunks__chunk_del (self, chunk);
+  }
+
+  self->last = NULL;
+  self->size = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_chunks_size (CapeChunks self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
+
+char* cape_chunks_pos (CapeChunks self, number_t* p_free_bytes)
+{
+  CapeChunk chunk = self->last;
+
+  if (chunk == NULL || chunk->end == self->chunk_size)
+  {
+    chunk = cape_chunks__chunk_new (self);
+  }
+
+  *p_free_bytes = self->chunk_size - chunk->end;
+
+  return CAPE_CHUNK_DATA (chunk) + chunk->end;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_set (CapeChunks self, number_t bytes_appended)
+{
+  if (self->last)
+  {
+    self->last->end += bytes_appended;
+    self->size += bytes_appended;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_chunks_append_buf (CapeChunks self, const char* bufdat, number_t buflen)
+{
+  number_t bytes_left = buflen;
+
+  while (bytes_left > 0)
+  {
+    number_t free_bytes;
+
+    char* pos = cape_chunks_pos (self, &free_bytes);
+
+    if (free_bytes > bytes_left)
+    {
+      free_bytes = bytes_left;
+    }
+
+    memcpy (pos, bufdat, free_bytes);
+
+    cape_chunks_set (self, free_bytes);
+
+    bufdat += free_bytes;
+    bytes_left -= free_bytes;
+  }
+
+  return buflen;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_append_str (CapeChunks self, const char* s)
+{
+  if (s)
+  {
+    cape_chunks_append_buf (self, s, strlen (s));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_append_c (CapeChunks self, char c)
+{
+  number_t free_bytes;
+
+  char* pos = cape_chunks_pos (self, &free_bytes);
+
+  *pos = c;
+
+  cape_chunks_set (self, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_append_n (CapeChunks self, number_t val)
+{
+  char buffer[26];
+
+#ifdef _MSC_VER
+
+  number_t len = _snprintf_s (buffer, 24, _TRUNCATE, "%Iu", val);
+
+#else
+
+  number_t len = snprintf (buffer, 24, "%li", val);
+
+#endif
+
+  cape_chunks_append_buf (self, buffer, len);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_append_stream (CapeChunks self, CapeStream stream)
+{
+  cape_chunks_append_buf (self, cape_stream_data (stream), cape_stream_size (stream));
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_chunks_segments (CapeChunks self, CapeChunksSegment* segments, number_t max_segments)
+{
+  number_t ret = 0;
+
+  CapeChunk chunk = self->first;
+
+  while (chunk && ret < max_segments)
+  {
+    if (chunk->end > chunk->start)
+    {
+      segments[ret].bufdat = CAPE_CHUNK_DATA (chunk) + chunk->start;
+      segments[ret].buflen = chunk->end - chunk->start;
+
+      ret++;
+    }
+
+    chunk = chunk->next;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_chunks_shift (CapeChunks self, number_t bytes)
+{
+  if (bytes > self->size)
+  {
+    bytes = self->size;
+  }
+
+  self->size -= bytes;
+
+  while (bytes > 0 && self->first)
+  {
+    CapeChunk chunk = self->first;
+
+    number_t len = chunk->end - chunk->start;
+
+    if (bytes < len)
+    {
+      chunk->start += bytes;
+      break;
+    }
+
+    bytes -= len;
+
+    // the chunk was consumed completely
+    self->first = chunk->next;
+
+    if (self->first == NULL)
+    {
+      self->last = NULL;
+    }
+
+    cape_chunks__chunk_del (self, chunk);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeStream cape_chunks_to_stream (CapeChunks self)
+{
+  CapeStream ret = cape_stream_new ();
+
+  CapeChunk chunk = self->first;
+
+  cape_stream_cap (ret, self->size);
+
+  while (chunk)
+  {
+    cape_stream_append_buf (ret, CAPE_CHUNK_DATA (chunk) + chunk->start, chunk->end - chunk->start);
+
+    chunk = chunk->next;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
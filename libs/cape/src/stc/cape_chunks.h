@@ -0,0 +1,84 @@
+#ifndef __CAPE_STC__CHUNKS__H
+#define __CAPE_STC__CHUNKS__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_stream.h"
+
+//=============================================================================
+
+/* segmented stream: the content is stored in a chain of fixed-size chunks
+ *
+ * -> appending never moves existing bytes, a full chunk is followed by a new one
+ * -> the chunks can be handed over to vectored writes (see cape_aio_socket_send_chunks)
+ * -> a contiguous copy is only created by cape_chunks_to_stream
+ * -> the chunks can be taken from a pool, which keeps released chunks for reuse
+ */
+
+//=============================================================================
+
+struct CapeChunksPool_s; typedef struct CapeChunksPool_s* CapeChunksPool;
+
+//-----------------------------------------------------------------------------
+
+                                 /* chunk_size = 0 -> default size of 16k, max_free = amount of chunks kept for reuse */
+__CAPE_LIBEX CapeChunksPool    cape_chunks_pool_new (number_t chunk_size, number_t max_free);
+
+__CAPE_LIBEX void              cape_chunks_pool_del (CapeChunksPool*);
+
+//=============================================================================
+
+struct CapeChunks_s; typedef struct CapeChunks_s* CapeChunks;
+
+typedef struct
+{
+  const char* bufdat;
+  number_t buflen;
+
+} CapeChunksSegment;
+
+//-----------------------------------------------------------------------------
+
+                                 /* pool can be NULL, then chunks of the default size are allocated */
+__CAPE_LIBEX CapeChunks        cape_chunks_new (CapeChunksPool pool);
+
+__CAPE_LIBEX void              cape_chunks_del (CapeChunks*);
+
+__CAPE_LIBEX void              cape_chunks_clr (CapeChunks);
+
+__CAPE_LIBEX number_t          cape_chunks_size (CapeChunks);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX number_t          cape_chunks_append_buf (CapeChunks, const char*, number_t size);
+
+__CAPE_LIBEX void              cape_chunks_append_str (CapeChunks, const char*);
+
+__CAPE_LIBEX void              cape_chunks_append_c (CapeChunks, char);
+
+__CAPE_LIBEX void              cape_chunks_append_n (CapeChunks, number_t);
+
+__CAPE_LIBEX void              cape_chunks_append_stream (CapeChunks, CapeStream);
+
+//-----------------------------------------------------------------------------
+
+                                 /* returns the free space of the last chunk, use it to write directly into the chunk */
+__CAPE_LIBEX char*             cape_chunks_pos (CapeChunks, number_t* p_free_bytes);
+
+                                 /* confirms the bytes written into the position from cape_chunks_pos */
+__CAPE_LIBEX void              cape_chunks_set (CapeChunks, number_t bytes_appended);
+
+//-----------------------------------------------------------------------------
+
+                                 /* fills the array with the segments of the content, returns the amount of used entries */
+__CAPE_LIBEX number_t          cape_chunks_segments (CapeChunks, CapeChunksSegment* segments, number_t max_segments);
+
+                                 /* removes bytes from the beginning, eg. after they were written */
+__CAPE_LIBEX void              cape_chunks_shift (CapeChunks, number_t bytes);
+
+                                 /* creates a contiguous copy of the content */
+__CAPE_LIBEX CapeStream        cape_chunks_to_stream (CapeChunks);
+
+//-----------------------------------------------------------------------------
+
+#endif
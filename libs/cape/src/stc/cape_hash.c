@@ -0,0 +1,602 @@
+#include "cape_hash.h"
+
+// cape includes
+#include "sys/cape_types.h"
+#include "sys/cape_log.h"
+#include "sys/cape_mutex.h"
+#include "stc/cape_str.h"
+
+// c includes
+#include <string.h>
+#include <ctype.h>
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_HASH_SLOT__EMPTY      0
+#define CAPE_HASH_SLOT__USED       1
+#define CAPE_HASH_SLOT__DELETED    2
+
+#define CAPE_HASH_MIN_CAPACITY    16
+
+#define CAPE_HASH_FNV_OFFSET      14695981039346656037ULL
+#define CAPE_HASH_FNV_PRIME       1099511628211ULL
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 __STDCALL cape_hash__hash__s (const void* key, void* ptr)
+{
+  const unsigned char* s = key;
+  cape_uint64 h = CAPE_HASH_FNV_OFFSET;
+
+  for (; *s; s++)
+  {
+    h ^= *s;
+    h *= CAPE_HASH_FNV_PRIME;
+  }
+
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 __STDCALL cape_hash__hash__s_i (const void* key, void* ptr)
+{
+  const unsigned char* s = key;
+  cape_uint64 h = CAPE_HASH_FNV_OFFSET;
+
+  for (; *s; s++)
+  {
+    h ^= tolower (*s);
+    h *= CAPE_HASH_FNV_PRIME;
+  }
+
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 __STDCALL cape_hash__hash__n (const void* key, void* ptr)
+{
+  // use the splitmix64 finalizer to distribute sequential numbers
+  cape_uint64 h = (cape_uint64)(number_t)key;
+
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 cape_hash__buf (const char* bufdat, number_t buflen)
+{
+  const unsigned char* s = (const unsigned char*)bufdat;
+  cape_uint64 h = CAPE_HASH_FNV_OFFSET;
+  number_t i;
+
+  for (i = 0; i < buflen; i++)
+  {
+    h ^= s[i];
+    h *= CAPE_HASH_FNV_PRIME;
+  }
+
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL cape_hash__compare__s (const void* a, const void* b, void* ptr)
+{
+  return strcmp (a, b);
+}
+
+//-----------------------------------------------------------------------------
+
+int __STDCALL cape_hash__compare__s_i (const void* a, const void* b, void* ptr)
+{
+  return cape_str_compare_c (a, b);
+}
+
+//=============================================================================
+
+struct CapeHashNode_s
+{
+  cape_uint64 hash;          // the cached hash of the key
+
+  void* key;
+  void* val;
+
+  int state;                 // empty, used or deleted
+};
+
+//-----------------------------------------------------------------------------
+
+void* cape_hash_node_value (CapeHashNode self)
+{
+  return self->val;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_hash_node_key (CapeHashNode self)
+{
+  return self->key;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_node_set (CapeHashNode self, void* val)
+{
+  self->val = val;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_hash_node_mv (CapeHashNode self)
+{
+  void* ret = self->val;
+  self->val = NULL;
+
+  return ret;
+}
+
+//=============================================================================
+
+struct CapeHash_s
+{
+  CapeHashNode slots;
+
+  number_t capacity;         // always a power of two
+  number_t size;             // used slots
+  number_t used;             // used and deleted slots
+
+  fct_cape_hash_hash hash_fct;
+  fct_cape_hash_cmp cmp_fct;
+  fct_cape_hash_destroy del_fct;
+
+  void* ptr;
+};
+
+//-----------------------------------------------------------------------------
+
+CapeHash cape_hash_new (fct_cape_hash_hash on_hash, fct_cape_hash_cmp on_cmp, fct_cape_hash_destroy on_del, void* ptr)
+{
+  CapeHash self = CAPE_NEW (struct CapeHash_s);
+
+  self->capacity = CAPE_HASH_MIN_CAPACITY;
+  self->slots = CAPE_ALLOC (self->capacity * sizeof(struct CapeHashNode_s));
+
+  self->size = 0;
+  self->used = 0;
+
+  self->hash_fct = on_hash ? on_hash : cape_hash__hash__s;
+  self->cmp_fct = on_cmp ? on_cmp : cape_hash__compare__s;
+  self->del_fct = on_del;
+
+  self->ptr = ptr;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_del (CapeHash* p_self)
+{
+  if (*p_self)
+  {
+    CapeHash self = *p_self;
+
+    cape_hash_clr (self);
+
+    CAPE_FREE (self->slots);
+
+    CAPE_DEL (p_self, struct CapeHash_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_clr (CapeHash self)
+{
+  number_t i;
+
+  if (self->del_fct)
+  {
+    for (i = 0; i < self->capacity; i++)
+    {
+      CapeHashNode n = self->slots + i;
+
+      if (n->state == CAPE_HASH_SLOT__USED)
+      {
+        self->del_fct (n->key, n->val);
+      }
+    }
+  }
+
+  memset (self->slots, 0, self->capacity * sizeof(struct CapeHashNode_s));
+
+  self->size = 0;
+  self->used = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_hash__rehash (CapeHash self, number_t capacity)
+{
+  number_t i;
+
+  CapeHashNode slots_old = self->slots;
+  number_t capacity_old = self->capacity;
+
+  self->slots = CAPE_ALLOC (capacity * sizeof(struct CapeHashNode_s));
+  self->capacity = capacity;
+
+  // deleted slots are not taken over
+  self->used = self->size;
+
+  for (i = 0; i < capacity_old; i++)
+  {
+    CapeHashNode n = slots_old + i;
+
+    if (n->state == CAPE_HASH_SLOT__USED)
+    {
+      // the cached hash avoids calling the hash function again
+      number_t pos = (number_t)(n->hash & (cape_uint64)(capacity - 1));
+
+      while (self->slots[pos].state != CAPE_HASH_SLOT__EMPTY)
+      {
+        pos = (pos + 1) & (capacity - 1);
+      }
+
+      self->slots[pos] = *n;
+    }
+  }
+
+  CAPE_FREE (slots_old);
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t cape_hash__capacity (number_t size)
+{
+  number_t capacity = CAPE_HASH_MIN_CAPACITY;
+
+  // keep the load factor below 0.7
+  while (capacity * 7 < size * 10)
+  {
+    capacity <<= 1;
+  }
+
+  return capacity;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_reserve (CapeHash self, number_t size)
+{
+  number_t capacity = cape_hash__capacity (size);
+
+  if (capacity > self->capacity)
+  {
+    cape_hash__rehash (self, capacity);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeHashNode cape_hash__insert (CapeHash self, void* key, void* val, cape_uint64 hash)
+{
+  CapeHashNode first_deleted = NULL;
+  number_t pos;
+
+  if ((self->used + 1) * 10 > self->capacity * 7)
+  {
+    // if there are many deleted slots, a rehash with the same capacity is enough
+    cape_hash__rehash (self, (self->size + 1) * 2 < self->used ? self->capacity : self->capacity << 1);
+  }
+
+  pos = (number_t)(hash & (cape_uint64)(self->capacity - 1));
+
+  while (TRUE)
+  {
+    CapeHashNode n = self->slots + pos;
+
+    if (n->state == CAPE_HASH_SLOT__EMPTY)
+    {
+      if (first_deleted)
+      {
+        n = first_deleted;
+      }
+      else
+      {
+        self->used++;
+      }
+
+      n->hash = hash;
+      n->key = key;
+      n->val = val;
+      n->state = CAPE_HASH_SLOT__USED;
+
+      self->size++;
+
+      return n;
+    }
+    else if (n->state == CAPE_HASH_SLOT__DELETED)
+    {
+      if (first_deleted == NULL)
+      {
+        first_deleted = n;
+      }
+    }
+    else if (n->hash == hash && self->cmp_fct (key, n->key, self->ptr) == 0)
+    {
+      // is the hash function known as string
+      if (self->hash_fct == cape_hash__hash__s)
+      {
+        cape_log_fmt (CAPE_LL_WARN, "CAPE", "hash insert", "key already exists '%s'", (char*)key);
+      }
+      else
+      {
+        cape_log_msg (CAPE_LL_WARN, "CAPE", "hash insert", "key already exists");
+      }
+
+      return NULL;
+    }
+
+    pos = (pos + 1) & (self->capacity - 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashNode cape_hash_insert (CapeHash self, void* key, void* val)
+{
+  return cape_hash__insert (self, key, val, self->hash_fct (key, self->ptr));
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashNode cape_hash_find_h (CapeHash self, const void* key, cape_uint64 hash)
+{
+  number_t pos = (number_t)(hash & (cape_uint64)(self->capacity - 1));
+
+  while (TRUE)
+  {
+    CapeHashNode n = self->slots + pos;
+
+    if (n->state == CAPE_HASH_SLOT__EMPTY)
+    {
+      return NULL;
+    }
+
+    if (n->state == CAPE_HASH_SLOT__USED && n->hash == hash && self->cmp_fct (key, n->key, self->ptr) == 0)
+    {
+      return n;
+    }
+
+    pos = (pos + 1) & (self->capacity - 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashNode cape_hash_find (CapeHash self, const void* key)
+{
+  return cape_hash_find_h (self, key, self->hash_fct (key, self->ptr));
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_erase (CapeHash self, CapeHashNode node)
+{
+  if (node && node->state == CAPE_HASH_SLOT__USED)
+  {
+    if (self->del_fct)
+    {
+      self->del_fct (node->key, node->val);
+    }
+
+    node->key = NULL;
+    node->val = NULL;
+
+    // keep the probing chain intact
+    node->state = CAPE_HASH_SLOT__DELETED;
+
+    self->size--;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_hash_size (CapeHash self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_cursor_init (CapeHash self, CapeHashCursor* cursor)
+{
+  cursor->node = NULL;
+  cursor->position = -1;
+  cursor->index = -1;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_hash_cursor_next (CapeHash self, CapeHashCursor* cursor)
+{
+  for (cursor->index++; cursor->index < self->capacity; cursor->index++)
+  {
+    CapeHashNode n = self->slots + cursor->index;
+
+    if (n->state == CAPE_HASH_SLOT__USED)
+    {
+      cursor->node = n;
+      cursor->position++;
+
+      return TRUE;
+    }
+  }
+
+  cursor->node = NULL;
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_cursor_erase (CapeHash self, CapeHashCursor* cursor)
+{
+  // deleted slots are kept until the next rehash, the index stays valid
+  cape_hash_erase (self, cursor->node);
+
+  cursor->node = NULL;
+}
+
+//=============================================================================
+
+typedef struct
+{
+  CapeHash hash;
+  CapeMutex mutex;
+
+} CapeHashShard;
+
+//-----------------------------------------------------------------------------
+
+struct CapeHashSync_s
+{
+  CapeHashShard* shards;
+
+  number_t shards_cnt;       // always a power of two
+
+  fct_cape_hash_hash hash_fct;
+  void* ptr;
+};
+
+//-----------------------------------------------------------------------------
+
+CapeHashSync cape_hash_sync_new (fct_cape_hash_hash on_hash, fct_cape_hash_cmp on_cmp, fct_cape_hash_destroy on_del, void* ptr, number_t shards)
+{
+  CapeHashSync self = CAPE_NEW (struct CapeHashSync_s);
+  number_t i;
+
+  self->shards_cnt = 1;
+
+  while (self->shards_cnt < shards)
+  {
+    self->shards_cnt <<= 1;
+  }
+
+  self->shards = CAPE_ALLOC (self->shards_cnt * sizeof(CapeHashShard));
+
+  for (i = 0; i < self->shards_cnt; i++)
+  {
+    self->shards[i].hash = cape_hash_new (on_hash, on_cmp, on_del, ptr);
+    self->shards[i].mutex = cape_mutex_new ();
+  }
+
+  self->hash_fct = on_hash ? on_hash : cape_hash__hash__s;
+  self->ptr = ptr;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hash_sync_del (CapeHashSync* p_self)
+{
+  if (*p_self)
+  {
+    CapeHashSync self = *p_self;
+    number_t i;
+
+    for (i = 0; i < self->shards_cnt; i++)
+    {
+      cape_hash_del (&(self->shards[i].hash));
+      cape_mutex_del (&(self->shards[i].mutex));
+    }
+
+    CAPE_FREE (self->shards);
+
+    CAPE_DEL (p_self, struct CapeHashSync_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeHashShard* cape_hash_sync__shard (CapeHashSync self, cape_uint64 hash)
+{
+  // use the upper bits, the lower bits are used for the slots
+  return self->shards + (number_t)((hash >> 32) & (cape_uint64)(self->shards_cnt - 1));
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_hash_sync_insert (CapeHashSync self, void* key, void* val)
+{
+  CapeHashNode n;
+
+  cape_uint64 hash = self->hash_fct (key, self->ptr);
+  CapeHashShard* shard = cape_hash_sync__shard (self, hash);
+
+  cape_mutex_lock (shard->mutex);
+
+  n = cape_hash__insert (shard->hash, key, val, hash);
+
+  cape_mutex_unlock (shard->mutex);
+
+  return n != NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_hash_sync_ext (CapeHashSync self, const void* key)
+{
+  void* ret = NULL;
+  CapeHashNode n;
+
+  cape_uint64 hash = self->hash_fct (key, self->ptr);
+  CapeHashShard* shard = cape_hash_sync__shard (self, hash);
+
+  cape_mutex_lock (shard->mutex);
+
+  n = cape_hash_find_h (shard->hash, key, hash);
+  if (n)
+  {
+    // removes the value from the node
+    ret = cape_hash_node_mv (n);
+
+    // the destroy callback is called with an empty value
+    cape_hash_erase (shard->hash, n);
+  }
+
+  cape_mutex_unlock (shard->mutex);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_hash_sync_size (CapeHashSync self)
+{
+  number_t ret = 0;
+  number_t i;
+
+  for (i = 0; i < self->shards_cnt; i++)
+  {
+    cape_mutex_lock (self->shards[i].mutex);
+
+    ret += cape_hash_size (self->shards[i].hash);
+
+    cape_mutex_unlock (self->shards[i].mutex);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+#ifndef __CAPE_STC__HASH__H
+#define __CAPE_STC__HASH__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* this class implements a hash table with open addressing
+ *
+ * -> follows the CapeMap API and the ownership rules of the destroy callback
+ * -> linear probing with cached hashes, the key compare callback is only
+ *    called if the cached hashes are equal
+ * -> erased slots are marked as deleted and are reused by the next insert
+ *    or cleaned up when the table grows
+ * -> use it for point lookups, there is no order in the cursor iteration
+ *
+ * remarks: a node is a slot inside the table, the node is only valid until
+ *          the next insert into the table
+ */
+
+//=============================================================================
+
+struct CapeHash_s; typedef struct CapeHash_s* CapeHash;
+struct CapeHashNode_s; typedef struct CapeHashNode_s* CapeHashNode;
+
+typedef cape_uint64 (__STDCALL *fct_cape_hash_hash)  (const void* key, void* ptr);
+typedef int   (__STDCALL *fct_cape_hash_cmp)         (const void* a, const void* b, void* ptr);
+typedef void  (__STDCALL *fct_cape_hash_destroy)     (void* key, void* val);
+
+//-----------------------------------------------------------------------------
+
+                                 /* FNV-1a hash of a zero terminated string */
+__CAPE_LIBEX   cape_uint64 __STDCALL cape_hash__hash__s     (const void* key, void* ptr);
+
+                                 /* FNV-1a hash of a zero terminated string, ignore case */
+__CAPE_LIBEX   cape_uint64 __STDCALL cape_hash__hash__s_i   (const void* key, void* ptr);
+
+                                 /* mixes the bits of a number_t key */
+__CAPE_LIBEX   cape_uint64 __STDCALL cape_hash__hash__n     (const void* key, void* ptr);
+
+                                 /* compare function for cape_hash__hash__s_i */
+__CAPE_LIBEX   int __STDCALL     cape_hash__compare__s_i    (const void* a, const void* b, void* ptr);
+
+                                 /* FNV-1a hash of a buffer */
+__CAPE_LIBEX   cape_uint64       cape_hash__buf             (const char* bufdat, number_t buflen);
+
+//-----------------------------------------------------------------------------
+
+                                 /* on_hash == NULL and on_cmp == NULL -> string keys */
+__CAPE_LIBEX   CapeHash          cape_hash_new              (fct_cape_hash_hash, fct_cape_hash_cmp, fct_cape_hash_destroy, void* ptr);
+
+__CAPE_LIBEX   void              cape_hash_del              (CapeHash*);
+
+__CAPE_LIBEX   void              cape_hash_clr              (CapeHash);
+
+                                 /* reserves enough slots for the amount of entries */
+__CAPE_LIBEX   void              cape_hash_reserve          (CapeHash, number_t size);
+
+//-----------------------------------------------------------------------------
+
+                                 /* returns NULL if the key already exists, the ownership stays with the caller */
+__CAPE_LIBEX   CapeHashNode      cape_hash_insert           (CapeHash, void* key, void* data);
+
+__CAPE_LIBEX   CapeHashNode      cape_hash_find             (CapeHash, const void* key);
+
+                                 /* same as find, but with an already calculated hash of the key */
+__CAPE_LIBEX   CapeHashNode      cape_hash_find_h           (CapeHash, const void* key, cape_uint64 hash);
+
+__CAPE_LIBEX   void              cape_hash_erase            (CapeHash, CapeHashNode);     // removes the node, calls the onDestroy callback
+
+__CAPE_LIBEX   number_t          cape_hash_size             (CapeHash);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void*             cape_hash_node_value       (CapeHashNode);
+
+__CAPE_LIBEX   void*             cape_hash_node_key         (CapeHashNode);
+
+__CAPE_LIBEX   void              cape_hash_node_set         (CapeHashNode, void*);        // use with care
+
+__CAPE_LIBEX   void*             cape_hash_node_mv          (CapeHashNode);               // returns the value and replace it with NULL
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeHashNode node;   // the current slot
+  number_t position;   // the current position
+  number_t index;      // the slot index
+
+} CapeHashCursor;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void              cape_hash_cursor_init      (CapeHash, CapeHashCursor*);
+
+__CAPE_LIBEX   int               cape_hash_cursor_next      (CapeHash, CapeHashCursor*);
+
+__CAPE_LIBEX   void              cape_hash_cursor_erase     (CapeHash, CapeHashCursor*);  // erasing while iterating is allowed
+
+//=============================================================================
+
+/* concurrent variant of the hash table
+ *
+ * -> the keys are distributed over several shards, each shard has its own lock
+ * -> there are no nodes in the API, values are moved in and out
+ */
+
+//-----------------------------------------------------------------------------
+
+struct CapeHashSync_s; typedef struct CapeHashSync_s* CapeHashSync;
+
+//-----------------------------------------------------------------------------
+
+                                 /* shards will be rounded up to a power of two */
+__CAPE_LIBEX   CapeHashSync      cape_hash_sync_new         (fct_cape_hash_hash, fct_cape_hash_cmp, fct_cape_hash_destroy, void* ptr, number_t shards);
+
+__CAPE_LIBEX   void              cape_hash_sync_del         (CapeHashSync*);
+
+                                 /* returns FALSE if the key already exists, the ownership stays with the caller */
+__CAPE_LIBEX   int               cape_hash_sync_insert      (CapeHashSync, void* key, void* data);
+
+                                 /* removes the entry and returns the value, the key will be destroyed */
+__CAPE_LIBEX   void*             cape_hash_sync_ext         (CapeHashSync, const void* key);
+
+__CAPE_LIBEX   number_t          cape_hash_sync_size        (CapeHashSync);
+
+//-----------------------------------------------------------------------------
+
+#endif
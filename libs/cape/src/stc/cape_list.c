@@ -278,6 +278,13 @@ CapeListNode cape_list_noed_next (CapeListNode node)
 
 //-----------------------------------------------------------------------------
 
+CapeListNode cape_list_node_next (CapeListNode self)
+{
+  return self->next;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeListNode cape_list_node_front (CapeList self)
 {
   return self->fpos;
@@ -8,6 +8,7 @@
 // cape includes
 #include "sys/cape_err.h"
 #include "sys/cape_log.h"
+#include "sys/cape_rand.h"
 #include "fmt/cape_dragon4.h"
 
 #include <string.h>
@@ -668,59 +669,15 @@ int cape_str_next (const CapeString self, char c, number_t* p_pos)
 
 CapeString cape_str_uuid (void)
 {
-  CapeString self = (CapeString)CAPE_ALLOC(38);
+  CapeString self = (CapeString)CAPE_ALLOC(CAPE_UUID_HEX_LENGTH + 1);
 
-#if defined _MSC_VER
-
-  sprintf_s (self, 38, "%04X%04X-%04X-%04X-%04X-%04X%04X%04X",
-          rand() & 0xffff, rand() & 0xffff,                          // Generates a 64-bit Hex number
-          rand() & 0xffff,                                           // Generates a 32-bit Hex number
-          ((rand() & 0x0fff) | 0x4000),                              // Generates a 32-bit Hex number of the form 4xxx (4 indicates the UUID version)
-          rand() % 0x3fff + 0x8000,                                  // Generates a 32-bit Hex number in the range [0x8000, 0xbfff]
-          rand() & 0xffff, rand() & 0xffff, rand() & 0xffff);        // Generates a 96-bit Hex number
-
-#else
-
-  sprintf (self, "%04X%04X-%04X-%04X-%04X-%04X%04X%04X",
-          rand() & 0xffff, rand() & 0xffff,                          // Generates a 64-bit Hex number
-          rand() & 0xffff,                                           // Generates a 32-bit Hex number
-          ((rand() & 0x0fff) | 0x4000),                              // Generates a 32-bit Hex number of the form 4xxx (4 indicates the UUID version)
-          rand() % 0x3fff + 0x8000,                                  // Generates a 32-bit Hex number in the range [0x8000, 0xbfff]
-          rand() & 0xffff, rand() & 0xffff, rand() & 0xffff);        // Generates a 96-bit Hex number
+  CapeUuid uuid;
 
-#endif
-
-  return self;
-
-  /*
-  CapeString self = CAPE_ALLOC(38);
-  int t = 0;
-
-  char *szTemp = "xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx";
-  char *szHex = "0123456789ABCDEF-";
-  int nLen = 36;
-  unsigned char* pos = (unsigned char*)self;
-
-  srand (clock());
-
-  for (t = 0; t < nLen + 1; t++, pos++)
-  {
-    int r = rand () % 16;
-    char c = ' ';
-
-    switch (szTemp[t])
-    {
-      case 'x' : { c = szHex [r]; } break;
-      case 'y' : { c = szHex [(r & 0x03) | 0x08]; } break;
-      case '-' : { c = '-'; } break;
-      case '4' : { c = '4'; } break;
-    }
-
-    *pos = ( t < nLen ) ? c : 0x00;
-  }
+  // random version 4 UUID from the per-thread generator
+  cape_uuid_gen (&uuid);
+  cape_uuid_hex (&uuid, self);
 
   return self;
-  */
 }
 
 //-----------------------------------------------------------------------------
@@ -732,7 +689,7 @@ CapeString cape_str_random_s (number_t len)
 
   for (i = 0; i < len; i++)
   {
-    self[i] = (rand() % 26) + 97;
+    self[i] = (char)cape_rand_n (0, 25) + 97;
   }
 
   // set termination
@@ -750,7 +707,7 @@ CapeString cape_str_random_n (number_t len)
 
   for (i = 0; i < len; i++)
   {
-    self[i] = (rand() % 10) + 48;
+    self[i] = (char)cape_rand_n (0, 9) + 48;
   }
 
   // set termination
@@ -795,7 +752,7 @@ CapeString cape_str_password (number_t len, number_t cnt_upper, number_t cnt_low
     number_t i;
     for (i = 0; i < len_upper; i++, p++)
     {
-      self[p] = (rand() % 26) + 65;
+      self[p] = (char)cape_rand_n (0, 25) + 65;
     }
   }
 
@@ -804,7 +761,7 @@ CapeString cape_str_password (number_t len, number_t cnt_upper, number_t cnt_low
     number_t i;
     for (i = 0; i < len_lower; i++, p++)
     {
-      self[p] = (rand() % 26) + 97;
+      self[p] = (char)cape_rand_n (0, 25) + 97;
     }
   }
 
@@ -813,7 +770,7 @@ CapeString cape_str_password (number_t len, number_t cnt_upper, number_t cnt_low
     number_t i;
     for (i = 0; i < len_digit; i++, p++)
     {
-      self[p] = (rand() % 10) + 48;
+      self[p] = (char)cape_rand_n (0, 9) + 48;
     }
   }
 
@@ -822,7 +779,7 @@ CapeString cape_str_password (number_t len, number_t cnt_upper, number_t cnt_low
     number_t i;
     for (i = 0; i < len_special; i++, p++)
     {
-      self[p] = specials[(rand() % 14)];
+      self[p] = specials[cape_rand_n (0, 13)];
     }
   }
   
@@ -831,7 +788,7 @@ CapeString cape_str_password (number_t len, number_t cnt_upper, number_t cnt_low
     number_t i;
     for (i = len_max - 1; i > 0; i--)
     {
-      number_t j = (number_t) (drand48() * (i + 1));
+      number_t j = cape_rand_n (0, i);
       
       // switch position
       char t = self[j];
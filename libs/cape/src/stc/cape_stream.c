@@ -289,9 +289,9 @@ void cape_stream_shift_l (CapeStream self, number_t bytes)
     // calculate used bytes
     number_t used = self->pos - self->buffer;
 
+    // the allocated size stays, the buffer can be reused
     if (bytes >= used)
     {
-        self->size = 0;
         self->pos = self->buffer;
 
         // special case overflow
@@ -307,7 +307,6 @@ void cape_stream_shift_l (CapeStream self, number_t bytes)
 
         memmove(self->buffer, self->buffer + bytes, tail);
 
-        self->size = tail;
         self->pos = self->buffer + tail;
     }
 }
@@ -21,8 +21,51 @@ struct CapeUdc_s
   void* data;
 
   CapeString name;
+
+  int* refcnt;         // shared counter of the node / list container, NULL if not shared
 };
 
+/* copy-on-write of node and list containers
+ *
+ * -> cape_udc_share doesn't copy the container of a node or a list, both udc objects
+ *    refer to the same container and share a reference counter
+ * -> before the container gets changed or a child is handed out for writing
+ *    the container is unshared: the map / list is copied and each child is copied
+ *    by cape_udc_share, so that children which are nodes or lists stay shared
+ * -> only the path which is touched will be copied
+ * -> cape_udc_cp always creates an independent copy
+ */
+
+//----------------------------------------------------------------------------------------
+
+static int cape_udc__refcnt_inc (int* refcnt)
+{
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  return __sync_add_and_fetch (refcnt, 1);
+
+#else
+
+  return ++(*refcnt);
+
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+
+static int cape_udc__refcnt_dec (int* refcnt)
+{
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  return __sync_sub_and_fetch (refcnt, 1);
+
+#else
+
+  return --(*refcnt);
+
+#endif
+}
+
 //----------------------------------------------------------------------------------------
 
 static void __STDCALL cape_udc_node_onDel (void* key, void* val)
@@ -85,18 +128,119 @@ void cape_udc__alloc_data (CapeUdc self)
 
 //-----------------------------------------------------------------------------
 
-void cape_udc__clear_data (CapeUdc self)
+static void cape_udc__share (CapeUdc self)
 {
-    switch (self->type)
+  if (self->refcnt == NULL)
+  {
+    // the counter will be created by the first copy
+    int* refcnt = CAPE_NEW (int);
+
+    *refcnt = 1;
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+    if (!__sync_bool_compare_and_swap (&(self->refcnt), NULL, refcnt))
+    {
+      // another copy was faster
+      CAPE_DEL (&refcnt, int);
+    }
+
+#else
+
+    self->refcnt = refcnt;
+
+#endif
+  }
+
+  cape_udc__refcnt_inc (self->refcnt);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_udc__release_data (CapeUdc self)
+{
+  if (self->refcnt)
+  {
+    if (cape_udc__refcnt_dec (self->refcnt) > 0)
+    {
+      // the container is still used by other udc objects
+      self->refcnt = NULL;
+      self->data = NULL;
+
+      return;
+    }
+
+    CAPE_DEL (&(self->refcnt), int);
+  }
+
+  switch (self->type)
+  {
+    case CAPE_UDC_NODE:
+    {
+      cape_map_del ((CapeMap*)&(self->data));
+      break;
+    }
+    case CAPE_UDC_LIST:
+    {
+      cape_list_del ((CapeList*)&(self->data));
+      break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_udc_share__map_on_clone (void* key_original, void* val_original, void** key_clone, void** val_clone);
+
+static void* __STDCALL cape_udc_share__list_on_clone (void* ptr);
+
+//-----------------------------------------------------------------------------
+
+static void cape_udc__unshare (CapeUdc self)
+{
+  if (self->refcnt)
+  {
+    if (*(self->refcnt) == 1)
+    {
+      // all other copies are gone, we own the container again
+      CAPE_DEL (&(self->refcnt), int);
+    }
+    else
     {
+      void* data = NULL;
+
+      // copy the container first, it might be released by the other copies
+      switch (self->type)
+      {
         case CAPE_UDC_NODE:
         {
-            cape_map_del ((CapeMap*)&(self->data));
-            break;
+          data = cape_map_clone (self->data, cape_udc_share__map_on_clone);
+          break;
         }
         case CAPE_UDC_LIST:
         {
-            cape_list_del ((CapeList*)&(self->data));
+          data = cape_list_clone (self->data, cape_udc_share__list_on_clone);
+          break;
+        }
+      }
+
+      cape_udc__release_data (self);
+
+      self->data = data;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_udc__clear_data (CapeUdc self)
+{
+    switch (self->type)
+    {
+        case CAPE_UDC_NODE:
+        case CAPE_UDC_LIST:
+        {
+            cape_udc__release_data (self);
             break;
         }
         case CAPE_UDC_STRING:
@@ -135,6 +279,7 @@ CapeUdc cape_udc_new (u_t type, const CapeString name)
 
     self->type = type;
     self->data = NULL;
+    self->refcnt = NULL;
 
     self->name = cape_str_cp (name);
 
@@ -196,8 +341,14 @@ CapeUdc cape_udc_cp (const CapeUdc self)
         return NULL;
     }
     
-    // allocate and initialize object
-    clone = cape_udc_new (self->type, self->name);
+    // allocate the object, the data will be set below
+    clone = CAPE_NEW(struct CapeUdc_s);
+
+    clone->type = self->type;
+    clone->data = NULL;
+    clone->refcnt = NULL;
+
+    clone->name = cape_str_cp (self->name);
 
     switch (self->type)
     {
@@ -266,6 +417,63 @@ CapeUdc cape_udc_cp (const CapeUdc self)
 
 //-----------------------------------------------------------------------------
 
+static void __STDCALL cape_udc_share__map_on_clone (void* key_original, void* val_original, void** key_clone, void** val_clone)
+{
+  CapeUdc cloned_udc = cape_udc_share (val_original);
+
+  // the key is owned by the udc
+  *key_clone = (void*)cape_udc_name (cloned_udc);
+  *val_clone = (void*)cloned_udc;
+}
+
+//-----------------------------------------------------------------------------
+
+static void* __STDCALL cape_udc_share__list_on_clone (void* ptr)
+{
+  return cape_udc_share (ptr);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_share (const CapeUdc self)
+{
+  CapeUdc clone;
+
+  if (NULL == self)
+  {
+    return NULL;
+  }
+
+  switch (self->type)
+  {
+    case CAPE_UDC_NODE:
+    case CAPE_UDC_LIST:
+    {
+      break;
+    }
+    default:
+    {
+      // values are always copied
+      return cape_udc_cp (self);
+    }
+  }
+
+  clone = CAPE_NEW(struct CapeUdc_s);
+
+  clone->type = self->type;
+  clone->name = cape_str_cp (self->name);
+
+  // share the container until one of both gets changed
+  cape_udc__share (self);
+
+  clone->data = self->data;
+  clone->refcnt = self->refcnt;
+
+  return clone;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeUdc cape_udc_mv (CapeUdc* p_origin)
 {
   CapeUdc ret = *p_origin;
@@ -390,7 +598,7 @@ void cape_udc_merge_cp__item__node (CapeUdc origin, const CapeUdc other)
 {
   if (origin->type == other->type)
   {
-    CapeUdcCursor* cursor = cape_udc_cursor_new (other, CAPE_DIRECTION_FORW);
+    CapeUdcCursor* cursor = cape_udc_cursor_new_r (other, CAPE_DIRECTION_FORW);
 
     while (cape_udc_cursor_next (cursor))
     {
@@ -424,7 +632,7 @@ void cape_udc_merge_cp__item__list (CapeUdc origin, const CapeUdc other)
 {
   if (origin->type == other->type)
   {
-    CapeUdcCursor* cursor = cape_udc_cursor_new (other, CAPE_DIRECTION_FORW);
+    CapeUdcCursor* cursor = cape_udc_cursor_new_r (other, CAPE_DIRECTION_FORW);
 
     while (cape_udc_cursor_next (cursor))
     {
@@ -503,6 +711,15 @@ void cape_udc_merge_cp (CapeUdc self, const CapeUdc udc)
 
 void cape_udc_clr (CapeUdc self)
 {
+    if (self->refcnt)
+    {
+        // no need to copy a shared container, just start with a new one
+        cape_udc__release_data (self);
+        cape_udc__alloc_data (self);
+
+        return;
+    }
+
     switch (self->type)
     {
         case CAPE_UDC_NODE:
@@ -631,7 +848,7 @@ static int cape_udc__convert_to_s (CapeUdc self)
             }
 
             // de-allocate old value
-            cape_map_del ((CapeMap*)&(self->data));
+            cape_udc__release_data (self);
 
             // change type and set value
             self->type = CAPE_UDC_STRING;
@@ -649,7 +866,7 @@ static int cape_udc__convert_to_s (CapeUdc self)
             }
 
             // de-allocate old value
-            cape_list_del ((CapeList*)&(self->data));
+            cape_udc__release_data (self);
             
             // change type and set value
             self->type = CAPE_UDC_STRING;
@@ -1141,6 +1358,8 @@ number_t cape_udc_size (const CapeUdc self)
 
 CapeUdc cape_udc_add (CapeUdc self, CapeUdc* p_item)
 {
+    cape_udc__unshare (self);
+
     switch (self->type)
     {
         case CAPE_UDC_NODE:
@@ -1200,7 +1419,7 @@ CapeUdc cape_udc_add_name (CapeUdc self, CapeUdc* p_item, const CapeString name)
 
 //-----------------------------------------------------------------------------
 
-CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
+static CapeUdc cape_udc__get (CapeUdc self, const CapeString name)
 {
   // better to check here
   if (self == NULL)
@@ -1238,6 +1457,26 @@ CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
 
 //-----------------------------------------------------------------------------
 
+CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
+{
+  if (self)
+  {
+    // the caller might change the child
+    cape_udc__unshare (self);
+  }
+
+  return cape_udc__get (self, name);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_get_r (const CapeUdc self, const CapeString name)
+{
+  return cape_udc__get (self, name);
+}
+
+//-----------------------------------------------------------------------------
+
 CapeUdc cape_udc_ext (CapeUdc self, const CapeString name)
 {
   // better to check here
@@ -1252,6 +1491,8 @@ CapeUdc cape_udc_ext (CapeUdc self, const CapeString name)
     return NULL;
   }
 
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -1299,6 +1540,8 @@ void cape_udc_rm (CapeUdc self, const CapeString name)
     return;
   }
 
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -1605,6 +1848,8 @@ CapeDatetime* cape_udc_d_mv (CapeUdc self, const CapeDatetime* alt)
 
 CapeList cape_udc_list_mv (CapeUdc self)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_LIST:
@@ -1780,7 +2025,7 @@ CapeUdc cape_udc_add_m_mv (CapeUdc self, const CapeString name, CapeStream* p_va
 
 const CapeString cape_udc_get_s (CapeUdc self, const CapeString name, const CapeString alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
 
   if (h)
   {
@@ -1794,7 +2039,7 @@ const CapeString cape_udc_get_s (CapeUdc self, const CapeString name, const Cape
 
 number_t cape_udc_get_n (CapeUdc self, const CapeString name, number_t alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
 
   if (h)
   {
@@ -1808,7 +2053,7 @@ number_t cape_udc_get_n (CapeUdc self, const CapeString name, number_t alt)
 
 double cape_udc_get_f (CapeUdc self, const CapeString name, double alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
 
   if (h)
   {
@@ -1822,7 +2067,7 @@ double cape_udc_get_f (CapeUdc self, const CapeString name, double alt)
 
 int cape_udc_get_b (CapeUdc self, const CapeString name, int alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
 
   if (h)
   {
@@ -1836,7 +2081,7 @@ int cape_udc_get_b (CapeUdc self, const CapeString name, int alt)
 
 const CapeDatetime* cape_udc_get_d (CapeUdc self, const CapeString name, const CapeDatetime* alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
 
   if (h)
   {
@@ -1850,7 +2095,7 @@ const CapeDatetime* cape_udc_get_d (CapeUdc self, const CapeString name, const C
 
 const CapeStream cape_udc_get_m (CapeUdc self, const CapeString name)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
 
   if (h)
   {
@@ -2020,6 +2265,8 @@ void cape_udc_put_node__replace (CapeMapNode n, CapeUdc new_value)
 
 void cape_udc_put_node_cp (CapeUdc self, const CapeString name, CapeUdc node)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -2045,6 +2292,8 @@ void cape_udc_put_node_cp (CapeUdc self, const CapeString name, CapeUdc node)
 
 void cape_udc_put_node_mv (CapeUdc self, const CapeString name, CapeUdc* p_node)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -2074,6 +2323,8 @@ void cape_udc_put_node_mv (CapeUdc self, const CapeString name, CapeUdc* p_node)
 
 CapeUdc cape_udc_get_first (CapeUdc self)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_LIST:
@@ -2113,6 +2364,8 @@ CapeUdc cape_udc_get_first (CapeUdc self)
 
 CapeUdc cape_udc_get_last (CapeUdc self)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_LIST:
@@ -2280,6 +2533,12 @@ int cape_udc_equal (CapeUdc self, CapeUdc other)
 {
     int ret = FALSE;
 
+    if (self->refcnt && (self->data == other->data))
+    {
+        // both share the same container
+        return TRUE;
+    }
+
     switch (self->type)
     {
         case CAPE_UDC_LIST:
@@ -2411,12 +2670,12 @@ int cape_udc_has__iterate (CapeUdc self, CapeUdc to_find)
 {
     int ret = FALSE;
 
-    CapeUdcCursor* cursor = cape_udc_cursor_new (to_find, CAPE_DIRECTION_FORW);
+    CapeUdcCursor* cursor = cape_udc_cursor_new_r (to_find, CAPE_DIRECTION_FORW);
 
     while (cape_udc_cursor_next (cursor))
     {
         // try to find a node with the same name
-        CapeUdc node_found = cape_udc_get (self, cape_udc_name (cursor->item));
+        CapeUdc node_found = cape_udc__get (self, cape_udc_name (cursor->item));
         
         if (node_found)
         {
@@ -2525,6 +2784,8 @@ CapeMap cape_udc_map_n (CapeUdc self, const CapeString key_name)
 
 CapeString cape_udc_ext_s (CapeUdc self, const CapeString name)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -2565,6 +2826,8 @@ CapeString cape_udc_ext_s (CapeUdc self, const CapeString name)
 
 CapeDatetime* cape_udc_ext_d (CapeUdc self, const CapeString name)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -2605,6 +2868,8 @@ CapeDatetime* cape_udc_ext_d (CapeUdc self, const CapeString name)
 
 CapeStream cape_udc_ext_m (CapeUdc self, const CapeString name)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_NODE:
@@ -2695,6 +2960,8 @@ CapeUdc cape_udc_ext_list (CapeUdc self, const CapeString name)
 
 CapeUdc cape_udc_ext_first (CapeUdc self)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_LIST:
@@ -2741,6 +3008,16 @@ CapeUdc cape_udc_ext_first (CapeUdc self)
 //-----------------------------------------------------------------------------
 
 CapeUdcCursor* cape_udc_cursor_new (CapeUdc self, int direction)
+{
+  // the caller might change the items
+  cape_udc__unshare (self);
+
+  return cape_udc_cursor_new_r (self, direction);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdcCursor* cape_udc_cursor_new_r (const CapeUdc self, int direction)
 {
   CapeUdcCursor* cursor = CAPE_NEW(CapeUdcCursor);
 
@@ -2932,7 +3209,7 @@ void cape_udc_print (const CapeUdc self)
   {
     case CAPE_UDC_NODE:
     {
-      CapeUdcCursor* cursor = cape_udc_cursor_new (self, CAPE_DIRECTION_FORW);
+      CapeUdcCursor* cursor = cape_udc_cursor_new_r (self, CAPE_DIRECTION_FORW);
 
       while (cape_udc_cursor_next (cursor))
       {
@@ -2992,6 +3269,8 @@ void cape_udc_print (const CapeUdc self)
 
 void cape_udc_sort_list (CapeUdc self, fct_cape_udc__on_compare on_compare)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_LIST:
@@ -3018,6 +3297,8 @@ void cape_udc_list_distinct (CapeUdc self)
         return;
     }
     
+    cape_udc__unshare (self);
+
     switch (self->type)
     {
         case CAPE_UDC_LIST:
@@ -3032,6 +3313,8 @@ void cape_udc_list_distinct (CapeUdc self)
 
 void cape_udc_add_n__max (CapeUdc self, const CapeString name, number_t val, number_t max_length)
 {
+  cape_udc__unshare (self);
+
   switch (self->type)
   {
     case CAPE_UDC_LIST:
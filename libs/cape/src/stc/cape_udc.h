@@ -46,6 +46,15 @@ __CAPE_LIBEX   number_t             cape_udc_size             (const CapeUdc);
                                     /* returns a copy of the UDC container */
 __CAPE_LIBEX   CapeUdc              cape_udc_cp               (const CapeUdc);
 
+                                    /* returns a copy which shares nodes and lists with the original (copy-on-write)
+                                       -> the container will be copied when one of both gets changed
+                                          or a child is returned by get, ext, find or a cursor
+                                       -> children of the original which were returned before must not be changed anymore
+                                       -> a shared copy can be read by several threads with cape_udc_get_r,
+                                          cape_udc_cursor_new_r and the value getters (get_s, get_n, ...)
+                                     */
+__CAPE_LIBEX   CapeUdc              cape_udc_share            (const CapeUdc);
+
                                     /* moves the UDC container */
 __CAPE_LIBEX   CapeUdc              cape_udc_mv               (CapeUdc*);
 
@@ -78,6 +87,9 @@ __CAPE_LIBEX   CapeUdc              cape_udc_add_name         (CapeUdc, CapeUdc*
 
 __CAPE_LIBEX   CapeUdc              cape_udc_get              (CapeUdc, const CapeString name);
 
+                                    /* read only access, the child must not be changed or extracted */
+__CAPE_LIBEX   CapeUdc              cape_udc_get_r            (const CapeUdc, const CapeString name);
+
 __CAPE_LIBEX   CapeUdc              cape_udc_ext              (CapeUdc, const CapeString name);
 
 __CAPE_LIBEX   void                 cape_udc_rm               (CapeUdc, const CapeString name);
@@ -270,6 +282,9 @@ typedef struct
 
 __CAPE_LIBEX   CapeUdcCursor*       cape_udc_cursor_new       (CapeUdc, int direction);
 
+                                    /* read only cursor, the items must not be changed or extracted */
+__CAPE_LIBEX   CapeUdcCursor*       cape_udc_cursor_new_r     (const CapeUdc, int direction);
+
 __CAPE_LIBEX   void                 cape_udc_cursor_del       (CapeUdcCursor**);
 
 __CAPE_LIBEX   int                  cape_udc_cursor_next      (CapeUdcCursor*);
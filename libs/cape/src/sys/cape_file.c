@@ -1320,6 +1320,67 @@ exit_and_cleanup:
 
 //-----------------------------------------------------------------------------
 
+#ifdef __WINDOWS_OS
+
+static void cape_fs__file_info (CapeFileInfo* info, struct _stat64* st)
+{
+  info->size = (off_t)st->st_size;
+  info->mtime = (number_t)st->st_mtime;
+  info->mtime_ns = 0;
+  info->inode = (number_t)st->st_ino;
+  info->regular = (st->st_mode & _S_IFREG) ? TRUE : FALSE;
+}
+
+#else
+
+static void cape_fs__file_info (CapeFileInfo* info, struct stat* st)
+{
+  info->size = st->st_size;
+  info->mtime = (number_t)st->st_mtime;
+
+#if defined __APPLE__
+  info->mtime_ns = (number_t)st->st_mtimespec.tv_nsec;
+#else
+  info->mtime_ns = (number_t)st->st_mtim.tv_nsec;
+#endif
+
+  info->inode = (number_t)st->st_ino;
+  info->regular = S_ISREG (st->st_mode) ? TRUE : FALSE;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+int cape_fs_file_info (const char* path, CapeFileInfo* info, CapeErr err)
+{
+#ifdef __WINDOWS_OS
+
+  struct _stat64 st;
+
+  if (_stat64 (path, &st) == -1)
+  {
+    return cape_err_lastOSError (err);
+  }
+
+#else
+
+  struct stat st;
+
+  if (stat (path, &st) == -1)
+  {
+    return cape_err_lastOSError (err);
+  }
+
+#endif
+
+  cape_fs__file_info (info, &st);
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_fs_ac_del (CapeFileAc* p_self)
 {
   if (*p_self)
@@ -1704,6 +1765,22 @@ number_t cape_fh_write_buf (CapeFileHandle self, const char* bufdat, number_t bu
 
 //-----------------------------------------------------------------------------
 
+int cape_fh_info (CapeFileHandle self, CapeFileInfo* info, CapeErr err)
+{
+  struct stat st;
+
+  if (fstat ((int)self->fd, &st) == -1)
+  {
+    return cape_err_lastOSError (err);
+  }
+
+  cape_fs__file_info (info, &st);
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 struct CapeDirCursor_s
 {
   FTS* tree;
@@ -2003,6 +2080,22 @@ number_t cape_fh_write_buf (CapeFileHandle self, const char* bufdat, number_t bu
 
 //-----------------------------------------------------------------------------
 
+int cape_fh_info (CapeFileHandle self, CapeFileInfo* info, CapeErr err)
+{
+  struct _stat64 st;
+
+  if (_fstat64 ((int)self->fd, &st) == -1)
+  {
+    return cape_err_lastOSError (err);
+  }
+
+  cape_fs__file_info (info, &st);
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 const CapeString cape_fh_file (CapeFileHandle self)
 {
   return self->file;
@@ -118,6 +118,24 @@ __CAPE_LIBEX   int                cape_fs_file_cp__ac    (const char* source, co
                                    */
 __CAPE_LIBEX   off_t              cape_fs_file_size      (const char* path, CapeErr);
 
+typedef struct
+{
+  off_t size;
+
+  number_t mtime;        // seconds since epoch
+  number_t mtime_ns;     // nanoseconds part, 0 if not supported
+
+  number_t inode;        // changes if the file was replaced
+
+  int regular;           // TRUE for regular files
+
+} CapeFileInfo;
+
+                                  /*
+                                   retrieves size and modification time of a file, returns a cape error
+                                   */
+__CAPE_LIBEX   int                cape_fs_file_info      (const char* path, CapeFileInfo*, CapeErr);
+
                                   /*
                                    returns file permissions or ACLs, including UID and GID
                                    */
@@ -156,6 +174,9 @@ __CAPE_LIBEX   number_t           cape_fh_write_buf      (CapeFileHandle, const
 
 __CAPE_LIBEX   const CapeString   cape_fh_file           (CapeFileHandle);
 
+                                  /* same as cape_fs_file_info for the opened file */
+__CAPE_LIBEX   int                cape_fh_info           (CapeFileHandle, CapeFileInfo*, CapeErr);
+
 //-----------------------------------------------------------------------------
 
 struct CapeDirCursor_s; typedef struct CapeDirCursor_s* CapeDirCursor;
@@ -6,6 +6,8 @@
 #if defined __LINUX_OS || defined __BSD_OS
 
 #include <pthread.h>
+#include <time.h>
+#include <errno.h>
 
 //-----------------------------------------------------------------------------
 
@@ -50,6 +52,86 @@ void cape_mutex_unlock (CapeMutex self)
 
 //-----------------------------------------------------------------------------
 
+CapeCond cape_cond_new (void)
+{
+  pthread_cond_t* self = CAPE_NEW (pthread_cond_t);
+  
+#if defined __LINUX_OS
+  
+  pthread_condattr_t attr;
+  
+  pthread_condattr_init (&attr);
+  
+  // don't depend on changes of the system time
+  pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+  
+  pthread_cond_init (self, &attr);
+  
+  pthread_condattr_destroy (&attr);
+  
+#else
+  
+  pthread_cond_init (self, NULL);
+  
+#endif
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_cond_del (CapeCond* p_self)
+{
+  if (*p_self)
+  {
+    pthread_cond_t* self = *p_self;
+    
+    pthread_cond_destroy (self);
+    
+    CAPE_DEL (p_self, pthread_cond_t);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_cond_wait (CapeCond self, CapeMutex mutex, number_t timeout)
+{
+  struct timespec ts;
+  
+#if defined __LINUX_OS
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+#else
+  clock_gettime (CLOCK_REALTIME, &ts);
+#endif
+  
+  ts.tv_sec += timeout / 1000;
+  ts.tv_nsec += (timeout % 1000) * 1000000;
+  
+  if (ts.tv_nsec >= 1000000000)
+  {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+  
+  return pthread_cond_timedwait (self, mutex, &ts) != ETIMEDOUT;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_cond_signal (CapeCond self)
+{
+  pthread_cond_signal (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_cond_broadcast (CapeCond self)
+{
+  pthread_cond_broadcast (self);
+}
+
+//-----------------------------------------------------------------------------
+
 #elif defined _WIN64 || defined _WIN32
 
 #include <windows.h>
@@ -92,4 +174,46 @@ void cape_mutex_unlock (CapeMutex self)
 
 //-----------------------------------------------------------------------------
 
+CapeCond cape_cond_new (void)
+{
+  CONDITION_VARIABLE* self = CAPE_NEW (CONDITION_VARIABLE);
+  
+  InitializeConditionVariable (self);
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_cond_del (CapeCond* p_self)
+{
+  if (*p_self)
+  {
+    CAPE_DEL (p_self, CONDITION_VARIABLE);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_cond_wait (CapeCond self, CapeMutex mutex, number_t timeout)
+{
+  return SleepConditionVariableCS (self, mutex, (DWORD)timeout) != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_cond_signal (CapeCond self)
+{
+  WakeConditionVariable (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_cond_broadcast (CapeCond self)
+{
+  WakeAllConditionVariable (self);
+}
+
+//-----------------------------------------------------------------------------
+
 #endif
@@ -3,6 +3,7 @@
 
 #include "sys/cape_export.h"
 #include "sys/cape_err.h"
+#include "sys/cape_types.h"
 
 //=============================================================================
 
@@ -20,6 +21,27 @@ __CAPE_LIBEX   void              cape_mutex_lock        (CapeMutex);
 
 __CAPE_LIBEX   void              cape_mutex_unlock      (CapeMutex);
 
+//=============================================================================
+
+typedef void* CapeCond;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeCond          cape_cond_new          (void);
+
+__CAPE_LIBEX   void              cape_cond_del          (CapeCond*);
+
+//-----------------------------------------------------------------------------
+
+                                 /* the mutex must be locked, returns FALSE if the timeout was reached (timeout in milliseconds) */
+__CAPE_LIBEX   int               cape_cond_wait         (CapeCond, CapeMutex, number_t timeout);
+
+                                 /* wakes up one waiting thread */
+__CAPE_LIBEX   void              cape_cond_signal       (CapeCond);
+
+                                 /* wakes up all waiting threads */
+__CAPE_LIBEX   void              cape_cond_broadcast    (CapeCond);
+
 //-----------------------------------------------------------------------------
 
 #endif
@@ -0,0 +1,451 @@
+#include "cape_rand.h"
+
+// cape includes
+#include "sys/cape_log.h"
+
+// c includes
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined __WINDOWS_OS
+
+#define CAPE_THREAD_LOCAL __declspec(thread)
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#if defined __LINUX_OS
+#include <sys/syscall.h>
+#endif
+
+#define CAPE_THREAD_LOCAL __thread
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  cape_uint32 state[16];
+
+  cape_uint8 buffer[64];
+
+  number_t pos;             // position in the buffer, 64 -> empty
+
+  number_t generation;      // to detect a fork
+
+  int seeded;
+
+} CapeRandContext;
+
+static CAPE_THREAD_LOCAL CapeRandContext cape_rand_ctx;
+
+// will be increased in the child process after a fork
+static volatile number_t cape_rand_generation = 0;
+
+//-----------------------------------------------------------------------------
+
+#if !defined __WINDOWS_OS
+
+static pthread_once_t cape_rand_once = PTHREAD_ONCE_INIT;
+
+static void cape_rand__on_fork_child (void)
+{
+  cape_rand_generation++;
+}
+
+static void cape_rand__on_once (void)
+{
+  pthread_atfork (NULL, NULL, cape_rand__on_fork_child);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static void cape_rand__entropy (void* bufdat, number_t buflen)
+{
+#if defined __WINDOWS_OS
+
+  number_t i;
+  cape_uint8* pos = bufdat;
+
+  for (i = 0; i < buflen; i++)
+  {
+    unsigned int r;
+
+    // uses RtlGenRandom
+    rand_s (&r);
+
+    pos[i] = (cape_uint8)r;
+  }
+
+#elif defined __BSD_OS
+
+  arc4random_buf (bufdat, buflen);
+
+#else
+
+  number_t bytes_read = 0;
+
+#if defined SYS_getrandom
+
+  while (bytes_read < buflen)
+  {
+    long res = syscall (SYS_getrandom, (char*)bufdat + bytes_read, buflen - bytes_read, 0);
+
+    if (res <= 0)
+    {
+      if (res < 0 && errno == EINTR)
+      {
+        continue;
+      }
+
+      break;
+    }
+
+    bytes_read += res;
+  }
+
+#endif
+
+  if (bytes_read < buflen)
+  {
+    int fd = open ("/dev/urandom", O_RDONLY);
+
+    if (fd >= 0)
+    {
+      while (bytes_read < buflen)
+      {
+        ssize_t res = read (fd, (char*)bufdat + bytes_read, buflen - bytes_read);
+
+        if (res <= 0)
+        {
+          break;
+        }
+
+        bytes_read += res;
+      }
+
+      close (fd);
+    }
+  }
+
+  if (bytes_read < buflen)
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "rand", "no entropy from the operating system, fallback to time and pid");
+
+    {
+      cape_uint64 h[4];
+
+      h[0] = (cape_uint64)time (NULL);
+      h[1] = (cape_uint64)clock ();
+      h[2] = (cape_uint64)getpid ();
+      h[3] = (cape_uint64)(number_t)&cape_rand_ctx;
+
+      memcpy (bufdat, h, buflen < sizeof(h) ? buflen : sizeof(h));
+    }
+  }
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_RAND_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CAPE_RAND_QR(a, b, c, d) \
+  a += b; d ^= a; d = CAPE_RAND_ROTL (d, 16); \
+  c += d; b ^= c; b = CAPE_RAND_ROTL (b, 12); \
+  a += b; d ^= a; d = CAPE_RAND_ROTL (d,  8); \
+  c += d; b ^= c; b = CAPE_RAND_ROTL (b,  7);
+
+//-----------------------------------------------------------------------------
+
+static void cape_rand__seed (CapeRandContext* ctx)
+{
+  cape_uint32 key[10];
+
+#if !defined __WINDOWS_OS
+
+  pthread_once (&cape_rand_once, cape_rand__on_once);
+
+#endif
+
+  cape_rand__entropy (key, sizeof(key));
+
+  // "expand 32-byte k"
+  ctx->state[0] = 0x61707865;
+  ctx->state[1] = 0x3320646e;
+  ctx->state[2] = 0x79622d32;
+  ctx->state[3] = 0x6b206574;
+
+  memcpy (ctx->state + 4, key, 32);
+
+  // block counter
+  ctx->state[12] = 0;
+  ctx->state[13] = 0;
+
+  // nonce
+  ctx->state[14] = key[8];
+  ctx->state[15] = key[9];
+
+  memset (key, 0, sizeof(key));
+
+  ctx->pos = 64;
+  ctx->generation = cape_rand_generation;
+  ctx->seeded = TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_rand__block (CapeRandContext* ctx)
+{
+  cape_uint32 x[16];
+  int i;
+
+  memcpy (x, ctx->state, sizeof(x));
+
+  for (i = 0; i < 10; i++)
+  {
+    // column round
+    CAPE_RAND_QR (x[0], x[4], x[ 8], x[12]);
+    CAPE_RAND_QR (x[1], x[5], x[ 9], x[13]);
+    CAPE_RAND_QR (x[2], x[6], x[10], x[14]);
+    CAPE_RAND_QR (x[3], x[7], x[11], x[15]);
+
+    // diagonal round
+    CAPE_RAND_QR (x[0], x[5], x[10], x[15]);
+    CAPE_RAND_QR (x[1], x[6], x[11], x[12]);
+    CAPE_RAND_QR (x[2], x[7], x[ 8], x[13]);
+    CAPE_RAND_QR (x[3], x[4], x[ 9], x[14]);
+  }
+
+  for (i = 0; i < 16; i++)
+  {
+    cape_uint32 v = x[i] + ctx->state[i];
+
+    ctx->buffer[i * 4 + 0] = (cape_uint8)(v);
+    ctx->buffer[i * 4 + 1] = (cape_uint8)(v >> 8);
+    ctx->buffer[i * 4 + 2] = (cape_uint8)(v >> 16);
+    ctx->buffer[i * 4 + 3] = (cape_uint8)(v >> 24);
+  }
+
+  // increase the 64-bit block counter
+  if (++(ctx->state[12]) == 0)
+  {
+    ctx->state[13]++;
+  }
+
+  ctx->pos = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rand_bytes (void* bufdat, number_t buflen)
+{
+  CapeRandContext* ctx = &cape_rand_ctx;
+
+  cape_uint8* pos = bufdat;
+
+  if (!ctx->seeded || ctx->generation != cape_rand_generation)
+  {
+    cape_rand__seed (ctx);
+  }
+
+  while (buflen > 0)
+  {
+    number_t len;
+
+    if (ctx->pos == 64)
+    {
+      cape_rand__block (ctx);
+    }
+
+    len = 64 - ctx->pos;
+
+    if (len > buflen)
+    {
+      len = buflen;
+    }
+
+    memcpy (pos, ctx->buffer + ctx->pos, len);
+
+    // don't keep used bytes in memory
+    memset (ctx->buffer + ctx->pos, 0, len);
+
+    ctx->pos += len;
+
+    pos += len;
+    buflen -= len;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 cape_rand_u64 (void)
+{
+  cape_uint64 ret;
+
+  cape_rand_bytes (&ret, sizeof(ret));
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_rand_n (number_t min, number_t max)
+{
+  cape_uint64 range = (cape_uint64)(max - min) + 1;
+
+  if (max <= min)
+  {
+    return min;
+  }
+
+  {
+    // reject values of the incomplete last range to avoid a bias
+    cape_uint64 limit = ((cape_uint64)-1) - (((cape_uint64)-1) % range);
+    cape_uint64 r;
+
+    do
+    {
+      r = cape_rand_u64 ();
+    }
+    while (r >= limit);
+
+    return min + (number_t)(r % range);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_uuid_gen (CapeUuid* self)
+{
+  cape_rand_bytes (self->data, 16);
+
+  // version 4
+  self->data[6] = (self->data[6] & 0x0F) | 0x40;
+
+  // variant 10xx
+  self->data[8] = (self->data[8] & 0x3F) | 0x80;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_uuid_hex (const CapeUuid* self, char* buffer)
+{
+  static const char* hex = "0123456789ABCDEF";
+
+  int i;
+  char* pos = buffer;
+
+  for (i = 0; i < 16; i++)
+  {
+    if (i == 4 || i == 6 || i == 8 || i == 10)
+    {
+      *pos++ = '-';
+    }
+
+    *pos++ = hex[self->data[i] >> 4];
+    *pos++ = hex[self->data[i] & 0x0F];
+  }
+
+  *pos = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_uuid__hex_value (char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_uuid_parse (CapeUuid* self, const char* hex)
+{
+  int i;
+  const char* pos = hex;
+
+  if (hex == NULL)
+  {
+    return FALSE;
+  }
+
+  for (i = 0; i < 16; i++)
+  {
+    int h, l;
+
+    if (i == 4 || i == 6 || i == 8 || i == 10)
+    {
+      if (*pos != '-')
+      {
+        return FALSE;
+      }
+
+      pos++;
+    }
+
+    h = cape_uuid__hex_value (pos[0]);
+    if (h < 0)
+    {
+      return FALSE;
+    }
+
+    l = cape_uuid__hex_value (pos[1]);
+    if (l < 0)
+    {
+      return FALSE;
+    }
+
+    self->data[i] = (cape_uint8)((h << 4) | l);
+
+    pos += 2;
+  }
+
+  return *pos == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 __STDCALL cape_uuid__hash (const void* key, void* ptr)
+{
+  cape_uint64 h1;
+  cape_uint64 h2;
+
+  // the content is random already
+  memcpy (&h1, ((const CapeUuid*)key)->data, 8);
+  memcpy (&h2, ((const CapeUuid*)key)->data + 8, 8);
+
+  return h1 ^ h2;
+}
+
+//-----------------------------------------------------------------------------
+
+int __STDCALL cape_uuid__compare (const void* a, const void* b, void* ptr)
+{
+  return memcmp (((const CapeUuid*)a)->data, ((const CapeUuid*)b)->data, 16);
+}
+
+//-----------------------------------------------------------------------------
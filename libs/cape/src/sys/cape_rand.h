@@ -0,0 +1,57 @@
+#ifndef __CAPE_SYS__RAND__H
+#define __CAPE_SYS__RAND__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* random numbers and UUIDs
+ *
+ * -> each thread has its own ChaCha20 generator, there is no global lock
+ * -> the generator is seeded from the operating system and seeded again
+ *    in a forked child process
+ * -> UUIDs are version 4 (122 random bits), collisions across threads,
+ *    processes and nodes are as unlikely as for any random UUID
+ */
+
+//-----------------------------------------------------------------------------
+
+                                 /* fills the buffer with random bytes */
+__CAPE_LIBEX   void              cape_rand_bytes            (void* bufdat, number_t buflen);
+
+__CAPE_LIBEX   cape_uint64       cape_rand_u64              (void);
+
+// cape_rand_n (min, max) is declared in cape_types.h and uses the same generator
+
+//=============================================================================
+
+typedef struct
+{
+  cape_uint8 data[16];
+
+} CapeUuid;
+
+#define CAPE_UUID_HEX_LENGTH 36
+
+//-----------------------------------------------------------------------------
+
+                                 /* creates a random version 4 UUID */
+__CAPE_LIBEX   void              cape_uuid_gen              (CapeUuid*);
+
+                                 /* writes the hex form (uppercase, 36 characters and the terminator) into the buffer */
+__CAPE_LIBEX   void              cape_uuid_hex              (const CapeUuid*, char* buffer);
+
+                                 /* parses the hex form, returns FALSE if the string is not a valid UUID */
+__CAPE_LIBEX   int               cape_uuid_parse            (CapeUuid*, const char* hex);
+
+//-----------------------------------------------------------------------------
+
+                                 /* hash / compare functions to use the binary form as key in CapeHash / CapeMap */
+__CAPE_LIBEX   cape_uint64 __STDCALL cape_uuid__hash        (const void* key, void* ptr);
+
+__CAPE_LIBEX   int __STDCALL     cape_uuid__compare         (const void* a, const void* b, void* ptr);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -4,6 +4,9 @@
 #include "fmt/cape_tokenizer.h"
 #include "sys/cape_log.h"
 
+// c includes
+#include <string.h>
+
 //-----------------------------------------------------------------------------
 
 #if defined __LINUX_OS || defined __BSD_OS
@@ -1336,6 +1339,63 @@ int cape_datetime__str (CapeDatetime* dt, const CapeString datetime_in_text)
 
 //-----------------------------------------------------------------------------
 
+int cape_datetime__gmt (CapeDatetime* dt, const CapeString datetime_in_text)
+{
+  static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+  unsigned int i;
+  const char* pos;
+
+  if (datetime_in_text == NULL)
+  {
+    return FALSE;
+  }
+
+  // skip the name of the day
+  pos = strchr (datetime_in_text, ',');
+  if (pos == NULL)
+  {
+    return FALSE;
+  }
+
+  pos++;
+
+  if (cape_sscanf (pos, "%u", &(dt->day)) != 1)
+  {
+    return FALSE;
+  }
+
+  // skip the day
+  while (*pos == ' ') pos++;
+  while (*pos >= '0' && *pos <= '9') pos++;
+  while (*pos == ' ') pos++;
+
+  dt->month = 0;
+
+  for (i = 0; i < 12; i++)
+  {
+    if (strncmp (pos, months + i * 3, 3) == 0)
+    {
+      dt->month = i + 1;
+      break;
+    }
+  }
+
+  if (dt->month == 0)
+  {
+    return FALSE;
+  }
+
+  dt->msec = 0;
+  dt->usec = 0;
+  dt->is_dst = FALSE;
+  dt->is_utc = TRUE;
+
+  return cape_sscanf (pos + 3, "%u %u:%u:%u", &(dt->year), &(dt->hour), &(dt->minute), &(dt->sec)) == 4;
+}
+
+//-----------------------------------------------------------------------------
+
 static inline number_t bcd_to_number (unsigned char c)
 { 
   return c / 16 * 10 + c % 16;
@@ -206,6 +206,9 @@ __CAPE_LIBEX   int             cape_datetime__str_msec    (CapeDatetime*, const
                                /* 2019-09-01 12:08:21 */
 __CAPE_LIBEX   int             cape_datetime__str         (CapeDatetime*, const CapeString datetime_in_text);
 
+                               /* Sun, 01 Sep 2019 12:08:21 GMT (same as cape_datetime_s__gmt) */
+__CAPE_LIBEX   int             cape_datetime__gmt         (CapeDatetime*, const CapeString datetime_in_text);
+
                                /* 01.01.1970 */
 __CAPE_LIBEX   int             cape_datetime__date_de     (CapeDatetime*, const CapeString datetime_in_text);
 
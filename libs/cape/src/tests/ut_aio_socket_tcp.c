@@ -0,0 +1,352 @@
+#include <aio/cape_aio_sock.h>
+#include <sys/cape_log.h>
+#include <sys/cape_mutex.h>
+#include <sys/cape_thread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <poll.h>
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeAioContext aio;
+
+  CapeAioSocket socket;
+
+  CapeMutex mutex;
+
+  number_t pending;              // responses which are ready to be sent
+
+  volatile int requests;         // requests which were received by the AIO thread
+
+  volatile int done;
+
+} TestContext;
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL test__request_worker (void* ptr)
+{
+  TestContext* ctx = ptr;
+
+  // don't wait on a semaphore, the response shall be ready
+  // while the AIO thread still finishes the event of the request
+  while (!ctx->done)
+  {
+    if (ctx->requests)
+    {
+      volatile number_t delay;
+
+      __sync_fetch_and_sub (&(ctx->requests), 1);
+
+      // vary the time until the response is ready
+      // -> hits the AIO thread at different steps of finishing the event
+      for (delay = 0; delay < (number_t)(rand () % 200); delay++);
+
+      // the worker has a response ready, like a qwebs request
+      cape_aio_socket_markSent (ctx->socket, ctx->aio);
+    }
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL test__on_recv (void* ptr, CapeAioSocket socket, const char* bufdat, number_t buflen)
+{
+  TestContext* ctx = ptr;
+
+  cape_mutex_lock (ctx->mutex);
+
+  ctx->pending += buflen;
+
+  cape_mutex_unlock (ctx->mutex);
+
+  __sync_fetch_and_add (&(ctx->requests), buflen);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL test__on_sent (void* ptr, CapeAioSocket socket, void* userdata)
+{
+  TestContext* ctx = ptr;
+  int send_next = FALSE;
+
+  cape_mutex_lock (ctx->mutex);
+
+  if (ctx->pending)
+  {
+    ctx->pending--;
+    send_next = TRUE;
+  }
+
+  cape_mutex_unlock (ctx->mutex);
+
+  if (send_next)
+  {
+    cape_aio_socket_send (socket, ctx->aio, "r", 1, NULL);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL test__aio_worker (void* ptr)
+{
+  TestContext* ctx = ptr;
+  CapeErr err = cape_err_new ();
+
+  while (!ctx->done)
+  {
+    cape_aio_context_next (ctx->aio, 100, err);
+  }
+
+  cape_err_del (&err);
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+int test01_mark_sent (number_t requests)
+{
+  int ret = 0;
+  number_t i;
+  int fds[2];
+
+  CapeErr err = cape_err_new ();
+  CapeThread thread = cape_thread_new ();
+  CapeThread worker = cape_thread_new ();
+
+  TestContext ctx;
+
+  ctx.aio = cape_aio_context_new ();
+  ctx.mutex = cape_mutex_new ();
+  ctx.pending = 0;
+  ctx.requests = 0;
+  ctx.done = FALSE;
+
+  if (cape_aio_context_open (ctx.aio, err))
+  {
+    printf ("ERROR: %s\n", cape_err_text (err));
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  if (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+  {
+    printf ("ERROR: can't create the socket pair\n");
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  {
+    CapeAioSocket socket = cape_aio_socket_new ((void*)(number_t)fds[0]);
+
+    cape_aio_socket_callback (socket, &ctx, test__on_sent, test__on_recv, NULL);
+
+    ctx.socket = socket;
+
+    cape_aio_socket_add_r (&socket, ctx.aio);
+  }
+
+  cape_thread_start (thread, test__aio_worker, &ctx);
+  cape_thread_start (worker, test__request_worker, &ctx);
+
+  // keep-alive: one request and wait for its response
+  for (i = 0; i < requests; i++)
+  {
+    char c = 'q';
+    struct pollfd pfd;
+
+    if (write (fds[1], &c, 1) != 1)
+    {
+      printf ("ERROR: can't write request #%lu\n", i);
+      ret = 1;
+      break;
+    }
+
+    pfd.fd = fds[1];
+    pfd.events = POLLIN;
+
+    if (poll (&pfd, 1, 2000) != 1)
+    {
+      printf ("ERROR: no response for request #%lu\n", i);
+      ret = 1;
+      break;
+    }
+
+    if (read (fds[1], &c, 1) != 1 || c != 'r')
+    {
+      printf ("ERROR: wrong response for request #%lu\n", i);
+      ret = 1;
+      break;
+    }
+  }
+
+  ctx.done = TRUE;
+
+  cape_thread_join (thread);
+  cape_thread_join (worker);
+
+  close (fds[1]);
+
+exit_and_cleanup:
+
+  cape_aio_context_del (&(ctx.aio));
+  cape_mutex_del (&(ctx.mutex));
+
+  cape_thread_del (&worker);
+  cape_thread_del (&thread);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeAioContext aio;
+
+  CapeAioHandle aioh;
+
+  int fd;
+
+  number_t events;
+
+} TestModContext;
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL test__mod_worker (void* ptr)
+{
+  TestModContext* ctx = ptr;
+
+  // wants to write while the AIO thread is still in the event
+  cape_aio_context_mod (ctx->aio, ctx->aioh, (void*)(number_t)ctx->fd, CAPE_AIO_WRITE | CAPE_AIO_READ, 0);
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL test__mod_on_event (void* ptr, int hflags, unsigned long events, unsigned long param1)
+{
+  TestModContext* ctx = ptr;
+
+  ctx->events++;
+
+  if (ctx->events == 1)
+  {
+    char c;
+
+    CapeThread thread = cape_thread_new ();
+
+    if (read (ctx->fd, &c, 1) != 1)
+    {
+      printf ("ERROR: can't read the request\n");
+    }
+
+    // the worker finishes before the event does
+    cape_thread_start (thread, test__mod_worker, ctx);
+    cape_thread_join (thread);
+
+    cape_thread_del (&thread);
+  }
+
+  // the event itself only wants to read further
+  return CAPE_AIO_READ;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL test__mod_on_unref (void* ptr, CapeAioHandle aioh, int force_close)
+{
+  cape_aio_handle_del (&aioh);
+}
+
+//-----------------------------------------------------------------------------
+
+int test02_context_mod ()
+{
+  int ret = 0;
+  number_t i;
+  int fds[2];
+
+  CapeErr err = cape_err_new ();
+
+  TestModContext ctx;
+
+  ctx.aio = cape_aio_context_new ();
+  ctx.events = 0;
+
+  if (cape_aio_context_open (ctx.aio, err))
+  {
+    printf ("ERROR: %s\n", cape_err_text (err));
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  if (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+  {
+    printf ("ERROR: can't create the socket pair\n");
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  ctx.fd = fds[0];
+  ctx.aioh = cape_aio_handle_new (CAPE_AIO_READ, &ctx, test__mod_on_event, test__mod_on_unref);
+
+  cape_aio_context_add (ctx.aio, ctx.aioh, (void*)(number_t)fds[0], 0);
+
+  if (write (fds[1], "q", 1) != 1)
+  {
+    printf ("ERROR: can't write the request\n");
+    ret = 1;
+  }
+
+  // there is nothing more to read
+  // -> the second event can only be the write event of the worker
+  for (i = 0; (ret == 0) && (i < 20) && (ctx.events < 2); i++)
+  {
+    cape_aio_context_next (ctx.aio, 100, err);
+  }
+
+  if (ctx.events < 2)
+  {
+    printf ("ERROR: the write flag of the worker got lost\n");
+    ret = 1;
+  }
+
+  close (fds[0]);
+  close (fds[1]);
+
+exit_and_cleanup:
+
+  cape_aio_context_del (&(ctx.aio));
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  res |= test01_mark_sent (50000);
+
+  res |= test02_context_mod ();
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+#include "stc/cape_arena.h"
+#include "stc/cape_str.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+
+int test01_sub (CapeArena arena)
+{
+  int ret = 0;
+  number_t i;
+
+  char* values[1000];
+
+  for (i = 0; i < 1000; i++)
+  {
+    CapeString h = cape_str_fmt ("value %lu", i);
+
+    values[i] = cape_arena_sub (arena, h, cape_str_size (h));
+
+    cape_str_del (&h);
+  }
+
+  // all values must still be intact
+  for (i = 0; i < 1000; i++)
+  {
+    CapeString h = cape_str_fmt ("value %lu", i);
+
+    if (!cape_str_equal (h, values[i]))
+    {
+      printf ("ERROR: value %lu differs: '%s'\n", i, values[i]);
+      ret = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_large (CapeArena arena)
+{
+  int ret = 0;
+
+  char* small1 = cape_arena_sub (arena, "small", 5);
+
+  // larger than the block size
+  char* large = cape_arena_alloc (arena, 10000);
+
+  char* small2 = cape_arena_sub (arena, "small", 5);
+
+  memset (large, 'x', 10000);
+
+  if (!cape_str_equal (small1, "small") || !cape_str_equal (small2, "small"))
+  {
+    printf ("ERROR: small values were overwritten\n");
+    ret = 1;
+  }
+
+  if (((number_t)large) % 8)
+  {
+    printf ("ERROR: memory is not aligned\n");
+    ret = 1;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i;
+
+  CapeArena arena = cape_arena_new (1024);
+
+  for (i = 0; i < 3; i++)
+  {
+    res |= test01_sub (arena);
+
+    res |= test02_large (arena);
+
+    cape_arena_clr (arena);
+
+    // only the first block is kept
+    if (cape_arena_size (arena) != 1024)
+    {
+      printf ("ERROR: size after clr is %lu\n", cape_arena_size (arena));
+      res = 1;
+    }
+  }
+
+  cape_arena_del (&arena);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
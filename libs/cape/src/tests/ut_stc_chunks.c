@@ -0,0 +1,139 @@
+#include "stc/cape_chunks.h"
+#include "stc/cape_str.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+
+int test01_append (CapeChunksPool pool, number_t max_bytes)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeChunks chunks = cape_chunks_new (pool);
+  CapeStream compare = cape_stream_new ();
+
+  for (i = 0; cape_chunks_size (chunks) < max_bytes; i++)
+  {
+    cape_chunks_append_str (chunks, "line ");
+    cape_chunks_append_n (chunks, i);
+    cape_chunks_append_c (chunks, '\n');
+
+    cape_stream_append_str (compare, "line ");
+    cape_stream_append_n (compare, i);
+    cape_stream_append_c (compare, '\n');
+  }
+
+  {
+    CapeStream s = cape_chunks_to_stream (chunks);
+
+    if (cape_stream_size (s) != cape_stream_size (compare) || memcmp (cape_stream_data (s), cape_stream_data (compare), cape_stream_size (s)))
+    {
+      printf ("ERROR: content differs\n");
+      ret = 1;
+    }
+
+    cape_stream_del (&s);
+  }
+
+  // consume the content in uneven steps
+  {
+    number_t pos = 0;
+
+    while (cape_chunks_size (chunks))
+    {
+      CapeChunksSegment segments[4];
+
+      number_t cnt = cape_chunks_segments (chunks, segments, 4);
+      number_t len = segments[0].buflen > 1000 ? 1000 : segments[0].buflen;
+
+      if (cnt == 0 || memcmp (segments[0].bufdat, cape_stream_data (compare) + pos, len))
+      {
+        printf ("ERROR: segment differs at %lu\n", pos);
+        ret = 1;
+        break;
+      }
+
+      cape_chunks_shift (chunks, len);
+      pos += len;
+    }
+
+    if (pos != cape_stream_size (compare))
+    {
+      printf ("ERROR: shifted %lu <> %lu\n", pos, cape_stream_size (compare));
+      ret = 1;
+    }
+  }
+
+  cape_chunks_del (&chunks);
+  cape_stream_del (&compare);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_pos_set (CapeChunksPool pool)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeChunks chunks = cape_chunks_new (pool);
+
+  for (i = 0; i < 100; i++)
+  {
+    number_t free_bytes;
+    char* pos = cape_chunks_pos (chunks, &free_bytes);
+
+    // write directly into the chunk
+    number_t len = free_bytes > 700 ? 700 : free_bytes;
+
+    memset (pos, 'a' + (i % 26), len);
+
+    cape_chunks_set (chunks, len);
+  }
+
+  {
+    CapeChunksSegment segments[100];
+
+    number_t cnt = cape_chunks_segments (chunks, segments, 100);
+    number_t total = 0;
+
+    for (i = 0; i < cnt; i++)
+    {
+      total += segments[i].buflen;
+    }
+
+    if (total != cape_chunks_size (chunks))
+    {
+      printf ("ERROR: segments %lu <> %lu\n", total, cape_chunks_size (chunks));
+      ret = 1;
+    }
+  }
+
+  cape_chunks_del (&chunks);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  CapeChunksPool pool = cape_chunks_pool_new (1024, 16);
+
+  res |= test01_append (NULL, 100000);
+
+  res |= test01_append (pool, 100000);
+
+  res |= test02_pos_set (pool);
+
+  cape_chunks_pool_del (&pool);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
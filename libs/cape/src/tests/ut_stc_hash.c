@@ -0,0 +1,265 @@
+#include "stc/cape_hash.h"
+#include "stc/cape_map.h"
+#include "stc/cape_str.h"
+#include "sys/cape_time.h"
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------------
+
+static number_t destroyed = 0;
+
+void __STDCALL string__on_del (void* key, void* val)
+{
+  {
+    CapeString h = key; cape_str_del (&h);
+  }
+  {
+    CapeString h = val; cape_str_del (&h);
+  }
+
+  destroyed++;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test01_insert_find (number_t max_entries)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeHash h = cape_hash_new (NULL, NULL, string__on_del, NULL);
+
+  destroyed = 0;
+
+  for (i = 0; i < max_entries; i++)
+  {
+    cape_hash_insert (h, cape_str_n (i), cape_str_n (i * 2));
+  }
+
+  if (cape_hash_size (h) != max_entries)
+  {
+    printf ("ERROR: size %lu <> %lu\n", cape_hash_size (h), max_entries);
+    ret = 1;
+  }
+
+  for (i = 0; i < max_entries; i++)
+  {
+    CapeString key = cape_str_n (i);
+
+    CapeHashNode n = cape_hash_find (h, key);
+    if (n == NULL || cape_str_to_n (cape_hash_node_value (n)) != i * 2)
+    {
+      printf ("ERROR: key '%s' not found\n", key);
+      ret = 1;
+    }
+
+    cape_str_del (&key);
+  }
+
+  // erase all even keys
+  for (i = 0; i < max_entries; i += 2)
+  {
+    CapeString key = cape_str_n (i);
+
+    cape_hash_erase (h, cape_hash_find (h, key));
+
+    cape_str_del (&key);
+  }
+
+  // the odd keys must survive the deleted slots
+  for (i = 0; i < max_entries; i++)
+  {
+    CapeString key = cape_str_n (i);
+
+    CapeHashNode n = cape_hash_find (h, key);
+    if ((i % 2 == 0) != (n == NULL))
+    {
+      printf ("ERROR: key '%s' has wrong state after erase\n", key);
+      ret = 1;
+    }
+
+    cape_str_del (&key);
+  }
+
+  cape_hash_del (&h);
+
+  if (destroyed != max_entries)
+  {
+    printf ("ERROR: destroyed %lu <> %lu\n", destroyed, max_entries);
+    ret = 1;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_cursor_erase (number_t max_entries)
+{
+  int ret = 0;
+  number_t cnt = 0;
+  number_t i;
+
+  CapeHashCursor cursor;
+  CapeHash h = cape_hash_new (cape_hash__hash__n, cape_map__compare__n, NULL, NULL);
+
+  for (i = 0; i < max_entries; i++)
+  {
+    cape_hash_insert (h, (void*)i, NULL);
+  }
+
+  cape_hash_cursor_init (h, &cursor);
+
+  while (cape_hash_cursor_next (h, &cursor))
+  {
+    if ((number_t)cape_hash_node_key (cursor.node) % 3 == 0)
+    {
+      cape_hash_cursor_erase (h, &cursor);
+    }
+
+    cnt++;
+  }
+
+  if (cnt != max_entries)
+  {
+    printf ("ERROR: cursor visited %lu <> %lu\n", cnt, max_entries);
+    ret = 1;
+  }
+
+  if (cape_hash_size (h) != max_entries - (max_entries + 2) / 3)
+  {
+    printf ("ERROR: size after erase %lu\n", cape_hash_size (h));
+    ret = 1;
+  }
+
+  cape_hash_del (&h);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test03_sync (number_t max_entries)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeHashSync h = cape_hash_sync_new (NULL, NULL, string__on_del, NULL, 8);
+
+  for (i = 0; i < max_entries; i++)
+  {
+    cape_hash_sync_insert (h, cape_str_uuid (), NULL);
+  }
+
+  {
+    CapeString key = cape_str_cp ("test");
+
+    cape_hash_sync_insert (h, key, cape_str_cp ("value"));
+
+    {
+      CapeString val = cape_hash_sync_ext (h, "test");
+
+      if (!cape_str_equal (val, "value"))
+      {
+        printf ("ERROR: sync extract failed\n");
+        ret = 1;
+      }
+
+      cape_str_del (&val);
+    }
+  }
+
+  if (cape_hash_sync_size (h) != max_entries)
+  {
+    printf ("ERROR: sync size %lu <> %lu\n", cape_hash_sync_size (h), max_entries);
+    ret = 1;
+  }
+
+  cape_hash_sync_del (&h);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+void test04_bench (number_t max_entries, number_t runs)
+{
+  number_t i, j;
+
+  CapeString* keys = CAPE_ALLOC (max_entries * sizeof(CapeString));
+
+  CapeMap m = cape_map_new (NULL, NULL, NULL);
+  CapeHash h = cape_hash_new (NULL, NULL, NULL, NULL);
+
+  CapeStopTimer t_map = cape_stoptimer_new ();
+  CapeStopTimer t_hash = cape_stoptimer_new ();
+
+  for (i = 0; i < max_entries; i++)
+  {
+    keys[i] = cape_str_uuid ();
+
+    cape_map_insert (m, keys[i], NULL);
+    cape_hash_insert (h, keys[i], NULL);
+  }
+
+  cape_stoptimer_start (t_map);
+
+  for (j = 0; j < runs; j++)
+  {
+    for (i = 0; i < max_entries; i++)
+    {
+      cape_map_find (m, keys[i]);
+    }
+  }
+
+  cape_stoptimer_stop (t_map);
+
+  cape_stoptimer_start (t_hash);
+
+  for (j = 0; j < runs; j++)
+  {
+    for (i = 0; i < max_entries; i++)
+    {
+      cape_hash_find (h, keys[i]);
+    }
+  }
+
+  cape_stoptimer_stop (t_hash);
+
+  printf ("find %lu keys x %lu: cape_map_find = %.3f ms, cape_hash_find = %.3f ms\n", max_entries, runs, cape_stoptimer_get (t_map), cape_stoptimer_get (t_hash));
+
+  cape_stoptimer_del (&t_map);
+  cape_stoptimer_del (&t_hash);
+
+  cape_map_del (&m);
+  cape_hash_del (&h);
+
+  for (i = 0; i < max_entries; i++)
+  {
+    cape_str_del (&(keys[i]));
+  }
+
+  CAPE_FREE (keys);
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  res |= test01_insert_find (10000);
+
+  res |= test02_cursor_erase (1000);
+
+  res |= test03_sync (1000);
+
+  test04_bench (100, 10000);
+
+  test04_bench (100000, 10);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
@@ -1,19 +1,344 @@
 #include "stc/cape_str.h"
+#include "stc/cape_udc.h"
+#include "fmt/cape_json.h"
+#include "sys/cape_thread.h"
 #include <stdio.h>
 #include <limits.h>
 
+//-----------------------------------------------------------------------------------
+
+int test01_cow_node ()
+{
+  int ret = 0;
+
+  CapeUdc origin = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc copy;
+
+  cape_udc_add_s_cp (origin, "name", "test");
+
+  {
+    CapeUdc sub = cape_udc_add_node (origin, "sub");
+
+    cape_udc_add_n (sub, "id", 1);
+    cape_udc_add_list (sub, "items");
+  }
+
+  copy = cape_udc_share (origin);
+
+  // change the copy in the second level
+  cape_udc_put_n (cape_udc_get (copy, "sub"), "id", 2);
+  cape_udc_add_s_cp (cape_udc_get_list (cape_udc_get (copy, "sub"), "items"), NULL, "item");
+  cape_udc_put_s_cp (copy, "name", "copy");
+
+  if (cape_udc_get_n (cape_udc_get (origin, "sub"), "id", 0) != 1 || cape_udc_get_n (cape_udc_get (copy, "sub"), "id", 0) != 2)
+  {
+    printf ("ERROR: node was changed in the original\n");
+    ret = 1;
+  }
+
+  if (cape_udc_size (cape_udc_get_list (cape_udc_get (origin, "sub"), "items")) != 0)
+  {
+    printf ("ERROR: list was changed in the original\n");
+    ret = 1;
+  }
+
+  if (!cape_str_equal (cape_udc_get_s (origin, "name", NULL), "test"))
+  {
+    printf ("ERROR: string was changed in the original\n");
+    ret = 1;
+  }
+
+  // the original is released first
+  cape_udc_del (&origin);
+
+  if (cape_udc_get_n (cape_udc_get (copy, "sub"), "id", 0) != 2)
+  {
+    printf ("ERROR: copy lost its content\n");
+    ret = 1;
+  }
+
+  cape_udc_del (&copy);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_cow_cursor (number_t copies)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeUdc origin = cape_json_from_s ("{\"list\":[{\"a\":1},{\"a\":2},{\"a\":3}],\"b\":{\"c\":\"d\"}}");
+  CapeString origin_json = cape_json_to_s (origin);
+
+  CapeUdc* list = CAPE_ALLOC (copies * sizeof(CapeUdc));
+
+  for (i = 0; i < copies; i++)
+  {
+    list[i] = cape_udc_share (origin);
+
+    if (!cape_udc_equal (origin, list[i]))
+    {
+      printf ("ERROR: copy is not equal\n");
+      ret = 1;
+    }
+  }
+
+  // change every second copy with a cursor
+  for (i = 0; i < copies; i += 2)
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (cape_udc_get (list[i], "list"), CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      cape_udc_put_n (cursor->item, "a", i);
+    }
+
+    cape_udc_cursor_del (&cursor);
+
+    cape_udc_rm (cape_udc_get (list[i], "b"), "c");
+  }
+
+  {
+    CapeString h = cape_json_to_s (origin);
+
+    if (!cape_str_equal (h, origin_json))
+    {
+      printf ("ERROR: original was changed: %s\n", h);
+      ret = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  for (i = 1; i < copies; i += 2)
+  {
+    CapeString h = cape_json_to_s (list[i]);
+
+    if (!cape_str_equal (h, origin_json))
+    {
+      printf ("ERROR: unchanged copy differs: %s\n", h);
+      ret = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  cape_udc_del (&origin);
+
+  for (i = 0; i < copies; i++)
+  {
+    cape_udc_del (&(list[i]));
+  }
+
+  CAPE_FREE (list);
+  cape_str_del (&origin_json);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test03_cp_kept_child ()
+{
+  int ret = 0;
+
+  CapeUdc origin = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc copy;
+
+  // children which are kept by the caller
+  CapeUdc h = cape_udc_add_node (origin, "sub");
+  CapeUdc s = cape_udc_add_s_cp (origin, "name", "test");
+
+  cape_udc_add_n (h, "id", 1);
+
+  copy = cape_udc_cp (origin);
+
+  // change the kept children of the original
+  cape_udc_add_n (h, "state", 2);
+  cape_udc_set_s_cp (s, "changed");
+
+  if (cape_udc_get (cape_udc_get (copy, "sub"), "state") || !cape_str_equal (cape_udc_get_s (copy, "name", NULL), "test"))
+  {
+    printf ("ERROR: copy was changed by a kept child of the original\n");
+    ret = 1;
+  }
+
+  cape_udc_del (&origin);
+
+  if (cape_udc_get_n (cape_udc_get (copy, "sub"), "id", 0) != 1 || cape_udc_get (cape_udc_get (copy, "sub"), "state") || !cape_str_equal (cape_udc_get_s (copy, "name", NULL), "test"))
+  {
+    printf ("ERROR: copy differs after the original was released\n");
+    ret = 1;
+  }
+
+  cape_udc_del (&copy);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeUdc shared;
+
+  const CapeString json;
+
+  int errors;
+
+} Test04Ctx;
+
+//-----------------------------------------------------------------------------------
+
+static int __STDCALL test04_worker (void* ptr)
+{
+  Test04Ctx* ctx = ptr;
+  number_t i;
+
+  for (i = 0; i < 10000; i++)
+  {
+    number_t sum = 0;
+
+    // read the nested children without changing the object
+    CapeUdc list = cape_udc_get_r (ctx->shared, "list");
+
+    if (list)
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new_r (list, CAPE_DIRECTION_FORW);
+
+      while (cape_udc_cursor_next (cursor))
+      {
+        sum += cape_udc_get_n (cursor->item, "a", 0);
+      }
+
+      cape_udc_cursor_del (&cursor);
+    }
+
+    if (sum != 6 || !cape_str_equal (cape_udc_get_s (cape_udc_get_r (ctx->shared, "b"), "c", NULL), "d"))
+    {
+      ctx->errors++;
+    }
+
+    if (i % 100 == 0)
+    {
+      CapeString h = cape_json_to_s (ctx->shared);
+
+      if (!cape_str_equal (h, ctx->json))
+      {
+        ctx->errors++;
+      }
+
+      cape_str_del (&h);
+    }
+  }
+
+  // run only once
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test04_share_threads (number_t max_threads)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeUdc origin = cape_json_from_s ("{\"list\":[{\"a\":1},{\"a\":2},{\"a\":3}],\"b\":{\"c\":\"d\"}}");
+  CapeString json = cape_json_to_s (origin);
+
+  Test04Ctx* ctxs = CAPE_ALLOC (max_threads * sizeof(Test04Ctx));
+  CapeThread* threads = CAPE_ALLOC (max_threads * sizeof(CapeThread));
+
+  CapeUdc shared = cape_udc_share (origin);
+
+  for (i = 0; i < max_threads; i++)
+  {
+    ctxs[i].shared = shared;
+    ctxs[i].json = json;
+    ctxs[i].errors = 0;
+
+    threads[i] = cape_thread_new ();
+    cape_thread_start (threads[i], test04_worker, &(ctxs[i]));
+  }
+
+  // change the original while the shared copy is read
+  for (i = 0; i < 1000; i++)
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (cape_udc_get (origin, "list"), CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      cape_udc_put_n (cursor->item, "a", i);
+    }
+
+    cape_udc_cursor_del (&cursor);
+
+    cape_udc_put_s_cp (cape_udc_get (origin, "b"), "c", "e");
+  }
+
+  for (i = 0; i < max_threads; i++)
+  {
+    cape_thread_join (threads[i]);
+    cape_thread_del (&(threads[i]));
+
+    if (ctxs[i].errors)
+    {
+      printf ("ERROR: thread %lu read %i wrong values\n", i, ctxs[i].errors);
+      ret = 1;
+    }
+  }
+
+  cape_udc_del (&origin);
+
+  {
+    CapeString h = cape_json_to_s (shared);
+
+    if (!cape_str_equal (h, json))
+    {
+      printf ("ERROR: shared copy was changed: %s\n", h);
+      ret = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  cape_udc_del (&shared);
+  cape_str_del (&json);
+
+  CAPE_FREE (threads);
+  CAPE_FREE (ctxs);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
 int main (int argc, char *argv[])
 {
+  int res = 0;
+
   long long test = 82361783681;
-  
+
   CapeString h = cape_str_fmt ("%lld", test);
-  
+
   if (h)
   {
     printf ("%s\n", h);
   }
-  
-  return 0;
-}
 
+  cape_str_del (&h);
+
+  res |= test01_cow_node ();
+
+  res |= test02_cow_cursor (10);
+
+  res |= test03_cp_kept_child ();
+
+  res |= test04_share_threads (4);
+
+  return res;
+}
 
+//-----------------------------------------------------------------------------------
@@ -0,0 +1,191 @@
+#include "sys/cape_rand.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_mutex.h"
+#include "stc/cape_hash.h"
+#include "stc/cape_str.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+
+int test01_uuid_format (number_t max_entries)
+{
+  int ret = 0;
+  number_t i;
+
+  for (i = 0; i < max_entries; i++)
+  {
+    CapeString h = cape_str_uuid ();
+
+    CapeUuid uuid;
+    char buffer [CAPE_UUID_HEX_LENGTH + 1];
+
+    if (strlen (h) != CAPE_UUID_HEX_LENGTH || h[14] != '4' || strchr ("89AB", h[19]) == NULL)
+    {
+      printf ("ERROR: wrong format '%s'\n", h);
+      ret = 1;
+    }
+
+    // the parsed binary form must result in the same string
+    if (!cape_uuid_parse (&uuid, h))
+    {
+      printf ("ERROR: can't parse '%s'\n", h);
+      ret = 1;
+    }
+
+    cape_uuid_hex (&uuid, buffer);
+
+    if (!cape_str_equal (h, buffer))
+    {
+      printf ("ERROR: '%s' <> '%s'\n", h, buffer);
+      ret = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  {
+    CapeUuid uuid;
+
+    if (cape_uuid_parse (&uuid, "0000") || cape_uuid_parse (&uuid, "G0000000-0000-4000-8000-000000000000"))
+    {
+      printf ("ERROR: invalid uuid was parsed\n");
+      ret = 1;
+    }
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static CapeHash uuids = NULL;
+static CapeMutex mutex = NULL;
+static number_t duplicates = 0;
+
+//-----------------------------------------------------------------------------------
+
+static void __STDCALL uuid__on_del (void* key, void* val)
+{
+  CapeUuid* h = key; CAPE_DEL (&h, CapeUuid);
+}
+
+//-----------------------------------------------------------------------------------
+
+static int __STDCALL test02_worker (void* ptr)
+{
+  number_t i;
+
+  for (i = 0; i < 10000; i++)
+  {
+    CapeUuid* uuid = CAPE_NEW (CapeUuid);
+
+    cape_uuid_gen (uuid);
+
+    cape_mutex_lock (mutex);
+
+    if (cape_hash_insert (uuids, uuid, NULL) == NULL)
+    {
+      duplicates++;
+      CAPE_DEL (&uuid, CapeUuid);
+    }
+
+    cape_mutex_unlock (mutex);
+  }
+
+  // run only once
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_threads (number_t max_threads)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeThread* threads = CAPE_ALLOC (max_threads * sizeof(CapeThread));
+
+  uuids = cape_hash_new (cape_uuid__hash, cape_uuid__compare, uuid__on_del, NULL);
+  mutex = cape_mutex_new ();
+
+  for (i = 0; i < max_threads; i++)
+  {
+    threads[i] = cape_thread_new ();
+    cape_thread_start (threads[i], test02_worker, NULL);
+  }
+
+  for (i = 0; i < max_threads; i++)
+  {
+    cape_thread_join (threads[i]);
+    cape_thread_del (&(threads[i]));
+  }
+
+  if (duplicates || cape_hash_size (uuids) != max_threads * 10000)
+  {
+    printf ("ERROR: duplicates %lu, size %lu\n", duplicates, cape_hash_size (uuids));
+    ret = 1;
+  }
+
+  cape_hash_del (&uuids);
+  cape_mutex_del (&mutex);
+
+  CAPE_FREE (threads);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test03_range (number_t max_entries)
+{
+  int ret = 0;
+  number_t i;
+
+  number_t hits[10];
+
+  memset (hits, 0, sizeof(hits));
+
+  for (i = 0; i < max_entries; i++)
+  {
+    number_t n = cape_rand_n (0, 9);
+
+    if (n >= 10)
+    {
+      printf ("ERROR: %lu out of range\n", n);
+      return 1;
+    }
+
+    hits[n]++;
+  }
+
+  for (i = 0; i < 10; i++)
+  {
+    // very rough check for the distribution
+    if (hits[i] < max_entries / 20)
+    {
+      printf ("ERROR: value %lu was only hit %lu times\n", i, hits[i]);
+      ret = 1;
+    }
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  res |= test01_uuid_format (10000);
+
+  res |= test02_threads (8);
+
+  res |= test03_range (100000);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #include "stc/cape_list.h"
 #include "sys/cape_mutex.h"
 #include "stc/cape_stream.h"
+#include "stc/cape_chunks.h"
 #include "sys/cape_log.h"
 
 //-----------------------------------------------------------------------------
@@ -31,6 +32,8 @@ struct QBusConnection_s
   // out 
   
   CapeList cache_qeue;
+
+  CapeChunksPool chunks_pool;
   
   CapeMutex mutex;  
 };
@@ -39,7 +42,7 @@ struct QBusConnection_s
 
 static void __STDCALL qbus_connection_cache_onDel (void* ptr)
 {
-  CapeStream cs = ptr; cape_stream_del (&cs);
+  CapeChunks chunks = ptr; cape_chunks_del (&chunks);
 }
 
 //-----------------------------------------------------------------------------
@@ -50,6 +53,9 @@ QBusConnection qbus_connection_new (QBusRoute route, number_t channels)
   
   self->cache_qeue = cape_list_new (qbus_connection_cache_onDel);
   self->mutex = cape_mutex_new (); 
+
+  // keep some chunks for the next frames
+  self->chunks_pool = cape_chunks_pool_new (0, 4);
   
   // initial frame
   self->frame = qbus_frame_new ();
@@ -72,6 +78,9 @@ void qbus_connection_del (QBusConnection* p_self)
   
   cape_list_del (&(self->cache_qeue));
   cape_mutex_del (&(self->mutex));
+
+  // after the cache queue, all chunks must be returned first
+  cape_chunks_pool_del (&(self->chunks_pool));
   
   qbus_frame_del (&(self->frame));
   
@@ -125,7 +134,7 @@ const CapeString qbus_connection__uuid (QBusConnection self)
 
 void qbus_connection_onSent (QBusConnection self, void* userdata)
 {
-  CapeStream cs;
+  CapeChunks chunks;
   
   if (userdata)
   {
@@ -135,14 +144,14 @@ void qbus_connection_onSent (QBusConnection self, void* userdata)
   cape_mutex_lock (self->mutex);
   
   // extract the first element from the queue cache
-  cs = cape_list_pop_front (self->cache_qeue);
+  chunks = cape_list_pop_front (self->cache_qeue);
   
   cape_mutex_unlock (self->mutex);
   
-  if (cs)
+  if (chunks)
   {
     // finally send the buffer content to the unerlaying engine
-    self->fct_send (self->ptr1, self->ptr2, cape_stream_data(cs), cape_stream_size(cs), cs);
+    self->fct_send (self->ptr1, self->ptr2, chunks, chunks);
   }
 }
 
@@ -172,11 +181,11 @@ void qbus_connection_send (QBusConnection self, QBusFrame* p_frame)
 {
   number_t queue_size;
   
-  // create a new buffer stream
-  CapeStream cs = cape_stream_new ();
+  // create a new buffer, the content of the frame is not copied into one contiguous block
+  CapeChunks chunks = cape_chunks_new (self->chunks_pool);
 
   // encode (stringify) the frame
-  qbus_frame_encode (*p_frame, cs);
+  qbus_frame_encode_chunks (*p_frame, chunks);
 
   // cleanup the frame  
   qbus_frame_del (p_frame);
@@ -187,8 +196,8 @@ void qbus_connection_send (QBusConnection self, QBusFrame* p_frame)
   // get the current queue size
   queue_size = cape_list_size (self->cache_qeue);
 
-  // add the stream buffer to the queue
-  cape_list_push_back (self->cache_qeue, (void*)cs);
+  // add the buffer to the queue
+  cape_list_push_back (self->cache_qeue, (void*)chunks);
   
   // leave monitor
   cape_mutex_unlock (self->mutex);
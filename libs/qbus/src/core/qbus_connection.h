@@ -24,7 +24,7 @@ __CAPE_LIBEX   void              qbus_connection_send     (QBusConnection, QBusF
 
 //-----------------------------------------------------------------------------
 
-typedef void (__STDCALL *fct_qbus_connection_send) (void* ptr1, void* ptr2, const char* bufdat, number_t buflen, void* userdata);
+typedef void (__STDCALL *fct_qbus_connection_send) (void* ptr1, void* ptr2, CapeChunks chunks, void* userdata);
 typedef void (__STDCALL *fct_qbus_connection_mark) (void* ptr1, void* ptr2);
 
 __CAPE_LIBEX   void              qbus_connection_cb       (QBusConnection, void* ptr1, void* ptr2, fct_qbus_connection_send, fct_qbus_connection_mark);
@@ -266,14 +266,14 @@ int qbus_engine_ctx_del (QBusEngine self, QbusPvdCtx* p_ctx, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
-void __STDCALL qbus_engine__send (void* ptr1, void* ptr2, const char* bufdat, number_t buflen, void* userdata)
+void __STDCALL qbus_engine__send (void* ptr1, void* ptr2, CapeChunks chunks, void* userdata)
 {
   QBusEngine self = ptr1;
   QbusPvdConnection connection = ptr2;
   
   if (self->functions.pvd_send)
   {
-    self->functions.pvd_send (connection, bufdat, buflen, userdata);
+    self->functions.pvd_send (connection, chunks, userdata);
   }
 }
 
@@ -507,10 +507,8 @@ int qbus_frame_decode (QBusFrame self, const char* bufdat, number_t buflen, numb
 
 //-----------------------------------------------------------------------------
 
-void qbus_frame_encode (QBusFrame self, CapeStream cs)
+static void qbus_frame__encode_header (QBusFrame self, CapeStream cs)
 {
-  cape_stream_clr (cs);
-  
   // P1
   cape_stream_append_c (cs, QBUS_SE_STATE__P1);
   cape_stream_append_n (cs, self->ftype);
@@ -550,6 +548,16 @@ void qbus_frame_encode (QBusFrame self, CapeStream cs)
   
   // CO
   cape_stream_append_c (cs, QBUS_SE_STATE__CO);
+}
+
+//-----------------------------------------------------------------------------
+
+void qbus_frame_encode (QBusFrame self, CapeStream cs)
+{
+  cape_stream_clr (cs);
+
+  qbus_frame__encode_header (self, cs);
+
   if (self->msg_data)
   {
     cape_stream_append_buf (cs, self->msg_data, self->msg_size);
@@ -558,3 +566,21 @@ void qbus_frame_encode (QBusFrame self, CapeStream cs)
 
 //-----------------------------------------------------------------------------
 
+void qbus_frame_encode_chunks (QBusFrame self, CapeChunks chunks)
+{
+  CapeStream cs = cape_stream_new ();
+
+  qbus_frame__encode_header (self, cs);
+
+  cape_chunks_append_stream (chunks, cs);
+
+  if (self->msg_data)
+  {
+    cape_chunks_append_buf (chunks, self->msg_data, self->msg_size);
+  }
+
+  cape_stream_del (&cs);
+}
+
+//-----------------------------------------------------------------------------
+
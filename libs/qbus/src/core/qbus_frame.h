@@ -4,6 +4,7 @@
 #include "sys/cape_export.h"
 #include "sys/cape_err.h"
 #include "stc/cape_stream.h"
+#include "stc/cape_chunks.h"
 
 #include "qbus_route.h"
 
@@ -67,6 +68,9 @@ __CAPE_LIBEX   int               qbus_frame_decode        (QBusFrame, const char
 
 __CAPE_LIBEX   void              qbus_frame_encode        (QBusFrame, CapeStream cs);
 
+                                 /* appends the encoded frame, the content doesn't need to fit into one contiguous buffer */
+__CAPE_LIBEX   void              qbus_frame_encode_chunks (QBusFrame, CapeChunks chunks);
+
 //=============================================================================
 
 #endif
@@ -8,6 +8,7 @@
 #include "sys/cape_mutex.h"
 #include "sys/cape_log.h"
 #include "stc/cape_map.h"
+#include "stc/cape_hash.h"
 #include "fmt/cape_json.h"
 #include "sys/cape_queue.h"
 
@@ -63,11 +64,9 @@ struct QBusRoute_s
   CapeString name;
   CapeString uuid;
   
-  CapeMap methods;
+  CapeHash methods;
   
-  CapeMap chains;
-  
-  CapeMutex chain_mutex;
+  CapeHashSync chains;
   
   QBusRouteItems route_items;  
   
@@ -103,10 +102,11 @@ QBusRoute qbus_route_new (QBus qbus, const CapeString name)
   self->name = cape_str_cp (name);
   self->uuid = cape_str_uuid ();
   
-  self->methods = cape_map_new (NULL, qbus_route_methods_del, NULL);
+  // methods are stored in lower case, the case insensitive hash avoids a copy for each lookup
+  self->methods = cape_hash_new (cape_hash__hash__s_i, cape_hash__compare__s_i, qbus_route_methods_del, NULL);
   
-  self->chain_mutex = cape_mutex_new ();
-  self->chains = cape_map_new (NULL, qbus_route_methods_del, NULL);
+  // chains are accessed from many threads
+  self->chains = cape_hash_sync_new (NULL, NULL, qbus_route_methods_del, NULL, 16);
   
   self->route_items = qbus_route_items_new ();
   
@@ -129,10 +129,9 @@ void qbus_route_del (QBusRoute* p_self)
   cape_str_del (&(self->name));
   cape_str_del (&(self->uuid));
 
-  cape_map_del (&(self->methods));
+  cape_hash_del (&(self->methods));
   
-  cape_mutex_del (&(self->chain_mutex));
-  cape_map_del (&(self->chains));
+  cape_hash_sync_del (&(self->chains));
   
   qbus_route_items_del (&(self->route_items));
   
@@ -369,17 +368,13 @@ void qbus_route_on_msg_foward (QBusRoute self, QBusConnection conn, QBusFrame* p
   // create a new chain key
   chain_key = cape_str_uuid();
   
-  cape_mutex_lock (self->chain_mutex);
-  
   {
     QBusMethod qmeth = qbus_method_new (QBUS_METHOD_TYPE__FORWARD, qbus_fd, NULL, NULL);
     
     // transfer ownership of chain_key to the map
-    cape_map_insert (self->chains, (void*)chain_key, (void*)qmeth);
+    cape_hash_sync_insert (self->chains, (void*)chain_key, (void*)qmeth);
   }
   
-  cape_mutex_unlock (self->chain_mutex);
-  
   // chain key
   {
     CapeString h = cape_str_cp (chain_key);
@@ -403,28 +398,22 @@ void qbus_route_on_msg_foward (QBusRoute self, QBusConnection conn, QBusFrame* p
 QBusMethod qbus_route__find_method (QBusRoute self, const char* method_origin, CapeErr err)
 {
   QBusMethod ret = NULL;
-  CapeMapNode n;
-  
-  // local objects
-  CapeString method = cape_str_cp (method_origin);
-  
-  // convert into lower case
-  cape_str_to_lower (method);
+  CapeHashNode n;
   
   // try to find the method
-  n = cape_map_find (self->methods, method);
+  // -> the hash ignores the case of the method
+  n = cape_hash_find (self->methods, method_origin);
   if (n == NULL)
   {
-    cape_err_set_fmt (err, CAPE_ERR_NOT_FOUND, "method [%s] not found", method);
+    cape_err_set_fmt (err, CAPE_ERR_NOT_FOUND, "method [%s] not found", method_origin);
     goto exit_and_cleanup;
   }
   
   // get the methods object
-  ret = cape_map_node_value (n);
+  ret = cape_hash_node_value (n);
   
 exit_and_cleanup:
   
-  cape_str_del (&method);
   return ret;
 }
 
@@ -625,31 +614,9 @@ void qbus_route__response__method (QBusRoute self, QBusMethod qmeth, QBusFrame*
 
 QBusMethod qbus_route__find_chain (QBusRoute self, const CapeString chain_key)
 {
-  QBusMethod ret = NULL;
-  CapeMapNode n;
-  
-  cape_mutex_lock (self->chain_mutex);
-  
-  n = cape_map_find (self->chains, (void*)chain_key);
-  if (n)
-  {
-    // removes the node from the map, returns the removed node
-    n = cape_map_extract (self->chains, n);
-  }
-    
-  cape_mutex_unlock (self->chain_mutex);
-
-  if (n)
-  {
-    // removes the value from the map-node
-    ret = cape_map_node_mv (n);
-
-    // free memory and the node key
-    // self->chains is thread safe here
-    cape_map_del_node (self->chains, &n);
-  }
-  
-  return ret;
+  // removes the entry and returns the value
+  // -> the key is released by the hash
+  return cape_hash_sync_ext (self->chains, chain_key);
 }
 
 //-----------------------------------------------------------------------------
@@ -712,9 +679,11 @@ CapeUdc qbus_route__generate_modules_list (QBusRoute self)
 
   // iterate through all methods
   {
-    CapeMapCursor* cursor = cape_map_cursor_create (self->methods, CAPE_DIRECTION_FORW);
+    CapeHashCursor cursor;
     
-    while (cape_map_cursor_next (cursor))
+    cape_hash_cursor_init (self->methods, &cursor);
+    
+    while (cape_hash_cursor_next (self->methods, &cursor))
     {
       //QBusMethod qmeth = cape_map_node_value (cursor->node);
      
@@ -724,10 +693,8 @@ CapeUdc qbus_route__generate_modules_list (QBusRoute self)
       
       //cape_udc_add (method_list, &method_node);
       
-      cape_udc_add_s_cp (method_list, NULL, cape_map_node_key (cursor->node));
+      cape_udc_add_s_cp (method_list, NULL, cape_hash_node_key (cursor.node));
     }
-    
-    cape_map_cursor_destroy (&cursor);
   }
 
   return method_list;
@@ -883,7 +850,7 @@ void qbus_route_meth_reg (QBusRoute self, const char* method_origin, void* ptr,
 
   qmeth = qbus_method_new (QBUS_METHOD_TYPE__REQUEST, ptr, onMsg, onRm);
   
-  cape_map_insert (self->methods, (void*)method, (void*)qmeth);
+  cape_hash_insert (self->methods, (void*)method, (void*)qmeth);
 }
 
 //-----------------------------------------------------------------------------
@@ -935,11 +902,7 @@ void qbus_route__add_to_chain (QBusRoute self, void* ptr, fct_qbus_onMessage onM
     qbus_method_continue (qmeth, p_last_chainkey, p_last_sender, p_rinfo);
   }
   
-  cape_mutex_lock (self->chain_mutex);
-  
-  cape_map_insert (self->chains, (void*)cape_str_mv (p_next_chainkey), (void*)qmeth);
-  
-  cape_mutex_unlock (self->chain_mutex);
+  cape_hash_sync_insert (self->chains, (void*)cape_str_mv (p_next_chainkey), (void*)qmeth);
 }
 
 //-----------------------------------------------------------------------------
@@ -1001,7 +964,8 @@ void qbus_route_request__local_request (QBusRoute self, const char* method_origi
     CapeString last_chain_key_copy = cape_str_cp (last_chain_key);
     CapeString last_sender_copy = cape_str_cp (last_sender);
     
-    CapeUdc rinfo_copy = cape_udc_cp (msg->rinfo);
+    // the method changes its rinfo only on write, the chain keeps the original
+    CapeUdc rinfo_copy = cape_udc_share (msg->rinfo);
     
     qbus_route__add_to_chain (self, ptr, onMsg, &last_chain_key_copy, &next_chain_key, &last_sender_copy, &rinfo_copy);
     
@@ -1047,7 +1011,8 @@ void qbus_route_request__local_request (QBusRoute self, const char* method_origi
       cape_str_replace_cp (&(qout->sender), last_sender);
 
       // add rinfo
-      cape_udc_replace_cp (&(qout->rinfo), msg->rinfo);
+      cape_udc_del (&(qout->rinfo));
+      qout->rinfo = cape_udc_share (msg->rinfo);
       
       {
         // create a method object to re-use existing functionality
@@ -1357,16 +1322,12 @@ void qbus_route_methods (QBusRoute self, const char* module, void* ptr, fct_qbus
     qbus_methods->ptr = ptr;
     qbus_methods->on_methods = on_methods;
     
-    cape_mutex_lock (self->chain_mutex);
-    
     {
       QBusMethod qmeth = qbus_method_new (QBUS_METHOD_TYPE__METHODS, qbus_methods, NULL, NULL);
       
       // transfer ownership of chain_key to the map
-      cape_map_insert (self->chains, (void*)chain_key, (void*)qmeth);
+      cape_hash_sync_insert (self->chains, (void*)chain_key, (void*)qmeth);
     }
-    
-    cape_mutex_unlock (self->chain_mutex);
 
     qbus_frame_set (frame, QBUS_FRAME_TYPE_METHODS, chain_key, module, NULL, self->name);
         
@@ -10,9 +10,9 @@
 
 //-----------------------------------------------------------------------------
 
-void __STDCALL qbus_engine_tcp_send (void* ptr1, void* ptr2, const char* bufdat, number_t buflen, void* userdata)
+void __STDCALL qbus_engine_tcp_send (void* ptr1, void* ptr2, CapeChunks chunks, void* userdata)
 {
-  cape_aio_socket_send (ptr2, ptr1, bufdat, buflen, userdata);
+  cape_aio_socket_send_chunks (ptr2, ptr1, chunks, userdata);
 }
 
 //-----------------------------------------------------------------------------
@@ -147,9 +147,9 @@ void qbus_pvd_phy_connection_del (QbusPvdConnection* p_self)
 
 //------------------------------------------------------------------------------------------------------
 
-void __STDCALL qbus_pvd_send (QbusPvdConnection self, const char* bufdat, number_t buflen, void* userdata)
+void __STDCALL qbus_pvd_send (QbusPvdConnection self, CapeChunks chunks, void* userdata)
 {
-  cape_aio_socket_send (self->aio_socket, qbus_pvd_conn_aio (self->conn), bufdat, buflen, userdata);
+  cape_aio_socket_send_chunks (self->aio_socket, qbus_pvd_conn_aio (self->conn), chunks, userdata);
 }
 
 //------------------------------------------------------------------------------------------------------
@@ -23,7 +23,7 @@ __CAPE_LIBEX  int            __STDCALL qbus_pvd_reconnect     (QbusPvdEntity, Ca
 
 //-----------------------------------------------------------------------------
 
-__CAPE_LIBEX  void           __STDCALL qbus_pvd_send          (QbusPvdConnection, const char* bufdat, number_t buflen, void* userdata);
+__CAPE_LIBEX  void           __STDCALL qbus_pvd_send          (QbusPvdConnection, CapeChunks chunks, void* userdata);
 
 __CAPE_LIBEX  void           __STDCALL qbus_pvd_mark          (QbusPvdConnection);
 
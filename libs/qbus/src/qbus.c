@@ -711,13 +711,14 @@ int qbus_message_role_has (QBusM self, const CapeString role_name)
     return FALSE;
   }
   
-  roles = cape_udc_get (self->rinfo, "roles");
+  // read only, a shared rinfo stays shared
+  roles = cape_udc_get_r (self->rinfo, "roles");
   if (roles == NULL)
   {
     return FALSE;
   }
 
-  role = cape_udc_get (roles, role_name);
+  role = cape_udc_get_r (roles, role_name);
   if (role == NULL)
   {
     return FALSE;
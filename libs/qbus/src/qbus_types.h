@@ -53,7 +53,8 @@ typedef int            (__STDCALL *fct_qbus_pvd_reconnect)    (QbusPvdEntity, Ca
 //-----------------------------------------------------------------------------
 // connection functions
 
-typedef void           (__STDCALL *fct_qbus_pvd_send)         (QbusPvdConnection, const char* bufdat, number_t buflen, void* userdata);
+                       /* the chunks are consumed while they are sent, they must be kept until the on sent callback with userdata */
+typedef void           (__STDCALL *fct_qbus_pvd_send)         (QbusPvdConnection, CapeChunks chunks, void* userdata);
 
 typedef void           (__STDCALL *fct_qbus_pvd_mark)         (QbusPvdConnection);
 
@@ -0,0 +1,140 @@
+#include <qbus.h>
+
+// cape includes
+#include <sys/cape_log.h>
+#include <fmt/cape_json.h>
+
+#include <stdio.h>
+
+//-------------------------------------------------------------------------------------
+
+static int g_errors = 0;
+
+static number_t g_responses = 0;
+
+//-------------------------------------------------------------------------------------
+
+static void test__expect (const CapeString where, CapeUdc rinfo, const CapeString expected)
+{
+  CapeString h = cape_json_to_s (rinfo);
+
+  if (!cape_str_equal (h, expected))
+  {
+    printf ("ERROR [%s]: rinfo is %s instead of %s\n", where, h, expected);
+    g_errors++;
+  }
+
+  cape_str_del (&h);
+}
+
+//-------------------------------------------------------------------------------------
+
+static void test__change (CapeUdc rinfo, number_t userid, const CapeString role)
+{
+  // change the top node and a child node
+  cape_udc_put_n (rinfo, "userid", userid);
+  cape_udc_add_n (cape_udc_get (rinfo, "roles"), role, 1);
+}
+
+//-------------------------------------------------------------------------------------
+
+static int __STDCALL test__on_direct (QBus qbus, void* ptr, QBusM qin, QBusM qout, CapeErr err)
+{
+  test__change (qin->rinfo, 1, "direct");
+
+  return CAPE_ERR_NONE;
+}
+
+//-------------------------------------------------------------------------------------
+
+static int __STDCALL test__on_step (QBus qbus, void* ptr, QBusM qin, QBusM qout, CapeErr err)
+{
+  test__expect ("step", qin->rinfo, "{\"roles\":{\"admin\":1,\"main\":1},\"userid\":2}");
+
+  test__change (qin->rinfo, 3, "step");
+
+  return CAPE_ERR_NONE;
+}
+
+//-------------------------------------------------------------------------------------
+
+static int __STDCALL test__on_main__step (QBus qbus, void* ptr, QBusM qin, QBusM qout, CapeErr err)
+{
+  test__expect ("main after step", qin->rinfo, "{\"roles\":{\"admin\":1,\"main\":1,\"step\":1},\"userid\":3}");
+
+  test__change (qin->rinfo, 4, "main_after_step");
+
+  return CAPE_ERR_NONE;
+}
+
+//-------------------------------------------------------------------------------------
+
+static int __STDCALL test__on_main (QBus qbus, void* ptr, QBusM qin, QBusM qout, CapeErr err)
+{
+  // the sender must not see this change, the request kept its own rinfo
+  test__change (qin->rinfo, 2, "main");
+
+  return qbus_continue (qbus, "TEST", "step", qin, NULL, test__on_main__step, err);
+}
+
+//-------------------------------------------------------------------------------------
+
+static int __STDCALL test__on_response (QBus qbus, void* ptr, QBusM qin, QBusM qout, CapeErr err)
+{
+  test__expect ("response", qin->rinfo, ptr);
+
+  g_responses++;
+
+  return CAPE_ERR_NONE;
+}
+
+//-------------------------------------------------------------------------------------
+
+static void test__send (QBus qbus, const CapeString method, const CapeString expected)
+{
+  CapeErr err = cape_err_new ();
+  QBusM msg = qbus_message_new (NULL, NULL);
+
+  msg->rinfo = cape_json_from_s ("{\"userid\":99,\"roles\":{\"admin\":1}}");
+
+  qbus_send (qbus, "TEST", method, msg, (void*)expected, test__on_response, err);
+
+  qbus_message_del (&msg);
+  cape_err_del (&err);
+}
+
+//-------------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  CapeErr err = cape_err_new ();
+
+  // local objects
+  QBus qbus = qbus_new ("test");
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  qbus_register (qbus, "direct"   , NULL, test__on_direct, NULL, err);
+  qbus_register (qbus, "main"     , NULL, test__on_main, NULL, err);
+  qbus_register (qbus, "step"     , NULL, test__on_step, NULL, err);
+
+  // local requests are executed directly
+  // -> the method returns the changed rinfo
+  test__send (qbus, "direct", "{\"roles\":{\"admin\":1,\"direct\":1},\"userid\":1}");
+
+  // -> a continued request returns the rinfo of the original request
+  test__send (qbus, "main", "{\"roles\":{\"admin\":1},\"userid\":99}");
+
+  if (g_responses != 2)
+  {
+    printf ("ERROR: got %lu responses instead of 2\n", g_responses);
+    g_errors++;
+  }
+
+  qbus_del (&qbus);
+  cape_err_del (&err);
+
+  return g_errors ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------------------
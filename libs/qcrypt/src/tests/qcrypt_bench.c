@@ -0,0 +1,101 @@
+#include "qcrypt.h"
+
+// cape includes
+#include "bench/cape_bench.h"
+
+//-----------------------------------------------------------------------------
+
+#define BENCH_BUFFER_SIZE  65536
+
+static CapeStream buffer = NULL;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_base64_encode (CapeBench bench, number_t loops)
+{
+  number_t i;
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeString h = qcrypt__encode_base64_m (buffer);
+
+    cape_str_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_base64_decode (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeString encoded = qcrypt__encode_base64_m (buffer);
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeStream h = qcrypt__decode_base64_s (encoded);
+
+    cape_stream_del (&h);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_str_del (&encoded);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL bench_json_stream_encode (CapeBench bench, number_t loops)
+{
+  number_t i;
+  CapeUdc h = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  // a file upload as it is sent over qbus
+  cape_udc_add_s_cp (h, "name", "document.pdf");
+  cape_udc_add_m_cp (h, "content", buffer);
+
+  cape_bench_start (bench);
+
+  for (i = 0; i < loops; i++)
+  {
+    CapeString s = cape_json_to_s__ex (h, qcrypt__stream_base64_encode);
+
+    cape_str_del (&s);
+  }
+
+  cape_bench_stop (bench);
+
+  cape_udc_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res;
+  number_t i;
+
+  CapeBench bench = cape_bench_new (argc, argv, "qcrypt");
+
+  buffer = cape_stream_new ();
+
+  for (i = 0; i < BENCH_BUFFER_SIZE; i++)
+  {
+    cape_stream_append_c (buffer, (char)(rand () & 0xff));
+  }
+
+  cape_bench_run (bench, "base64.encode", 2000, bench_base64_encode);
+  cape_bench_run (bench, "base64.decode", 2000, bench_base64_decode);
+  cape_bench_run (bench, "json.stream_encode", 2000, bench_json_stream_encode);
+
+  cape_stream_del (&buffer);
+
+  res = cape_bench_done (bench);
+
+  cape_bench_del (&bench);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
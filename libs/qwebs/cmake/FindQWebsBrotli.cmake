@@ -0,0 +1,39 @@
+if (NOT BROTLI_FOUND)
+
+  ##____________________________________________________________________________
+  ## Check for the header files
+
+  find_path (BROTLI_INCLUDES
+    NAMES brotli/encode.h
+    HINTS ${CMAKE_INSTALL_PREFIX}
+  )
+
+  ##____________________________________________________________________________
+  ## Check for the library
+
+  find_library (BROTLI_LIBRARIES brotlienc
+    HINTS ${CMAKE_INSTALL_PREFIX}
+  )
+
+  ##____________________________________________________________________________
+  ## Actions taken when all components have been found
+
+  if (BROTLI_INCLUDES AND BROTLI_LIBRARIES)
+    SET(BROTLI_FOUND TRUE)
+  endif (BROTLI_INCLUDES AND BROTLI_LIBRARIES)
+
+  if (BROTLI_FOUND)
+    if (NOT BROTLI_FIND_QUIETLY)
+      message (STATUS "BROTLI_INCLUDES  = ${BROTLI_INCLUDES}")
+      message (STATUS "BROTLI_LIBRARIES = ${BROTLI_LIBRARIES}")
+    endif (NOT BROTLI_FIND_QUIETLY)
+  else (BROTLI_FOUND)
+    message (STATUS "brotli not found, brotli compression is disabled")
+  endif (BROTLI_FOUND)
+
+  ##____________________________________________________________________________
+  ## Mark advanced variables
+
+  mark_as_advanced (BROTLI_INCLUDES BROTLI_LIBRARIES)
+
+endif (NOT BROTLI_FOUND)
@@ -0,0 +1,50 @@
+if (NOT ZLIB_FOUND)
+
+  ## try the default way
+  find_package(ZLIB QUIET)
+
+  if (ZLIB_FOUND)
+
+    SET(ZLIB_INCLUDES ${ZLIB_INCLUDE_DIRS})
+
+  else (ZLIB_FOUND)
+
+    ##____________________________________________________________________________
+    ## Check for the header files
+
+    find_path (ZLIB_INCLUDES
+      NAMES zlib.h
+      HINTS ${CMAKE_INSTALL_PREFIX}
+    )
+
+    ##____________________________________________________________________________
+    ## Check for the library
+
+    find_library (ZLIB_LIBRARIES z
+      HINTS ${CMAKE_INSTALL_PREFIX}
+    )
+
+    ##____________________________________________________________________________
+    ## Actions taken when all components have been found
+
+    if (ZLIB_INCLUDES AND ZLIB_LIBRARIES)
+      SET(ZLIB_FOUND TRUE)
+    endif (ZLIB_INCLUDES AND ZLIB_LIBRARIES)
+
+    ##____________________________________________________________________________
+    ## Mark advanced variables
+
+    mark_as_advanced (ZLIB_INCLUDES ZLIB_LIBRARIES)
+
+  endif (ZLIB_FOUND)
+
+  if (ZLIB_FOUND)
+    if (NOT ZLIB_FIND_QUIETLY)
+      message (STATUS "ZLIB_INCLUDES  = ${ZLIB_INCLUDES}")
+      message (STATUS "ZLIB_LIBRARIES = ${ZLIB_LIBRARIES}")
+    endif (NOT ZLIB_FIND_QUIETLY)
+  else (ZLIB_FOUND)
+    message (STATUS "zlib not found, gzip compression is disabled")
+  endif (ZLIB_FOUND)
+
+endif (NOT ZLIB_FOUND)
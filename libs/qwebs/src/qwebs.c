@@ -2,15 +2,18 @@
 #include "qwebs_connection.h"
 #include "qwebs_files.h"
 #include "qwebs_multipart.h"
+#include "qwebs_router.h"
 
 // cape includes
 #include <aio/cape_aio_sock.h>
 #include <sys/cape_socket.h>
-#include <stc/cape_map.h>
 #include <sys/cape_queue.h>
 #include <sys/cape_log.h>
 #include <sys/cape_file.h>
 
+// c includes
+#include <string.h>
+
 //-----------------------------------------------------------------------------
 
 struct QWebsApi_s
@@ -90,11 +93,12 @@ void qwebs_upgrade_del (QWebsUpgrade* p_self)
 
 struct QWebs_s
 {
-  CapeMap request_apis;          // all api callbacks
-  CapeMap request_page;          // all page callbacks
-  CapeMap request_upgrades;      // all upgrade callbacks
+  QWebsRouter request_apis;        // all api callbacks
+  QWebsRouter request_page;        // all page callbacks
+  QWebsRouter request_upgrades;    // all upgrade callbacks
 
-  CapeMap sites;
+  QWebsRouter sites;
+  QWebsRouter routes;              // compiled from the route_list
   
   CapeString host;
   
@@ -106,7 +110,11 @@ struct QWebs_s
   
   CapeAioAccept accept;
   
-  CapeQueue queue;
+  CapeQueue queue;                 // API requests
+  CapeQueue queue_files;           // file requests (disk I/O)
+
+  number_t threads;
+  number_t threads_files;
   
   QWebsFiles files;
   
@@ -119,42 +127,33 @@ struct QWebs_s
   
   void* on_raise_user_ptr;
   fct_qwebs__on_raise on_raise;
+
+  number_t compression_threshold;
+  number_t compression_level;
+
+  CapeString upload_path;          // NULL -> multipart bodies are kept in memory
+  int upload_encrypt;
 };
 
 //-----------------------------------------------------------------------------
 
-static void __STDCALL qwebs__intern__on_api_del (void* key, void* val)
+static void __STDCALL qwebs__intern__on_api_del (void* val)
 {
-  {
-    CapeString h = key; cape_str_del (&h);
-  }
-  {
-    QWebsApi api = val; qwebs_api_del (&api);
-  }
+  QWebsApi api = val; qwebs_api_del (&api);
 }
 
 //-----------------------------------------------------------------------------
 
-static void __STDCALL qwebs__intern__on_sites_del (void* key, void* val)
+static void __STDCALL qwebs__intern__on_sites_del (void* val)
 {
-  {
-    CapeString h = key; cape_str_del (&h);
-  }
-  {
-    CapeString h = val; cape_str_del (&h);
-  }
+  CapeString h = val; cape_str_del (&h);
 }
 
 //-----------------------------------------------------------------------------
 
-static void __STDCALL qwebs__intern__on_upgrade_del (void* key, void* val)
+static void __STDCALL qwebs__intern__on_upgrade_del (void* val)
 {
-  {
-    CapeString h = key; cape_str_del (&h);
-  }
-  {
-    QWebsUpgrade api = val; qwebs_upgrade_del (&api);
-  }
+  QWebsUpgrade api = val; qwebs_upgrade_del (&api);
 }
 
 //-----------------------------------------------------------------------------
@@ -178,7 +177,10 @@ void qwebs__internal__convert_sites (QWebs self, CapeUdc sites)
       {
         cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "init", "set site '%s' = %s", name, site);
 
-        cape_map_insert (self->sites, cape_str_cp (name), site_absolute);
+        if (!qwebs_router_add (self->sites, name, cape_str_size (name), site_absolute))
+        {
+          cape_str_del (&site_absolute);
+        }
       }
       else
       {
@@ -194,6 +196,26 @@ void qwebs__internal__convert_sites (QWebs self, CapeUdc sites)
 
 //-----------------------------------------------------------------------------
 
+void qwebs__internal__convert_routes (QWebs self)
+{
+  CapeUdcCursor* cursor = cape_udc_cursor_new (self->route_list, CAPE_DIRECTION_FORW);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    const CapeString name = cape_udc_name (cursor->item);
+
+    if (name)
+    {
+      // the value is not used, the node is owned by the route_list
+      qwebs_router_add (self->routes, name, cape_str_size (name), cursor->item);
+    }
+  }
+
+  cape_udc_cursor_del (&cursor);
+}
+
+//-----------------------------------------------------------------------------
+
 QWebs qwebs_new (CapeUdc sites, const CapeString host, number_t port, number_t threads, const CapeString pages, CapeUdc route_list, const CapeString identifier, const CapeString provider)
 {
   QWebs self = CAPE_NEW (struct QWebs_s);
@@ -203,25 +225,36 @@ QWebs qwebs_new (CapeUdc sites, const CapeString host, number_t port, number_t t
   
   self->pages = cape_str_cp (pages);
   
-  self->request_apis = cape_map_new (NULL, qwebs__intern__on_api_del, NULL);
-  self->request_page = cape_map_new (NULL, qwebs__intern__on_api_del, NULL);
-  self->request_upgrades = cape_map_new (NULL, qwebs__intern__on_upgrade_del, NULL);
+  self->request_apis = qwebs_router_new (qwebs__intern__on_api_del);
+  self->request_page = qwebs_router_new (qwebs__intern__on_api_del);
+  self->request_upgrades = qwebs_router_new (qwebs__intern__on_upgrade_del);
   
   self->aio_attached = NULL;
   self->accept = NULL;
   
   self->queue = cape_queue_new (1000);  // maximum of 1 second
+  self->queue_files = cape_queue_new (1000);
+
+  // at least one worker for each queue
+  self->threads = threads > 0 ? threads : 1;
+  self->threads_files = self->threads;
   
   self->files = qwebs_files_new (self);
   
   self->route_list = cape_udc_cp (route_list);
+  self->routes = qwebs_router_new (NULL);
+
+  if (self->route_list)
+  {
+    qwebs__internal__convert_routes (self);
+  }
   
-  self->sites = cape_map_new (NULL, qwebs__intern__on_sites_del, NULL);
+  self->sites = qwebs_router_new (qwebs__intern__on_sites_del);
 
   if (sites)
   {
-    // convert site into a map
-    // -> map can be altered later to fit more needs
+    // convert site into a trie
+    // -> the first part of the URL is matched against it for each request
     qwebs__internal__convert_sites (self, sites);
   }
   
@@ -232,6 +265,13 @@ QWebs qwebs_new (CapeUdc sites, const CapeString host, number_t port, number_t t
 
   self->on_raise_user_ptr = NULL;
   self->on_raise = NULL;
+
+  // default: compress everything which doesn't fit into one TCP packet
+  self->compression_threshold = 1400;
+  self->compression_level = 6;
+
+  self->upload_path = NULL;
+  self->upload_encrypt = FALSE;
   
   return self;
 }
@@ -244,10 +284,11 @@ void qwebs_del (QWebs* p_self)
   {
     QWebs self = *p_self;
     
-    cape_map_del (&(self->request_apis));
-    cape_map_del (&(self->request_page));
-    cape_map_del (&(self->request_upgrades));
-    cape_map_del (&(self->sites));
+    qwebs_router_del (&(self->request_apis));
+    qwebs_router_del (&(self->request_page));
+    qwebs_router_del (&(self->request_upgrades));
+    qwebs_router_del (&(self->sites));
+    qwebs_router_del (&(self->routes));
 
     cape_str_del (&(self->host));    
     cape_str_del (&(self->pages));
@@ -255,6 +296,7 @@ void qwebs_del (QWebs* p_self)
     //cape_aio_accept_del (&(self->accept));
     
     cape_queue_del (&(self->queue));
+    cape_queue_del (&(self->queue_files));
     
     qwebs_files_del (&(self->files));
     
@@ -264,6 +306,7 @@ void qwebs_del (QWebs* p_self)
     
     cape_str_del (&(self->identifier));
     cape_str_del (&(self->provider));
+    cape_str_del (&(self->upload_path));
 
     CAPE_DEL (p_self, struct QWebs_s);
   }
@@ -275,18 +318,17 @@ int qwebs_reg (QWebs self, const CapeString name, void* user_ptr, fct_qwebs__on_
 {
   if (name)
   {
-    CapeMapNode n = cape_map_find (self->request_apis, name);
-    if (NULL == n)
+    QWebsApi api = qwebs_api_new (user_ptr, on_request);
+
+    // transfer ownership to the router
+    if (qwebs_router_add (self->request_apis, name, cape_str_size (name), api))
     {
-      QWebsApi api = qwebs_api_new (user_ptr, on_request);
-      
-      // transfer ownership to the map
-      cape_map_insert (self->request_apis, cape_str_cp (name), api);
-      
       return CAPE_ERR_NONE;
     }
     else
     {
+      qwebs_api_del (&api);
+
       return cape_err_set (err, CAPE_ERR_RUNTIME, "API was already registered");
     }
   }
@@ -300,18 +342,17 @@ int qwebs_reg_page (QWebs self, const CapeString page, void* user_ptr, fct_qwebs
 {
   if (page)
   {
-    CapeMapNode n = cape_map_find (self->request_page, page);
-    if (NULL == n)
+    QWebsApi api = qwebs_api_new (user_ptr, on_request);
+
+    // transfer ownership to the router
+    if (qwebs_router_add (self->request_page, page, cape_str_size (page), api))
     {
-      QWebsApi api = qwebs_api_new (user_ptr, on_request);
-      
-      // transfer ownership to the map
-      cape_map_insert (self->request_page, cape_str_cp (page), api);
-      
       return CAPE_ERR_NONE;
     }
     else
     {
+      qwebs_api_del (&api);
+
       return cape_err_set (err, CAPE_ERR_RUNTIME, "API was already registered");
     }
   }
@@ -329,22 +370,44 @@ void qwebs_set_raise (QWebs self, void* user_ptr, fct_qwebs__on_raise on_raise)
 
 //-----------------------------------------------------------------------------
 
+void qwebs_set_compression (QWebs self, number_t threshold, number_t level)
+{
+  self->compression_threshold = threshold;
+  self->compression_level = level;
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_set_threads_files (QWebs self, number_t threads)
+{
+  self->threads_files = threads > 0 ? threads : 1;
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_set_upload (QWebs self, const CapeString path, int encrypt)
+{
+  cape_str_replace_cp (&(self->upload_path), path);
+  self->upload_encrypt = encrypt;
+}
+
+//-----------------------------------------------------------------------------
+
 int qwebs_on_upgrade (QWebs self, const CapeString name, void* user_ptr, fct_qwebs__on_upgrade on_upgrade, fct_qwebs__on_switched on_switched, fct_qwebs__on_recv on_recv, fct_qwebs__on_del on_del, CapeErr err)
 {
   if (name)
   {
-    CapeMapNode n = cape_map_find (self->request_upgrades, name);
-    if (NULL == n)
+    QWebsUpgrade upgrade = qwebs_upgrade_new (user_ptr, on_upgrade, on_switched, on_recv, on_del);
+
+    // transfer ownership to the router
+    if (qwebs_router_add (self->request_upgrades, name, cape_str_size (name), upgrade))
     {
-      QWebsUpgrade upgrade = qwebs_upgrade_new (user_ptr, on_upgrade, on_switched, on_recv, on_del);
-      
-      // transfer ownership to the map
-      cape_map_insert (self->request_upgrades, cape_str_cp (name), upgrade);
-      
       return CAPE_ERR_NONE;
     }
     else
     {
+      qwebs_upgrade_del (&upgrade);
+
       return cape_err_set (err, CAPE_ERR_RUNTIME, "Upgrade was already registered");
     }
   }
@@ -392,9 +455,14 @@ const CapeString qwebs_pages (QWebs self)
 
 int qwebs_route (QWebs self, const CapeString name)
 {
-  CapeUdc h = cape_udc_get (self->route_list, name);
-  
-  return h ? TRUE : FALSE;
+  return qwebs_route_buf (self, name, cape_str_size (name));
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_route_buf (QWebs self, const char* bufdat, number_t buflen)
+{
+  return qwebs_router_get (self->routes, bufdat, buflen) ? TRUE : FALSE;
 }
 
 //-----------------------------------------------------------------------------
@@ -403,7 +471,14 @@ int qwebs_attach (QWebs self, CapeAioContext aio_context, CapeErr err)
 {
   int res;
   
-  res = cape_queue_start (self->queue, 1, err);
+  res = cape_queue_start (self->queue, (int)self->threads, err);
+  if (res)
+  {
+    goto exit_and_cleanup;
+  }
+
+  // a slow disk should not block the API requests
+  res = cape_queue_start (self->queue_files, (int)self->threads_files, err);
   if (res)
   {
     goto exit_and_cleanup;
@@ -442,48 +517,35 @@ exit_and_cleanup:
 
 QWebsApi qwebs_get_api (QWebs self, const CapeString name)
 {
-  if (name)
-  {
-    CapeMapNode n = cape_map_find (self->request_apis, name);
-    if (n)
-    {
-      return cape_map_node_value (n);
-    }
-  }
-  
-  return NULL;
+  return qwebs_get_api_buf (self, name, cape_str_size (name));
+}
+
+//-----------------------------------------------------------------------------
+
+QWebsApi qwebs_get_api_buf (QWebs self, const char* bufdat, number_t buflen)
+{
+  return qwebs_router_get (self->request_apis, bufdat, buflen);
 }
 
 //-----------------------------------------------------------------------------
 
 QWebsApi qwebs_get_page (QWebs self, const CapeString page)
 {
-  if (page)
-  {
-    CapeMapNode n = cape_map_find (self->request_page, page);
-    if (n)
-    {
-      return cape_map_node_value (n);
-    }
-  }
-  
-  return NULL;
+  return qwebs_get_page_buf (self, page, cape_str_size (page));
+}
+
+//-----------------------------------------------------------------------------
+
+QWebsApi qwebs_get_page_buf (QWebs self, const char* bufdat, number_t buflen)
+{
+  return qwebs_router_get (self->request_page, bufdat, buflen);
 }
 
 //-----------------------------------------------------------------------------
 
 QWebsUpgrade qwebs_get_upgrade (QWebs self, const CapeString name)
 {
-  if (name)
-  {
-    CapeMapNode n = cape_map_find (self->request_upgrades, name);
-    if (n)
-    {
-      return cape_map_node_value (n);
-    }
-  }
-  
-  return NULL;
+  return qwebs_router_get (self->request_upgrades, name, cape_str_size (name));
 }
 
 //-----------------------------------------------------------------------------
@@ -495,6 +557,13 @@ QWebsFiles qwebs_files (QWebs self)
 
 //-----------------------------------------------------------------------------
 
+CapeQueue qwebs_queue_files (QWebs self)
+{
+  return self->queue_files;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeString qwebs_url_encode (QWebs self, const CapeString url)
 {
   return qwebs_encode_run (self->encoder, url);
@@ -544,65 +613,56 @@ void qwebs_upgrade_conn (QWebsUpgrade self, QWebsConnection conn, void* user_ptr
 
 //-----------------------------------------------------------------------------
 
-const CapeString qwebs__intern__get_site (QWebs self, const CapeString part)
+const CapeString qwebs_site (QWebs self, const char *bufdat, size_t buflen, CapeString* p_url)
 {
-  CapeMapNode n = cape_map_find (self->sites, part);
-  if (n)
-  {
-    return cape_map_node_value (n);
-  }
-  else
-  {
-    return NULL;
-  }
+  const char* url;
+  number_t url_len;
+
+  const CapeString ret = qwebs_site_buf (self, bufdat, buflen, &url, &url_len);
+
+  *p_url = cape_str_sub (url, url_len);
+
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
 
-const CapeString qwebs_site (QWebs self, const char *bufdat, size_t buflen, CapeString* p_url)
+const CapeString qwebs_site_buf (QWebs self, const char* bufdat, number_t buflen, const char** p_url, number_t* p_url_len)
 {
   const CapeString ret;
   
-  // local objects
-  CapeString url = cape_str_sub (bufdat, buflen);
-  
-  if ('/' == *url)
+  if (buflen > 0 && '/' == *bufdat)
   {
-    number_t pos;
-    if (cape_str_next (url + 1, '/', &pos))
+    // the site is the first part of the url including the leading '/'
+    const char* pos = memchr (bufdat + 1, '/', buflen - 1);
+    if (pos)
     {
-      CapeString h = cape_str_sub (url, pos + 1);
-      
-      ret = qwebs__intern__get_site (self, h);
-      
-      cape_str_del (&h);
-      
+      ret = qwebs_router_get (self->sites, bufdat, pos - bufdat);
       if (ret)
       {
-        *p_url = cape_str_sub (url + pos + 1, cape_str_size (url) - pos - 1);
-        goto exit_and_cleanup;
+        *p_url = pos;
+        *p_url_len = buflen - (pos - bufdat);
+        return ret;
       }
     }
     else
     {
-      ret = qwebs__intern__get_site (self, url);
+      ret = qwebs_router_get (self->sites, bufdat, buflen);
       if (ret)
       {
         // this means the whole url is a site
         // -> re-write to /
-        *p_url = cape_str_cp ("/");
-        goto exit_and_cleanup;
+        *p_url = "/";
+        *p_url_len = 1;
+        return ret;
       }
     }
   }
   
-  ret = qwebs__intern__get_site (self, "/");
-  *p_url = cape_str_mv (&url);
-  
-exit_and_cleanup:
-  
-  cape_str_del (&url);
-  return ret;
+  *p_url = bufdat;
+  *p_url_len = buflen;
+
+  return qwebs_router_get (self->sites, "/", 1);
 }
 
 //-----------------------------------------------------------------------------
@@ -621,6 +681,34 @@ const CapeString qwebs_provider (QWebs self)
 
 //-----------------------------------------------------------------------------
 
+number_t qwebs_compression_threshold (QWebs self)
+{
+  return self->compression_threshold;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t qwebs_compression_level (QWebs self)
+{
+  return self->compression_level;
+}
+
+//-----------------------------------------------------------------------------
+
+const CapeString qwebs_upload_path (QWebs self)
+{
+  return self->upload_path;
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_upload_encrypt (QWebs self)
+{
+  return self->upload_encrypt;
+}
+
+//-----------------------------------------------------------------------------
+
 int qwebs_raise_file (QWebs self, const CapeString file, QWebsRequest request)
 {
   int ret = FALSE;
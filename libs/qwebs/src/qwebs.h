@@ -14,6 +14,7 @@
 #include <stc/cape_list.h>
 #include <stc/cape_map.h>
 #include <stc/cape_udc.h>
+#include <sys/cape_queue.h>
 
 #define QWEBS_RAISE_TYPE__MINOR      1
 #define QWEBS_RAISE_TYPE__CRITICAL  10
@@ -38,6 +39,16 @@ typedef int     (__STDCALL *fct_qwebs__on_raise)        (void* user_ptr, number_
 
 __CAPE_LIBEX     void               qwebs_set_raise     (QWebs, void* user_ptr, fct_qwebs__on_raise);
 
+                                    /* JSON responses larger than threshold are compressed with level (1 - 9), threshold = 0 disables it */
+__CAPE_LIBEX     void               qwebs_set_compression (QWebs, number_t threshold, number_t level);
+
+                                    /* amount of worker threads for static files (default: same as threads), must be set before qwebs_attach */
+__CAPE_LIBEX     void               qwebs_set_threads_files (QWebs, number_t threads);
+
+                                    /* multipart bodies of API requests are parsed while they are received, file parts are
+                                       written into path and can be fetched by qwebs_request_parts (path = NULL disables it) */
+__CAPE_LIBEX     void               qwebs_set_upload    (QWebs, const CapeString path, int encrypt);
+
 //-----------------------------------------------------------------------------
 
 typedef void*   (__STDCALL *fct_qwebs__on_upgrade)      (void* user_ptr, QWebsRequest, CapeMap return_header, CapeErr err);
@@ -54,20 +65,41 @@ __CAPE_LIBEX     QWebsApi           qwebs_get_api       (QWebs, const CapeString
 
 __CAPE_LIBEX     QWebsApi           qwebs_get_page      (QWebs, const CapeString page);
 
+                                    /* lookups directly on the bytes of the URL, the buffer doesn't need to be terminated */
+__CAPE_LIBEX     QWebsApi           qwebs_get_api_buf   (QWebs, const char* bufdat, number_t buflen);
+
+__CAPE_LIBEX     QWebsApi           qwebs_get_page_buf  (QWebs, const char* bufdat, number_t buflen);
+
 __CAPE_LIBEX     QWebsUpgrade       qwebs_get_upgrade   (QWebs, const CapeString name);
 
 __CAPE_LIBEX     QWebsFiles         qwebs_files         (QWebs);
 
+                                    /* the API requests are executed in the queue of the connection */
+__CAPE_LIBEX     CapeQueue          qwebs_queue_files   (QWebs);
+
 __CAPE_LIBEX     const CapeString   qwebs_pages         (QWebs);
 
 __CAPE_LIBEX     int                qwebs_route         (QWebs, const CapeString name);
 
+__CAPE_LIBEX     int                qwebs_route_buf     (QWebs, const char* bufdat, number_t buflen);
+
 __CAPE_LIBEX     const CapeString   qwebs_site          (QWebs, const char *bufdat, size_t buflen, CapeString* url);
 
+                                    /* same as qwebs_site, but the url is returned as slice of the buffer (or a constant) */
+__CAPE_LIBEX     const CapeString   qwebs_site_buf      (QWebs, const char* bufdat, number_t buflen, const char** p_url, number_t* p_url_len);
+
 __CAPE_LIBEX     const CapeString   qwebs_identifier    (QWebs);
 
 __CAPE_LIBEX     const CapeString   qwebs_provider      (QWebs);
 
+__CAPE_LIBEX     number_t           qwebs_compression_threshold (QWebs);
+
+__CAPE_LIBEX     number_t           qwebs_compression_level (QWebs);
+
+__CAPE_LIBEX     const CapeString   qwebs_upload_path   (QWebs);
+
+__CAPE_LIBEX     int                qwebs_upload_encrypt (QWebs);
+
                                     /* returns TRUE if the file might be critical */
 __CAPE_LIBEX     int                qwebs_raise_file    (QWebs, const CapeString file, QWebsRequest);
 
@@ -0,0 +1,294 @@
+#include "qwebs_compress.h"
+#include "qwebs_connection.h"
+
+// cape includes
+#include <sys/cape_log.h>
+#include <stc/cape_map.h>
+
+// c includes
+#include <string.h>
+
+#if defined QWEBS_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined QWEBS_WITH_BROTLI
+#include <brotli/encode.h>
+#endif
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_compress__is_space (char c)
+{
+  return c == ' ' || c == '\t';
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_compress__name_equal (const char* name, number_t len, const char* compare)
+{
+  number_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    char c = name[i];
+
+    if (c >= 'A' && c <= 'Z')
+    {
+      c += 'a' - 'A';
+    }
+
+    if (compare[i] == 0 || compare[i] != c)
+    {
+      return FALSE;
+    }
+  }
+
+  return compare[len] == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_compress__token (const char* bufdat, number_t buflen)
+{
+  number_t name_len = 0;
+
+  // skip leading spaces
+  while (buflen && qwebs_compress__is_space (*bufdat))
+  {
+    bufdat++;
+    buflen--;
+  }
+
+  // name until parameters or spaces
+  while (name_len < buflen && bufdat[name_len] != ';' && !qwebs_compress__is_space (bufdat[name_len]))
+  {
+    name_len++;
+  }
+
+  // check for 'q=0', 'q=0.0', etc
+  {
+    const char* q = NULL;
+    number_t i;
+
+    for (i = name_len; i + 1 < buflen; i++)
+    {
+      if ((bufdat[i] == 'q' || bufdat[i] == 'Q') && bufdat[i + 1] == '=')
+      {
+        q = bufdat + i + 2;
+        break;
+      }
+    }
+
+    if (q)
+    {
+      const char* end = bufdat + buflen;
+
+      int is_zero = TRUE;
+
+      for (; q < end && !qwebs_compress__is_space (*q); q++)
+      {
+        if (*q != '0' && *q != '.')
+        {
+          is_zero = FALSE;
+          break;
+        }
+      }
+
+      if (is_zero)
+      {
+        // explicitly not accepted
+        return 0;
+      }
+    }
+  }
+
+  if (qwebs_compress__name_equal (bufdat, name_len, "gzip") || qwebs_compress__name_equal (bufdat, name_len, "*"))
+  {
+    return QWEBS_ENCODING_GZIP;
+  }
+
+  if (qwebs_compress__name_equal (bufdat, name_len, "br"))
+  {
+    return QWEBS_ENCODING_BR;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_compress_accepted (QWebsRequest request)
+{
+  int ret = 0;
+  const char* sep;
+
+  const char* pos = qwebs_request_header (request, "Accept-Encoding");
+  if (pos == NULL)
+  {
+    return 0;
+  }
+
+  for (sep = strchr (pos, ','); sep; sep = strchr (pos, ','))
+  {
+    ret |= qwebs_compress__token (pos, sep - pos);
+
+    pos = sep + 1;
+  }
+
+  ret |= qwebs_compress__token (pos, strlen (pos));
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_compress_supported (void)
+{
+  int ret = 0;
+
+#if defined QWEBS_WITH_ZLIB
+  ret |= QWEBS_ENCODING_GZIP;
+#endif
+
+#if defined QWEBS_WITH_BROTLI
+  ret |= QWEBS_ENCODING_BR;
+#endif
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_compress_mime (const CapeString mime)
+{
+  if (mime == NULL)
+  {
+    return FALSE;
+  }
+
+  return cape_str_begins (mime, "text/") || strstr (mime, "json") || strstr (mime, "javascript") || strstr (mime, "svg") || strstr (mime, "xml");
+}
+
+//-----------------------------------------------------------------------------
+
+const CapeString qwebs_compress_name (int encoding)
+{
+  switch (encoding)
+  {
+    case QWEBS_ENCODING_GZIP: return "gzip";
+    case QWEBS_ENCODING_BR: return "br";
+  }
+
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined QWEBS_WITH_ZLIB
+
+static CapeStream qwebs_compress__gzip (const char* bufdat, number_t buflen, number_t level, CapeErr err)
+{
+  CapeStream ret = NULL;
+  z_stream strm;
+  uLong bound;
+
+  memset (&strm, 0, sizeof(z_stream));
+
+  // window bits + 16 -> gzip header and trailer
+  if (deflateInit2 (&strm, (int)level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    cape_err_set (err, CAPE_ERR_RUNTIME, "can't initialize zlib");
+    return NULL;
+  }
+
+  bound = deflateBound (&strm, buflen);
+
+  ret = cape_stream_new ();
+  cape_stream_cap (ret, bound);
+
+  strm.next_in = (Bytef*)bufdat;
+  strm.avail_in = (uInt)buflen;
+  strm.next_out = (Bytef*)cape_stream_pos (ret);
+  strm.avail_out = (uInt)bound;
+
+  // the output buffer is large enough to finish in one step
+  if (deflate (&strm, Z_FINISH) != Z_STREAM_END)
+  {
+    cape_err_set (err, CAPE_ERR_RUNTIME, "can't compress with zlib");
+    cape_stream_del (&ret);
+  }
+  else
+  {
+    cape_stream_set (ret, strm.total_out);
+  }
+
+  deflateEnd (&strm);
+
+  return ret;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+#if defined QWEBS_WITH_BROTLI
+
+static CapeStream qwebs_compress__br (const char* bufdat, number_t buflen, number_t level, CapeErr err)
+{
+  CapeStream ret = cape_stream_new ();
+
+  size_t encoded_size = BrotliEncoderMaxCompressedSize (buflen);
+
+  cape_stream_cap (ret, encoded_size);
+
+  // brotli has a quality range of 0 - 11, use the same range for the level as zlib
+  if (!BrotliEncoderCompress ((int)level, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, buflen, (const uint8_t*)bufdat, &encoded_size, (uint8_t*)cape_stream_pos (ret)))
+  {
+    cape_err_set (err, CAPE_ERR_RUNTIME, "can't compress with brotli");
+    cape_stream_del (&ret);
+  }
+  else
+  {
+    cape_stream_set (ret, encoded_size);
+  }
+
+  return ret;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+CapeStream qwebs_compress_buf (int encoding, const char* bufdat, number_t buflen, number_t level, CapeErr err)
+{
+  if (level < 1)
+  {
+    level = 1;
+  }
+  else if (level > 9)
+  {
+    level = 9;
+  }
+
+  switch (encoding)
+  {
+#if defined QWEBS_WITH_ZLIB
+    case QWEBS_ENCODING_GZIP:
+    {
+      return qwebs_compress__gzip (bufdat, buflen, level, err);
+    }
+#endif
+#if defined QWEBS_WITH_BROTLI
+    case QWEBS_ENCODING_BR:
+    {
+      return qwebs_compress__br (bufdat, buflen, level, err);
+    }
+#endif
+  }
+
+  cape_err_set (err, CAPE_ERR_NOT_SUPPORTED, "encoding is not supported");
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,39 @@
+#ifndef __QWEBS_COMPRESS__H
+#define __QWEBS_COMPRESS__H 1
+
+#include "qwebs_structs.h"
+
+// cape includes
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "sys/cape_err.h"
+#include "stc/cape_str.h"
+#include "stc/cape_stream.h"
+
+//-----------------------------------------------------------------------------
+
+#define QWEBS_ENCODING_GZIP     0x01
+#define QWEBS_ENCODING_BR       0x02
+
+//-----------------------------------------------------------------------------
+
+                                    /* returns the encodings of the 'Accept-Encoding' header as QWEBS_ENCODING flags */
+__CAPE_LIBEX     int                qwebs_compress_accepted   (QWebsRequest);
+
+                                    /* returns the encodings which can be created on the fly */
+__CAPE_LIBEX     int                qwebs_compress_supported  (void);
+
+                                    /* returns TRUE if the content of the mime type is worth to compress */
+__CAPE_LIBEX     int                qwebs_compress_mime       (const CapeString mime);
+
+                                    /* returns the name of the encoding used in HTTP headers */
+__CAPE_LIBEX     const CapeString   qwebs_compress_name       (int encoding);
+
+//-----------------------------------------------------------------------------
+
+                                    /* compresses the buffer with the encoding, level 1 - 9, returns NULL on error */
+__CAPE_LIBEX     CapeStream         qwebs_compress_buf        (int encoding, const char* bufdat, number_t buflen, number_t level, CapeErr);
+
+//-----------------------------------------------------------------------------
+
+#endif
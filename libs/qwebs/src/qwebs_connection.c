@@ -3,27 +3,55 @@
 #include "qwebs_files.h"
 #include "http_parser.h"
 #include "qwebs_response.h"
+#include "qwebs_compress.h"
+#include "qwebs_multipart.h"
+#include "qwebs_upload.h"
 
 // cape includes
 #include <aio/cape_aio_sock.h>
 #include <sys/cape_socket.h>
 #include <stc/cape_map.h>
 #include <stc/cape_list.h>
+#include <stc/cape_arena.h>
+#include <stc/cape_chunks.h>
 #include <sys/cape_log.h>
-#include <fmt/cape_tokenizer.h>
 #include <sys/cape_mutex.h>
 #include <fmt/cape_json.h>
 
+// qcrypt includes
+#include <qcrypt_file.h>
+
+// c includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// size of the window for streamed content
+#define QWEBS_SEND_WINDOW 65536
+
 //-----------------------------------------------------------------------------
 
 void qwebs_connection_send (QWebsConnection, CapeStream*);
 
+void qwebs_connection_send_decrypt (QWebsConnection, CapeStream* p_header, QCryptDecrypt* p_decrypt);
+
+void qwebs_connection_send_content (QWebsConnection, CapeStream* p_header, const char* bufdat, number_t buflen, const CapeString trailer);
+
 void qwebs_connection_inc (QWebsConnection);
 
 void qwebs_connection_dec (QWebsConnection);
 
+void qwebs_connection__dispatch (QWebsConnection, QWebsRequest);
+
+void qwebs_connection__release (QWebsConnection, QWebsRequest, int was_dispatched);
+
+CapeQueue qwebs_connection__queue (QWebsConnection);
+
 //-----------------------------------------------------------------------------
 
+#define QWEBS_REQUEST_SEGMENTS 8   // most urls don't have more parts
+#define QWEBS_REQUEST_BODY_KEEP 65536   // larger body buffers are not kept for the next request
+
 struct QWebsRequest_s
 {
   QWebs webs;                      // reference
@@ -32,23 +60,40 @@ struct QWebsRequest_s
 
   QWebsConnection conn;            // reference
 
-  CapeString method;
-  CapeString url;
+  const char* method;              // constant of the parser
+  char* url_raw;                   // url as received
+  char* path;                      // url without site and query, owns the bytes of the segments
+  const char* url;                 // path or a re-written url
   CapeString mime;
 
-  CapeMap header_values;
-  CapeMap option_values;
+  CapeArena arena;                 // all strings of the message, cleared for the next message
+
+  CapeMap header_values;           // keys and values are stored in the arena
+  CapeMap option_values;           // keys and values are stored in the arena
+
+  int has_query;
 
-  CapeList url_values;
+  QWebsSegment segments_local[QWEBS_REQUEST_SEGMENTS];
+
+  QWebsSegment* segments;          // NULL -> the url has no path
+  number_t segments_cnt;
+  number_t segments_pos;           // parts which were used for routing
+
+  CapeList url_values;             // will be filled from the segments on demand
+  int has_url_values;
 
   CapeStream body_value;
+  QWebsUpload upload;              // the multipart body is parsed while it is received
 
   // temporary members
 
-  CapeString last_header_field;
+  char* last_header_field;
+  char* last_header_value;
 
   int is_complete;
   int is_processed;
+  int is_dispatched;               // the request was handed over to a worker
+  int close_connection;
 
   const CapeString site;
 };
@@ -67,57 +112,109 @@ static void __STDCALL qwebs_request__intern__on_headers_del (void* key, void* va
 
 //-----------------------------------------------------------------------------
 
-QWebsRequest qwebs_request_new (QWebs webs, QWebsConnection conn)
+static void qwebs_request__internal__reset (QWebsRequest self)
 {
-  QWebsRequest self = CAPE_NEW (struct QWebsRequest_s);
-
-  self->webs = webs;
-  self->conn = conn;
-
   self->api = NULL;
 
   self->method = NULL;
+  self->url_raw = NULL;
+  self->path = NULL;
   self->url = NULL;
 
-  // this will be set in API mode
-  self->header_values = NULL;
-  self->option_values = NULL;
+  cape_map_clr (self->header_values);
+  cape_map_clr (self->option_values);
+
+  self->has_query = FALSE;
+
+  if (self->segments != self->segments_local)
+  {
+    CAPE_FREE (self->segments);
+  }
+
+  self->segments = NULL;
+  self->segments_cnt = 0;
+  self->segments_pos = 0;
+
+  cape_list_clr (self->url_values);
+  self->has_url_values = FALSE;
+
+  if (cape_stream_size (self->body_value) > QWEBS_REQUEST_BODY_KEEP)
+  {
+    // don't keep the memory of large uploads
+    cape_stream_del (&(self->body_value));
+    self->body_value = cape_stream_new ();
+  }
+  else
+  {
+    cape_stream_clr (self->body_value);
+  }
 
-  self->url_values = NULL;
-  self->body_value = NULL;
+  // removes all uploaded files
+  qwebs_upload_del (&(self->upload));
 
   self->last_header_field = NULL;
+  self->last_header_value = NULL;
 
   self->is_complete = FALSE;
   self->is_processed = FALSE;
-
-  qwebs_connection_inc (self->conn);
+  self->is_dispatched = FALSE;
+  self->close_connection = FALSE;
 
   self->site = NULL;
 
+  // must be the last, all strings are released
+  cape_arena_clr (self->arena);
+}
+
+//-----------------------------------------------------------------------------
+
+QWebsRequest qwebs_request_new (QWebs webs, QWebsConnection conn)
+{
+  QWebsRequest self = CAPE_NEW (struct QWebsRequest_s);
+
+  self->webs = webs;
+  self->conn = conn;
+
+  self->mime = NULL;
+
+  self->arena = cape_arena_new (0);
+
+  // the strings are owned by the arena
+  self->header_values = cape_map_new (NULL, NULL, NULL);
+  self->option_values = cape_map_new (NULL, NULL, NULL);
+
+  self->segments = NULL;
+
+  self->url_values = cape_list_new (NULL);
+  self->body_value = cape_stream_new ();
+  self->upload = NULL;
+
+  qwebs_request__internal__reset (self);
+
   return self;
 }
 
 //-----------------------------------------------------------------------------
 
-void qwebs_request_del (QWebsRequest* p_self)
+static void qwebs_request__internal__destroy (QWebsRequest* p_self)
 {
   if (*p_self)
   {
     QWebsRequest self = *p_self;
 
-    qwebs_connection_dec (self->conn);
-
-    cape_str_del (&(self->method));
-    cape_str_del (&(self->url));
-
     cape_map_del (&(self->header_values));
     cape_map_del (&(self->option_values));
 
+    if (self->segments != self->segments_local)
+    {
+      CAPE_FREE (self->segments);
+    }
+
     cape_list_del (&(self->url_values));
     cape_stream_del (&(self->body_value));
+    qwebs_upload_del (&(self->upload));
 
-    cape_str_del (&(self->last_header_field));
+    cape_arena_del (&(self->arena));
 
     CAPE_DEL (p_self, struct QWebsRequest_s);
   }
@@ -125,113 +222,263 @@ void qwebs_request_del (QWebsRequest* p_self)
 
 //-----------------------------------------------------------------------------
 
-CapeMap qwebs_request__internal__convert_query (const CapeString query)
+void qwebs_request_del (QWebsRequest* p_self)
 {
-  CapeMap ret = cape_map_new (NULL, qwebs_request__intern__on_headers_del, NULL);
+  if (*p_self)
+  {
+    QWebsRequest self = *p_self;
+    QWebsConnection conn = self->conn;
 
-  CapeList values = cape_tokenizer_buf__noempty (query, cape_str_size (query), '&');
+    int was_dispatched = self->is_dispatched;
+
+    *p_self = NULL;
 
-  CapeListCursor* cursor = cape_list_cursor_new (values, CAPE_DIRECTION_FORW);
-  while (cape_list_cursor_next (cursor))
+    // clear all values of the message
+    // -> the connection keeps the request for the next message
+    qwebs_request__internal__reset (self);
+
+    qwebs_connection__release (conn, self, was_dispatched);
+
+    // might delete the connection
+    qwebs_connection_dec (conn);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_request__internal__convert_query (QWebsRequest self, const char* query)
+{
+  const char* pos = query;
+
+  while (*pos)
   {
-    const CapeString value = cape_list_node_data (cursor->node);
+    const char* end = strchr (pos, '&');
+    const char* sep;
 
-    CapeString key = NULL;
-    CapeString val = NULL;
+    if (end == NULL)
+    {
+      end = pos + strlen (pos);
+    }
 
-    if (cape_tokenizer_split (value, '=', &key, &val))
+    sep = memchr (pos, '=', end - pos);
+    if (sep)
     {
-      cape_map_insert (ret, key, val);
+      char* key = cape_arena_sub (self->arena, pos, sep - pos);
+      char* val = cape_arena_sub (self->arena, sep + 1, end - sep - 1);
+
+      cape_map_insert (self->option_values, key, val);
     }
-    else
+
+    if (*end == '\0')
     {
-      cape_str_del (&key);
-      cape_str_del (&val);
+      break;
     }
+
+    pos = end + 1;
   }
 
-  cape_list_cursor_del (&cursor);
-  
-  cape_list_del (&values);
-  return ret;
+  self->has_query = TRUE;
 }
 
 //-----------------------------------------------------------------------------
 
-static int qwebs_request__internal__on_url (http_parser* parser, const char *at, size_t length)
+static void qwebs_request__internal__segments (QWebsRequest self)
 {
-  QWebsRequest self = parser->data;
+  const char* pos = self->path + 1;
+  const char* end;
 
-  // this will re-write the url
-  // -> checks all sites for re-writing
-  self->site = qwebs_site (self->webs, at, length, &(self->url));
+  number_t cnt = 0;
+  number_t max = 1;
 
-  cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "on url", "access: %s", self->url);
-
-  // create a map for all header values
-  self->header_values = cape_map_new (NULL, qwebs_request__intern__on_headers_del, NULL);
+  // the amount of '/' gives the maximum amount of parts
+  for (end = pos; *end; end++)
+  {
+    if ('/' == *end)
+    {
+      max++;
+    }
+  }
 
-  if ('/' == *(self->url))
+  if (max > QWEBS_REQUEST_SEGMENTS)
   {
-    CapeString url = NULL;
-    CapeString query = NULL;
+    self->segments = CAPE_ALLOC (max * sizeof(QWebsSegment));
+  }
+  else
+  {
+    self->segments = self->segments_local;
+  }
 
-    if (cape_tokenizer_split (self->url, '?', &url, &query))
+  while (pos < end)
+  {
+    const char* next = memchr (pos, '/', end - pos);
+    if (next == NULL)
     {
-      cape_str_replace_mv (&(self->url), &url);
+      next = end;
+    }
 
-      // parse the options into a map
-      self->option_values = qwebs_request__internal__convert_query (query);
+    // empty parts are skipped
+    if (next > pos)
+    {
+      self->segments[cnt].bufdat = pos;
+      self->segments[cnt].buflen = next - pos;
 
-      cape_str_del (&query);
+      cnt++;
     }
 
-    // split the url into its parts
-    self->url_values = cape_tokenizer_buf__noempty (self->url + 1, cape_str_size (self->url) - 1, '/');
+    pos = next + 1;
+  }
+
+  self->segments_cnt = cnt;
+}
+
+//-----------------------------------------------------------------------------
+
+static char* qwebs_request__internal__append (QWebsRequest self, char* str, const char* bufdat, number_t buflen)
+{
+  // the parser delivers a part in pieces, if it was split over several reads
+  if (str)
+  {
+    number_t len = strlen (str);
+
+    char* ret = cape_arena_alloc (self->arena, len + buflen + 1);
+
+    memcpy (ret, str, len);
+    memcpy (ret + len, bufdat, buflen);
+
+    ret[len + buflen] = '\0';
+
+    return ret;
+  }
+
+  return cape_arena_sub (self->arena, bufdat, buflen);
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_request__internal__header_done (QWebsRequest self)
+{
+  if (self->last_header_field && self->last_header_value)
+  {
+    // printf ("HEADER VALUE: %s = %s\n", self->last_header_field, self->last_header_value);
+
+    cape_map_insert (self->header_values, self->last_header_field, self->last_header_value);
+  }
 
-    if (cape_list_size (self->url_values) >= 1)
+  self->last_header_field = NULL;
+  self->last_header_value = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_request__internal__route (QWebsRequest self)
+{
+  {
+    const char* url;
+    number_t url_len;
+
+    // this will re-write the url
+    // -> checks all sites for re-writing
+    self->site = qwebs_site_buf (self->webs, self->url_raw, strlen (self->url_raw), &url, &url_len);
+
+    self->path = cape_arena_sub (self->arena, url, url_len);
+    self->url = self->path;
+  }
+
+  cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "on url", "access: %s", self->path);
+
+  if ('/' == *(self->path))
+  {
     {
-      CapeListNode n = cape_list_node_front (self->url_values);
+      char* query = strchr (self->path, '?');
+      if (query)
+      {
+        // cut the query from the path
+        *query = '\0';
+
+        // parse the options into a map
+        qwebs_request__internal__convert_query (self, query + 1);
+      }
+    }
 
+    // split the path into its parts
+    // -> the parts are slices of the path, no copies
+    qwebs_request__internal__segments (self);
+
+    if (self->segments_cnt >= 1)
+    {
       // get the first part
-      const CapeString first_part = cape_list_node_data (n);
+      const QWebsSegment* first_part = self->segments;
 
-      if (qwebs_route (self->webs, first_part))
+      if (qwebs_route_buf (self->webs, first_part->bufdat, first_part->buflen))
       {
-        cape_str_replace_cp (&(self->url), "/index.html");
+        self->url = "/index.html";
       }
-      else if (cape_list_size (self->url_values) >= 2)
+      else if (self->segments_cnt >= 2)
       {
         // anaylse the URL if we have an API or not
-        self->api = qwebs_get_api (self->webs, first_part);
+        self->api = qwebs_get_api_buf (self->webs, first_part->bufdat, first_part->buflen);
 
         if (self->api)
         {
-          // reduce the url values by one
-          {
-            CapeListNode n = cape_list_node_front (self->url_values);
-
-            cape_list_node_erase (self->url_values, n);
-          }
-
-          self->body_value = cape_stream_new ();
+          // the API name is not part of the url values
+          self->segments_pos = 1;
         }
       }
       else
       {
-        self->api = qwebs_get_page (self->webs, self->url + 1);
+        self->api = qwebs_get_page (self->webs, self->path + 1);
       }
     }
     else
     {
-      if (cape_str_equal ("/", self->url))
+      if (cape_str_equal ("/", self->path))
       {
-        cape_str_replace_cp (&(self->url), "/index.html");
+        self->url = "/index.html";
       }
 
       self->api = qwebs_get_page (self->webs, self->url);
     }
   }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_request__internal__upload (QWebsRequest self)
+{
+  const CapeString mime = NULL;
+
+  {
+    CapeMapNode n = cape_map_find (self->header_values, "Content-Type");
+    if (NULL == n)
+    {
+      n = cape_map_find (self->header_values, "content-type");
+    }
+
+    if (n)
+    {
+      mime = cape_map_node_value (n);
+    }
+  }
+
+  if (cape_str_begins (mime, "multipart/form-data"))
+  {
+    CapeString boundary = qwebs_parse_line (mime, "boundary");
+    if (boundary)
+    {
+      self->upload = qwebs_upload_new (qwebs_upload_path (self->webs), qwebs_upload_encrypt (self->webs), boundary);
+    }
+
+    cape_str_del (&boundary);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_request__internal__on_url (http_parser* parser, const char *at, size_t length)
+{
+  QWebsRequest self = parser->data;
+
+  self->url_raw = qwebs_request__internal__append (self, self->url_raw, at, length);
 
   return 0;
 }
@@ -242,13 +489,14 @@ static int qwebs_request__internal__on_header_field (http_parser* parser, const
 {
   QWebsRequest self = parser->data;
 
-  if (self->header_values)
+  if (self->last_header_value)
   {
-    CapeString h = cape_str_sub (at, length);
-
-    cape_str_replace_mv (&(self->last_header_field), &h);
+    // a new header starts
+    qwebs_request__internal__header_done (self);
   }
 
+  self->last_header_field = qwebs_request__internal__append (self, self->last_header_field, at, length);
+
   return 0;
 }
 
@@ -258,17 +506,32 @@ static int qwebs_request__internal__on_header_value (http_parser* parser, const
 {
   QWebsRequest self = parser->data;
 
-  if (self->header_values)
+  if (self->last_header_field)
   {
-    if (self->last_header_field)
-    {
-      CapeString h = cape_str_sub (at, length);
-     // printf ("HEADER VALUE: %s = %s\n", self->last_header_field, h);
+    self->last_header_value = qwebs_request__internal__append (self, self->last_header_value, at, length);
+  }
 
-      // transfer ownership to the map
-      cape_map_insert (self->header_values, self->last_header_field, h);
-      self->last_header_field = NULL;
-    }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_request__internal__on_headers_complete (http_parser* parser)
+{
+  QWebsRequest self = parser->data;
+
+  qwebs_request__internal__header_done (self);
+
+  // the url is complete now
+  if (self->url_raw)
+  {
+    qwebs_request__internal__route (self);
+  }
+
+  if (self->api && qwebs_upload_path (self->webs))
+  {
+    // check if the body can be parsed while receiving
+    qwebs_request__internal__upload (self);
   }
 
   return 0;
@@ -285,7 +548,12 @@ static int qwebs_request__internal__on_body (http_parser* parser, const char* at
   printf ("%.*s\n", (int)length, at);
 */
 
-  if (self->api)
+  if (self->upload)
+  {
+    // files are written directly to disk
+    qwebs_upload_process (self->upload, at, length);
+  }
+  else if (self->api)
   {
     cape_stream_append_buf (self->body_value, at, length);
   }
@@ -320,11 +588,107 @@ static int qwebs_request__internal__on_message_complete (http_parser* parser)
 
   self->is_complete = TRUE;
 
+  // stop the parser after each message
+  // -> pipelined requests in the same buffer need their own request instance
+  http_parser_pause (parser, 1);
+
   return 0;
 }
 
 //-----------------------------------------------------------------------------
 
+static void __STDCALL qwebs_request__internal__on_cancel (void* ptr, number_t pos, number_t queue_size)
+{
+  // the worker thread must not be cancelled, it might hold locks
+  cape_log_msg (CAPE_LL_WARN, "QWEBS", "request", "request is running for too long");
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  QWebsRequest request;
+
+  CapeString content;
+
+  number_t ttl;
+
+  int encoding;
+
+} QWebsCompressTask;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_request__compress__on_event (void* ptr, number_t pos, number_t queue_size)
+{
+  QWebsCompressTask* task = ptr;
+  QWebsRequest self = task->request;
+
+  // local objects
+  CapeErr err = cape_err_new ();
+  CapeStream s = cape_stream_new ();
+  CapeStream h = qwebs_compress_buf (task->encoding, task->content, cape_str_size (task->content), qwebs_compression_level (self->webs), err);
+
+  if (h)
+  {
+    qwebs_response_json_header (s, self->webs, cape_stream_size (h), qwebs_compress_name (task->encoding), task->ttl);
+
+    qwebs_connection_send_content (self->conn, &s, cape_stream_data (h), cape_stream_size (h), NULL);
+  }
+  else
+  {
+    cape_log_fmt (CAPE_LL_WARN, "QWEBS", "send json", "compression failed: %s", cape_err_text (err));
+
+    qwebs_response_json_header (s, self->webs, cape_str_size (task->content), NULL, task->ttl);
+
+    qwebs_connection_send_content (self->conn, &s, task->content, cape_str_size (task->content), NULL);
+  }
+
+  qwebs_request_del (&(task->request));
+
+  cape_stream_del (&h);
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_request__compress__on_done (void* ptr, number_t pos, number_t queue_size)
+{
+  QWebsCompressTask* task = ptr;
+
+  // in case the task was not executed
+  qwebs_request_del (&(task->request));
+
+  cape_str_del (&(task->content));
+
+  CAPE_DEL (&task, QWebsCompressTask);
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_request__compress_encoding (QWebsRequest self, number_t content_size)
+{
+  int accepted;
+
+  number_t threshold = qwebs_compression_threshold (self->webs);
+
+  if (threshold == 0 || content_size < threshold)
+  {
+    return 0;
+  }
+
+  accepted = qwebs_compress_accepted (self) & qwebs_compress_supported ();
+
+  if (accepted & QWEBS_ENCODING_BR)
+  {
+    return QWEBS_ENCODING_BR;
+  }
+
+  return accepted & QWEBS_ENCODING_GZIP;
+}
+
+//-----------------------------------------------------------------------------
+
 void qwebs_request_send_json (QWebsRequest* p_self, CapeUdc content, number_t ttl, CapeErr err)
 {
   if (*p_self)
@@ -339,6 +703,39 @@ void qwebs_request_send_json (QWebsRequest* p_self, CapeUdc content, number_t tt
       // create the HTTP error response
       qwebs_response_err (s, self->webs, content, "application/json", err);
     }
+    else if (content)
+    {
+      CapeString h = cape_json_to_s__strict (content);
+
+      int encoding = qwebs_request__compress_encoding (self, cape_str_size (h));
+
+      if (encoding)
+      {
+        QWebsCompressTask* task = CAPE_NEW (QWebsCompressTask);
+
+        task->request = self;
+        task->content = h;
+        task->ttl = ttl;
+        task->encoding = encoding;
+
+        *p_self = NULL;
+
+        // don't compress in the thread of the caller, which might be the AIO thread
+        cape_queue_add (qwebs_connection__queue (self->conn), NULL, qwebs_request__compress__on_event, qwebs_request__compress__on_done, qwebs_request__internal__on_cancel, task, 0);
+
+        cape_stream_del (&s);
+        return;
+      }
+
+      // create the JSON response
+      qwebs_response_json_header (s, self->webs, cape_str_size (h), NULL, ttl);
+
+      qwebs_connection_send_content (self->conn, &s, h, cape_str_size (h), NULL);
+      qwebs_request_del (p_self);
+
+      cape_str_del (&h);
+      return;
+    }
     else
     {
       // create the JSON response
@@ -352,18 +749,138 @@ void qwebs_request_send_json (QWebsRequest* p_self, CapeUdc content, number_t tt
 
 //-----------------------------------------------------------------------------
 
+static void qwebs_request__send_file_stream (QWebsRequest self, CapeUdc file_node)
+{
+  int res;
+
+  const CapeString file;
+
+  // local objects
+  CapeErr err = cape_err_new ();
+  CapeStream s = cape_stream_new ();
+  CapeFileHandle fh = NULL;
+  QCryptDecrypt decrypt = NULL;
+
+  file = cape_udc_get_s (file_node, "file", NULL);
+  if (NULL == file)
+  {
+    cape_err_set (err, CAPE_ERR_WRONG_VALUE, "file is not set");
+    goto exit_and_cleanup;
+  }
+
+  if (cape_udc_get_b (file_node, "encrypted", FALSE))
+  {
+    const CapeString vsec = cape_udc_get_s (file_node, "vsec", NULL);
+    if (NULL == vsec)
+    {
+      cape_err_set (err, CAPE_ERR_WRONG_VALUE, "vsec is not set");
+      goto exit_and_cleanup;
+    }
+
+    decrypt = qcrypt_decrypt_new (NULL, file, vsec);
+
+    res = qcrypt_decrypt_open (decrypt, err);
+    if (res)
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
+      goto exit_and_cleanup;
+    }
+
+    // the size of the decrypted content is unknown, ranges are not supported
+    qwebs_response_file_chunked (s, self->webs, file_node);
+
+    // the content will be decrypted window by window while sending
+    qwebs_connection_send_decrypt (self->conn, &s, &decrypt);
+  }
+  else
+  {
+    CapeFileInfo info;
+    number_t offset;
+    number_t length;
+
+    fh = cape_fh_new (NULL, file);
+
+    res = cape_fh_open (fh, O_RDONLY, err);
+    if (res)
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
+      goto exit_and_cleanup;
+    }
+
+    res = cape_fh_info (fh, &info, err);
+    if (res)
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
+      goto exit_and_cleanup;
+    }
+
+    switch (qwebs_request_range (self, info.size, NULL, NULL, &offset, &length))
+    {
+      case QWEBS_RANGE_PART:
+      {
+        break;
+      }
+      case QWEBS_RANGE_ERR:
+      {
+        qwebs_response_range_err (s, self->webs, info.size);
+
+        qwebs_connection_send (self->conn, &s);
+        goto exit_and_cleanup;
+      }
+      default:
+      {
+        offset = 0;
+        length = info.size;
+        break;
+      }
+    }
+
+    qwebs_response_file_range (s, self->webs, file_node, offset, length, info.size);
+
+    // the content will be sent by the kernel
+    qwebs_connection_send_file (self->conn, &s, &fh, offset, length);
+  }
+
+exit_and_cleanup:
+
+  if (cape_err_code (err))
+  {
+    CapeStream h = cape_stream_new ();
+
+    qwebs_response_err (h, self->webs, NULL, cape_udc_get_s (file_node, "mime", "application/json"), err);
+
+    qwebs_connection_send (self->conn, &h);
+  }
+
+  qcrypt_decrypt_del (&decrypt);
+  cape_fh_del (&fh);
+  cape_stream_del (&s);
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
 void qwebs_request_send_file (QWebsRequest* p_self, CapeUdc file_node, CapeErr err)
 {
   if (*p_self)
   {
     QWebsRequest self = *p_self;
 
-    // local objects
-    CapeStream s = cape_stream_new ();
+    if (cape_udc_get_b (file_node, "data_uri", FALSE) || cape_udc_get_b (file_node, "base64", FALSE))
+    {
+      // the content must be transformed as a whole
+      CapeStream s = cape_stream_new ();
 
-    qwebs_response_file (s, self->webs, file_node);
+      qwebs_response_file (s, self->webs, file_node);
+
+      qwebs_connection_send (self->conn, &s);
+    }
+    else
+    {
+      // stream the content with bounded memory
+      qwebs_request__send_file_stream (self, file_node);
+    }
 
-    qwebs_connection_send (self->conn, &s);
     qwebs_request_del (p_self);
   }
 }
@@ -397,9 +914,9 @@ void qwebs_request_send_buf (QWebsRequest* p_self, const CapeString buf, const C
     // local objects
     CapeStream s = cape_stream_new ();
 
-    qwebs_response_buf (s, self->webs, buf, mime_type, ttl);
+    qwebs_response_buf_header (s, self->webs, mime_type, cape_str_size (buf), ttl);
 
-    qwebs_connection_send (self->conn, &s);
+    qwebs_connection_send_content (self->conn, &s, buf, cape_str_size (buf), NULL);
     qwebs_request_del (p_self);
   }
 }
@@ -480,9 +997,9 @@ void qwebs_request_stream_buf (QWebsRequest self, const CapeString boundary, con
   // local objects
   CapeStream s = cape_stream_new ();
 
-  qwebs_response_mp_part (s, self->webs, boundary, mime_type, bufdat, buflen);
+  qwebs_response_mp_part_header (s, self->webs, boundary, mime_type, buflen);
 
-  qwebs_connection_send (self->conn, &s);
+  qwebs_connection_send_content (self->conn, &s, bufdat, buflen, "\r\n");
 }
 
 //-----------------------------------------------------------------------------
@@ -513,11 +1030,37 @@ exit_and_cleanup:
 
 CapeList qwebs_request_clist (QWebsRequest self)
 {
+  if (self->segments == NULL)
+  {
+    return NULL;
+  }
+
+  if (!self->has_url_values)
+  {
+    number_t i;
+
+    for (i = self->segments_pos; i < self->segments_cnt; i++)
+    {
+      cape_list_push_back (self->url_values, cape_arena_sub (self->arena, self->segments[i].bufdat, self->segments[i].buflen));
+    }
+
+    self->has_url_values = TRUE;
+  }
+
   return self->url_values;
 }
 
 //-----------------------------------------------------------------------------
 
+const QWebsSegment* qwebs_request_segments (QWebsRequest self, number_t* p_size)
+{
+  *p_size = self->segments_cnt - self->segments_pos;
+
+  return self->segments ? self->segments + self->segments_pos : NULL;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeMap qwebs_request_headers (QWebsRequest self)
 {
   return self->header_values;
@@ -525,9 +1068,158 @@ CapeMap qwebs_request_headers (QWebsRequest self)
 
 //-----------------------------------------------------------------------------
 
+const CapeString qwebs_request_header (QWebsRequest self, const CapeString name)
+{
+  const CapeString ret = NULL;
+
+  // most clients send the names as written in the RFC
+  CapeMapNode n = cape_map_find (self->header_values, name);
+  if (n)
+  {
+    ret = cape_map_node_value (n);
+  }
+  else
+  {
+    // field names are case insensitive (HTTP/2 uses lower case only)
+    CapeMapCursor cursor; cape_map_cursor_init (self->header_values, &cursor, CAPE_DIRECTION_FORW);
+
+    while (cape_map_cursor_next (&cursor))
+    {
+      if (cape_str_compare (cape_map_node_key (cursor.node), name))
+      {
+        ret = cape_map_node_value (cursor.node);
+        break;
+      }
+    }
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_request__range_number (const char** p_pos, number_t* p_value)
+{
+  const char* pos = *p_pos;
+  char* end;
+
+  if (*pos < '0' || *pos > '9')
+  {
+    return FALSE;
+  }
+
+  *p_value = strtoul (pos, &end, 10);
+  *p_pos = end;
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_request_range (QWebsRequest self, number_t size, const CapeString etag, const CapeString last_modified, number_t* p_offset, number_t* p_length)
+{
+  const char* pos;
+  number_t first;
+  number_t last;
+
+  pos = qwebs_request_header (self, "Range");
+  if (pos == NULL)
+  {
+    return QWEBS_RANGE_NONE;
+  }
+
+  // the range is only valid if the content was not changed
+  {
+    const CapeString validator = qwebs_request_header (self, "If-Range");
+    if (validator)
+    {
+      // etags must be compared strong, dates must be exact
+      if (!cape_str_equal (validator, validator[0] == '"' ? etag : last_modified))
+      {
+        return QWEBS_RANGE_NONE;
+      }
+    }
+  }
+
+  if (!cape_str_begins (pos, "bytes="))
+  {
+    return QWEBS_RANGE_NONE;
+  }
+
+  pos += 6;
+
+  // multiple ranges are not supported, send the whole content
+  if (strchr (pos, ','))
+  {
+    return QWEBS_RANGE_NONE;
+  }
+
+  if (*pos == '-')
+  {
+    pos++;
+
+    // suffix range: the last bytes of the content
+    if (!qwebs_request__range_number (&pos, &last) || *pos)
+    {
+      return QWEBS_RANGE_NONE;
+    }
+
+    if (last == 0 || size == 0)
+    {
+      return QWEBS_RANGE_ERR;
+    }
+
+    if (last > size)
+    {
+      last = size;
+    }
+
+    *p_offset = size - last;
+    *p_length = last;
+
+    return QWEBS_RANGE_PART;
+  }
+
+  if (!qwebs_request__range_number (&pos, &first) || *pos != '-')
+  {
+    return QWEBS_RANGE_NONE;
+  }
+
+  pos++;
+
+  if (*pos)
+  {
+    if (!qwebs_request__range_number (&pos, &last) || *pos || last < first)
+    {
+      return QWEBS_RANGE_NONE;
+    }
+  }
+  else
+  {
+    last = size - 1;
+  }
+
+  if (first >= size)
+  {
+    return QWEBS_RANGE_ERR;
+  }
+
+  if (last >= size)
+  {
+    last = size - 1;
+  }
+
+  *p_offset = first;
+  *p_length = last - first + 1;
+
+  return QWEBS_RANGE_PART;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeMap qwebs_request_query (QWebsRequest self)
 {
-  return self->option_values;
+  return self->has_query ? self->option_values : NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -539,6 +1231,13 @@ CapeStream qwebs_request_body (QWebsRequest self)
 
 //-----------------------------------------------------------------------------
 
+CapeUdc qwebs_request_parts (QWebsRequest self)
+{
+  return self->upload ? qwebs_upload_parts (self->upload) : NULL;
+}
+
+//-----------------------------------------------------------------------------
+
 const CapeString qwebs_request_method (QWebsRequest self)
 {
   return self->method;
@@ -546,7 +1245,7 @@ const CapeString qwebs_request_method (QWebsRequest self)
 
 //-----------------------------------------------------------------------------
 
-static void __STDCALL qwebs_request__internal__on_run (void* ptr, number_t pos)
+static void __STDCALL qwebs_request__internal__on_run (void* ptr, number_t pos, number_t queue_size)
 {
   QWebsRequest self = ptr;
 
@@ -556,12 +1255,7 @@ static void __STDCALL qwebs_request__internal__on_run (void* ptr, number_t pos)
   }
   else
   {
-    CapeStream s = qwebs_files_get (qwebs_files (self->webs), self, self->site, self->url);
-
-    if (s)
-    {
-      qwebs_connection_send (self->conn, &s);
-    }
+    qwebs_files_send (qwebs_files (self->webs), self, self->site, self->url);
 
     qwebs_request_del (&self);
   }
@@ -569,8 +1263,13 @@ static void __STDCALL qwebs_request__internal__on_run (void* ptr, number_t pos)
 
 //-----------------------------------------------------------------------------
 
-static void __STDCALL qwebs_request__internal__on_del (void* ptr, number_t pos)
+static void qwebs_request__internal__queue (QWebsRequest self)
 {
+  self->is_dispatched = TRUE;
+
+  // run the request in one of the worker threads
+  // -> the AIO thread continues with the other connections
+  cape_queue_add (self->api ? qwebs_connection__queue (self->conn) : qwebs_queue_files (self->webs), NULL, qwebs_request__internal__on_run, NULL, qwebs_request__internal__on_cancel, self, 0);
 }
 
 //-----------------------------------------------------------------------------
@@ -604,7 +1303,7 @@ QWebsProtHttp qwebs_prot_http_new ()
   self->settings.on_status = NULL;
   self->settings.on_header_field = qwebs_request__internal__on_header_field;
   self->settings.on_header_value = qwebs_request__internal__on_header_value;
-  self->settings.on_headers_complete = NULL;
+  self->settings.on_headers_complete = qwebs_request__internal__on_headers_complete;
   self->settings.on_body = qwebs_request__internal__on_body;
   self->settings.on_message_complete = qwebs_request__internal__on_message_complete;
   self->settings.on_chunk_header = NULL;
@@ -619,7 +1318,11 @@ void qwebs_prot_http_del (QWebsProtHttp* p_self)
 {
   if (*p_self)
   {
-    //QWebsProtHttp self = *p_self;
+    QWebsProtHttp self = *p_self;
+
+    // the connection was dropped while a request was received
+    // -> removes also the files of an incomplete upload
+    qwebs_request__internal__destroy ((QWebsRequest*)&(self->parser.data));
 
     CAPE_DEL (p_self, struct QWebsProtHttp_s);
   }
@@ -631,37 +1334,72 @@ void __STDCALL qwebs_prot_http__on_recv (void* user_ptr, QWebsConnection conn, c
 {
   QWebsProtHttp self = user_ptr;
 
-  if (NULL == self->parser.data)
+  // the buffer might contain more than one request (pipelining)
+  while (buflen > 0)
   {
-    // creates a new request instance
-    // increases the connection counter
-    self->parser.data = qwebs_connection_factory (conn);
-  }
+    number_t bytes_processed;
+
+    if (NULL == self->parser.data)
+    {
+      // creates a new request instance
+      // increases the connection counter
+      self->parser.data = qwebs_connection_factory (conn);
+    }
 
-  //int bytes_processed = http_parser_execute (&(self->parser), &(self->settings), bufdat, buflen);
-  http_parser_execute (&(self->parser), &(self->settings), bufdat, buflen);
+    bytes_processed = http_parser_execute (&(self->parser), &(self->settings), bufdat, buflen);
 
-  //printf ("BYTES PROCESSED: %i\n", bytes_processed);
+    if (HPE_PAUSED == self->parser.http_errno)
+    {
+      // the parser was stopped after a complete message
+      http_parser_pause (&(self->parser), 0);
+    }
+    else if (self->parser.http_errno > 0)
+    {
+      CapeString h = cape_str_catenate_3 (http_errno_name (self->parser.http_errno), " : ", http_errno_description ((enum http_errno)self->parser.http_errno));
 
-  if (self->parser.http_errno > 0)
-  {
-    CapeString h = cape_str_catenate_3 (http_errno_name (self->parser.http_errno), " : ", http_errno_description ((enum http_errno)self->parser.http_errno));
+      cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "on recv", "parser returned an error [%i]: %s", self->parser.http_errno, h);
 
-    cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "on recv", "parser returned an error [%i]: %s", self->parser.http_errno, h);
+      cape_str_del (&h);
 
-    cape_str_del (&h);
+      // close it
+      qwebs_connection_close (conn);
+      return;
+    }
 
-    // close it
-    qwebs_connection_close (conn);
-    return;
-  }
+    if (http_body_is_final (&(self->parser)))
+    {
+      return;
+    }
 
-  if (http_body_is_final (&(self->parser)))
-  {
-    return;
-  }
+    {
+      QWebsRequest request = self->parser.data;
+
+      if (!request->is_complete)
+      {
+        // wait for more data
+        return;
+      }
+    }
+
+    if (self->parser.upgrade)
+    {
+      // the protocol handler will be replaced, this object might be deleted
+      // -> take the request out of the parser, it must not point into a deleted object
+      // -> the rest of the buffer belongs to a different protocol
+      QWebsRequest request = self->parser.data;
+
+      self->parser.data = NULL;
 
-  qwebs_request_complete ((QWebsRequest*)&(self->parser.data), http_method_str (self->parser.method));
+      qwebs_request_complete (&request, http_method_str (self->parser.method));
+      return;
+    }
+
+    // transfers the ownership of the request
+    qwebs_request_complete ((QWebsRequest*)&(self->parser.data), http_method_str (self->parser.method));
+
+    bufdat += bytes_processed;
+    buflen -= bytes_processed;
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -683,8 +1421,15 @@ struct QWebsConnection_s
 
   CapeList send_cache;
 
+  CapeChunksPool chunks_pool;      // chunks for the responses
+
   CapeMutex mutex;
 
+  CapeList requests;               // complete requests waiting for the running one
+  int running;                     // one request of this connection is handled by a worker
+
+  QWebsRequest request_cache;      // released request, will be reused for the next message
+
   int close_connection;           // closes the connection for each request
   int active;
 
@@ -697,9 +1442,88 @@ struct QWebsConnection_s
 
 //-----------------------------------------------------------------------------
 
+typedef struct
+{
+  CapeChunks chunks;               // optional, header and content which are sent instead of the stream
+
+  CapeStream stream;               // will be sent first
+
+  CapeFileHandle fh;               // optional, a part of the file follows the stream
+  number_t offset;
+  number_t length;
+
+  QCryptDecrypt decrypt;           // optional, the decrypted content follows the stream in chunks
+  char* window;
+
+  const char* bufdat;              // optional, a buffer of the caller follows the stream
+  number_t buflen;
+
+  fct_qwebs__on_release on_release;
+  void* release_ptr;               // the buffer is valid until on_release was called
+
+} QWebsSendItem;
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_connection__item_del (QWebsSendItem** p_self)
+{
+  if (*p_self)
+  {
+    QWebsSendItem* self = *p_self;
+
+    cape_chunks_del (&(self->chunks));
+    cape_stream_del (&(self->stream));
+    cape_fh_del (&(self->fh));
+    qcrypt_decrypt_del (&(self->decrypt));
+
+    if (self->window)
+    {
+      CAPE_FREE (self->window);
+    }
+
+    if (self->on_release)
+    {
+      self->on_release (self->release_ptr);
+    }
+
+    CAPE_DEL (p_self, QWebsSendItem);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_connection__item_next (QWebsSendItem* self)
+{
+  // decrypt the next window of the file
+  number_t len = qcrypt_decrypt_next (self->decrypt, self->window, QWEBS_SEND_WINDOW);
+
+  // reuse the stream for all chunks
+  cape_stream_clr (self->stream);
+
+  if (len)
+  {
+    char buffer[20];
+
+    snprintf (buffer, 20, "%lx\r\n", (unsigned long)len);
+
+    cape_stream_append_str (self->stream, buffer);
+    cape_stream_append_buf (self->stream, self->window, len);
+    cape_stream_append_str (self->stream, "\r\n");
+  }
+  else
+  {
+    // last chunk
+    cape_stream_append_str (self->stream, "0\r\n\r\n");
+
+    qcrypt_decrypt_del (&(self->decrypt));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 static void __STDCALL qwebs_connection__cache__on_del (void* ptr)
 {
-  CapeStream s = ptr; cape_stream_del (&s);
+  QWebsSendItem* item = ptr; qwebs_connection__item_del (&item);
 }
 
 //-----------------------------------------------------------------------------
@@ -722,6 +1546,15 @@ QWebsConnection qwebs_connection_new (void* handle, CapeQueue queue, QWebs webs,
   self->send_cache = cape_list_new (qwebs_connection__cache__on_del);
   self->mutex = cape_mutex_new ();
 
+  // keep one chunk for the next response
+  self->chunks_pool = cape_chunks_pool_new (0, 1);
+
+  // all requests hold a reference, the list is empty when the connection is deleted
+  self->requests = cape_list_new (NULL);
+  self->running = FALSE;
+
+  self->request_cache = NULL;
+
   self->close_connection = FALSE;
   self->active = FALSE;
 
@@ -747,6 +1580,12 @@ void qwebs_connection_del (QWebsConnection* p_self)
     cape_list_del (&(self->send_cache));
     cape_mutex_del (&(self->mutex));
 
+    cape_list_del (&(self->requests));
+    qwebs_request__internal__destroy (&(self->request_cache));
+
+    // all send items are released
+    cape_chunks_pool_del (&(self->chunks_pool));
+
     cape_str_del (&(self->remote));
 
     if (self->on_del)
@@ -762,9 +1601,88 @@ void qwebs_connection_del (QWebsConnection* p_self)
 
 QWebsRequest qwebs_connection_factory (QWebsConnection self)
 {
+  QWebsRequest ret;
+
   self->active = TRUE;
 
-  return qwebs_request_new (self->webs, self);
+  cape_mutex_lock (self->mutex);
+
+  ret = self->request_cache;
+  self->request_cache = NULL;
+
+  cape_mutex_unlock (self->mutex);
+
+  if (ret == NULL)
+  {
+    ret = qwebs_request_new (self->webs, self);
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_connection__dispatch (QWebsConnection self, QWebsRequest request)
+{
+  cape_mutex_lock (self->mutex);
+
+  if (self->running)
+  {
+    // pipelined request, the responses must be sent in the same order
+    // -> wait until the running request was released
+    cape_list_push_back (self->requests, request);
+    request = NULL;
+  }
+  else
+  {
+    self->running = TRUE;
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  if (request)
+  {
+    self->close_connection = request->close_connection;
+
+    qwebs_request__internal__queue (request);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_connection__release (QWebsConnection self, QWebsRequest request, int was_dispatched)
+{
+  QWebsRequest next = NULL;
+
+  cape_mutex_lock (self->mutex);
+
+  if (was_dispatched)
+  {
+    // continue with the next pipelined request
+    next = cape_list_pop_front (self->requests);
+
+    if (next == NULL)
+    {
+      self->running = FALSE;
+    }
+  }
+
+  if (self->request_cache == NULL)
+  {
+    self->request_cache = request;
+    request = NULL;
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  qwebs_request__internal__destroy (&request);
+
+  if (next)
+  {
+    self->close_connection = next->close_connection;
+
+    qwebs_request__internal__queue (next);
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -776,32 +1694,74 @@ void qwebs_connection_close (QWebsConnection self)
 
 //-----------------------------------------------------------------------------
 
+static void qwebs_connection__item_send (QWebsConnection self, QWebsSendItem* item)
+{
+  if (item->chunks)
+  {
+    // header and content are written together with one vectored write
+    cape_aio_socket_send_chunks (self->aio_socket, self->aio_attached, item->chunks, item);
+  }
+  else if (item->stream)
+  {
+    cape_aio_socket_send (self->aio_socket, self->aio_attached, cape_stream_get (item->stream), cape_stream_size (item->stream), item);
+  }
+  else if (item->bufdat)
+  {
+    cape_aio_socket_send (self->aio_socket, self->aio_attached, item->bufdat, item->buflen, item);
+  }
+  else
+  {
+    // the file content is copied by the kernel
+    cape_aio_socket_send_file (self->aio_socket, self->aio_attached, cape_fh_fd (item->fh), item->offset, item->length, item);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 static void __STDCALL qwebs_connection__internal__on_send_ready (void* ptr, CapeAioSocket socket, void* userdata)
 {
   QWebsConnection self = ptr;
 
-  CapeStream s;
+  QWebsSendItem* item;
 
   // check for userdata
   if (userdata)
   {
-    // userdata is always a stream
-    s = userdata;
+    // userdata is always a send item
+    item = userdata;
+
+    if (item->stream && (item->fh || item->bufdat))
+    {
+      // the stream was sent, continue with the file or the buffer
+      cape_stream_del (&(item->stream));
+
+      qwebs_connection__item_send (self, item);
+      return;
+    }
+
+    if (item->decrypt)
+    {
+      // the stream was sent, continue with the next chunk
+      qwebs_connection__item_next (item);
 
-    // cleanup stream
-    cape_stream_del (&s);
+      qwebs_connection__item_send (self, item);
+      return;
+    }
+
+    // cleanup
+    qwebs_connection__item_del (&item);
   }
 
   cape_mutex_lock (self->mutex);
 
-  s = cape_list_pop_front (self->send_cache);
+  item = cape_list_pop_front (self->send_cache);
 
   cape_mutex_unlock (self->mutex);
 
-  if (s)
+  if (item)
   {
-    // if we do have a stream send it to the socket
-    cape_aio_socket_send (self->aio_socket, self->aio_attached, cape_stream_get (s), cape_stream_size (s), s);
+    // if we do have an item send it to the socket
+    qwebs_connection__item_send (self, item);
   }
   else if (self->active == FALSE)
   {
@@ -822,7 +1782,10 @@ void qwebs_request_complete (QWebsRequest* p_self, const CapeString method)
 {
   QWebsRequest self = *p_self;
 
-  cape_str_replace_cp (&(self->method), method);
+  self->method = method;
+
+  // the complete request keeps the connection alive
+  qwebs_connection_inc (self->conn);
 
   //printf ("METHOD %s (COMPLETE %i)\n", request->method, request->is_complete);
 
@@ -861,7 +1824,8 @@ void qwebs_request_complete (QWebsRequest* p_self, const CapeString method)
 
         //cape_log_fmt (CAPE_LL_TRACE, "WEBS", "on recv", "connection type: %s", connection_type);
 
-        self->conn->close_connection = cape_str_equal (connection_type, "close");
+        // will be applied when the request runs, the requests before still need the connection
+        self->close_connection = cape_str_equal (connection_type, "close");
       }
       else
       {
@@ -869,20 +1833,10 @@ void qwebs_request_complete (QWebsRequest* p_self, const CapeString method)
       }
     }
 
-    if (self->api)
-    {
-      qwebs_request_api (p_self);
-    }
-    else
-    {
-      CapeStream s = qwebs_files_get (qwebs_files (self->webs), self, self->site, self->url);
-      if (s)
-      {
-        qwebs_connection_send (self->conn, &s);
-      }
+    // the ownership was transfered to the connection
+    qwebs_connection__dispatch (self->conn, self);
 
-      qwebs_request_del (p_self);
-    }
+    *p_self = NULL;
   }
 }
 
@@ -912,11 +1866,10 @@ static void __STDCALL qwebs_connection__internal__on_done (void* ptr, void* user
   // check for userdata
   if (userdata)
   {
-    // userdata is always a stream
-    CapeStream s = userdata;
+    // userdata is always a send item
+    QWebsSendItem* item = userdata;
 
-    // cleanup stream
-    cape_stream_del (&s);
+    qwebs_connection__item_del (&item);
   }
 
   qwebs_connection_del (&self);
@@ -941,28 +1894,181 @@ void qwebs_connection_attach (QWebsConnection self, CapeAioContext aio_context)
 
 //-----------------------------------------------------------------------------
 
-void qwebs_connection_send (QWebsConnection self, CapeStream* p_stream)
+static void qwebs_connection__push (QWebsConnection self, QWebsSendItem* item)
 {
   cape_mutex_lock (self->mutex);
 
   if (cape_list_size (self->send_cache) < 30)
   {
-    cape_list_push_back (self->send_cache, *p_stream);
-    *p_stream = NULL;
+    cape_list_push_back (self->send_cache, item);
+    item = NULL;
   }
-  else
+
+  cape_mutex_unlock (self->mutex);
+
+  if (item)
   {
-    cape_stream_del (p_stream);
+    qwebs_connection__item_del (&item);
     cape_log_msg (CAPE_LL_WARN, "QWEBS", "connection send", "send buffer reached maximum queue size");
   }
 
-  cape_mutex_unlock (self->mutex);
-
   cape_aio_socket_markSent (self->aio_socket, self->aio_attached);
 }
 
 //-----------------------------------------------------------------------------
 
+void qwebs_connection_send (QWebsConnection self, CapeStream* p_stream)
+{
+  QWebsSendItem* item = CAPE_NEW (QWebsSendItem);
+
+  item->chunks = NULL;
+
+  item->stream = *p_stream;
+  *p_stream = NULL;
+
+  item->fh = NULL;
+  item->offset = 0;
+  item->length = 0;
+
+  item->decrypt = NULL;
+  item->window = NULL;
+
+  item->bufdat = NULL;
+  item->buflen = 0;
+  item->on_release = NULL;
+  item->release_ptr = NULL;
+
+  qwebs_connection__push (self, item);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_connection_send_file (QWebsConnection self, CapeStream* p_header, CapeFileHandle* p_fh, number_t offset, number_t length)
+{
+  QWebsSendItem* item = CAPE_NEW (QWebsSendItem);
+
+  item->chunks = NULL;
+
+  item->stream = *p_header;
+  *p_header = NULL;
+
+  item->fh = *p_fh;
+  *p_fh = NULL;
+
+  item->offset = offset;
+  item->length = length;
+
+  item->decrypt = NULL;
+  item->window = NULL;
+
+  item->bufdat = NULL;
+  item->buflen = 0;
+  item->on_release = NULL;
+  item->release_ptr = NULL;
+
+  qwebs_connection__push (self, item);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_connection_send_decrypt (QWebsConnection self, CapeStream* p_header, QCryptDecrypt* p_decrypt)
+{
+  QWebsSendItem* item = CAPE_NEW (QWebsSendItem);
+
+  item->chunks = NULL;
+
+  item->stream = *p_header;
+  *p_header = NULL;
+
+  item->fh = NULL;
+  item->offset = 0;
+  item->length = 0;
+
+  item->decrypt = *p_decrypt;
+  *p_decrypt = NULL;
+
+  // the decryption might produce one block more than it reads
+  item->window = CAPE_ALLOC (QWEBS_SEND_WINDOW + 64);
+
+  item->bufdat = NULL;
+  item->buflen = 0;
+  item->on_release = NULL;
+  item->release_ptr = NULL;
+
+  qwebs_connection__push (self, item);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_connection_send_content (QWebsConnection self, CapeStream* p_header, const char* bufdat, number_t buflen, const CapeString trailer)
+{
+  QWebsSendItem* item = CAPE_NEW (QWebsSendItem);
+
+  // the content is not copied into the header stream
+  item->chunks = cape_chunks_new (self->chunks_pool);
+
+  cape_chunks_append_stream (item->chunks, *p_header);
+  cape_chunks_append_buf (item->chunks, bufdat, buflen);
+
+  if (trailer)
+  {
+    cape_chunks_append_str (item->chunks, trailer);
+  }
+
+  cape_stream_del (p_header);
+
+  item->stream = NULL;
+
+  item->fh = NULL;
+  item->offset = 0;
+  item->length = 0;
+
+  item->decrypt = NULL;
+  item->window = NULL;
+
+  item->bufdat = NULL;
+  item->buflen = 0;
+  item->on_release = NULL;
+  item->release_ptr = NULL;
+
+  qwebs_connection__push (self, item);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_connection_send_ref (QWebsConnection self, CapeStream* p_header, const char* bufdat, number_t buflen, void* ptr, fct_qwebs__on_release on_release)
+{
+  QWebsSendItem* item = CAPE_NEW (QWebsSendItem);
+
+  item->chunks = NULL;
+
+  item->stream = *p_header;
+  *p_header = NULL;
+
+  item->fh = NULL;
+  item->offset = 0;
+  item->length = 0;
+
+  item->decrypt = NULL;
+  item->window = NULL;
+
+  item->bufdat = bufdat;
+  item->buflen = buflen;
+  item->on_release = on_release;
+  item->release_ptr = ptr;
+
+  qwebs_connection__push (self, item);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeQueue qwebs_connection__queue (QWebsConnection self)
+{
+  return self->queue;
+}
+
+//-----------------------------------------------------------------------------
+
 void qwebs_connection_inc (QWebsConnection self)
 {
   cape_aio_socket_inref (self->aio_socket);
@@ -972,8 +2078,21 @@ void qwebs_connection_inc (QWebsConnection self)
 
 void qwebs_connection_dec (QWebsConnection self)
 {
+  if (!self->running)
+  {
+    // no pipelined request is waiting for its response
+    self->active = FALSE;
+  }
+
+  if (self->close_connection)
+  {
+    // the request might have been finished in a worker thread after the response was sent
+    // -> trigger the send ready event again to close the connection
+    cape_aio_socket_markSent (self->aio_socket, self->aio_attached);
+  }
+
+  // might delete the connection
   cape_aio_socket_unref (self->aio_socket);
-  self->active = FALSE;
 }
 
 //-----------------------------------------------------------------------------
@@ -14,6 +14,7 @@
 #include <stc/cape_list.h>
 #include <stc/cape_map.h>
 #include <stc/cape_udc.h>
+#include <sys/cape_file.h>
 
 //-----------------------------------------------------------------------------
 
@@ -29,6 +30,12 @@ __CAPE_LIBEX     QWebsRequest       qwebs_connection_factory    (QWebsConnection
 
 __CAPE_LIBEX     void               qwebs_connection_send       (QWebsConnection, CapeStream*);
 
+                                    /* sends the header followed by a part of the opened file, takes the ownership of both */
+__CAPE_LIBEX     void               qwebs_connection_send_file  (QWebsConnection, CapeStream* p_header, CapeFileHandle* p_fh, number_t offset, number_t length);
+
+                                    /* sends the header followed by a buffer which is not copied, on_release is called with ptr after the buffer was sent */
+__CAPE_LIBEX     void               qwebs_connection_send_ref   (QWebsConnection, CapeStream* p_header, const char* bufdat, number_t buflen, void* ptr, fct_qwebs__on_release);
+
 __CAPE_LIBEX     void               qwebs_connection_close      (QWebsConnection);
 
 //-----------------------------------------------------------------------------
@@ -51,14 +58,40 @@ __CAPE_LIBEX     void               qwebs_request_stream_buf    (QWebsRequest, c
 
 //-----------------------------------------------------------------------------
 
+typedef struct
+{
+  const char* bufdat;
+  number_t buflen;
+
+} QWebsSegment;
+
+                                    /* the parts of the url as list of strings (without the API name), the list is created on the first call */
 __CAPE_LIBEX     CapeList           qwebs_request_clist         (QWebsRequest);
 
+                                    /* the same parts as slices into the url of the request, valid as long as the request exists */
+__CAPE_LIBEX     const QWebsSegment* qwebs_request_segments     (QWebsRequest, number_t* p_size);
+
 __CAPE_LIBEX     CapeMap            qwebs_request_headers       (QWebsRequest);
 
+                                    /* returns the value of a header field or NULL, the name is matched case insensitive */
+__CAPE_LIBEX     const CapeString   qwebs_request_header        (QWebsRequest, const CapeString name);
+
+#define QWEBS_RANGE_NONE    0      // no (usable) range, send the whole content
+#define QWEBS_RANGE_PART    1      // offset and length are set
+#define QWEBS_RANGE_ERR     2      // the range is outside of the content -> 416
+
+                                    /* evaluates the Range and If-Range headers for a content of size bytes
+                                       etag and last_modified are the validators of the content (can be NULL) */
+__CAPE_LIBEX     int                qwebs_request_range         (QWebsRequest, number_t size, const CapeString etag, const CapeString last_modified, number_t* p_offset, number_t* p_length);
+
 __CAPE_LIBEX     CapeMap            qwebs_request_query         (QWebsRequest);
 
 __CAPE_LIBEX     CapeStream         qwebs_request_body          (QWebsRequest);
 
+                                    /* the parts of a multipart body which was parsed while receiving (see qwebs_set_upload)
+                                       returns NULL if the body is available as stream, the files are removed with the request */
+__CAPE_LIBEX     CapeUdc            qwebs_request_parts         (QWebsRequest);
+
 __CAPE_LIBEX     const CapeString   qwebs_request_method        (QWebsRequest);
 
 __CAPE_LIBEX     CapeString         qwebs_request_remote        (QWebsRequest);
@@ -1,19 +1,63 @@
 #include "qwebs_files.h"
 #include "qwebs_response.h"
+#include "qwebs_connection.h"
+#include "qwebs_compress.h"
 #include "qwebs.h"
 
 // cape includes
 #include <sys/cape_types.h>
 #include <sys/cape_file.h>
 #include <sys/cape_log.h>
+#include <stc/cape_hash.h>
+#include <sys/cape_mutex.h>
+#include <sys/cape_time.h>
 #include <stc/cape_map.h>
 
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+// files up to this size are kept in memory, larger files are sent with sendfile
+#define QWEBS_FILES_CACHE_MAX_CONTENT   262144
+
+// maximum of all file contents kept in memory
+#define QWEBS_FILES_CACHE_MAX_TOTAL     67108864
+
+#define QWEBS_FILES_CACHE_MAX_ENTRIES   10000
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  int refcnt;                      // the cache and each response in progress hold a reference
+
+  CapeFileInfo info;               // to detect changes of the file
+
+  const CapeString mime;           // reference
+  const CapeString encoding;       // reference
+
+  CapeString etag;                 // validators for conditional requests
+  CapeString last_modified;
+
+  CapeStream header;               // preformatted header of the whole content
+
+  CapeStream content;              // NULL -> the content is sent with sendfile
+
+} QWebsFilesEntry;
+
 //-----------------------------------------------------------------------------
 
 struct QWebsFiles_s
 {
-  CapeMap mime_types;
+  CapeHash mime_types;
   QWebs webs;
+
+  CapeMutex mutex;
+
+  CapeHash cache;                  // resolved path -> QWebsFilesEntry
+  number_t cache_size;             // sum of all contents in the cache
 };
 
 //-----------------------------------------------------------------------------
@@ -24,25 +68,99 @@ static void __STDCALL qwebs_files__intern__on_mime_types_del (void* key, void* v
 
 //-----------------------------------------------------------------------------
 
+static QWebsFilesEntry* qwebs_files__entry_inc (QWebsFilesEntry* self)
+{
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+  __sync_add_and_fetch (&(self->refcnt), 1);
+
+#else
+
+  (self->refcnt)++;
+
+#endif
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_files__entry_del (QWebsFilesEntry** p_self)
+{
+  if (*p_self)
+  {
+    QWebsFilesEntry* self = *p_self;
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+
+    int val = __sync_sub_and_fetch (&(self->refcnt), 1);
+
+#else
+
+    int val = --(self->refcnt);
+
+#endif
+
+    if (val == 0)
+    {
+      cape_stream_del (&(self->header));
+      cape_stream_del (&(self->content));
+      cape_str_del (&(self->etag));
+      cape_str_del (&(self->last_modified));
+
+      CAPE_DEL (p_self, QWebsFilesEntry);
+    }
+    else
+    {
+      *p_self = NULL;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_files__entry__on_release (void* ptr)
+{
+  QWebsFilesEntry* h = ptr; qwebs_files__entry_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_files__intern__on_cache_del (void* key, void* val)
+{
+  {
+    CapeString h = key; cape_str_del (&h);
+  }
+  {
+    QWebsFilesEntry* h = val; qwebs_files__entry_del (&h);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 QWebsFiles qwebs_files_new (QWebs webs)
 {
   QWebsFiles self = CAPE_NEW (struct QWebsFiles_s);
   
   self->webs = webs;
-  self->mime_types = cape_map_new (NULL, qwebs_files__intern__on_mime_types_del, NULL);
+  self->mime_types = cape_hash_new (NULL, NULL, qwebs_files__intern__on_mime_types_del, NULL);
+
+  self->mutex = cape_mutex_new ();
+  self->cache = cape_hash_new (NULL, NULL, qwebs_files__intern__on_cache_del, NULL);
+  self->cache_size = 0;
   
-  cape_map_insert (self->mime_types, "html",  "text/html; charset=utf-8");
-  cape_map_insert (self->mime_types, "htm",   "text/html; charset=utf-8");
-  cape_map_insert (self->mime_types, "css",   "text/css");
-  cape_map_insert (self->mime_types, "js",    "text/javascript; charset=utf-8");
-  cape_map_insert (self->mime_types, "ico",   "image/vnd.microsoft.icon");
-  cape_map_insert (self->mime_types, "png",   "image/png");
-  cape_map_insert (self->mime_types, "jpeg",  "image/jpeg");
-  cape_map_insert (self->mime_types, "jpg",   "image/jpeg");
-  cape_map_insert (self->mime_types, "jpe",   "image/jpeg");
-  cape_map_insert (self->mime_types, "svg",   "image/svg+xml");
-  cape_map_insert (self->mime_types, "json",  "application/json; charset=utf-8");
-  cape_map_insert (self->mime_types, "pdf",   "application/pdf");
+  cape_hash_insert (self->mime_types, "html",  "text/html; charset=utf-8");
+  cape_hash_insert (self->mime_types, "htm",   "text/html; charset=utf-8");
+  cape_hash_insert (self->mime_types, "css",   "text/css");
+  cape_hash_insert (self->mime_types, "js",    "text/javascript; charset=utf-8");
+  cape_hash_insert (self->mime_types, "ico",   "image/vnd.microsoft.icon");
+  cape_hash_insert (self->mime_types, "png",   "image/png");
+  cape_hash_insert (self->mime_types, "jpeg",  "image/jpeg");
+  cape_hash_insert (self->mime_types, "jpg",   "image/jpeg");
+  cape_hash_insert (self->mime_types, "jpe",   "image/jpeg");
+  cape_hash_insert (self->mime_types, "svg",   "image/svg+xml");
+  cape_hash_insert (self->mime_types, "json",  "application/json; charset=utf-8");
+  cape_hash_insert (self->mime_types, "pdf",   "application/pdf");
 
   return self;
 }
@@ -55,7 +173,9 @@ void qwebs_files_del (QWebsFiles* p_self)
   {
     QWebsFiles self = *p_self;
     
-    cape_map_del (&(self->mime_types));
+    cape_hash_del (&(self->mime_types));
+    cape_hash_del (&(self->cache));
+    cape_mutex_del (&(self->mutex));
     
     CAPE_DEL (p_self, struct QWebsFiles_s);
   }
@@ -67,10 +187,10 @@ const CapeString qwebs_files_mime (QWebsFiles self, const CapeString extension)
 {
   if (extension)
   {
-    CapeMapNode n = cape_map_find (self->mime_types, extension);
+    CapeHashNode n = cape_hash_find (self->mime_types, extension);
     if (n)
     {
-      return cape_map_node_value (n);
+      return cape_hash_node_value (n);
     }
   }
   
@@ -79,79 +199,502 @@ const CapeString qwebs_files_mime (QWebsFiles self, const CapeString extension)
 
 //-----------------------------------------------------------------------------
 
-CapeStream qwebs_files_get (QWebsFiles self, QWebsRequest request, const CapeString site, const CapeString path)
+static int __STDCALL qwebs_files__on_load (void* ptr, const char* bufdat, number_t buflen, CapeErr err)
 {
-  CapeStream ret = NULL;
-  
+  cape_stream_append_buf (ptr, bufdat, buflen);
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_files__info_equal (const CapeFileInfo* a, const CapeFileInfo* b)
+{
+  return a->size == b->size && a->mtime == b->mtime && a->mtime_ns == b->mtime_ns && a->inode == b->inode;
+}
+
+//-----------------------------------------------------------------------------
+
+static QWebsFilesEntry* qwebs_files__entry_new (QWebsFiles self, const CapeString file, const CapeString mime, const CapeString encoding, const CapeFileInfo* info, int load_content, CapeErr err)
+{
+  QWebsFilesEntry* ret = CAPE_NEW (QWebsFilesEntry);
+
+  ret->refcnt = 1;
+  ret->info = *info;
+  ret->mime = mime;
+  ret->encoding = encoding;
+  ret->header = cape_stream_new ();
+  ret->content = NULL;
+
+  // strong validator, each encoding has its own
+  {
+    char buffer[100];
+
+    snprintf (buffer, 100, "\"%lx-%lx-%lx%s%s\"", (unsigned long)info->inode, (unsigned long)info->size, (unsigned long)(info->mtime * 1000 + info->mtime_ns / 1000000), encoding ? "-" : "", encoding ? encoding : "");
+
+    ret->etag = cape_str_cp (buffer);
+  }
+
+  {
+    CapeDatetime dt;
+
+    cape_datetime_utc__s (&dt, (time_t)info->mtime);
+
+    ret->last_modified = cape_datetime_s__gmt (&dt);
+  }
+
+  qwebs_response_file_header (ret->header, self->webs, ret->mime, ret->encoding, ret->etag, ret->last_modified, info->size);
+
+  if (load_content && info->size <= QWEBS_FILES_CACHE_MAX_CONTENT)
+  {
+    ret->content = cape_stream_new ();
+
+    if (cape_fs_file_load (NULL, file, ret->content, qwebs_files__on_load, err))
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
+
+      qwebs_files__entry_del (&ret);
+      return NULL;
+    }
+
+    if (cape_stream_size (ret->content) != info->size)
+    {
+      // the file was changed while loading, use sendfile for this request
+      // and force a reload for the next request
+      ret->info.mtime = 0;
+
+      cape_stream_del (&(ret->content));
+    }
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_files__etag_match (const CapeString etag, const char* pos)
+{
+  number_t len = cape_str_size (etag);
+
+  while (*pos)
+  {
+    const char* end;
+
+    // skip spaces and separators
+    while (*pos == ' ' || *pos == ',')
+    {
+      pos++;
+    }
+
+    if (*pos == '*')
+    {
+      return TRUE;
+    }
+
+    // weak comparison
+    if (pos[0] == 'W' && pos[1] == '/')
+    {
+      pos += 2;
+    }
+
+    end = pos;
+
+    while (*end && *end != ',' && *end != ' ')
+    {
+      end++;
+    }
+
+    if ((number_t)(end - pos) == len && strncmp (pos, etag, len) == 0)
+    {
+      return TRUE;
+    }
+
+    pos = end;
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_files__not_modified (QWebsFilesEntry* entry, QWebsRequest request)
+{
+  const CapeString value;
+
+  // if-none-match has precedence
+  value = qwebs_request_header (request, "If-None-Match");
+  if (value)
+  {
+    return qwebs_files__etag_match (entry->etag, value);
+  }
+
+  value = qwebs_request_header (request, "If-Modified-Since");
+  if (value)
+  {
+    CapeDatetime dt;
+
+    if (cape_datetime__gmt (&dt, value))
+    {
+      return entry->info.mtime <= (number_t)cape_datetime_n__unix (&dt);
+    }
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeStream qwebs_files__entry_response (QWebsFiles self, QWebsFilesEntry* entry, QWebsRequest request, int* p_has_content, number_t* p_offset, number_t* p_length)
+{
+  CapeStream ret = cape_stream_new ();
+
+  number_t offset = 0;
+  number_t length = entry->info.size;
+
+  // the entry doesn't change, only the header of this request is created
+  if (qwebs_files__not_modified (entry, request))
+  {
+    qwebs_response_not_modified (ret, self->webs, entry->etag, entry->last_modified);
+
+    // no content follows
+    *p_has_content = TRUE;
+    length = 0;
+  }
+  else switch (qwebs_request_range (request, entry->info.size, entry->etag, entry->last_modified, &offset, &length))
+  {
+    case QWEBS_RANGE_PART:
+    {
+      qwebs_response_file_header_range (ret, self->webs, entry->mime, entry->encoding, entry->etag, entry->last_modified, offset, length, entry->info.size);
+
+      *p_has_content = entry->content != NULL;
+      break;
+    }
+    case QWEBS_RANGE_ERR:
+    {
+      qwebs_response_range_err (ret, self->webs, entry->info.size);
+
+      // no content follows
+      *p_has_content = TRUE;
+      offset = 0;
+      length = 0;
+      break;
+    }
+    default:
+    {
+      offset = 0;
+      length = entry->info.size;
+
+      cape_stream_append_stream (ret, entry->header);
+
+      *p_has_content = entry->content != NULL;
+      break;
+    }
+  }
+
+  *p_offset = offset;
+  *p_length = length;
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static QWebsFilesEntry* qwebs_files__cache_get (QWebsFiles self, const CapeString file, const CapeString mime, const CapeString encoding, const CapeFileInfo* info, CapeErr err)
+{
+  QWebsFilesEntry* ret = NULL;
+  int load_content;
+
+  cape_mutex_lock (self->mutex);
+
+  {
+    CapeHashNode n = cape_hash_find (self->cache, file);
+    if (n)
+    {
+      QWebsFilesEntry* entry = cape_hash_node_value (n);
+
+      if (qwebs_files__info_equal (&(entry->info), info))
+      {
+        // the content is shared, the response is created without holding the lock
+        ret = qwebs_files__entry_inc (entry);
+      }
+    }
+  }
+
+  // files which don't fit into the cache are sent with sendfile
+  load_content = self->cache_size + info->size <= QWEBS_FILES_CACHE_MAX_TOTAL;
+
+  cape_mutex_unlock (self->mutex);
+
+  if (ret)
+  {
+    return ret;
+  }
+
+  // load the file without holding the lock
+  ret = qwebs_files__entry_new (self, file, mime, encoding, info, load_content, err);
+  if (ret == NULL)
+  {
+    return NULL;
+  }
+
+  cape_mutex_lock (self->mutex);
+
+  {
+    CapeHashNode n = cape_hash_find (self->cache, file);
+    if (n)
+    {
+      QWebsFilesEntry* old_entry = cape_hash_node_mv (n);
+
+      if (old_entry->content)
+      {
+        self->cache_size -= old_entry->info.size;
+      }
+
+      // responses in progress might still use the old entry
+      qwebs_files__entry_del (&old_entry);
+    }
+    else if (cape_hash_size (self->cache) >= QWEBS_FILES_CACHE_MAX_ENTRIES)
+    {
+      cape_log_msg (CAPE_LL_DEBUG, "QWEBS", "files cache", "maximum of entries reached, clear the cache");
+
+      cape_hash_clr (self->cache);
+      self->cache_size = 0;
+    }
+
+    if (ret->content && self->cache_size + info->size > QWEBS_FILES_CACHE_MAX_TOTAL)
+    {
+      // other requests have filled the cache meanwhile, the content is only used for this request
+      if (n)
+      {
+        cape_hash_erase (self->cache, n);
+      }
+    }
+    else
+    {
+      if (ret->content)
+      {
+        self->cache_size += info->size;
+      }
+
+      if (n)
+      {
+        cape_hash_node_set (n, qwebs_files__entry_inc (ret));
+      }
+      else
+      {
+        cape_hash_insert (self->cache, cape_str_cp (file), qwebs_files__entry_inc (ret));
+      }
+    }
+  }
+
+  cape_mutex_unlock (self->mutex);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeStream qwebs_files__response_err (QWebsFiles self, const CapeString mime, CapeErr err)
+{
+  CapeStream ret = cape_stream_new ();
+
+  //cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "send file", "got error: %s", cape_err_text (err));
+  qwebs_response_err (ret, self->webs, NULL, mime, err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeString qwebs_files__sibling (const CapeString file, const CapeString extension, CapeFileInfo* info)
+{
+  CapeString ret = cape_str_catenate_2 (file, extension);
+
+  // local objects
+  CapeErr err = cape_err_new ();
+
+  if (cape_fs_file_info (ret, info, err) || !info->regular)
+  {
+    cape_str_del (&ret);
+  }
+
+  cape_err_del (&err);
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_files_send (QWebsFiles self, QWebsRequest request, const CapeString site, const CapeString path)
+{
+  int res;
+  CapeFileInfo info;
+
+  int has_content;
+  number_t offset;
+  number_t length;
+
+  const CapeString mime = qwebs_files_mime (self, cape_fs_extension (path));
+  const CapeString err_mime = "application/json";
+  const CapeString encoding = NULL;
+  const CapeString file;
+
   // local objects
   CapeErr err = cape_err_new ();
-  CapeUdc file_node = cape_udc_new (CAPE_UDC_NODE, NULL);
   CapeString file_relative = cape_fs_path_merge (site, path);
   CapeString file_rebuild = NULL;
-  
+  CapeString file_encoded = NULL;
+  CapeStream s = NULL;
+  CapeFileHandle fh = NULL;
+  QWebsFilesEntry* entry = NULL;
+
+  cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "files send", "path: %s", file_relative);
+
+  // retrieve an absolute path
+  file_rebuild = cape_fs_path_rebuild (file_relative, err);
+  if (file_rebuild == NULL)
   {
-    cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "files get", "path: %s", file_relative);
+    cape_log_msg (CAPE_LL_WARN, "QWEBS", "files send", "file path invalid");
 
-    // retrieve an absolute path
-    file_rebuild = cape_fs_path_rebuild (file_relative, err);
-    if (file_rebuild == NULL)
+    cape_err_set (err, CAPE_ERR_NOT_FOUND, "not found");
+
+    // report an incident
+    if (qwebs_raise_file (self->webs, file_rebuild, request))
     {
-      cape_log_msg (CAPE_LL_WARN, "QWEBS", "files get", "file path invalid");
-      
-      cape_err_set (err, CAPE_ERR_NOT_FOUND, "not found");
+      // do something special here
 
-      // report an incident
-      if (qwebs_raise_file (self->webs, file_rebuild, request))
-      {
-        // do something special here
-        
-      }
+    }
+
+    // it seems to be no valid file
+    goto exit_and_cleanup;
+  }
+
+  if (!cape_str_begins (file_rebuild, site))
+  {
+    cape_log_msg (CAPE_LL_WARN, "QWEBS", "files send", "file outside site path");
+
+    cape_err_set (err, CAPE_ERR_NOT_FOUND, "not found");
+
+    // report an incident
+    if (qwebs_raise_file (self->webs, file_rebuild, request))
+    {
+      // do something special here
+
+    }
+
+    // it seems to be no valid file
+    goto exit_and_cleanup;
+  }
+
+  err_mime = mime;
+
+  if (qwebs_compress_mime (mime))
+  {
+    int accepted = qwebs_compress_accepted (request);
+
+    // try the precompressed siblings of the file
+    if (accepted & QWEBS_ENCODING_BR)
+    {
+      file_encoded = qwebs_files__sibling (file_rebuild, ".br", &info);
+      encoding = "br";
+    }
+
+    if (file_encoded == NULL && (accepted & QWEBS_ENCODING_GZIP))
+    {
+      file_encoded = qwebs_files__sibling (file_rebuild, ".gz", &info);
+      encoding = "gzip";
+    }
+  }
+
+  if (file_encoded)
+  {
+    file = file_encoded;
+  }
+  else
+  {
+    file = file_rebuild;
+    encoding = NULL;
 
-      // it seems to be no valid file
+    // one stat call to validate the cached entry
+    res = cape_fs_file_info (file_rebuild, &info, err);
+    if (res || !info.regular)
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
       goto exit_and_cleanup;
     }
-    
-    if (!cape_str_begins (file_rebuild, site))
-    {
-      cape_log_msg (CAPE_LL_WARN, "QWEBS", "files get", "file outside site path");
-      
-      cape_err_set (err, CAPE_ERR_NOT_FOUND, "not found");
-      
-      // report an incident
-      if (qwebs_raise_file (self->webs, file_rebuild, request))
-      {
-        // do something special here
-        
-      }
-      
-      // it seems to be no valid file
+  }
+
+  entry = qwebs_files__cache_get (self, file, mime, encoding, &info, err);
+  if (entry == NULL)
+  {
+    goto exit_and_cleanup;
+  }
+
+  s = qwebs_files__entry_response (self, entry, request, &has_content, &offset, &length);
+
+  if (has_content)
+  {
+    if (length > 0)
+    {
+      // the content is sent from the cached entry, the connection releases the entry
+      qwebs_connection_send_ref (qwebs_request_conn (request), &s, cape_stream_data (entry->content) + offset, length, entry, qwebs_files__entry__on_release);
+
+      entry = NULL;
+    }
+    else
+    {
+      // no content follows
+      qwebs_connection_send (qwebs_request_conn (request), &s);
+    }
+  }
+  else
+  {
+    CapeFileInfo fh_info;
+
+    fh = cape_fh_new (NULL, file);
+
+    res = cape_fh_open (fh, O_RDONLY, err);
+    if (res)
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
       goto exit_and_cleanup;
     }
 
-    ret = cape_stream_new ();
-    
-    cape_udc_add_s_mv (file_node, "file", &file_rebuild);
-    cape_udc_add_s_cp (file_node, "mime", qwebs_files_mime (self, cape_fs_extension (path)));
+    res = cape_fh_info (fh, &fh_info, err);
+    if (res)
+    {
+      cape_err_set (err, CAPE_ERR_NOT_FOUND, "can't open file");
+      goto exit_and_cleanup;
+    }
+
+    if (fh_info.size != info.size)
+    {
+      // the file was changed between stat and open, send the whole file
+      qwebs_response_file_header (s, self->webs, mime, encoding, NULL, NULL, fh_info.size);
+
+      offset = 0;
+      length = fh_info.size;
+    }
+
+    // the content will be sent by the kernel
+    qwebs_connection_send_file (qwebs_request_conn (request), &s, &fh, offset, length);
   }
-  
-  qwebs_response_file (ret, self->webs, file_node);
 
 exit_and_cleanup:
-  
-  if (ret == NULL)
+
+  if (cape_err_code (err))
   {
-    ret = cape_stream_new ();
-    
-    //cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "send file", "got error: %s", cape_err_text (err));
-    qwebs_response_err (ret, self->webs, NULL, cape_udc_get_s (file_node, "mime", "application/json"), err);
+    CapeStream h = qwebs_files__response_err (self, err_mime, err);
+
+    qwebs_connection_send (qwebs_request_conn (request), &h);
   }
 
+  qwebs_files__entry_del (&entry);
+  cape_fh_del (&fh);
+  cape_stream_del (&s);
+  cape_str_del (&file_encoded);
   cape_str_del (&file_rebuild);
   cape_str_del (&file_relative);
-  cape_udc_del (&file_node);
   cape_err_del (&err);
-  
-  return ret;
 }
 
 //-----------------------------------------------------------------------------
@@ -16,7 +16,8 @@ __CAPE_LIBEX     QWebsFiles         qwebs_files_new           (QWebs webs);
 
 __CAPE_LIBEX     void               qwebs_files_del           (QWebsFiles*);
 
-__CAPE_LIBEX     CapeStream         qwebs_files_get           (QWebsFiles, QWebsRequest, const CapeString site, const CapeString path);
+                                    /* sends the file as response of the request, small files are served from the cache */
+__CAPE_LIBEX     void               qwebs_files_send          (QWebsFiles, QWebsRequest, const CapeString site, const CapeString path);
 
 //-----------------------------------------------------------------------------
 
@@ -9,29 +9,40 @@
 
 // c includes
 #include <ctype.h>
+#include <string.h>
+
+// header lines can't be larger
+#define QWEBS_MULTIPART_LINE_MAX 65536
+
+#define QWEBS_MULTIPART_STATE__PREAMBLE   0   // the first line, finds out the type of line breaks
+#define QWEBS_MULTIPART_STATE__HEADER     1   // header lines of a part until an empty line
+#define QWEBS_MULTIPART_STATE__CONTENT    2   // content of a part until the delimiter
+#define QWEBS_MULTIPART_STATE__BOUNDARY   3   // the rest of the line after the delimiter
+#define QWEBS_MULTIPART_STATE__EPILOGUE   4   // everything after the last boundary is ignored
 
 //-----------------------------------------------------------------------------
 
 struct QWebsMultipart_s
 {
   CapeString boundary;
+  CapeString delimiter;            // line break + boundary, marks the end of each content
+
+  CapeStream line;                 // header line or the beginning of a delimiter in the content
 
-  CapeStream buffer;
-  CapeStream line;
-  
   CapeStream content;
   CapeMap params;
 
-  number_t boundary_len__min;
-  number_t boundary_len__max;
-
   void* ptr;
   qwebs_multipart__on_part on_part;
 
+  qwebs_multipart__on_begin on_begin;
+  qwebs_multipart__on_data on_data;
+  qwebs_multipart__on_end on_end;
+
+  int streamed;                    // the content of the current part is passed to on_data
+
   int state;
-  int breakType;
-  int state2;
-  int line_break_add;
+  int breakType;                   // 1: CR, 2: LF, 3: CRLF
 };
 
 //-----------------------------------------------------------------------------
@@ -53,22 +64,24 @@ QWebsMultipart qwebs_multipart_new (const CapeString boundary, void* user_ptr, q
   QWebsMultipart self = CAPE_NEW (struct QWebsMultipart_s);
 
   self->boundary = cape_str_catenate_2 ("--", boundary);
-  
-  self->boundary_len__min = cape_str_size (self->boundary);
-  self->boundary_len__max = self->boundary_len__min + 4;
+  self->delimiter = NULL;
   
   self->on_part = on_part;
   self->ptr = user_ptr;
+
+  self->on_begin = NULL;
+  self->on_data = NULL;
+  self->on_end = NULL;
+
+  self->streamed = FALSE;
   
-  self->buffer = cape_stream_new ();
   self->line = cape_stream_new ();
   self->params = cape_map_new (NULL, qwebs_multipart__params__on_del, NULL);
   
-  self->state = 0;
+  self->state = QWEBS_MULTIPART_STATE__PREAMBLE;
   self->breakType = 0;
 
   self->content = NULL;
-  self->line_break_add = FALSE;
   
   return self;
 }
@@ -82,8 +95,8 @@ void qwebs_multipart_del (QWebsMultipart* p_self)
     QWebsMultipart self = *p_self;
     
     cape_str_del (&(self->boundary));
+    cape_str_del (&(self->delimiter));
 
-    cape_stream_del (&(self->buffer));
     cape_stream_del (&(self->line));
 
     cape_stream_del (&(self->content));
@@ -95,68 +108,78 @@ void qwebs_multipart_del (QWebsMultipart* p_self)
 
 //-----------------------------------------------------------------------------
 
-typedef struct
+void qwebs_multipart_stream (QWebsMultipart self, qwebs_multipart__on_begin on_begin, qwebs_multipart__on_data on_data, qwebs_multipart__on_end on_end)
 {
-  const char* pos;
-  number_t len;
-  
-  CapeString name;
-  
-} QWebsParserData;
+  self->on_begin = on_begin;
+  self->on_data = on_data;
+  self->on_end = on_end;
+}
 
 //-----------------------------------------------------------------------------
 
-void qwebs_multipart__pd__is_boundary (QWebsMultipart self, int addToContent)
+static void qwebs_multipart__content_add (QWebsMultipart self, const char* bufdat, number_t buflen)
 {
-  number_t lsize = cape_stream_size (self->line);
-  
-  // reached boundary
-  if ((lsize < self->boundary_len__max) && (lsize >= self->boundary_len__min) && cape_str_begins (cape_stream_data (self->line), self->boundary))
+  if (buflen == 0)
   {
-    // create a new http content
-    if (self->on_part)
-    {
-      self->on_part (self->ptr, cape_stream_data (self->content), cape_stream_size (self->content), self->params);
-    }
-    
-    // clear the map
-    cape_map_clr (self->params);
-    
-    // remove the content
-    cape_stream_del (&(self->content));
+    return;
+  }
 
-    self->line_break_add = FALSE;
+  if (self->streamed)
+  {
+    self->on_data (self->ptr, bufdat, buflen);
   }
-  else if (addToContent)
+  else
   {
-    if (self->line_break_add)
-    {
-      switch (self->breakType)
-      {
-        case 1: cape_stream_append_c (self->content, '\r'); break;
-        case 2: cape_stream_append_c (self->content, '\n'); break;
-        case 3:
-        {
-          cape_stream_append_c (self->content, '\r');
-          cape_stream_append_c (self->content, '\n');
-
-          break;
-        }
-      }
-      
-      self->line_break_add = FALSE;
-    }
-    
-    // append to content
-    cape_stream_append_stream (self->content, self->line);
-    
-    self->line_break_add = TRUE;
+    cape_stream_append_buf (self->content, bufdat, buflen);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_multipart__content_begin (QWebsMultipart self)
+{
+  self->streamed = FALSE;
+
+  if (self->on_begin)
+  {
+    self->streamed = self->on_begin (self->ptr, self->params);
+  }
+
+  if (!self->streamed)
+  {
+    self->content = cape_stream_new ();
+  }
+
+  self->state = QWEBS_MULTIPART_STATE__CONTENT;
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_multipart__content_end (QWebsMultipart self)
+{
+  if (self->streamed)
+  {
+    self->on_end (self->ptr);
+  }
+  else if (self->on_part)
+  {
+    // create a new http content
+    self->on_part (self->ptr, cape_stream_data (self->content), cape_stream_size (self->content), self->params);
   }
+
+  // clear the map
+  cape_map_clr (self->params);
+
+  // remove the content
+  cape_stream_del (&(self->content));
+
+  self->streamed = FALSE;
+  self->state = QWEBS_MULTIPART_STATE__BOUNDARY;
 }
 
 //-----------------------------------------------------------------------------
 
-void qwebs_multipart__pd__param (QWebsMultipart self)
+static void qwebs_multipart__param (QWebsMultipart self)
 {
   // add special header value to map
   CapeString key = NULL;
@@ -182,251 +205,245 @@ void qwebs_multipart__pd__param (QWebsMultipart self)
 
 //-----------------------------------------------------------------------------
 
-int qwebs_multipart__pd__line (QWebsMultipart self, QWebsParserData* pd)
+static void qwebs_multipart__line (QWebsMultipart self)
 {
-  if (self->content)
+  if (self->state == QWEBS_MULTIPART_STATE__BOUNDARY)
   {
-    qwebs_multipart__pd__is_boundary (self, TRUE);
+    // the last boundary ends with '--'
+    if (cape_str_begins (cape_stream_get (self->line), "--"))
+    {
+      self->state = QWEBS_MULTIPART_STATE__EPILOGUE;
+    }
+    else
+    {
+      self->state = QWEBS_MULTIPART_STATE__HEADER;
+    }
   }
   else if (cape_stream_size (self->line) == 0)
   {
-    self->content = cape_stream_new ();
+    // the header is complete
+    qwebs_multipart__content_begin (self);
   }
   else
   {
     // add to parameters
-    qwebs_multipart__pd__param (self);
+    qwebs_multipart__param (self);
   }
-  
-  cape_stream_clr (self->line);
 
-  return TRUE;
+  cape_stream_clr (self->line);
 }
 
 //-----------------------------------------------------------------------------
 
-int qwebs_multipart__pd__state0 (QWebsMultipart self, QWebsParserData* pd)
+static number_t qwebs_multipart__state_preamble (QWebsMultipart self, const char* bufdat, number_t buflen)
 {
-  // initial line
-  // find what kind of line breaks we have and parse
-  const char* c;
-  for (c = pd->pos; (pd->len > 0); c++)
+  // initial line, only used to find out what kind of line breaks we have
+  number_t i;
+
+  for (i = 0; i < buflen; i++)
   {
-    (pd->len)--;
-    
-    if (*c == '\r')
+    char c = bufdat[i];
+
+    if (self->breakType == 1)
     {
-      if (self->breakType > 0)
+      // the char after CR decides
+      if (c == '\n')
       {
-        cape_log_msg (CAPE_LL_WARN, "QWEBS", "multipart", "wrong sequence of breaks #1");
-        return FALSE;
+        self->breakType = 3;
+        i++;
       }
-      
-      self->breakType = 1;
-      continue;
+
+      break;
     }
-    
-    if (*c == '\n')
+
+    if (c == '\r')
     {
-      if (self->breakType == 0)
-      {
-        self->breakType = 2;
-        continue;
-      }
-      else if (self->breakType == 1)
-      {
-        self->breakType = 3;
-        continue;
-      }
-      else
-      {
-        cape_log_msg (CAPE_LL_WARN, "QWEBS", "multipart", "wrong sequence of breaks #2");
-        return FALSE;
-      }
+      self->breakType = 1;
     }
-    
-    // done, finding break type
-    if (self->breakType > 0)
+    else if (c == '\n')
     {
-      // TODO: parse first line
-      cape_stream_clr (self->line);
-      
-      (pd->len)++;
-      self->state = 1;
-      pd->pos = c;
-      
-      return TRUE;
+      self->breakType = 2;
+
+      i++;
+      break;
     }
   }
-  
-  return FALSE;
+
+  if (self->breakType == 0 || (self->breakType == 1 && i == buflen))
+  {
+    // wait for more data
+    return buflen;
+  }
+
+  switch (self->breakType)
+  {
+    case 1: self->delimiter = cape_str_catenate_2 ("\r", self->boundary); break;
+    case 2: self->delimiter = cape_str_catenate_2 ("\n", self->boundary); break;
+    case 3: self->delimiter = cape_str_catenate_2 ("\r\n", self->boundary); break;
+  }
+
+  self->state = QWEBS_MULTIPART_STATE__HEADER;
+
+  return i;
 }
 
 //-----------------------------------------------------------------------------
 
-int qwebs_multipart__pd__state1 (QWebsMultipart self, QWebsParserData* pd)
+static number_t qwebs_multipart__state_line (QWebsMultipart self, const char* bufdat, number_t buflen)
 {
-  int a = 0;
-  const char* c;
-  for (c = pd->pos; (pd->len > 0); c++)
+  // the last char of a line break
+  const char* pos = memchr (bufdat, self->breakType == 1 ? '\r' : '\n', buflen);
+
+  if (pos == NULL)
   {
-    (pd->len)--;
-    
-    // check break char
-    if (((self->breakType == 2) && (*c == '\n')) || ((self->breakType == 1) && (*c == '\r')))
+    cape_stream_append_buf (self->line, bufdat, buflen);
+
+    if (cape_stream_size (self->line) > QWEBS_MULTIPART_LINE_MAX)
     {
-      cape_stream_append_buf (self->line, pd->pos, a);
+      cape_log_msg (CAPE_LL_WARN, "QWEBS", "multipart", "header line is too long");
 
-      pd->pos = c + 1;
-      return qwebs_multipart__pd__line (self, pd);
+      self->state = QWEBS_MULTIPART_STATE__EPILOGUE;
     }
-    
-    // check break char
-    if ((self->breakType == 3) && (*c == '\r'))
-    {
-      cape_stream_append_buf (self->line, pd->pos, a);
 
-      self->state = 2;
-      pd->pos = c + 1;
+    return buflen;
+  }
 
-      return TRUE;
-    }
-    
-    if ((NULL == self->content) && ((*c == '\r')||(*c == '\n')))
+  cape_stream_append_buf (self->line, bufdat, pos - bufdat);
+
+  if (self->breakType == 3)
+  {
+    number_t size = cape_stream_size (self->line);
+
+    // the CR might be in the line from the last buffer
+    if (size && cape_stream_data (self->line)[size - 1] == '\r')
     {
-      cape_log_fmt (CAPE_LL_WARN, "QWEBS", "multipart", "wrong line break type %i with [%i]", self->breakType, *c);
-      return FALSE;
+      cape_stream_dec (self->line, 1);
     }
-    
-    a++;
   }
-  
-  cape_stream_append_buf (self->line, pd->pos, a);
-    
-  if (self->content)
-  {
-    qwebs_multipart__pd__is_boundary (self, FALSE);
-  }
-    
-  return FALSE;
+
+  qwebs_multipart__line (self);
+
+  return pos - bufdat + 1;
 }
 
 //-----------------------------------------------------------------------------
 
-int qwebs_multipart__pd__state2 (QWebsMultipart self, QWebsParserData* pd)
+static number_t qwebs_multipart__state_content (QWebsMultipart self, const char* bufdat, number_t buflen)
 {
-  const char* c;
-  for (c = pd->pos; (pd->len > 0); c++)
+  const char* delimiter = self->delimiter;
+  number_t delimiter_len = cape_str_size (self->delimiter);
+
+  const char* pos = bufdat;
+  const char* end = bufdat + buflen;
+
+  number_t kept = cape_stream_size (self->line);
+
+  if (kept)
   {
-    if ((self->breakType == 3) && (*c == '\n'))
-    {
-      (pd->len)--;
+    // the last buffer ended with the beginning of the delimiter
+    number_t need = delimiter_len - kept;
+    number_t len = buflen < need ? buflen : need;
 
-      self->state = 1;
-      pd->pos = c + 1;
-      
-      return qwebs_multipart__pd__line (self, pd);
-    }
-    
-    if (self->content)
-    {
-      cape_stream_append_c (self->line, '\r');
-      self->state = 1;
-      
-      return TRUE;
-    }
-    else
+    if (memcmp (bufdat, delimiter + kept, len) == 0)
     {
-      cape_log_fmt (CAPE_LL_WARN, "QWEBS", "multipart", "wrong sequence of breaks #3, break type %i with [%s]", self->breakType, *c);
-      return FALSE;
+      if (len == need)
+      {
+        cape_stream_clr (self->line);
+
+        qwebs_multipart__content_end (self);
+
+        return len;
+      }
+
+      // still not complete
+      cape_stream_append_buf (self->line, bufdat, len);
+
+      return len;
     }
-  }
-  
-  return FALSE;
-}
 
-//-----------------------------------------------------------------------------
+    // was part of the content
+    // -> the line break is only the first char of the delimiter, so no delimiter can start within
+    qwebs_multipart__content_add (self, cape_stream_data (self->line), kept);
 
-int qwebs_multipart__pd__state3 (QWebsMultipart self, QWebsParserData* pd)
-{
-  const char* c;
-  for (c = pd->pos; pd->len > 0; c++)
+    cape_stream_clr (self->line);
+  }
+
+  // find the first char of the delimiter and compare the rest
+  while (pos < end)
   {
-    (pd->len)--;
-    
-    if (((self->breakType == 2) && (*c == '\n')) || ((self->breakType == 1) && (*c == '\r')))
+    const char* found = memchr (pos, *delimiter, end - pos);
+
+    if (found == NULL)
     {
-      // line break !!
-      self->state = 1;
-      return TRUE;
+      break;
     }
-    
-    if ((self->breakType == 3) && (*c == '\r'))
+
+    if ((number_t)(end - found) < delimiter_len)
     {
-      self->state = 4;
-      return TRUE;
-    }
-    
-    //ecdevstream_appendc (self->devsteam, *c);
-  }
-  
-  return FALSE;
-}
+      // might be the beginning of the delimiter, check it with the next buffer
+      if (memcmp (found, delimiter, end - found) == 0)
+      {
+        qwebs_multipart__content_add (self, bufdat, found - bufdat);
 
-//-----------------------------------------------------------------------------
+        cape_stream_append_buf (self->line, found, end - found);
 
-int qwebs_multipart__pd__state4 (QWebsMultipart self, QWebsParserData* pd)
-{
-  const char* c;
-  for (c = pd->pos; pd->len > 0; c++)
-  {
-    (pd->len)--;
-    
-    if ((self->breakType == 3) && (*c == '\n'))
+        return buflen;
+      }
+    }
+    else if (memcmp (found, delimiter, delimiter_len) == 0)
     {
-      // line break !!
-      self->state = 1;
-      return TRUE;
+      qwebs_multipart__content_add (self, bufdat, found - bufdat);
+
+      qwebs_multipart__content_end (self);
+
+      return found - bufdat + delimiter_len;
     }
-    
-    //ecdevstream_appendc (self->devsteam, '\r');
-    //ecdevstream_appendc (self->devsteam, *c);
 
-    // continue
-    self->state = 3;
-    return TRUE;
+    pos = found + 1;
   }
-  
-  return FALSE;
-}
 
-//-----------------------------------------------------------------------------
+  // everything is content
+  qwebs_multipart__content_add (self, bufdat, buflen);
 
-int qwebs_multipart__pd__states (QWebsMultipart self, QWebsParserData* pd)
-{
-  switch (self->state)
-  {
-    case 0: return qwebs_multipart__pd__state0 (self, pd);
-    case 1: return qwebs_multipart__pd__state1 (self, pd);
-    case 2: return qwebs_multipart__pd__state2 (self, pd);
-    case 3: return qwebs_multipart__pd__state3 (self, pd);
-    case 4: return qwebs_multipart__pd__state4 (self, pd);
-  }
-  
-  return FALSE;
+  return buflen;
 }
 
 //-----------------------------------------------------------------------------
 
 void qwebs_multipart_process (QWebsMultipart self, const char* bufdat, number_t buflen)
 {
-  QWebsParserData pd;
-  
-  pd.pos = bufdat;
-  pd.len = buflen;
-  pd.name = NULL;
-  
-  while (qwebs_multipart__pd__states (self, &pd));
+  while (buflen > 0)
+  {
+    number_t processed;
+
+    switch (self->state)
+    {
+      case QWEBS_MULTIPART_STATE__PREAMBLE:
+      {
+        processed = qwebs_multipart__state_preamble (self, bufdat, buflen);
+        break;
+      }
+      case QWEBS_MULTIPART_STATE__HEADER:
+      case QWEBS_MULTIPART_STATE__BOUNDARY:
+      {
+        processed = qwebs_multipart__state_line (self, bufdat, buflen);
+        break;
+      }
+      case QWEBS_MULTIPART_STATE__CONTENT:
+      {
+        processed = qwebs_multipart__state_content (self, bufdat, buflen);
+        break;
+      }
+      default:
+      {
+        // ignore the rest
+        return;
+      }
+    }
+
+    bufdat += processed;
+    buflen -= processed;
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -13,14 +13,23 @@ struct QWebsMultipart_s; typedef struct QWebsMultipart_s* QWebsMultipart;
 
 typedef void  (__STDCALL *qwebs_multipart__on_part)  (void* ptr, const char* bufdat, number_t buflen, CapeMap part_values);
 
+typedef int   (__STDCALL *qwebs_multipart__on_begin) (void* ptr, CapeMap part_values);
+typedef void  (__STDCALL *qwebs_multipart__on_data)  (void* ptr, const char* bufdat, number_t buflen);
+typedef void  (__STDCALL *qwebs_multipart__on_end)   (void* ptr);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   QWebsMultipart    qwebs_multipart_new      (const CapeString boundary, void* user_ptr, qwebs_multipart__on_part);
 
 __CAPE_LIBEX   void              qwebs_multipart_del      (QWebsMultipart*);
 
+                                 /* can be called for each chunk of the body, the state is kept between the calls */
 __CAPE_LIBEX   void              qwebs_multipart_process  (QWebsMultipart, const char* bufdat, number_t buflen);
 
+                                 /* on_begin is called after the header of each part, if it returns TRUE the content
+                                    of the part is passed in pieces to on_data and finished with on_end instead of on_part */
+__CAPE_LIBEX   void              qwebs_multipart_stream   (QWebsMultipart, qwebs_multipart__on_begin, qwebs_multipart__on_data, qwebs_multipart__on_end);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   CapeString        qwebs_parse_line         (const CapeString line, const CapeString key_to_seek);
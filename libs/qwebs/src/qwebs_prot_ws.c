@@ -12,6 +12,9 @@
 // qcrypt includes
 #include <qcrypt.h>
 
+// c includes
+#include <string.h>
+
 //-----------------------------------------------------------------------------
 
 #define RFC_WEBSOCKET_FRAME__CONTINUATION    0x0
@@ -21,6 +24,12 @@
 #define RFC_WEBSOCKET_FRAME__PING            0x9
 #define RFC_WEBSOCKET_FRAME__PONG            0xa
 
+// larger messages will close the connection
+#define QWEBS_PROT_WEBSOCKET_MESSAGE_MAX     16777216
+
+// the maximum size of the frame header
+#define QWEBS_PROT_WEBSOCKET_HEADER_MAX      10
+
 //-----------------------------------------------------------------------------
 
 struct QWebsProtWebsocketConnection_s
@@ -39,11 +48,13 @@ struct QWebsProtWebsocketConnection_s
   int mask;
   
   number_t data_size;
-  CapeString masking_key;
+  cape_uint8 masking_key[4];
   cape_uint8 opcode;
   
-  CapeStream buffer;
+  CapeStream buffer;               // received bytes of an incomplete frame, kept for reuse
 
+  CapeStream message;              // payload of all frames of the current message, kept for reuse
+  cape_uint8 message_opcode;       // 0 -> no message was started
 };
 
 //-----------------------------------------------------------------------------
@@ -52,6 +63,7 @@ struct QWebsProtWebsocketConnection_s
 #define QWEBS_PROT_WEBSOCKET_RECV__HEADER1   1
 #define QWEBS_PROT_WEBSOCKET_RECV__LENGTH    2
 #define QWEBS_PROT_WEBSOCKET_RECV__PAYLOAD   3
+#define QWEBS_PROT_WEBSOCKET_RECV__CLOSED    4
 
 //-----------------------------------------------------------------------------
 
@@ -72,10 +84,12 @@ QWebsProtWebsocketConnection qwebs_prot_websocket_connection_new (QWebsProtWebso
   self->rsv3 = 0;
   self->mask = 0;
   
-  self->masking_key = NULL;
   self->opcode = 0;
   
-  self->buffer = NULL;
+  self->buffer = cape_stream_new ();
+
+  self->message = cape_stream_new ();
+  self->message_opcode = 0;
   
   return self;
 }
@@ -91,8 +105,8 @@ void qwebs_prot_websocket_connection_del (QWebsProtWebsocketConnection* p_self)
     // decrease the reference counter for this websocket addon
     qwebs_prot_websocket_dec (&(self->ws), &(self->conn_ptr));
         
-    cape_str_del (&(self->masking_key));
     cape_stream_del (&(self->buffer));
+    cape_stream_del (&(self->message));
     
     CAPE_DEL (p_self, struct QWebsProtWebsocketConnection_s);
   }
@@ -111,17 +125,74 @@ void __STDCALL qwebs_prot_websocket_connection__on_del (void** p_user_ptr)
 
 //-----------------------------------------------------------------------------
 
-/*
-void qwebs_prot_websocket__encode_payload (char* bufdat, number_t buflen, const CapeString m)
+static void qwebs_prot_websocket__unmask (char* dest, const char* src, number_t len, const cape_uint8* masking_key)
 {
-  number_t i;
-  
-  for (i = 0; i < buflen; i++)
+  number_t i = 0;
+  cape_uint64 key64;
+
+  // the key repeated to 64 bits, the byte order is the same as in the payload
+  {
+    cape_uint8 h[8] = {masking_key[0], masking_key[1], masking_key[2], masking_key[3], masking_key[0], masking_key[1], masking_key[2], masking_key[3]};
+
+    memcpy (&key64, h, 8);
+  }
+
+  // memcpy avoids unaligned access, the compiler reduces it to plain loads and stores
+  // -> the loop can be vectorized
+  for (; i + 8 <= len; i += 8)
+  {
+    cape_uint64 v;
+
+    memcpy (&v, src + i, 8);
+    v ^= key64;
+    memcpy (dest + i, &v, 8);
+  }
+
+  for (; i < len; i++)
   {
-    bufdat[i] = bufdat[i] ^ m[i % 4];
+    dest[i] = src[i] ^ masking_key[i % 4];
   }
 }
-*/
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_prot_websocket__frame (CapeStream s, number_t opcode, int fin, const char* bufdat, number_t buflen)
+{
+  /* the server is not allowed to send masked payload
+   * -> mask was set to 0
+   */
+
+  cape_stream_cap (s, QWEBS_PROT_WEBSOCKET_HEADER_MAX + buflen);
+
+  {
+    cape_uint8 bits01 = opcode;
+
+    if (fin)
+    {
+      bits01 |= 0B10000000;
+    }
+
+    cape_stream_append_08 (s, bits01);
+  }
+
+  if (buflen < 126)
+  {
+    cape_stream_append_08 (s, buflen);
+  }
+  else if (buflen < 65536)
+  {
+    cape_stream_append_08 (s, 126);
+    cape_stream_append_16 (s, buflen, TRUE);
+  }
+  else
+  {
+    cape_stream_append_08 (s, 127);
+    cape_stream_append_64 (s, buflen, TRUE);
+  }
+
+  // add the message to the buffer
+  cape_stream_append_buf (s, bufdat, buflen);
+}
 
 //-----------------------------------------------------------------------------
 
@@ -131,58 +202,10 @@ void qwebs_prot_websocket_send__frame (QWebsProtWebsocketConnection self, number
   {
     // local objects
     CapeStream s = cape_stream_new ();
-    number_t size_type = 0;
-    
-    /* the server is not allowed to send masked payload
-     * -> mask was set to 0
-     */
     
     cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "send frame", "buflen = %lu", buflen);
     
-    {
-      cape_uint8 bits01 = opcode;  // opcode text
-      
-      bits01 |= 0B10000000;   // fin
-      
-      cape_stream_append_08 (s, bits01);
-    }
-    {
-      cape_uint8 bits02 = 0;
-      
-      if (buflen < 126)
-      {
-        bits02 = buflen;
-      }
-      else if (buflen < 65535)
-      {
-        bits02 = 126;
-        size_type = 1;
-      }
-      else
-      {
-        bits02 = 127;
-        size_type = 2;
-      }
-      
-      cape_stream_append_08 (s, bits02);
-    }
-    
-    switch (size_type)
-    {
-      case 1:
-      {
-        cape_stream_append_16 (s, buflen, TRUE);
-        break;
-      }
-      case 2:
-      {
-        cape_stream_append_64 (s, buflen, TRUE);
-        break;
-      }
-    }
-    
-    // add the message to the buffer
-    cape_stream_append_buf (s, bufdat, buflen);
+    qwebs_prot_websocket__frame (s, opcode, TRUE, bufdat, buflen);
     
     qwebs_connection_send (self->conn, &s);
   }
@@ -209,6 +232,68 @@ void qwebs_prot_websocket_send_buf (QWebsProtWebsocketConnection self, const cha
 
 //-----------------------------------------------------------------------------
 
+void qwebs_prot_websocket_send_frag (QWebsProtWebsocketConnection self, const char* bufdat, number_t buflen, int binary, number_t fragment_size)
+{
+  if (self && self->conn)
+  {
+    // local objects
+    CapeStream s = cape_stream_new ();
+
+    number_t opcode = binary ? RFC_WEBSOCKET_FRAME__BINARY : RFC_WEBSOCKET_FRAME__TEXT;
+
+    if (fragment_size == 0)
+    {
+      // an empty message is sent as one empty frame
+      fragment_size = buflen > 0 ? buflen : 1;
+    }
+
+    // all frames are sent at once
+    cape_stream_cap (s, buflen + (buflen / fragment_size + 1) * QWEBS_PROT_WEBSOCKET_HEADER_MAX);
+
+    do
+    {
+      number_t len = buflen < fragment_size ? buflen : fragment_size;
+
+      qwebs_prot_websocket__frame (s, opcode, len == buflen, bufdat, len);
+
+      // all following frames continue the message
+      opcode = RFC_WEBSOCKET_FRAME__CONTINUATION;
+
+      bufdat += len;
+      buflen -= len;
+    }
+    while (buflen > 0);
+
+    qwebs_connection_send (self->conn, &s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_prot_websocket_send_list (QWebsProtWebsocketConnection self, CapeList messages)
+{
+  if (self && self->conn && cape_list_size (messages))
+  {
+    // local objects
+    CapeStream s = cape_stream_new ();
+    CapeListCursor* cursor = cape_list_cursor_create (messages, CAPE_DIRECTION_FORW);
+
+    while (cape_list_cursor_next (cursor))
+    {
+      const CapeString message = cape_list_node_data (cursor->node);
+
+      qwebs_prot_websocket__frame (s, RFC_WEBSOCKET_FRAME__TEXT, TRUE, message, cape_str_size (message));
+    }
+
+    cape_list_cursor_destroy (&cursor);
+
+    // one send for all messages
+    qwebs_connection_send (self->conn, &s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 struct QWebsProtWebsocket_s
 {
   void* user_ptr;
@@ -337,30 +422,72 @@ void qwebs_prot_websocket__decode_header1 (QWebsProtWebsocketConnection self, Ca
 
 //-----------------------------------------------------------------------------
 
-void qwebs_prot_websocket_connection__decode_payload (QWebsProtWebsocketConnection self, CapeCursor cursor)
+int qwebs_prot_websocket_connection__decode_payload (QWebsProtWebsocketConnection self, CapeCursor cursor)
 {
-  number_t i;
-  
-  CapeString h = cape_cursor_scan_s (cursor, self->data_size);
-  
+  // the payload was checked to be complete in the cursor
+  const char* payload = cape_cursor_tpos (cursor, self->data_size);
   
   // handle some opcodes
   switch (self->opcode)
   {
-    case RFC_WEBSOCKET_FRAME__TEXT:   // text frame
+    case RFC_WEBSOCKET_FRAME__TEXT:           // first frame of a text message
+    case RFC_WEBSOCKET_FRAME__BINARY:         // first frame of a binary message
+    {
+      cape_stream_clr (self->message);
+      
+      self->message_opcode = self->opcode;
+      
+      // fall through
+    }
+    case RFC_WEBSOCKET_FRAME__CONTINUATION:   // next frame of the current message
     {
-      if (self->masking_key)
+      if (self->message_opcode == 0)
       {
-        for (i = 0; i < self->data_size; i++)
-        {
-          h[i] = h[i] ^ self->masking_key[i % 4];
-        }
+        cape_log_msg (CAPE_LL_WARN, "QWEBS", "payload", "continuation frame without message");
+        break;
+      }
+      
+      if (cape_stream_size (self->message) + self->data_size > QWEBS_PROT_WEBSOCKET_MESSAGE_MAX)
+      {
+        cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "payload", "message exceeds %i bytes, close connection", QWEBS_PROT_WEBSOCKET_MESSAGE_MAX);
+        return FALSE;
       }
       
-      // TODO: run this in a queue
-      if (self->ws->on_msg)
+      // unmask directly into the message buffer
+      cape_stream_cap (self->message, self->data_size);
+      
+      if (self->mask)
+      {
+        qwebs_prot_websocket__unmask (cape_stream_pos (self->message), payload, self->data_size, self->masking_key);
+      }
+      else
       {
-        self->ws->on_msg (self->conn_ptr, h);
+        memcpy (cape_stream_pos (self->message), payload, self->data_size);
+      }
+      
+      cape_stream_set (self->message, self->data_size);
+      
+      if (self->fin)
+      {
+        // binary messages are not supported by the callback
+        if (self->message_opcode == RFC_WEBSOCKET_FRAME__TEXT && self->ws->on_msg)
+        {
+          // the stream is terminated by get, the buffer stays owned by the stream
+          self->ws->on_msg (self->conn_ptr, (CapeString)cape_stream_get (self->message));
+        }
+        
+        self->message_opcode = 0;
+        
+        // release large buffers, keep small ones for the next message
+        if (cape_stream_size (self->message) > 65536)
+        {
+          cape_stream_del (&(self->message));
+          self->message = cape_stream_new ();
+        }
+        else
+        {
+          cape_stream_clr (self->message);
+        }
       }
       
       break;
@@ -374,43 +501,34 @@ void qwebs_prot_websocket_connection__decode_payload (QWebsProtWebsocketConnecti
     }
     case RFC_WEBSOCKET_FRAME__PING:   // ping
     {
+      // control frames have a payload of max 125 bytes
+      char h[125];
+      
       cape_log_msg (CAPE_LL_TRACE, "QWEBS", "payload", "retrieved PING request");
-
-      qwebs_prot_websocket_send__frame (self, RFC_WEBSOCKET_FRAME__PONG, h, self->data_size);
       
-      break;
-    }
-  }
-  
-  cape_str_del (&h);
-}
-
-//-----------------------------------------------------------------------------
-
-void qwebs_prot_websocket_connection__adjust_buffer (QWebsProtWebsocketConnection self, CapeCursor cursor)
-{
-  // local objects
-  CapeStream h = NULL;
-  
-  {
-    // returns the bytes which had not been used for parsing
-    number_t bytes_left_to_scan = cape_cursor_tail (cursor);
-    
-    cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "on recv", "adjust buffer = %lu", bytes_left_to_scan);
-    
-    if (bytes_left_to_scan > 0)
-    {
-      h = cape_stream_new ();
+      if (self->data_size > 125)
+      {
+        cape_log_msg (CAPE_LL_ERROR, "QWEBS", "payload", "PING payload is too large, close connection");
+        return FALSE;
+      }
+      
+      if (self->mask)
+      {
+        qwebs_prot_websocket__unmask (h, payload, self->data_size, self->masking_key);
+      }
+      else
+      {
+        memcpy (h, payload, self->data_size);
+      }
       
-      // shift the buffer
-      // travers the cursor (to the end)
-      cape_stream_append_buf (h, cape_cursor_tpos (cursor, bytes_left_to_scan), bytes_left_to_scan);
+      // the PONG must contain the same application data
+      qwebs_prot_websocket_send__frame (self, RFC_WEBSOCKET_FRAME__PONG, h, self->data_size);
       
+      break;
     }
   }
   
-  // replace the buffer
-  cape_stream_replace_mv (&(self->buffer), &h);
+  return TRUE;
 }
 
 //-----------------------------------------------------------------------------
@@ -423,9 +541,12 @@ void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsCo
   // local objects
   CapeCursor cursor = cape_cursor_new ();
   
+  // incomplete frames from the last call must be continued
+  int use_buffer = cape_stream_size (self->buffer) > 0;
+  
   cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "websocket", "received buffer with len = %i", buflen);
 
-  if (self->buffer)
+  if (use_buffer)
   {
     // extend the current buffer with the data we received
     cape_stream_append_buf (self->buffer, bufdat, buflen);
@@ -435,6 +556,7 @@ void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsCo
   }
   else
   {
+    // parse directly from the received data, no copy is needed
     cape_cursor_set (cursor, bufdat, buflen);
   }
   
@@ -491,6 +613,15 @@ void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsCo
         {
           self->state = QWEBS_PROT_WEBSOCKET_RECV__LENGTH;
         }
+        
+        if (self->state == QWEBS_PROT_WEBSOCKET_RECV__LENGTH && self->data_size > QWEBS_PROT_WEBSOCKET_MESSAGE_MAX)
+        {
+          cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "on recv", "frame exceeds %i bytes, close connection", QWEBS_PROT_WEBSOCKET_MESSAGE_MAX);
+          
+          qwebs_connection_close (self->conn);
+          
+          self->state = QWEBS_PROT_WEBSOCKET_RECV__CLOSED;
+        }
        
         break;
       }
@@ -500,8 +631,7 @@ void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsCo
         {
           if (cape_cursor__has_data (cursor, 4))
           {
-            cape_str_del (&(self->masking_key));
-            self->masking_key = cape_cursor_scan_s (cursor, 4);
+            memcpy (self->masking_key, cape_cursor_tpos (cursor, 4), 4);
             
             self->state = QWEBS_PROT_WEBSOCKET_RECV__PAYLOAD;
           }
@@ -524,9 +654,16 @@ void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsCo
           cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "on recv", "payload length = %lu -> decode payload", self->data_size);
           
           // travers the cursor by self->data_size
-          qwebs_prot_websocket_connection__decode_payload (self, cursor);
-                    
-          self->state = QWEBS_PROT_WEBSOCKET_RECV__NONE;
+          if (qwebs_prot_websocket_connection__decode_payload (self, cursor))
+          {
+            self->state = QWEBS_PROT_WEBSOCKET_RECV__NONE;
+          }
+          else
+          {
+            qwebs_connection_close (self->conn);
+            
+            self->state = QWEBS_PROT_WEBSOCKET_RECV__CLOSED;
+          }
         }
         else
         {
@@ -537,15 +674,38 @@ void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsCo
         
         break;
       }
+      case QWEBS_PROT_WEBSOCKET_RECV__CLOSED:
+      {
+        // the connection is closing, ignore all further data
+        cape_cursor_tpos (cursor, cape_cursor_tail (cursor));
+        
+        has_enogh_bytes_for_parsing = FALSE;
+        break;
+      }
     }
   }
   
-  qwebs_prot_websocket_connection__adjust_buffer (self, cursor);
+  {
+    // returns the bytes which had not been used for parsing
+    number_t bytes_left_to_scan = cape_cursor_tail (cursor);
+    
+    cape_log_fmt (CAPE_LL_TRACE, "QWEBS", "on recv", "adjust buffer = %lu", bytes_left_to_scan);
+    
+    if (use_buffer)
+    {
+      // remove the parsed bytes, the allocated memory is kept
+      cape_stream_shift_l (self->buffer, cape_stream_size (self->buffer) - bytes_left_to_scan);
+    }
+    else if (bytes_left_to_scan > 0)
+    {
+      // keep only the incomplete frame
+      cape_stream_append_buf (self->buffer, cape_cursor_tpos (cursor, bytes_left_to_scan), bytes_left_to_scan);
+    }
+  }
   
   cape_cursor_del (&cursor);
 }
 
-
 //-----------------------------------------------------------------------------
 
 void* __STDCALL qwebs_prot_websocket__on_upgrade (void* user_ptr, QWebsRequest request, CapeMap return_header, CapeErr err)
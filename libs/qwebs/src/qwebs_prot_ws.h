@@ -10,6 +10,7 @@
 #include "stc/cape_str.h"
 #include "stc/cape_map.h"
 #include "stc/cape_stream.h"
+#include "stc/cape_list.h"
 
 //-----------------------------------------------------------------------------
 
@@ -53,6 +54,12 @@ __CAPE_LIBEX   void                 qwebs_prot_websocket_send_s     (QWebsProtWe
 
 __CAPE_LIBEX   void                 qwebs_prot_websocket_send_buf   (QWebsProtWebsocketConnection connection, const char* bufdat, number_t buflen);
 
+                                    /* sends one message split into frames of fragment_size bytes, all frames are sent at once */
+__CAPE_LIBEX   void                 qwebs_prot_websocket_send_frag  (QWebsProtWebsocketConnection connection, const char* bufdat, number_t buflen, int binary, number_t fragment_size);
+
+                                    /* sends each string of the list as text message with a single send */
+__CAPE_LIBEX   void                 qwebs_prot_websocket_send_list  (QWebsProtWebsocketConnection connection, CapeList messages);
+
 //-----------------------------------------------------------------------------
 
 #endif
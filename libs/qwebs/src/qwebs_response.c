@@ -1,5 +1,6 @@
 #include "qwebs_response.h"
 #include "qwebs.h"
+#include "qwebs_compress.h"
 
 // cape includes
 #include <sys/cape_file.h>
@@ -352,6 +353,169 @@ exit_and_cleanup:
 
 //-----------------------------------------------------------------------------
 
+static void qwebs_response__internal__validators (CapeStream s, const CapeString etag, const CapeString last_modified)
+{
+  if (etag)
+  {
+    cape_stream_append_str (s, "ETag: ");
+    cape_stream_append_str (s, etag);
+    cape_stream_append_str (s, "\r\n");
+  }
+
+  if (last_modified)
+  {
+    cape_stream_append_str (s, "Last-Modified: ");
+    cape_stream_append_str (s, last_modified);
+    cape_stream_append_str (s, "\r\n");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_response__internal__file_begin (CapeStream s, QWebs webs, int partial, const CapeString mime, const CapeString name)
+{
+  // BEGIN
+  cape_stream_clr (s);
+
+  if (partial)
+  {
+    cape_stream_append_str (s, "HTTP/1.1 206 Partial Content\r\n");
+  }
+  else
+  {
+    cape_stream_append_str (s, "HTTP/1.1 200 OK\r\n");
+  }
+
+  qwebs_response__internal__identification (s, qwebs_identifier (webs), qwebs_provider (webs));
+
+  // mime type
+  {
+    cape_stream_append_str (s, "Content-Type: ");
+    cape_stream_append_str (s, mime);
+    cape_stream_append_str (s, "\r\n");
+  }
+
+  // same as in qwebs_response_file__content
+  {
+    cape_stream_append_str (s, "Content-Disposition: inline; filename=\"");
+    cape_stream_append_str (s, name);
+    cape_stream_append_str (s, "\"; name=\"");
+    cape_stream_append_str (s, name);
+    cape_stream_append_str (s, "\"\r\n");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_response__internal__file_range (CapeStream s, number_t offset, number_t length, number_t size)
+{
+  cape_stream_append_str (s, "Accept-Ranges: bytes\r\n");
+
+  if (offset > 0 || length < size)
+  {
+    cape_stream_append_str (s, "Content-Range: bytes ");
+    cape_stream_append_n (s, offset);
+    cape_stream_append_c (s, '-');
+    cape_stream_append_n (s, offset + length - 1);
+    cape_stream_append_c (s, '/');
+    cape_stream_append_n (s, size);
+    cape_stream_append_str (s, "\r\n");
+  }
+
+  qwebs_response__internal__content_length (s, length);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_file_header (CapeStream s, QWebs webs, const CapeString mime, const CapeString encoding, const CapeString etag, const CapeString last_modified, number_t content_length)
+{
+  qwebs_response_file_header_range (s, webs, mime, encoding, etag, last_modified, 0, content_length, content_length);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_file_header_range (CapeStream s, QWebs webs, const CapeString mime, const CapeString encoding, const CapeString etag, const CapeString last_modified, number_t offset, number_t length, number_t size)
+{
+  qwebs_response__internal__file_begin (s, webs, offset > 0 || length < size, mime, "document");
+
+  if (encoding)
+  {
+    cape_stream_append_str (s, "Content-Encoding: ");
+    cape_stream_append_str (s, encoding);
+    cape_stream_append_str (s, "\r\n");
+  }
+
+  if (qwebs_compress_mime (mime))
+  {
+    // the content depends on the accepted encodings of the client
+    cape_stream_append_str (s, "Vary: Accept-Encoding\r\n");
+  }
+
+  qwebs_response__internal__validators (s, etag, last_modified);
+
+  qwebs_response__internal__file_range (s, offset, length, size);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_file_range (CapeStream s, QWebs webs, CapeUdc file_node, number_t offset, number_t length, number_t size)
+{
+  qwebs_response__internal__file_begin (s, webs, offset > 0 || length < size, cape_udc_get_s (file_node, "mime", "application/json"), cape_udc_get_s (file_node, "name", "document"));
+
+  qwebs_response__internal__file_range (s, offset, length, size);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_file_chunked (CapeStream s, QWebs webs, CapeUdc file_node)
+{
+  qwebs_response__internal__file_begin (s, webs, FALSE, cape_udc_get_s (file_node, "mime", "application/json"), cape_udc_get_s (file_node, "name", "document"));
+
+  // the size of the content is not known in advance
+  cape_stream_append_str (s, "Accept-Ranges: none\r\n");
+  cape_stream_append_str (s, "Transfer-Encoding: chunked\r\n");
+
+  // END
+  cape_stream_append_str (s, "\r\n");
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_range_err (CapeStream s, QWebs webs, number_t size)
+{
+  // BEGIN
+  cape_stream_clr (s);
+
+  cape_stream_append_str (s, "HTTP/1.1 416 Range Not Satisfiable\r\n");
+
+  qwebs_response__internal__identification (s, qwebs_identifier (webs), qwebs_provider (webs));
+
+  cape_stream_append_str (s, "Content-Range: bytes */");
+  cape_stream_append_n (s, size);
+  cape_stream_append_str (s, "\r\n");
+
+  qwebs_response__internal__content_length (s, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_not_modified (CapeStream s, QWebs webs, const CapeString etag, const CapeString last_modified)
+{
+  // BEGIN
+  cape_stream_clr (s);
+
+  cape_stream_append_str (s, "HTTP/1.1 304 Not Modified\r\n");
+
+  qwebs_response__internal__identification (s, qwebs_identifier (webs), qwebs_provider (webs));
+
+  qwebs_response__internal__validators (s, etag, last_modified);
+
+  // END
+  cape_stream_append_str (s, "\r\n");
+}
+
+//-----------------------------------------------------------------------------
+
 void qwebs_response_expires (CapeStream s, number_t ttl)
 {
   if (ttl > 0)
@@ -403,6 +567,48 @@ void qwebs_response_json (CapeStream s, QWebs webs, CapeUdc content, number_t tt
 
 //-----------------------------------------------------------------------------
 
+void qwebs_response_json_buf (CapeStream s, QWebs webs, const char* bufdat, number_t buflen, const CapeString encoding, number_t ttl)
+{
+  qwebs_response_json_header (s, webs, buflen, encoding, ttl);
+
+  cape_stream_append_buf (s, bufdat, buflen);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_json_header (CapeStream s, QWebs webs, number_t buflen, const CapeString encoding, number_t ttl)
+{
+  // BEGIN
+  cape_stream_clr (s);
+
+  cape_stream_append_str (s, "HTTP/1.1 200 OK\r\n");
+
+  qwebs_response__internal__identification (s, qwebs_identifier (webs), qwebs_provider (webs));
+
+  // mime type for JSON
+  {
+    cape_stream_append_str (s, "Content-Type: ");
+    cape_stream_append_str (s, "application/json;charset=UTF-8");
+    cape_stream_append_str (s, "\r\n");
+  }
+
+  if (encoding)
+  {
+    cape_stream_append_str (s, "Content-Encoding: ");
+    cape_stream_append_str (s, encoding);
+    cape_stream_append_str (s, "\r\n");
+  }
+
+  cape_stream_append_str (s, "Vary: Accept-Encoding\r\n");
+
+  // add expire date
+  qwebs_response_expires (s, ttl);
+
+  qwebs_response__internal__content_length (s, buflen);
+}
+
+//-----------------------------------------------------------------------------
+
 void qwebs_response_image (CapeStream s, QWebs webs, const CapeString buf)
 {
   // BEGIN
@@ -429,6 +635,15 @@ void qwebs_response_image (CapeStream s, QWebs webs, const CapeString buf)
 //-----------------------------------------------------------------------------
 
 void qwebs_response_buf (CapeStream s, QWebs webs, const CapeString buf, const CapeString mime_type, number_t ttl)
+{
+  qwebs_response_buf_header (s, webs, mime_type, cape_str_size (buf), ttl);
+
+  cape_stream_append_str (s, buf);
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_buf_header (CapeStream s, QWebs webs, const CapeString mime_type, number_t buflen, number_t ttl)
 {
   cape_stream_clr (s);
   
@@ -446,8 +661,7 @@ void qwebs_response_buf (CapeStream s, QWebs webs, const CapeString buf, const C
   // add expire date
   qwebs_response_expires (s, ttl);
 
-  qwebs_response__internal__content_length (s, cape_str_size (buf));
-  cape_stream_append_str (s, buf);
+  qwebs_response__internal__content_length (s, buflen);
 }
 
 //-----------------------------------------------------------------------------
@@ -641,6 +855,17 @@ void qwebs_response_mp_init (CapeStream s, QWebs webs, const CapeString boundary
 //-----------------------------------------------------------------------------
 
 void qwebs_response_mp_part (CapeStream s, QWebs webs, const CapeString boundary, const CapeString mime, const char* bufdat, number_t buflen)
+{
+  qwebs_response_mp_part_header (s, webs, boundary, mime, buflen);
+
+  cape_stream_append_buf (s, bufdat, buflen);
+
+  cape_stream_append_str (s, "\r\n");
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_response_mp_part_header (CapeStream s, QWebs webs, const CapeString boundary, const CapeString mime, number_t buflen)
 {
   // BEGIN
   cape_stream_clr (s);
@@ -654,10 +879,6 @@ void qwebs_response_mp_part (CapeStream s, QWebs webs, const CapeString boundary
   cape_stream_append_str (s, "\r\n");
 
   qwebs_response__internal__content_length (s, buflen);
-
-  cape_stream_append_buf (s, bufdat, buflen);
-
-  cape_stream_append_str (s, "\r\n");
 }
 
 //-----------------------------------------------------------------------------
@@ -16,12 +16,41 @@
 
 __CAPE_LIBEX   void      qwebs_response_file      (CapeStream s, QWebs webs, CapeUdc file_node);
 
+                         /* header of a static file, the content with the length of content_length must follow
+                            encoding is the content encoding of the file (NULL if not encoded)
+                            etag and last_modified are the validators of the file (can be NULL) */
+__CAPE_LIBEX   void      qwebs_response_file_header  (CapeStream s, QWebs webs, const CapeString mime, const CapeString encoding, const CapeString etag, const CapeString last_modified, number_t content_length);
+
+                         /* header of a part of a static file (206 if the range doesn't cover the whole file) */
+__CAPE_LIBEX   void      qwebs_response_file_header_range (CapeStream s, QWebs webs, const CapeString mime, const CapeString encoding, const CapeString etag, const CapeString last_modified, number_t offset, number_t length, number_t size);
+
+                         /* header of a file node, the content with the length of length must follow */
+__CAPE_LIBEX   void      qwebs_response_file_range   (CapeStream s, QWebs webs, CapeUdc file_node, number_t offset, number_t length, number_t size);
+
+                         /* header of a file node with unknown size, the content must follow in chunks */
+__CAPE_LIBEX   void      qwebs_response_file_chunked (CapeStream s, QWebs webs, CapeUdc file_node);
+
+                         /* 416 response, the range is outside of the content */
+__CAPE_LIBEX   void      qwebs_response_range_err    (CapeStream s, QWebs webs, number_t size);
+
+                         /* 304 response without content */
+__CAPE_LIBEX   void      qwebs_response_not_modified (CapeStream s, QWebs webs, const CapeString etag, const CapeString last_modified);
+
 __CAPE_LIBEX   void      qwebs_response_json      (CapeStream s, QWebs webs, CapeUdc content, number_t ttl);
 
+                         /* JSON response with an already serialized (and maybe encoded) content */
+__CAPE_LIBEX   void      qwebs_response_json_buf  (CapeStream s, QWebs webs, const char* bufdat, number_t buflen, const CapeString encoding, number_t ttl);
+
+                         /* only the header of qwebs_response_json_buf, the content must follow */
+__CAPE_LIBEX   void      qwebs_response_json_header (CapeStream s, QWebs webs, number_t buflen, const CapeString encoding, number_t ttl);
+
 __CAPE_LIBEX   void      qwebs_response_image     (CapeStream s, QWebs webs, const CapeString image_as_base64);
 
 __CAPE_LIBEX   void      qwebs_response_buf       (CapeStream s, QWebs webs, const CapeString buf, const CapeString mime_type, number_t ttl);
 
+                         /* only the header of qwebs_response_buf, the content must follow */
+__CAPE_LIBEX   void      qwebs_response_buf_header (CapeStream s, QWebs webs, const CapeString mime_type, number_t buflen, number_t ttl);
+
 __CAPE_LIBEX   void      qwebs_response_err       (CapeStream s, QWebs webs, CapeUdc content, const CapeString mime, CapeErr);
 
 __CAPE_LIBEX   void      qwebs_response_redirect  (CapeStream s, QWebs webs, const CapeString url);
@@ -30,6 +59,9 @@ __CAPE_LIBEX   void      qwebs_response_mp_init   (CapeStream s, QWebs webs, con
 
 __CAPE_LIBEX   void      qwebs_response_mp_part   (CapeStream s, QWebs webs, const CapeString boundary, const CapeString mime, const char* bufdat, number_t buflen);
 
+                         /* only the header of qwebs_response_mp_part, the content and "\r\n" must follow */
+__CAPE_LIBEX   void      qwebs_response_mp_part_header (CapeStream s, QWebs webs, const CapeString boundary, const CapeString mime, number_t buflen);
+
                          /* switching protocols */
 __CAPE_LIBEX   void      qwebs_response_sp        (CapeStream s, QWebs webs, const CapeString name, CapeMap return_headers);
 
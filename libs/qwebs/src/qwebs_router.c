@@ -0,0 +1,262 @@
+#include "qwebs_router.h"
+
+// c includes
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+struct QWebsRouterNode_s
+{
+  char* prefix;                    // bytes of the edge from the parent to this node
+  number_t prefix_len;
+
+  void* value;                     // NULL -> no key ends in this node
+
+  number_t children_cnt;
+
+  char* children_index;            // first byte of each child, same order as children
+  struct QWebsRouterNode_s** children;
+};
+
+typedef struct QWebsRouterNode_s* QWebsRouterNode;
+
+//-----------------------------------------------------------------------------
+
+static QWebsRouterNode qwebs_router_node__new (const char* bufdat, number_t buflen, void* value)
+{
+  QWebsRouterNode self = CAPE_NEW (struct QWebsRouterNode_s);
+
+  self->prefix = CAPE_ALLOC (buflen + 1);
+  self->prefix_len = buflen;
+
+  if (buflen)
+  {
+    memcpy (self->prefix, bufdat, buflen);
+  }
+
+  self->value = value;
+
+  self->children_cnt = 0;
+  self->children_index = NULL;
+  self->children = NULL;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_router_node__del (QWebsRouterNode* p_self, fct_qwebs_router__on_del on_del)
+{
+  if (*p_self)
+  {
+    QWebsRouterNode self = *p_self;
+    number_t i;
+
+    for (i = 0; i < self->children_cnt; i++)
+    {
+      qwebs_router_node__del (&(self->children[i]), on_del);
+    }
+
+    if (self->value && on_del)
+    {
+      on_del (self->value);
+    }
+
+    CAPE_FREE (self->children);
+    CAPE_FREE (self->children_index);
+    CAPE_FREE (self->prefix);
+
+    CAPE_DEL (p_self, struct QWebsRouterNode_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_router_node__append (QWebsRouterNode self, QWebsRouterNode child)
+{
+  // the arrays are only changed while the server is configured
+  // -> allocate them in the exact size
+  char* children_index = CAPE_ALLOC (self->children_cnt + 1);
+  QWebsRouterNode* children = CAPE_ALLOC ((self->children_cnt + 1) * sizeof(QWebsRouterNode));
+
+  if (self->children_cnt)
+  {
+    memcpy (children_index, self->children_index, self->children_cnt);
+    memcpy (children, self->children, self->children_cnt * sizeof(QWebsRouterNode));
+  }
+
+  children_index[self->children_cnt] = *(child->prefix);
+  children[self->children_cnt] = child;
+
+  CAPE_FREE (self->children_index);
+  CAPE_FREE (self->children);
+
+  self->children_index = children_index;
+  self->children = children;
+
+  self->children_cnt++;
+}
+
+//-----------------------------------------------------------------------------
+
+static QWebsRouterNode qwebs_router_node__child (QWebsRouterNode self, char c)
+{
+  if (self->children_cnt)
+  {
+    const char* pos = memchr (self->children_index, c, self->children_cnt);
+    if (pos)
+    {
+      return self->children[pos - self->children_index];
+    }
+  }
+
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_router_node__split (QWebsRouterNode self, number_t len)
+{
+  // move everything behind len into a new child
+  // -> the node itself stays in place, so the parent needs no update
+  QWebsRouterNode child = qwebs_router_node__new (self->prefix + len, self->prefix_len - len, self->value);
+
+  child->children_cnt = self->children_cnt;
+  child->children_index = self->children_index;
+  child->children = self->children;
+
+  self->prefix_len = len;
+  self->value = NULL;
+
+  self->children_cnt = 0;
+  self->children_index = NULL;
+  self->children = NULL;
+
+  qwebs_router_node__append (self, child);
+}
+
+//-----------------------------------------------------------------------------
+
+struct QWebsRouter_s
+{
+  QWebsRouterNode root;            // has always an empty prefix
+
+  fct_qwebs_router__on_del on_del;
+
+  number_t size;
+};
+
+//-----------------------------------------------------------------------------
+
+QWebsRouter qwebs_router_new (fct_qwebs_router__on_del on_del)
+{
+  QWebsRouter self = CAPE_NEW (struct QWebsRouter_s);
+
+  self->root = qwebs_router_node__new (NULL, 0, NULL);
+  self->on_del = on_del;
+
+  self->size = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_router_del (QWebsRouter* p_self)
+{
+  if (*p_self)
+  {
+    QWebsRouter self = *p_self;
+
+    qwebs_router_node__del (&(self->root), self->on_del);
+
+    CAPE_DEL (p_self, struct QWebsRouter_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int qwebs_router_add (QWebsRouter self, const char* bufdat, number_t buflen, void* value)
+{
+  QWebsRouterNode node = self->root;
+
+  if (value == NULL)
+  {
+    return FALSE;
+  }
+
+  while (TRUE)
+  {
+    QWebsRouterNode child;
+    number_t len = 0;
+
+    // find the common part of the key and the edge
+    while (len < node->prefix_len && len < buflen && node->prefix[len] == bufdat[len])
+    {
+      len++;
+    }
+
+    if (len < node->prefix_len)
+    {
+      qwebs_router_node__split (node, len);
+    }
+
+    bufdat += len;
+    buflen -= len;
+
+    if (buflen == 0)
+    {
+      if (node->value)
+      {
+        return FALSE;
+      }
+
+      node->value = value;
+      break;
+    }
+
+    child = qwebs_router_node__child (node, *bufdat);
+    if (child == NULL)
+    {
+      qwebs_router_node__append (node, qwebs_router_node__new (bufdat, buflen, value));
+      break;
+    }
+
+    node = child;
+  }
+
+  self->size++;
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+void* qwebs_router_get (QWebsRouter self, const char* bufdat, number_t buflen)
+{
+  QWebsRouterNode node = self->root;
+
+  while (buflen > 0)
+  {
+    node = qwebs_router_node__child (node, *bufdat);
+
+    if (node == NULL || node->prefix_len > buflen || memcmp (node->prefix, bufdat, node->prefix_len))
+    {
+      return NULL;
+    }
+
+    bufdat += node->prefix_len;
+    buflen -= node->prefix_len;
+  }
+
+  return node->value;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t qwebs_router_size (QWebsRouter self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
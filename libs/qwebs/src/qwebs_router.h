@@ -0,0 +1,42 @@
+#ifndef __QWEBS_ROUTER__H
+#define __QWEBS_ROUTER__H 1
+
+// cape includes
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* radix trie for the routing of requests
+ *
+ * -> keys are added while the server is configured, lookups are done
+ *    for each request directly on the bytes of the URL
+ * -> a lookup doesn't allocate memory and doesn't need a terminated string
+ * -> adding keys is not thread safe, all keys must be added before
+ *    the server is attached
+ */
+
+//-----------------------------------------------------------------------------
+
+struct QWebsRouter_s; typedef struct QWebsRouter_s* QWebsRouter;
+
+typedef void (__STDCALL *fct_qwebs_router__on_del) (void* value);
+
+//-----------------------------------------------------------------------------
+
+                                    /* on_del is called for each value when the router is deleted, can be NULL */
+__CAPE_LIBEX     QWebsRouter        qwebs_router_new    (fct_qwebs_router__on_del);
+
+__CAPE_LIBEX     void               qwebs_router_del    (QWebsRouter*);
+
+                                    /* returns FALSE if the key exists already, in this case the ownership of value stays with the caller */
+__CAPE_LIBEX     int                qwebs_router_add    (QWebsRouter, const char* bufdat, number_t buflen, void* value);
+
+                                    /* returns the value of the key or NULL */
+__CAPE_LIBEX     void*              qwebs_router_get    (QWebsRouter, const char* bufdat, number_t buflen);
+
+__CAPE_LIBEX     number_t           qwebs_router_size   (QWebsRouter);
+
+//-----------------------------------------------------------------------------
+
+#endif
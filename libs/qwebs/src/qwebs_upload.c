@@ -0,0 +1,344 @@
+#include "qwebs_upload.h"
+#include "qwebs_multipart.h"
+
+// cape includes
+#include <stc/cape_stream.h>
+#include <stc/cape_list.h>
+#include <sys/cape_file.h>
+#include <sys/cape_log.h>
+
+// qcrypt includes
+#include <qcrypt_file.h>
+
+// values are kept in memory, larger values are cut
+#define QWEBS_UPLOAD_VALUE_MAX 1048576
+
+//-----------------------------------------------------------------------------
+
+struct QWebsUpload_s
+{
+  CapeString path;
+  int encrypt;
+
+  QWebsMultipart multipart;
+
+  CapeUdc parts;                   // all complete parts
+  CapeList files;                  // all files which were created
+
+  // the current part
+
+  CapeUdc part;
+  CapeStream value;                // NULL -> the part is a file
+  CapeFileHandle fh;
+  QCryptFile crypt;
+
+  number_t size;
+  int failed;
+};
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_upload__files__on_del (void* ptr)
+{
+  CapeString file = ptr;
+
+  cape_fs_file_rm (file, NULL);
+
+  cape_str_del (&file);
+}
+
+//-----------------------------------------------------------------------------
+
+static void qwebs_upload__part_clr (QWebsUpload self)
+{
+  cape_udc_del (&(self->part));
+  cape_stream_del (&(self->value));
+  cape_fh_del (&(self->fh));
+  qcrypt_file_del (&(self->crypt));
+
+  self->size = 0;
+  self->failed = FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int qwebs_upload__file_open (QWebsUpload self, CapeErr err)
+{
+  int res;
+
+  // local objects
+  CapeString uuid = cape_str_uuid ();
+  CapeString file = cape_fs_path_merge (self->path, uuid);
+
+  // add the file first, so that it is removed in all cases
+  cape_list_push_back (self->files, cape_str_cp (file));
+
+  if (self->encrypt)
+  {
+    CapeString vsec = cape_str_random_s (32);
+
+    self->crypt = qcrypt_file_new (file);
+
+    // creates the file
+    res = qcrypt_file_encrypt (self->crypt, vsec, err);
+
+    cape_udc_add_b (self->part, "encrypted", TRUE);
+    cape_udc_add_s_mv (self->part, "vsec", &vsec);
+  }
+  else
+  {
+    self->fh = cape_fh_new (NULL, file);
+
+    res = cape_fh_open (self->fh, O_CREAT | O_WRONLY | O_TRUNC, err);
+  }
+
+  cape_udc_add_s_mv (self->part, "file", &file);
+
+  cape_str_del (&uuid);
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL qwebs_upload__on_begin (void* ptr, CapeMap part_values)
+{
+  QWebsUpload self = ptr;
+
+  // local objects
+  CapeString name = NULL;
+  CapeString filename = NULL;
+
+  qwebs_upload__part_clr (self);
+
+  self->part = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  {
+    CapeMapNode n = cape_map_find (part_values, "CONTENT-DISPOSITION");
+    if (n)
+    {
+      const CapeString disposition = cape_map_node_value (n);
+
+      name = qwebs_parse_line (disposition, "name");
+      filename = qwebs_parse_line (disposition, "filename");
+    }
+  }
+
+  if (NULL == name)
+  {
+    // parts without a name are not used
+    self->failed = TRUE;
+    goto exit_and_cleanup;
+  }
+
+  // the part named 'file' was always handled as file
+  if (filename || cape_str_equal (name, "file"))
+  {
+    CapeErr err = cape_err_new ();
+
+    if (filename)
+    {
+      cape_udc_add_s_mv (self->part, "filename", &filename);
+    }
+
+    {
+      CapeMapNode n = cape_map_find (part_values, "CONTENT-TYPE");
+      if (n)
+      {
+        cape_udc_add_s_cp (self->part, "mime", cape_map_node_value (n));
+      }
+    }
+
+    if (qwebs_upload__file_open (self, err))
+    {
+      cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "upload", "can't create temporary file: %s", cape_err_text (err));
+
+      self->failed = TRUE;
+    }
+
+    cape_err_del (&err);
+  }
+  else
+  {
+    self->value = cape_stream_new ();
+  }
+
+  cape_udc_add_s_mv (self->part, "name", &name);
+
+exit_and_cleanup:
+
+  cape_str_del (&name);
+  cape_str_del (&filename);
+
+  // all parts are streamed
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_upload__on_data (void* ptr, const char* bufdat, number_t buflen)
+{
+  QWebsUpload self = ptr;
+
+  if (self->failed)
+  {
+    return;
+  }
+
+  if (self->value)
+  {
+    if (self->size + buflen > QWEBS_UPLOAD_VALUE_MAX)
+    {
+      cape_log_msg (CAPE_LL_WARN, "QWEBS", "upload", "value is too large, part is skipped");
+
+      self->failed = TRUE;
+      return;
+    }
+
+    cape_stream_append_buf (self->value, bufdat, buflen);
+  }
+  else if (self->crypt)
+  {
+    CapeErr err = cape_err_new ();
+
+    if (qcrypt_file_write (self->crypt, bufdat, buflen, err))
+    {
+      cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "upload", "can't write file: %s", cape_err_text (err));
+
+      self->failed = TRUE;
+    }
+
+    cape_err_del (&err);
+  }
+  else if (self->fh)
+  {
+    // write might not take all bytes at once
+    while (buflen > 0)
+    {
+      number_t bytes_written = cape_fh_write_buf (self->fh, bufdat, buflen);
+
+      if (bytes_written <= 0 || bytes_written > buflen)
+      {
+        cape_log_msg (CAPE_LL_ERROR, "QWEBS", "upload", "can't write file");
+
+        self->failed = TRUE;
+        return;
+      }
+
+      bufdat += bytes_written;
+      buflen -= bytes_written;
+
+      self->size += bytes_written;
+    }
+
+    return;
+  }
+
+  self->size += buflen;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL qwebs_upload__on_end (void* ptr)
+{
+  QWebsUpload self = ptr;
+
+  if (self->crypt && !self->failed)
+  {
+    CapeErr err = cape_err_new ();
+
+    if (qcrypt_file_finalize (self->crypt, err))
+    {
+      cape_log_fmt (CAPE_LL_ERROR, "QWEBS", "upload", "can't write file: %s", cape_err_text (err));
+
+      self->failed = TRUE;
+    }
+
+    cape_err_del (&err);
+  }
+
+  if (!self->failed)
+  {
+    if (self->value)
+    {
+      CapeString h = cape_stream_to_str (&(self->value));
+
+      cape_udc_add_s_mv (self->part, "value", &h);
+    }
+    else
+    {
+      cape_udc_add_n (self->part, "size", self->size);
+    }
+
+    cape_udc_add (self->parts, &(self->part));
+  }
+
+  // closes the file
+  qwebs_upload__part_clr (self);
+}
+
+//-----------------------------------------------------------------------------
+
+QWebsUpload qwebs_upload_new (const CapeString path, int encrypt, const CapeString boundary)
+{
+  QWebsUpload self = CAPE_NEW (struct QWebsUpload_s);
+
+  self->path = cape_str_cp (path);
+  self->encrypt = encrypt;
+
+  self->multipart = qwebs_multipart_new (boundary, self, NULL);
+
+  qwebs_multipart_stream (self->multipart, qwebs_upload__on_begin, qwebs_upload__on_data, qwebs_upload__on_end);
+
+  self->parts = cape_udc_new (CAPE_UDC_LIST, NULL);
+  self->files = cape_list_new (qwebs_upload__files__on_del);
+
+  self->part = NULL;
+  self->value = NULL;
+  self->fh = NULL;
+  self->crypt = NULL;
+
+  self->size = 0;
+  self->failed = FALSE;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_upload_del (QWebsUpload* p_self)
+{
+  if (*p_self)
+  {
+    QWebsUpload self = *p_self;
+
+    // an incomplete part might be still open
+    qwebs_upload__part_clr (self);
+
+    qwebs_multipart_del (&(self->multipart));
+
+    cape_udc_del (&(self->parts));
+
+    // removes all files
+    cape_list_del (&(self->files));
+
+    cape_str_del (&(self->path));
+
+    CAPE_DEL (p_self, struct QWebsUpload_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void qwebs_upload_process (QWebsUpload self, const char* bufdat, number_t buflen)
+{
+  qwebs_multipart_process (self->multipart, bufdat, buflen);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc qwebs_upload_parts (QWebsUpload self)
+{
+  return self->parts;
+}
+
+//-----------------------------------------------------------------------------
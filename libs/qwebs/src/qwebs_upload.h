@@ -0,0 +1,41 @@
+#ifndef __QWEBS_UPLOAD__H
+#define __QWEBS_UPLOAD__H 1
+
+// cape includes
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_str.h"
+#include "stc/cape_udc.h"
+
+//=============================================================================
+
+/* parses a multipart body while it is received
+ *
+ * -> file parts are written directly into temporary files in path,
+ *    the body is never hold completely in memory
+ * -> all other parts are collected as values
+ * -> the temporary files are removed when the upload is deleted
+ */
+
+//-----------------------------------------------------------------------------
+
+struct QWebsUpload_s; typedef struct QWebsUpload_s* QWebsUpload;
+
+//-----------------------------------------------------------------------------
+
+                                    /* boundary is taken from the mime type, with encrypt each file is encrypted with its own key */
+__CAPE_LIBEX     QWebsUpload        qwebs_upload_new      (const CapeString path, int encrypt, const CapeString boundary);
+
+__CAPE_LIBEX     void               qwebs_upload_del      (QWebsUpload*);
+
+                                    /* can be called with each chunk of the body */
+__CAPE_LIBEX     void               qwebs_upload_process  (QWebsUpload, const char* bufdat, number_t buflen);
+
+                                    /* list of all complete parts
+                                       -> values: {name, value}
+                                       -> files: {name, filename, mime, file, size} + {encrypted, vsec} */
+__CAPE_LIBEX     CapeUdc            qwebs_upload_parts    (QWebsUpload);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,291 @@
+#include "qwebs_multipart.h"
+
+// cape includes
+#include "stc/cape_stream.h"
+#include "stc/cape_str.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+
+#define TEST_BOUNDARY "XyZ-boundary-42"
+
+// contents which are close to the delimiter, %s is replaced by the line break
+static const char* test_contents[] =
+{
+  "hello world",
+  "",
+  "two%slines",
+  "%s--XyZ-boundary-4",
+  "--XyZ-boundary-42 without a line break",
+  "%s-",
+  "%s--",
+  "ends with a line break%s",
+  "%s%s%s--XyZ-bound",
+  "\r\r\n\n-- mixed \n\r\n\r",
+  NULL
+};
+
+//-----------------------------------------------------------------------------------
+
+static void test__append_lb (CapeStream s, const char* text, const char* lb)
+{
+  const char* pos = text;
+  const char* found;
+
+  for (found = strstr (pos, "%s"); found; found = strstr (pos, "%s"))
+  {
+    cape_stream_append_buf (s, pos, found - pos);
+    cape_stream_append_str (s, lb);
+
+    pos = found + 2;
+  }
+
+  cape_stream_append_str (s, pos);
+}
+
+//-----------------------------------------------------------------------------------
+
+static void test__append_part (CapeStream s, const CapeString name, const char* bufdat, number_t buflen)
+{
+  cape_stream_append_str (s, "CONTENT-DISPOSITION=form-data; name=\"");
+  cape_stream_append_str (s, name);
+  cape_stream_append_str (s, "\"\nCONTENT-TYPE=text/plain\n[");
+  cape_stream_append_buf (s, bufdat, buflen);
+  cape_stream_append_str (s, "]\n");
+}
+
+//-----------------------------------------------------------------------------------
+
+static void test__create (const char* lb, CapeStream body, CapeStream expected)
+{
+  number_t i;
+
+  cape_stream_append_str (body, "--" TEST_BOUNDARY);
+  cape_stream_append_str (body, lb);
+
+  for (i = 0; test_contents[i]; i++)
+  {
+    CapeStream content = cape_stream_new ();
+    CapeString name = cape_str_fmt ("p%i", i);
+
+    test__append_lb (content, test_contents[i], lb);
+
+    if (i)
+    {
+      cape_stream_append_str (body, lb);
+      cape_stream_append_str (body, "--" TEST_BOUNDARY);
+      cape_stream_append_str (body, lb);
+    }
+
+    cape_stream_append_str (body, "Content-Disposition: form-data; name=\"");
+    cape_stream_append_str (body, name);
+    cape_stream_append_str (body, "\"");
+    cape_stream_append_str (body, lb);
+    cape_stream_append_str (body, "Content-Type: text/plain");
+    cape_stream_append_str (body, lb);
+    cape_stream_append_str (body, lb);
+    cape_stream_append_buf (body, cape_stream_data (content), cape_stream_size (content));
+
+    test__append_part (expected, name, cape_stream_data (content), cape_stream_size (content));
+
+    cape_str_del (&name);
+    cape_stream_del (&content);
+  }
+
+  cape_stream_append_str (body, lb);
+  cape_stream_append_str (body, "--" TEST_BOUNDARY "--");
+  cape_stream_append_str (body, lb);
+}
+
+//-----------------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeStream result;
+
+  CapeStream content;              // content of a streamed part
+
+} TestContext;
+
+//-----------------------------------------------------------------------------------
+
+static void test__add_values (TestContext* ctx, CapeMap part_values)
+{
+  CapeMapCursor cursor; cape_map_cursor_init (part_values, &cursor, CAPE_DIRECTION_FORW);
+
+  while (cape_map_cursor_next (&cursor))
+  {
+    cape_stream_append_str (ctx->result, cape_map_node_key (cursor.node));
+    cape_stream_append_c (ctx->result, '=');
+    cape_stream_append_str (ctx->result, cape_map_node_value (cursor.node));
+    cape_stream_append_c (ctx->result, '\n');
+  }
+
+  cape_stream_append_c (ctx->result, '[');
+}
+
+//-----------------------------------------------------------------------------------
+
+static void __STDCALL test__on_part (void* ptr, const char* bufdat, number_t buflen, CapeMap part_values)
+{
+  TestContext* ctx = ptr;
+
+  test__add_values (ctx, part_values);
+
+  cape_stream_append_buf (ctx->result, bufdat, buflen);
+  cape_stream_append_str (ctx->result, "]\n");
+}
+
+//-----------------------------------------------------------------------------------
+
+static int __STDCALL test__on_begin (void* ptr, CapeMap part_values)
+{
+  TestContext* ctx = ptr;
+
+  // the map is cleared after the part
+  test__add_values (ctx, part_values);
+
+  ctx->content = cape_stream_new ();
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------------
+
+static void __STDCALL test__on_data (void* ptr, const char* bufdat, number_t buflen)
+{
+  TestContext* ctx = ptr;
+
+  cape_stream_append_buf (ctx->content, bufdat, buflen);
+}
+
+//-----------------------------------------------------------------------------------
+
+static void __STDCALL test__on_end (void* ptr)
+{
+  TestContext* ctx = ptr;
+
+  cape_stream_append_buf (ctx->result, cape_stream_data (ctx->content), cape_stream_size (ctx->content));
+  cape_stream_append_str (ctx->result, "]\n");
+
+  cape_stream_del (&(ctx->content));
+}
+
+//-----------------------------------------------------------------------------------
+
+static CapeStream test__run (CapeStream body, number_t max_chunk, int streamed)
+{
+  TestContext ctx;
+
+  ctx.result = cape_stream_new ();
+  ctx.content = NULL;
+
+  {
+    QWebsMultipart mp = qwebs_multipart_new (TEST_BOUNDARY, &ctx, test__on_part);
+
+    const char* pos = cape_stream_data (body);
+    number_t left = cape_stream_size (body);
+
+    if (streamed)
+    {
+      qwebs_multipart_stream (mp, test__on_begin, test__on_data, test__on_end);
+    }
+
+    while (left > 0)
+    {
+      // 0 -> the whole body at once
+      number_t len = max_chunk ? (rand () % max_chunk) + 1 : left;
+
+      if (len > left)
+      {
+        len = left;
+      }
+
+      qwebs_multipart_process (mp, pos, len);
+
+      pos += len;
+      left -= len;
+    }
+
+    qwebs_multipart_del (&mp);
+  }
+
+  cape_stream_del (&(ctx.content));
+
+  return ctx.result;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__equal (CapeStream s1, CapeStream s2)
+{
+  return cape_stream_size (s1) == cape_stream_size (s2) && memcmp (cape_stream_data (s1), cape_stream_data (s2), cape_stream_size (s1)) == 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test01_chunked (const char* lb_name, const char* lb)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeStream body = cape_stream_new ();
+  CapeStream expected = cape_stream_new ();
+
+  test__create (lb, body, expected);
+
+  {
+    CapeStream whole = test__run (body, 0, FALSE);
+
+    if (!test__equal (whole, expected))
+    {
+      printf ("ERROR [%s]: whole buffer differs\n%s\n", lb_name, cape_stream_get (whole));
+      ret = 1;
+    }
+
+    cape_stream_del (&whole);
+  }
+
+  for (i = 0; (ret == 0) && (i < 200); i++)
+  {
+    // small chunks split the delimiter at every position
+    number_t max_chunk = (i % 2) ? 1 + (i % 13) : 1 + (i % 97);
+
+    CapeStream chunked = test__run (body, max_chunk, i % 3 == 0);
+
+    if (!test__equal (chunked, expected))
+    {
+      printf ("ERROR [%s]: chunked run #%lu differs\n%s\n", lb_name, i, cape_stream_get (chunked));
+      ret = 1;
+    }
+
+    cape_stream_del (&chunked);
+  }
+
+  cape_stream_del (&body);
+  cape_stream_del (&expected);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  srand (42);
+
+  res |= test01_chunked ("CRLF", "\r\n");
+
+  res |= test01_chunked ("LF", "\n");
+
+  res |= test01_chunked ("CR", "\r");
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
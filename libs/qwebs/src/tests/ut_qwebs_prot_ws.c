@@ -0,0 +1,527 @@
+#include "qwebs_prot_ws.h"
+#include "qwebs_connection.h"
+
+// cape includes
+#include "aio/cape_aio_ctx.h"
+#include "sys/cape_log.h"
+#include "stc/cape_list.h"
+#include "stc/cape_stream.h"
+#include "stc/cape_str.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------------
+
+// internal functions of the websocket protocol, used by the upgrade of a connection
+QWebsProtWebsocketConnection qwebs_prot_websocket_connection_new (QWebsProtWebsocket, QWebsConnection);
+
+void __STDCALL qwebs_prot_websocket_connection__on_recv (void* user_ptr, QWebsConnection conn, const char* bufdat, number_t buflen);
+
+void __STDCALL qwebs_prot_websocket_connection__on_del (void** p_user_ptr);
+
+//-----------------------------------------------------------------------------------
+
+#define TEST_MESSAGE_MAX   16777216
+
+static const cape_uint8 test_masking_key[4] = {0x12, 0x34, 0x56, 0x78};
+
+static number_t g_messages = 0;
+
+static number_t g_done = 0;
+
+static CapeStream g_message = NULL;
+
+//-----------------------------------------------------------------------------------
+
+static void __STDCALL test__on_msg (void* conn_ptr, CapeString message)
+{
+  g_messages++;
+
+  cape_stream_clr (g_message);
+  cape_stream_append_buf (g_message, message, strlen (message));
+}
+
+//-----------------------------------------------------------------------------------
+
+static void __STDCALL test__on_done (void* conn_ptr)
+{
+  g_done++;
+}
+
+//-----------------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeAioContext aio;
+
+  QWebsProtWebsocket ws;
+
+  QWebsConnection conn;            // owned by the AIO context
+
+  QWebsProtWebsocketConnection wsc;   // owned by the connection
+
+  int fds[2];
+
+} TestContext;
+
+//-----------------------------------------------------------------------------------
+
+static int test__init (TestContext* ctx)
+{
+  CapeErr err = cape_err_new ();
+
+  ctx->aio = cape_aio_context_new ();
+  ctx->ws = qwebs_prot_websocket_new ();
+
+  qwebs_prot_websocket_cb (ctx->ws, NULL, NULL, NULL, test__on_msg, test__on_done);
+
+  if (cape_aio_context_open (ctx->aio, err) || socketpair (AF_UNIX, SOCK_STREAM, 0, ctx->fds) < 0)
+  {
+    printf ("ERROR: can't initialize the connection\n");
+
+    cape_err_del (&err);
+    return 1;
+  }
+
+  // server side of the connection
+  ctx->conn = qwebs_connection_new ((void*)(number_t)ctx->fds[0], NULL, NULL, "test");
+
+  qwebs_connection_attach (ctx->conn, ctx->aio);
+
+  // switch the protocol like the upgrade does
+  ctx->wsc = qwebs_prot_websocket_connection_new (ctx->ws, ctx->conn);
+
+  qwebs_connection_upgrade (ctx->conn, ctx->wsc, qwebs_prot_websocket_connection__on_recv, qwebs_prot_websocket_connection__on_del);
+
+  g_messages = 0;
+  g_done = 0;
+
+  cape_err_del (&err);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__wait_done (TestContext* ctx)
+{
+  number_t i;
+
+  CapeErr err = cape_err_new ();
+
+  for (i = 0; (i < 50) && (g_done == 0); i++)
+  {
+    cape_aio_context_next (ctx->aio, 10, err);
+  }
+
+  cape_err_del (&err);
+
+  return g_done > 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__done (TestContext* ctx)
+{
+  int ret = 0;
+
+  if (g_done == 0)
+  {
+    qwebs_connection_close (ctx->conn);
+
+    if (!test__wait_done (ctx))
+    {
+      printf ("ERROR: connection was not closed\n");
+      ret = 1;
+    }
+  }
+
+  close (ctx->fds[1]);
+
+  cape_aio_context_del (&(ctx->aio));
+  qwebs_prot_websocket_del (&(ctx->ws));
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static void test__frame (CapeStream s, cape_uint8 opcode, int fin, const char* bufdat, number_t buflen, int mask)
+{
+  // frames of a client
+  cape_stream_append_08 (s, fin ? (opcode | 0x80) : opcode);
+
+  if (buflen < 126)
+  {
+    cape_stream_append_08 (s, buflen | (mask ? 0x80 : 0));
+  }
+  else if (buflen < 65536)
+  {
+    cape_stream_append_08 (s, 126 | (mask ? 0x80 : 0));
+    cape_stream_append_16 (s, buflen, TRUE);
+  }
+  else
+  {
+    cape_stream_append_08 (s, 127 | (mask ? 0x80 : 0));
+    cape_stream_append_64 (s, buflen, TRUE);
+  }
+
+  if (mask)
+  {
+    number_t i;
+
+    cape_stream_append_buf (s, (const char*)test_masking_key, 4);
+
+    for (i = 0; i < buflen; i++)
+    {
+      cape_stream_append_08 (s, bufdat[i] ^ test_masking_key[i % 4]);
+    }
+  }
+  else
+  {
+    cape_stream_append_buf (s, bufdat, buflen);
+  }
+}
+
+//-----------------------------------------------------------------------------------
+
+static void test__recv (TestContext* ctx, CapeStream s, number_t chunk_size)
+{
+  const char* bufdat = cape_stream_data (s);
+  number_t buflen = cape_stream_size (s);
+
+  CapeErr err = cape_err_new ();
+
+  // each chunk is received by its own read of the AIO context
+  while (buflen > 0 && g_done == 0)
+  {
+    number_t len = buflen < chunk_size ? buflen : chunk_size;
+    int bytes_left;
+
+    if (send (ctx->fds[1], bufdat, len, MSG_NOSIGNAL) != len)
+    {
+      break;
+    }
+
+    do
+    {
+      cape_aio_context_next (ctx->aio, 10, err);
+    }
+    while (g_done == 0 && ioctl (ctx->fds[0], FIONREAD, &bytes_left) == 0 && bytes_left > 0);
+
+    bufdat += len;
+    buflen -= len;
+  }
+
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------------
+
+static void test__text (char* bufdat, number_t buflen)
+{
+  number_t i;
+
+  for (i = 0; i < buflen; i++)
+  {
+    bufdat[i] = 'a' + (i % 26);
+  }
+}
+
+//-----------------------------------------------------------------------------------
+
+int test01_recv ()
+{
+  int ret = 0;
+  number_t i;
+
+  // one byte reads, reads within the header and the masking key, unaligned and larger reads
+  const number_t chunk_sizes[] = {1, 2, 3, 5, 7, 13, 64, 4096, 0};
+
+  TestContext ctx;
+
+  CapeStream s = cape_stream_new ();
+
+  char text[1000];
+
+  test__text (text, sizeof(text));
+
+  // a text message of 3 frames, length fields of 7 and 16 bits
+  // -> the lengths are no multiples of the word size of the unmask
+  test__frame (s, 0x1, FALSE, text, 123, TRUE);
+  test__frame (s, 0x0, FALSE, text + 123, 0, TRUE);
+  test__frame (s, 0x0, TRUE, text + 123, 877, TRUE);
+
+  // a binary message is not given to the callback
+  test__frame (s, 0x2, TRUE, text, 10, TRUE);
+
+  // an unmasked single frame
+  test__frame (s, 0x1, TRUE, text, 5, FALSE);
+
+  if (test__init (&ctx))
+  {
+    cape_stream_del (&s);
+    return 1;
+  }
+
+  for (i = 0; chunk_sizes[i]; i++)
+  {
+    number_t messages = g_messages;
+
+    test__recv (&ctx, s, chunk_sizes[i]);
+
+    // the last message
+    if (g_messages != messages + 2 || cape_stream_size (g_message) != 5 || memcmp (cape_stream_data (g_message), text, 5))
+    {
+      printf ("ERROR: wrong messages for chunk size %lu\n", chunk_sizes[i]);
+      ret = 1;
+    }
+  }
+
+  // the frames of a message are split by the reads
+  cape_stream_clr (s);
+
+  test__frame (s, 0x1, FALSE, text, 123, TRUE);
+  test__frame (s, 0x0, TRUE, text + 123, 877, TRUE);
+
+  test__recv (&ctx, s, 100);
+
+  if (cape_stream_size (g_message) != 1000 || memcmp (cape_stream_data (g_message), text, 1000))
+  {
+    printf ("ERROR: fragmented message was not reassembled\n");
+    ret = 1;
+  }
+
+  // a continuation without a message is ignored
+  {
+    number_t messages = g_messages;
+
+    cape_stream_clr (s);
+
+    test__frame (s, 0x0, TRUE, text, 10, TRUE);
+
+    test__recv (&ctx, s, 100);
+
+    if (g_messages != messages)
+    {
+      printf ("ERROR: continuation without message was accepted\n");
+      ret = 1;
+    }
+  }
+
+  ret |= test__done (&ctx);
+
+  cape_stream_del (&s);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__recv_limit (CapeStream s, const char* where)
+{
+  int ret = 0;
+
+  TestContext ctx;
+
+  if (test__init (&ctx))
+  {
+    return 1;
+  }
+
+  test__recv (&ctx, s, 65536);
+
+  if (!test__wait_done (&ctx))
+  {
+    printf ("ERROR [%s]: connection was not closed\n", where);
+    ret = 1;
+  }
+
+  if (g_messages)
+  {
+    printf ("ERROR [%s]: message was accepted\n", where);
+    ret = 1;
+  }
+
+  ret |= test__done (&ctx);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_limit ()
+{
+  int ret = 0;
+
+  CapeStream s = cape_stream_new ();
+
+  // a single frame which is too large, the header is enough
+  cape_stream_append_08 (s, 0x81);
+  cape_stream_append_08 (s, 127 | 0x80);
+  cape_stream_append_64 (s, TEST_MESSAGE_MAX + 1, TRUE);
+
+  ret |= test__recv_limit (s, "frame");
+
+  // the frames of a message are too large
+  {
+    CapeStream h = cape_stream_new ();
+
+    cape_stream_clr (s);
+
+    cape_stream_append_c_series (h, 'a', TEST_MESSAGE_MAX - 4);
+
+    test__frame (s, 0x1, FALSE, cape_stream_data (h), cape_stream_size (h), FALSE);
+    test__frame (s, 0x0, TRUE, "12345", 5, FALSE);
+
+    cape_stream_del (&h);
+  }
+
+  ret |= test__recv_limit (s, "message");
+
+  cape_stream_del (&s);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__sent (TestContext* ctx, CapeStream expected, const char* where)
+{
+  int ret = 0;
+  number_t i;
+
+  CapeErr err = cape_err_new ();
+  CapeStream s = cape_stream_new ();
+
+  // the AIO context writes into the socket
+  for (i = 0; (i < 50) && (cape_stream_size (s) < cape_stream_size (expected)); i++)
+  {
+    char buf[1024];
+    ssize_t len;
+
+    cape_aio_context_next (ctx->aio, 10, err);
+
+    while ((len = recv (ctx->fds[1], buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+    {
+      cape_stream_append_buf (s, buf, len);
+    }
+  }
+
+  if (cape_stream_size (s) != cape_stream_size (expected) || memcmp (cape_stream_data (s), cape_stream_data (expected), cape_stream_size (s)))
+  {
+    printf ("ERROR [%s]: sent %lu bytes instead of %lu\n", where, cape_stream_size (s), cape_stream_size (expected));
+    ret = 1;
+  }
+
+  cape_stream_del (&s);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test03_send ()
+{
+  int ret = 0;
+
+  TestContext ctx;
+
+  CapeStream s = cape_stream_new ();
+
+  char text[1000];
+
+  test__text (text, sizeof(text));
+
+  if (test__init (&ctx))
+  {
+    cape_stream_del (&s);
+    return 1;
+  }
+
+  // empty messages are sent as one empty frame
+  test__frame (s, 0x1, TRUE, NULL, 0, FALSE);
+  test__frame (s, 0x2, TRUE, NULL, 0, FALSE);
+
+  qwebs_prot_websocket_send_frag (ctx.wsc, NULL, 0, FALSE, 0);
+  qwebs_prot_websocket_send_frag (ctx.wsc, NULL, 0, TRUE, 100);
+
+  ret |= test__sent (&ctx, s, "empty");
+
+  // fragments with a shorter last one
+  cape_stream_clr (s);
+
+  test__frame (s, 0x1, FALSE, text, 300, FALSE);
+  test__frame (s, 0x0, FALSE, text + 300, 300, FALSE);
+  test__frame (s, 0x0, FALSE, text + 600, 300, FALSE);
+  test__frame (s, 0x0, TRUE, text + 900, 100, FALSE);
+
+  qwebs_prot_websocket_send_frag (ctx.wsc, text, 1000, FALSE, 300);
+
+  ret |= test__sent (&ctx, s, "fragments");
+
+  // one frame if the fragment size is not set or larger than the message
+  cape_stream_clr (s);
+
+  test__frame (s, 0x2, TRUE, text, 1000, FALSE);
+  test__frame (s, 0x1, TRUE, text, 10, FALSE);
+
+  qwebs_prot_websocket_send_frag (ctx.wsc, text, 1000, TRUE, 0);
+  qwebs_prot_websocket_send_frag (ctx.wsc, text, 10, FALSE, 1000);
+
+  ret |= test__sent (&ctx, s, "single frame");
+
+  // a list of messages, each in its own frame
+  {
+    CapeList messages = cape_list_new (NULL);
+
+    cape_list_push_back (messages, "hello");
+    cape_list_push_back (messages, "");
+    cape_list_push_back (messages, "world");
+
+    cape_stream_clr (s);
+
+    test__frame (s, 0x1, TRUE, "hello", 5, FALSE);
+    test__frame (s, 0x1, TRUE, "", 0, FALSE);
+    test__frame (s, 0x1, TRUE, "world", 5, FALSE);
+
+    qwebs_prot_websocket_send_list (ctx.wsc, messages);
+
+    ret |= test__sent (&ctx, s, "list");
+
+    cape_list_del (&messages);
+  }
+
+  ret |= test__done (&ctx);
+
+  cape_stream_del (&s);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  g_message = cape_stream_new ();
+
+  res |= test01_recv ();
+
+  res |= test02_limit ();
+
+  res |= test03_send ();
+
+  cape_stream_del (&g_message);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
@@ -0,0 +1,226 @@
+#include "qwebs_router.h"
+
+// cape includes
+#include "stc/cape_map.h"
+#include "stc/cape_str.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+
+static number_t g_deleted = 0;
+
+static void __STDCALL test__on_del (void* value)
+{
+  CapeString h = value; cape_str_del (&h);
+
+  g_deleted++;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__check (QWebsRouter router, const char* key, const char* expected)
+{
+  const char* value = qwebs_router_get (router, key, strlen (key));
+
+  if (expected == NULL ? value != NULL : !cape_str_equal (value, expected))
+  {
+    printf ("ERROR: key '%s' returned '%s' instead of '%s'\n", key, value ? value : "NULL", expected ? expected : "NULL");
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test01_split ()
+{
+  int ret = 0;
+  number_t i;
+
+  // each key splits an edge or ends within one
+  const char* keys[] = { "apps", "api", "ap", "a", "apple", "b", "api/v2", "apples", "", NULL };
+
+  QWebsRouter router = qwebs_router_new (test__on_del);
+
+  g_deleted = 0;
+
+  for (i = 0; keys[i]; i++)
+  {
+    if (!qwebs_router_add (router, keys[i], strlen (keys[i]), cape_str_cp (keys[i])))
+    {
+      printf ("ERROR: can't add '%s'\n", keys[i]);
+      ret = 1;
+    }
+
+    // all keys added so far must still be found after the split
+    {
+      number_t j;
+
+      for (j = 0; j <= i; j++)
+      {
+        ret |= test__check (router, keys[j], keys[j]);
+      }
+    }
+  }
+
+  // prefixes and extensions of keys which were not added
+  ret |= test__check (router, "app", NULL);
+  ret |= test__check (router, "apis", NULL);
+  ret |= test__check (router, "api/", NULL);
+  ret |= test__check (router, "applesauce", NULL);
+  ret |= test__check (router, "c", NULL);
+
+  // duplicates are rejected, the ownership stays with the caller
+  {
+    CapeString h = cape_str_cp ("x");
+
+    if (qwebs_router_add (router, "ap", 2, h))
+    {
+      printf ("ERROR: duplicate was added\n");
+      ret = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  ret |= test__check (router, "ap", "ap");
+
+  if (qwebs_router_size (router) != i)
+  {
+    printf ("ERROR: size %lu <> %lu\n", qwebs_router_size (router), i);
+    ret = 1;
+  }
+
+  // lookups work on slices of a larger buffer
+  {
+    const char* url = "apple/index.html";
+
+    if (!cape_str_equal (qwebs_router_get (router, url, 5), "apple") || !cape_str_equal (qwebs_router_get (router, url, 2), "ap"))
+    {
+      printf ("ERROR: lookup of a slice failed\n");
+      ret = 1;
+    }
+  }
+
+  qwebs_router_del (&router);
+
+  if (g_deleted != i)
+  {
+    printf ("ERROR: deleted %lu values instead of %lu\n", g_deleted, i);
+    ret = 1;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_random (number_t cnt)
+{
+  int ret = 0;
+  number_t i;
+
+  QWebsRouter router = qwebs_router_new (test__on_del);
+  CapeMap compare = cape_map_new (cape_map__compare__s, NULL, NULL);
+
+  g_deleted = 0;
+
+  for (i = 0; i < cnt; i++)
+  {
+    // a small alphabet results in many common prefixes
+    char buf[9];
+    number_t j, len = rand () % 8 + 1;
+
+    for (j = 0; j < len; j++)
+    {
+      buf[j] = "ab/"[rand () % 3];
+    }
+
+    buf[len] = '\0';
+
+    {
+      CapeString key = cape_str_cp (buf);
+      CapeMapNode n = cape_map_find (compare, key);
+
+      if (qwebs_router_add (router, key, len, key) != (n == NULL))
+      {
+        printf ("ERROR: add of '%s' differs\n", key);
+        ret = 1;
+      }
+
+      if (n)
+      {
+        cape_str_del (&key);
+      }
+      else
+      {
+        cape_map_insert (compare, key, key);
+      }
+    }
+  }
+
+  if (qwebs_router_size (router) != cape_map_size (compare))
+  {
+    printf ("ERROR: size %lu <> %lu\n", qwebs_router_size (router), cape_map_size (compare));
+    ret = 1;
+  }
+
+  // all strings up to the maximum length
+  for (i = 0; (ret == 0) && (i < 9841); i++)
+  {
+    char buf[9];
+    number_t len = 0, h = i;
+
+    // enumerate all strings over the alphabet (bijective base 3)
+    while (h > 0 && len < 8)
+    {
+      h--;
+      buf[len++] = "ab/"[h % 3];
+      h /= 3;
+    }
+
+    buf[len] = '\0';
+
+    {
+      CapeMapNode n = cape_map_find (compare, buf);
+
+      ret |= test__check (router, buf, n ? cape_map_node_value (n) : NULL);
+    }
+  }
+
+  qwebs_router_del (&router);
+
+  // the router owned all values of the map
+  if (g_deleted != cape_map_size (compare))
+  {
+    printf ("ERROR: deleted %lu values instead of %lu\n", g_deleted, cape_map_size (compare));
+    ret = 1;
+  }
+
+  cape_map_del (&compare);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  srand (42);
+
+  res |= test01_split ();
+
+  res |= test02_random (100);
+
+  res |= test02_random (3000);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
@@ -75,11 +75,11 @@ int auth_gp_get (AuthGP* p_self, QBusM qin, QBusM qout, CapeErr err)
 
   // check role
   {
-    CapeUdc roles = cape_udc_get (qin->rinfo, "roles");
+    CapeUdc roles = cape_udc_get_r (qin->rinfo, "roles");
     if (roles)
     {
       {
-        CapeUdc role_admin = cape_udc_get (roles, "wspc_admin");
+        CapeUdc role_admin = cape_udc_get_r (roles, "wspc_admin");
         if (role_admin)
         {
           gpid = 0;
@@ -87,7 +87,7 @@ int auth_gp_get (AuthGP* p_self, QBusM qin, QBusM qout, CapeErr err)
       }
 
       {
-        CapeUdc role_list_read = cape_udc_get (roles, "auth_gp_ls_r");
+        CapeUdc role_list_read = cape_udc_get_r (roles, "auth_gp_ls_r");
         if (role_list_read)
         {
           gpid = 0;
@@ -201,10 +201,11 @@ int auth_gp_account (AuthGP* p_self, QBusM qin, QBusM qout, CapeErr err)
   
   // add also allknown roles
   {
-    CapeUdc roles = cape_udc_get (qin->rinfo, "roles");
+    CapeUdc roles = cape_udc_get_r (qin->rinfo, "roles");
     if (roles)
     {
-      CapeUdc h = cape_udc_cp (roles);
+      // the roles are only read, share them with the rinfo
+      CapeUdc h = cape_udc_share (roles);
       cape_udc_add_name (first_row, &h, "roles");
     }
   }
@@ -167,8 +167,8 @@ int auth_tokens_add__memory (AuthTokens self, const CapeString uuid, QBusM qin,
   titem->extras = qin->cdata;
   qin->cdata = NULL;
   
-  // copy rinfo
-  titem->rinfo = cape_udc_cp (qin->rinfo);
+  // share rinfo, it will be copied when the token adds its name
+  titem->rinfo = cape_udc_share (qin->rinfo);
   
   cape_mutex_lock (self->mutex);
   
@@ -1180,7 +1180,7 @@ int auth_ui_login (AuthUI* p_self, QBusM qin, QBusM qout, CapeErr err)
   }
   else
   {
-    qout->cdata = cape_udc_cp (qin->rinfo);
+    qout->cdata = cape_udc_share (qin->rinfo);
   }
   
   adbl_trx_commit (&adbl_trx, err);
@@ -2673,7 +2673,7 @@ int auth_ui_switch (AuthUI* p_self, QBusM qin, QBusM qout, CapeErr err)
   // check role
   {
     CapeUdc role_admin;
-    CapeUdc roles = cape_udc_get (qin->rinfo, "roles");
+    CapeUdc roles = cape_udc_get_r (qin->rinfo, "roles");
     
     if (roles == NULL)
     {
@@ -2681,7 +2681,7 @@ int auth_ui_switch (AuthUI* p_self, QBusM qin, QBusM qout, CapeErr err)
       goto exit_and_cleanup;
     }
     
-    role_admin = cape_udc_get (roles, "auth_ui_su_w");
+    role_admin = cape_udc_get_r (roles, "auth_ui_su_w");
     if (role_admin == NULL)
     {
       res = cape_err_set (err, CAPE_ERR_NO_ROLE, "{ui switch} missing role");
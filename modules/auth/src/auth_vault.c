@@ -181,10 +181,10 @@ int auth_vault_get (AuthVault self, QBusM qin, QBusM qout, CapeErr err)
   else if (qin->cdata)  // depricated way
   {
     // we need to set a special role
-    CapeUdc roles = cape_udc_get (qin->rinfo, "roles");
+    CapeUdc roles = cape_udc_get_r (qin->rinfo, "roles");
     if (roles)
     {
-      CapeUdc h = cape_udc_get (roles, "__auth_vsec");
+      CapeUdc h = cape_udc_get_r (roles, "__auth_vsec");
       if (h)
       {
         wpid = cape_udc_get_n (qin->cdata, "wpid", 0);
@@ -0,0 +1,415 @@
+#include "auth_tokens.h"
+#include "auth_vault.h"
+#include "auth_gp.h"
+#include "auth_ui.h"
+
+// cape includes
+#include <sys/cape_log.h>
+#include <sys/cape_file.h>
+#include <fmt/cape_json.h>
+
+// sqlite includes
+#include <sqlite3.h>
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------------
+
+#define TEST_RINFO "{\"gpid\":2,\"roles\":{\"__auth_vsec\":1,\"admin\":1,\"auth_gp_ls_r\":1,\"auth_ui_su_w\":1},\"userid\":3,\"wpid\":1}"
+
+#define TEST_DBFILE "ut_auth_rinfo.db"
+
+//-----------------------------------------------------------------------------------
+
+static int test__expect (const CapeString where, CapeUdc node, const CapeString expected)
+{
+  int ret = 0;
+
+  CapeString h = cape_json_to_s (node);
+
+  if (!cape_str_equal (h, expected))
+  {
+    printf ("ERROR [%s]: %s instead of %s\n", where, h, expected);
+    ret = 1;
+  }
+
+  cape_str_del (&h);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__expect_shared (const CapeString where, CapeUdc rinfo, CapeUdc original)
+{
+  // the roles are the same object as long as nobody unshared the rinfo
+  if (cape_udc_get_r (rinfo, "roles") != cape_udc_get_r (original, "roles"))
+  {
+    printf ("ERROR [%s]: rinfo is not shared anymore\n", where);
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test01_tokens ()
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeString token = NULL;
+
+  AuthTokens tokens = auth_tokens_new (NULL, NULL);
+
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    qin->rinfo = cape_json_from_s (TEST_RINFO);
+
+    if (auth_tokens_add (tokens, qin, qout, err))
+    {
+      printf ("ERROR [tokens add]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+    else
+    {
+      token = cape_str_cp (cape_udc_get_s (qout->cdata, "Token", NULL));
+    }
+
+    // the caller changes its rinfo after the token was added
+    cape_udc_put_n (qin->rinfo, "wpid", 9);
+    cape_udc_add_n (cape_udc_get (qin->rinfo, "roles"), "changed", 1);
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  if (token)
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    if (auth_tokens_fetch (tokens, token, qin, qout, err))
+    {
+      printf ("ERROR [tokens fetch]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+    else
+    {
+      if (!cape_str_equal (cape_udc_get_s (qout->rinfo, "__T", NULL), token))
+      {
+        printf ("ERROR [tokens fetch]: token is missing in rinfo\n");
+        ret = 1;
+      }
+
+      {
+        CapeUdc h = cape_udc_ext (qout->rinfo, "__T");
+        cape_udc_del (&h);
+      }
+
+      // the change of the caller is not visible
+      ret |= test__expect ("tokens fetch", qout->rinfo, TEST_RINFO);
+    }
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  cape_str_del (&token);
+
+  auth_tokens_del (&tokens);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_roles ()
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc original = cape_json_from_s (TEST_RINFO);
+
+  AuthVault vault = auth_vault_new ();
+
+  auth_vault__save (vault, 5, "vsec");
+
+  // vault with the role of the deprecated way
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    qin->rinfo = cape_udc_share (original);
+    qin->cdata = cape_json_from_s ("{\"wpid\":5}");
+
+    if (auth_vault_get (vault, qin, qout, err))
+    {
+      printf ("ERROR [vault get]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+    else
+    {
+      ret |= test__expect ("vault get", qout->cdata, "{\"secret\":\"vsec\"}");
+    }
+
+    if (!qbus_message_role_has (qin, "admin") || qbus_message_role_has (qin, "user"))
+    {
+      printf ("ERROR [role has]: wrong roles\n");
+      ret = 1;
+    }
+
+    ret |= test__expect_shared ("vault get", qin->rinfo, original);
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  // switch with the role, it fails later because of the missing pdata
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    AuthUI ui = auth_ui_new (NULL, NULL, NULL, vault, NULL, NULL);
+
+    qin->rinfo = cape_udc_share (original);
+
+    if (auth_ui_switch (&ui, qin, qout, err) != CAPE_ERR_MISSING_PARAM)
+    {
+      printf ("ERROR [ui switch]: role was not found: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+
+    ret |= test__expect_shared ("ui switch", qin->rinfo, original);
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  // switch without the role
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    AuthUI ui = auth_ui_new (NULL, NULL, NULL, vault, NULL, NULL);
+
+    qin->rinfo = cape_json_from_s ("{\"wpid\":1,\"roles\":{\"admin\":1}}");
+
+    if (auth_ui_switch (&ui, qin, qout, err) != CAPE_ERR_NO_ROLE)
+    {
+      printf ("ERROR [ui switch]: missing role was not detected\n");
+      ret = 1;
+    }
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  ret |= test__expect ("original", original, TEST_RINFO);
+
+  auth_vault_del (&vault);
+  cape_udc_del (&original);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__db_create (void)
+{
+  int ret = 0;
+  sqlite3* handle;
+  char* errmsg = NULL;
+
+  const char* statement =
+    "CREATE TABLE rbac_users_view (wpid INTEGER, gpid INTEGER, userid INTEGER, title TEXT, firstname TEXT, lastname TEXT, workspace TEXT, secret TEXT);"
+    "CREATE TABLE auth_logins_view (wpid INTEGER, userid INTEGER, ltime TEXT, info TEXT);"
+    "CREATE TABLE auth_logins (id INTEGER PRIMARY KEY AUTOINCREMENT, wpid INTEGER, gpid INTEGER, userid INTEGER, status INTEGER, ltime TEXT, ip TEXT, info TEXT);"
+    "INSERT INTO rbac_users_view VALUES (1, 2, 3, 'Dr', 'Ada', 'Lovelace', 'test', NULL);"
+    "INSERT INTO rbac_users_view VALUES (1, 4, 5, 'Mr', 'Alan', 'Turing', 'test', NULL);";
+
+  cape_fs_file_rm (TEST_DBFILE, NULL);
+
+  if (sqlite3_open (TEST_DBFILE, &handle) != SQLITE_OK)
+  {
+    printf ("ERROR [db]: can't create the database\n");
+    return 1;
+  }
+
+  if (sqlite3_exec (handle, statement, 0, 0, &errmsg) != SQLITE_OK)
+  {
+    printf ("ERROR [db]: %s\n", errmsg);
+    ret = 1;
+  }
+
+  sqlite3_free (errmsg);
+  sqlite3_close (handle);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test03_database ()
+{
+  int ret = 0;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc original = cape_json_from_s (TEST_RINFO);
+
+  AdblCtx adbl_ctx = NULL;
+  AdblSession adbl_session = NULL;
+
+  if (test__db_create ())
+  {
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  adbl_ctx = adbl_ctx_new ("adbl", "adbl2_sqlite3", err);
+  if (adbl_ctx == NULL)
+  {
+    printf ("ERROR [db]: %s\n", cape_err_text (err));
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  {
+    CapeUdc properties = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_s_cp (properties, "schema", "test");
+    cape_udc_add_s_cp (properties, "dbfile", TEST_DBFILE);
+
+    adbl_session = adbl_session_open (adbl_ctx, properties, err);
+
+    cape_udc_del (&properties);
+  }
+
+  if (adbl_session == NULL)
+  {
+    printf ("ERROR [db]: %s\n", cape_err_text (err));
+    ret = 1;
+    goto exit_and_cleanup;
+  }
+
+  // the account gets the roles of the rinfo
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    AuthGP gp = auth_gp_new (adbl_session, NULL);
+
+    qin->rinfo = cape_udc_share (original);
+
+    if (auth_gp_account (&gp, qin, qout, err))
+    {
+      printf ("ERROR [gp account]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+    else
+    {
+      CapeUdc first_row = cape_udc_get_first (qout->cdata);
+
+      ret |= test__expect ("gp account", cape_udc_get_r (first_row, "roles"), "{\"__auth_vsec\":1,\"admin\":1,\"auth_gp_ls_r\":1,\"auth_ui_su_w\":1}");
+
+      // change the roles of the result
+      cape_udc_add_n (cape_udc_get (first_row, "roles"), "changed", 1);
+    }
+
+    ret |= test__expect_shared ("gp account", qin->rinfo, original);
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  // the admin role returns all accounts
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    AuthGP gp = auth_gp_new (adbl_session, NULL);
+
+    qin->rinfo = cape_udc_share (original);
+
+    if (auth_gp_get (&gp, qin, qout, err))
+    {
+      printf ("ERROR [gp get]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+    else if (cape_udc_size (qout->cdata) != 2)
+    {
+      printf ("ERROR [gp get]: %lu rows instead of 2\n", cape_udc_size (qout->cdata));
+      ret = 1;
+    }
+
+    ret |= test__expect_shared ("gp get", qin->rinfo, original);
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  // a login without previous logins returns the rinfo
+  {
+    QBusM qin = qbus_message_new (NULL, NULL);
+    QBusM qout = qbus_message_new (NULL, NULL);
+
+    AuthUI ui = auth_ui_new (NULL, adbl_session, NULL, NULL, NULL, NULL);
+
+    qin->rinfo = cape_udc_share (original);
+
+    if (auth_ui_login (&ui, qin, qout, err))
+    {
+      printf ("ERROR [ui login]: %s\n", cape_err_text (err));
+      ret = 1;
+    }
+    else
+    {
+      ret |= test__expect ("ui login", qout->cdata, TEST_RINFO);
+
+      // change the result
+      cape_udc_put_n (qout->cdata, "wpid", 9);
+      cape_udc_add_n (cape_udc_get (qout->cdata, "roles"), "changed", 1);
+    }
+
+    qbus_message_del (&qin);
+    qbus_message_del (&qout);
+  }
+
+  ret |= test__expect ("original", original, TEST_RINFO);
+
+exit_and_cleanup:
+
+  adbl_session_close (&adbl_session);
+  adbl_ctx_del (&adbl_ctx);
+
+  cape_fs_file_rm (TEST_DBFILE, NULL);
+
+  cape_udc_del (&original);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  res |= test01_tokens ();
+
+  res |= test02_roles ();
+
+  res |= test03_database ();
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
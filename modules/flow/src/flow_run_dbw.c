@@ -200,7 +200,7 @@ FlowRunDbw flow_run_dbw_new (QBus qbus, AdblSession adbl_session, CapeQueue queu
   self->jobs = jobs;
 
   self->remote = cape_str_cp (remote);
-  self->rinfo = cape_udc_cp (rinfo);
+  self->rinfo = cape_udc_share (rinfo);
   self->refid = refid;
 
   self->wpid = wpid;
@@ -259,7 +259,7 @@ FlowRunDbw flow_run_dbw_clone (FlowRunDbw rhs, number_t psid, number_t sqid, num
   self->jobs = rhs->jobs;
 
   self->remote = cape_str_cp (rhs->remote);
-  self->rinfo = cape_udc_cp (rhs->rinfo);
+  self->rinfo = cape_udc_share (rhs->rinfo);
   self->refid = refid;
 
   self->wpid = rhs->wpid;
@@ -279,8 +279,8 @@ FlowRunDbw flow_run_dbw_clone (FlowRunDbw rhs, number_t psid, number_t sqid, num
 
   self->tdata_id = 0;
 
-  // copy the tdata
-  self->tdata = cape_udc_cp (rhs->tdata);
+  // share the tdata, only the changed nodes will be copied
+  self->tdata = cape_udc_share (rhs->tdata);
 
   cape_log_fmt (CAPE_LL_DEBUG, "FLOW", "clone", "clone a process with refid = %i", refid);
 
@@ -1106,7 +1106,7 @@ int flow_run_dbw_done__callback (FlowRunDbw self, CapeErr err)
     {
       QBusM msg = qbus_message_new (NULL, NULL);
 
-      msg->rinfo = cape_udc_cp (self->rinfo);
+      msg->rinfo = cape_udc_share (self->rinfo);
       msg->cdata = cape_udc_ext (first_row, "params");
 
       if (msg->cdata == NULL)
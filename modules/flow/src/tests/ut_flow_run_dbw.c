@@ -0,0 +1,131 @@
+#include "flow_run_dbw.h"
+
+// cape includes
+#include <sys/cape_log.h>
+#include <fmt/cape_json.h>
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------------
+
+static int test__expect (const CapeString where, CapeUdc node, const CapeString expected)
+{
+  int ret = 0;
+
+  CapeString h = cape_json_to_s (node);
+
+  if (!cape_str_equal (h, expected))
+  {
+    printf ("ERROR [%s]: %s instead of %s\n", where, h, expected);
+    ret = 1;
+  }
+
+  cape_str_del (&h);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int test__expect_tdata (const CapeString where, FlowRunDbw dbw, const CapeString expected)
+{
+  int ret;
+
+  CapeUdc tdata = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  flow_run_dbw_tdata__merge_in (dbw, tdata);
+
+  ret = test__expect (where, tdata, expected);
+
+  cape_udc_del (&tdata);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test01_rinfo ()
+{
+  int ret = 0;
+
+  CapeUdc rinfo = cape_json_from_s ("{\"wpid\":1,\"roles\":{\"admin\":1}}");
+
+  FlowRunDbw dbw = flow_run_dbw_new (NULL, NULL, NULL, NULL, 1, 10, "remote", rinfo, 0);
+  FlowRunDbw cloned = flow_run_dbw_clone (dbw, 11, 0, 0);
+
+  // the caller changes its rinfo after the dbw was created
+  cape_udc_put_n (rinfo, "wpid", 2);
+  cape_udc_add_n (cape_udc_get (rinfo, "roles"), "user", 1);
+  cape_udc_del (&rinfo);
+
+  // the clone changes its rinfo
+  cape_udc_add_n (cape_udc_get (flow_run_dbw_rinfo_get (cloned), "roles"), "cloned", 1);
+
+  ret |= test__expect ("new", flow_run_dbw_rinfo_get (dbw), "{\"roles\":{\"admin\":1},\"wpid\":1}");
+  ret |= test__expect ("clone", flow_run_dbw_rinfo_get (cloned), "{\"roles\":{\"admin\":1,\"cloned\":1},\"wpid\":1}");
+
+  flow_run_dbw_del (&dbw);
+
+  ret |= test__expect ("clone after del", flow_run_dbw_rinfo_get (cloned), "{\"roles\":{\"admin\":1,\"cloned\":1},\"wpid\":1}");
+
+  flow_run_dbw_del (&cloned);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int test02_tdata ()
+{
+  int ret = 0;
+
+  FlowRunDbw dbw = flow_run_dbw_new (NULL, NULL, NULL, NULL, 1, 10, "remote", NULL, 1);
+  FlowRunDbw cloned;
+
+  {
+    CapeUdc tdata = cape_json_from_s ("{\"refid\":1,\"a\":{\"x\":1},\"b\":[1,2]}");
+
+    flow_run_dbw_tdata__merge_to (dbw, &tdata);
+  }
+
+  // the clone gets its own refid
+  cloned = flow_run_dbw_clone (dbw, 11, 0, 7);
+
+  ret |= test__expect_tdata ("clone", cloned, "{\"a\":{\"x\":1},\"b\":[1,2],\"refid\":7}");
+  ret |= test__expect_tdata ("original", dbw, "{\"a\":{\"x\":1},\"b\":[1,2],\"refid\":1}");
+
+  // merge new values into the clone, the nodes of the tdata are moved into the params
+  {
+    CapeUdc params = cape_json_from_s ("{\"c\":3}");
+
+    flow_run_dbw_tdata__merge_to (cloned, &params);
+  }
+
+  ret |= test__expect_tdata ("clone merged", cloned, "{\"a\":{\"x\":1},\"b\":[1,2],\"c\":3,\"refid\":7}");
+  ret |= test__expect_tdata ("original after merge", dbw, "{\"a\":{\"x\":1},\"b\":[1,2],\"refid\":1}");
+
+  flow_run_dbw_del (&dbw);
+
+  ret |= test__expect_tdata ("clone after del", cloned, "{\"a\":{\"x\":1},\"b\":[1,2],\"c\":3,\"refid\":7}");
+
+  flow_run_dbw_del (&cloned);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  cape_log_set_level (CAPE_LL_WARN);
+
+  res |= test01_rinfo ();
+
+  res |= test02_tdata ();
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------------
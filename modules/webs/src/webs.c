@@ -290,6 +290,15 @@ int qbus_webs__context_init (WebsContext self, QBus qbus, CapeErr err)
   
   // create a new QWEBS instance
   self->webs = qwebs_new (sites, host, port, threads, pages, route_list, identifier, provider);
+
+  // compression of JSON responses
+  qwebs_set_compression (self->webs, qbus_config_n (qbus, "compression_threshold", 1400), qbus_config_n (qbus, "compression_level", 6));
+
+  // worker threads for static files, API requests use 'threads'
+  qwebs_set_threads_files (self->webs, qbus_config_n (qbus, "threads_files", threads));
+
+  // multipart uploads are written into temporary files while receiving
+  qwebs_set_upload (self->webs, qbus_config_s (qbus, "upload_path", "/tmp"), qbus_config_b (qbus, "upload_encrypt", FALSE));
   
   res = qwebs_reg (self->webs, "json", qbus, qbus_webs__json, err);
   if (res)
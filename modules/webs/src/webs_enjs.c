@@ -326,12 +326,52 @@ void __STDCALL webs_enjs_run__mp__on_part (void* ptr, const char* bufdat, number
 
 //-----------------------------------------------------------------------------
 
+void webs_enjs_run__parts (WebsEnjs self, CapeUdc parts)
+{
+  CapeUdcCursor* cursor = cape_udc_cursor_new (parts, CAPE_DIRECTION_FORW);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc part = cursor->item;
+
+    if (cape_udc_get (part, "file"))  // content is a file
+    {
+      if (NULL == self->files)
+      {
+        self->files = cape_udc_new (CAPE_UDC_LIST, NULL);
+      }
+
+      // the file is removed together with the request
+      if (cape_udc_get_b (part, "encrypted", FALSE))
+      {
+        CapeUdc h = cape_udc_cp (part);
+        cape_udc_add (self->files, &h);
+      }
+      else
+      {
+        cape_udc_add_s_cp (self->files, NULL, cape_udc_get_s (part, "file", NULL));
+      }
+    }
+  }
+
+  cape_udc_cursor_del (&cursor);
+}
+
+//-----------------------------------------------------------------------------
+
 void webs_enjs_run__body (WebsEnjs self)
 {
   // get the body as stream from the incoming request
   CapeStream body = qwebs_request_body (self->request);
 
-  if (self->mime)
+  // multipart bodies might be parsed already
+  CapeUdc parts = qwebs_request_parts (self->request);
+
+  if (parts)
+  {
+    webs_enjs_run__parts (self, parts);
+  }
+  else if (self->mime)
   {
     //cape_log_fmt (CAPE_LL_TRACE, "WEBS", "auth run", "handling content type = %s", self->mime);
 
@@ -318,12 +318,58 @@ void __STDCALL webs__mp__on_part (void* ptr, const char* bufdat, number_t buflen
 
 //-----------------------------------------------------------------------------
 
+void webs__check_parts (WebsJson self, CapeUdc parts)
+{
+  CapeUdcCursor* cursor = cape_udc_cursor_new (parts, CAPE_DIRECTION_FORW);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    CapeUdc part = cursor->item;
+
+    if (cape_udc_get (part, "file"))  // content is a file
+    {
+      if (NULL == self->files)
+      {
+        self->files = cape_udc_new (CAPE_UDC_LIST, NULL);
+      }
+
+      // the file is removed together with the request
+      if (cape_udc_get_b (part, "encrypted", FALSE))
+      {
+        CapeUdc h = cape_udc_cp (part);
+        cape_udc_add (self->files, &h);
+      }
+      else
+      {
+        cape_udc_add_s_cp (self->files, NULL, cape_udc_get_s (part, "file", NULL));
+      }
+    }
+    else // a parameter
+    {
+      CapeString val = cape_str_cp (cape_udc_get_s (part, "value", NULL));
+      webs_add_param (self, cape_udc_get_s (part, "name", NULL), &val);
+    }
+  }
+
+  cape_udc_cursor_del (&cursor);
+}
+
+//-----------------------------------------------------------------------------
+
 void webs__check_body (WebsJson self)
 {
   // get the body as stream from the incoming request
   CapeStream body = qwebs_request_body (self->request);
 
-  if (self->mime)
+  // multipart bodies might be parsed already
+  CapeUdc parts = qwebs_request_parts (self->request);
+
+  if (parts)
+  {
+    // the multipart body was already parsed while receiving
+    webs__check_parts (self, parts);
+  }
+  else if (self->mime)
   {
     //cape_log_fmt (CAPE_LL_TRACE, "WEBS", "auth run", "handling content type = %s", self->mime);
 
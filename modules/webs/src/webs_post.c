@@ -147,6 +147,30 @@ int webs_post__parse__multipart (WebsPost self, CapeErr err)
 {
   CapeStream body = qwebs_request_body (self->request);
 
+  // multipart bodies might be parsed already
+  CapeUdc parts = qwebs_request_parts (self->request);
+
+  if (parts)
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (parts, CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      const CapeString name = cape_udc_get_s (cursor->item, "name", NULL);
+      const CapeString value = cape_udc_get_s (cursor->item, "value", NULL);
+
+      // files are not supported by forms
+      if (name && value)
+      {
+        webs_post__parse__add (self, name, value);
+      }
+    }
+
+    cape_udc_cursor_del (&cursor);
+
+    return CAPE_ERR_NONE;
+  }
+
   CapeString boundary = qwebs_parse_line (self->mime, "boundary");
   if (boundary)
   {